@@ -2,6 +2,7 @@
 
 #include "core/pomodoro_timer.h"
 #include "focus/focus_guard.h"
+#include "storage/session_writer.h"
 #include "tray/tray_item.h"
 #include "ui/dialogs.h"
 
@@ -19,6 +20,20 @@ app_state_create(GtkWindow *window, TaskStore *store)
   return state;
 }
 
+void
+app_state_shutdown(AppState *state)
+{
+  if (state == NULL) {
+    return;
+  }
+
+  /* A phase still running at quit is recorded as aborted, while the widgets
+   * its callback touches are still alive; then nothing more is recorded. */
+  pomodoro_timer_abort_phase(state->timer);
+  pomodoro_timer_set_phase_end_callback(state->timer, NULL, NULL);
+  g_clear_pointer(&state->session_writer, session_writer_free);
+}
+
 void
 app_state_free(gpointer data)
 {
@@ -31,6 +46,8 @@ app_state_free(gpointer data)
   dialogs_cleanup_timer_settings(state);
   dialogs_cleanup_archived(state);
 
+  g_clear_pointer(&state->session_writer, session_writer_free);
+
   tray_item_destroy(state);
 
   focus_guard_destroy(state->focus_guard);
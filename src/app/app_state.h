@@ -8,6 +8,7 @@ typedef struct _TaskRowControls TaskRowControls;
 typedef struct _PomodoroTimer PomodoroTimer;
 typedef struct _TrayItem TrayItem;
 typedef struct _FocusGuard FocusGuard;
+typedef struct _SessionWriter SessionWriter;
 
 typedef struct {
   TaskStore *store;
@@ -40,7 +41,9 @@ typedef struct {
   GtkWidget *focus_stats_day_label;
   GtkWidget *focus_stats_list;
   GtkWidget *focus_stats_empty_label;
+  GtkWidget *focus_heatmap;
   FocusGuard *focus_guard;
+  SessionWriter *session_writer;
   TrayItem *tray_item;
   gboolean close_to_tray;
   gboolean autostart_enabled;
@@ -50,4 +53,7 @@ typedef struct {
 } AppState;
 
 AppState *app_state_create(GtkWindow *window, TaskStore *store);
+/* Ends the running phase and drains pending writes; called from the
+ * application's "shutdown" signal, before any widget is torn down. */
+void app_state_shutdown(AppState *state);
 void app_state_free(gpointer data);
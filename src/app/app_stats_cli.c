@@ -0,0 +1,208 @@
+#include "app/app_stats_cli.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "storage/usage_stats_export.h"
+
+typedef struct {
+  char *export_path;
+  char *import_path;
+  char *format_name;
+  char *from_date;
+  char *to_date;
+  char *scope;
+} AppStatsCliOptions;
+
+typedef struct {
+  const char *verb;
+  gboolean tty;
+} AppStatsCliProgress;
+
+static gboolean
+parse_local_date(const char *text, gint64 *utc_out)
+{
+  int year = 0;
+  int month = 0;
+  int day = 0;
+  char trailing = '\0';
+  if (sscanf(text, "%d-%d-%d%c", &year, &month, &day, &trailing) != 3 ||
+      !g_date_valid_dmy((GDateDay)day, (GDateMonth)month, (GDateYear)year)) {
+    return FALSE;
+  }
+
+  GDateTime *local = g_date_time_new_local(year, month, day, 0, 0, 0);
+  if (local == NULL) {
+    return FALSE;
+  }
+
+  *utc_out = g_date_time_to_unix(local);
+  g_date_time_unref(local);
+  return TRUE;
+}
+
+static void
+on_cli_progress(guint64 rows_done, gint64 rows_total, gpointer user_data)
+{
+  AppStatsCliProgress *progress = user_data;
+  if (!progress->tty) {
+    return;
+  }
+
+  if (rows_total >= 0) {
+    fprintf(stderr,
+            "\r%s %" G_GUINT64_FORMAT " / %" G_GINT64_FORMAT " rows",
+            progress->verb,
+            rows_done,
+            rows_total);
+  } else {
+    fprintf(stderr, "\r%s %" G_GUINT64_FORMAT " rows", progress->verb, rows_done);
+  }
+}
+
+static int
+app_stats_cli_transfer(const AppStatsCliOptions *options)
+{
+  const char *path =
+      options->export_path != NULL ? options->export_path : options->import_path;
+  UsageStatsFormat format = usage_stats_format_for_path(path);
+  gint64 since_utc = 0;
+  gint64 until_utc = 0;
+  if (options->export_path != NULL && options->import_path != NULL) {
+    fprintf(stderr, "--export-stats and --import-stats cannot be combined\n");
+    return 2;
+  }
+  if (options->format_name != NULL &&
+      !usage_stats_format_parse(options->format_name, &format)) {
+    fprintf(stderr, "Unknown stats format '%s' (use csv or ndjson)\n", options->format_name);
+    return 2;
+  }
+  if (options->from_date != NULL && !parse_local_date(options->from_date, &since_utc)) {
+    fprintf(stderr, "Invalid --stats-from date '%s'\n", options->from_date);
+    return 2;
+  }
+  if (options->to_date != NULL) {
+    if (!parse_local_date(options->to_date, &until_utc)) {
+      fprintf(stderr, "Invalid --stats-to date '%s'\n", options->to_date);
+      return 2;
+    }
+    /* The last day is inclusive. */
+    GDateTime *day = g_date_time_new_from_unix_local(until_utc);
+    GDateTime *next = g_date_time_add_days(day, 1);
+    until_utc = g_date_time_to_unix(next);
+    g_date_time_unref(next);
+    g_date_time_unref(day);
+  }
+  if (options->scope != NULL && g_strcmp0(options->scope, "global") != 0 &&
+      g_strcmp0(options->scope, "task") != 0) {
+    fprintf(stderr, "Unknown stats scope '%s' (use global or task)\n", options->scope);
+    return 2;
+  }
+
+  UsageStatsStore *store = usage_stats_store_new();
+  if (store == NULL) {
+    fprintf(stderr, "Could not open the usage stats database\n");
+    return 1;
+  }
+
+  gboolean exporting = options->export_path != NULL;
+  AppStatsCliProgress progress = {
+      .verb = exporting ? "Exported" : "Imported",
+      .tty = isatty(fileno(stderr)),
+  };
+  GFile *file = g_file_new_for_commandline_arg(path);
+  GError *error = NULL;
+  guint64 rows = 0;
+  gboolean ok = exporting ? usage_stats_export_file(store,
+                                                    file,
+                                                    format,
+                                                    options->scope,
+                                                    since_utc,
+                                                    until_utc,
+                                                    on_cli_progress,
+                                                    &progress,
+                                                    NULL,
+                                                    &rows,
+                                                    &error)
+                          : usage_stats_import_file(store,
+                                                    file,
+                                                    format,
+                                                    on_cli_progress,
+                                                    &progress,
+                                                    NULL,
+                                                    &rows,
+                                                    &error);
+  if (progress.tty) {
+    fprintf(stderr, "\n");
+  }
+
+  int status = 0;
+  if (ok) {
+    fprintf(stderr, "%s %" G_GUINT64_FORMAT " rows\n", progress.verb, rows);
+  } else {
+    fprintf(stderr,
+            "Stats %s failed: %s\n",
+            exporting ? "export" : "import",
+            error != NULL ? error->message : "unknown error");
+    g_clear_error(&error);
+    status = 1;
+  }
+
+  g_object_unref(file);
+  usage_stats_store_free(store);
+  return status;
+}
+
+gboolean
+app_stats_cli_run(int *argc, char ***argv, int *status_out)
+{
+  if (argc == NULL || argv == NULL || *argv == NULL || status_out == NULL) {
+    return FALSE;
+  }
+
+  AppStatsCliOptions options = {0};
+  GOptionEntry entries[] = {
+      {"export-stats", 0, 0, G_OPTION_ARG_FILENAME, &options.export_path,
+       "Write usage stats to FILE and exit", "FILE"},
+      {"import-stats", 0, 0, G_OPTION_ARG_FILENAME, &options.import_path,
+       "Merge usage stats from FILE and exit; buckets in FILE replace stored ones "
+       "(task totals are not updated)",
+       "FILE"},
+      {"stats-format", 0, 0, G_OPTION_ARG_STRING, &options.format_name,
+       "csv or ndjson (default: from the file extension)", "FORMAT"},
+      {"stats-from", 0, 0, G_OPTION_ARG_STRING, &options.from_date,
+       "First day to export", "YYYY-MM-DD"},
+      {"stats-to", 0, 0, G_OPTION_ARG_STRING, &options.to_date,
+       "Last day to export", "YYYY-MM-DD"},
+      {"stats-scope", 0, 0, G_OPTION_ARG_STRING, &options.scope,
+       "global or task (default: both)", "SCOPE"},
+      {NULL},
+  };
+
+  /* GApplication parses the rest, so unknown options and --help pass through. */
+  GOptionContext *context = g_option_context_new(NULL);
+  g_option_context_add_main_entries(context, entries, NULL);
+  g_option_context_set_help_enabled(context, FALSE);
+  g_option_context_set_ignore_unknown_options(context, TRUE);
+
+  GError *error = NULL;
+  gboolean handled = TRUE;
+  if (!g_option_context_parse(context, argc, argv, &error)) {
+    fprintf(stderr, "%s\n", error->message);
+    g_clear_error(&error);
+    *status_out = 2;
+  } else if (options.export_path != NULL || options.import_path != NULL) {
+    *status_out = app_stats_cli_transfer(&options);
+  } else {
+    handled = FALSE;
+  }
+
+  g_option_context_free(context);
+  g_free(options.export_path);
+  g_free(options.import_path);
+  g_free(options.format_name);
+  g_free(options.from_date);
+  g_free(options.to_date);
+  g_free(options.scope);
+  return handled;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <glib.h>
+
+/* Handles --export-stats/--import-stats before the GUI starts. Returns TRUE
+ * when one of them was given, with the process exit code in status_out. */
+gboolean app_stats_cli_run(int *argc, char ***argv, int *status_out);
@@ -9,6 +9,9 @@ struct _PomodoroTimer {
   guint breaks_completed;
   gint64 focus_ms_total;
   gint64 break_ms_total;
+  gint64 phase_started_us;
+  gint64 phase_active_ms;
+  guint phase_interruptions;
   gboolean use_test_durations;
   gint64 focus_ms_override;
   gint64 short_break_ms_override;
@@ -18,6 +21,8 @@ struct _PomodoroTimer {
   PomodoroTimerUpdateFn tick_cb;
   PomodoroTimerUpdateFn phase_cb;
   gpointer user_data;
+  PomodoroTimerPhaseEndFn phase_end_cb;
+  gpointer phase_end_user_data;
 };
 
 static gint64
@@ -108,6 +113,30 @@ pomodoro_timer_fire_phase(PomodoroTimer *timer)
   }
 }
 
+static void
+pomodoro_timer_end_phase(PomodoroTimer *timer, PomodoroPhaseOutcome outcome)
+{
+  if (timer == NULL) {
+    return;
+  }
+
+  if (timer->phase_active_ms > 0 && timer->phase_end_cb != NULL) {
+    PomodoroPhaseRecord record = {
+        .phase = timer->phase,
+        .outcome = outcome,
+        .started_at_utc = timer->phase_started_us / G_USEC_PER_SEC,
+        .ended_at_utc = g_get_real_time() / G_USEC_PER_SEC,
+        .active_ms = timer->phase_active_ms,
+        .interruptions = timer->phase_interruptions,
+    };
+    timer->phase_end_cb(timer, &record, timer->phase_end_user_data);
+  }
+
+  timer->phase_started_us = 0;
+  timer->phase_active_ms = 0;
+  timer->phase_interruptions = 0;
+}
+
 static PomodoroPhase
 pomodoro_timer_break_for_count(const PomodoroTimer *timer, guint focus_count)
 {
@@ -148,6 +177,9 @@ pomodoro_timer_advance_phase(PomodoroTimer *timer)
   }
 
   timer->remaining_ms = pomodoro_timer_phase_duration_ms(timer, timer->phase);
+  if (timer->state == POMODORO_TIMER_RUNNING) {
+    timer->phase_started_us = g_get_real_time();
+  }
 }
 
 static gboolean
@@ -176,8 +208,10 @@ pomodoro_timer_on_tick(gpointer data)
   } else {
     timer->break_ms_total += tick_ms;
   }
+  timer->phase_active_ms += tick_ms;
 
   if (timer->remaining_ms <= 0) {
+    pomodoro_timer_end_phase(timer, POMODORO_PHASE_COMPLETED);
     pomodoro_timer_advance_phase(timer);
     pomodoro_timer_fire_phase(timer);
   }
@@ -224,6 +258,19 @@ pomodoro_timer_set_update_callback(PomodoroTimer *timer,
   timer->user_data = user_data;
 }
 
+void
+pomodoro_timer_set_phase_end_callback(PomodoroTimer *timer,
+                                      PomodoroTimerPhaseEndFn phase_end_cb,
+                                      gpointer user_data)
+{
+  if (timer == NULL) {
+    return;
+  }
+
+  timer->phase_end_cb = phase_end_cb;
+  timer->phase_end_user_data = user_data;
+}
+
 void
 pomodoro_timer_apply_config(PomodoroTimer *timer, PomodoroTimerConfig config)
 {
@@ -381,6 +428,9 @@ pomodoro_timer_start(PomodoroTimer *timer)
   }
 
   timer->state = POMODORO_TIMER_RUNNING;
+  if (timer->phase_started_us == 0) {
+    timer->phase_started_us = g_get_real_time();
+  }
 
   if (timer->tick_source_id == 0) {
     timer->tick_source_id =
@@ -402,6 +452,7 @@ pomodoro_timer_pause(PomodoroTimer *timer)
   }
 
   timer->state = POMODORO_TIMER_PAUSED;
+  timer->phase_interruptions++;
   pomodoro_timer_stop_tick(timer);
   pomodoro_timer_fire_tick(timer);
 }
@@ -428,6 +479,7 @@ pomodoro_timer_skip(PomodoroTimer *timer)
   }
 
   PomodoroTimerState previous_state = timer->state;
+  pomodoro_timer_end_phase(timer, POMODORO_PHASE_SKIPPED);
   pomodoro_timer_advance_phase(timer);
   pomodoro_timer_fire_phase(timer);
 
@@ -447,6 +499,7 @@ pomodoro_timer_stop(PomodoroTimer *timer)
   }
 
   pomodoro_timer_stop_tick(timer);
+  pomodoro_timer_end_phase(timer, POMODORO_PHASE_ABORTED);
   timer->state = POMODORO_TIMER_STOPPED;
   timer->phase = POMODORO_PHASE_FOCUS;
   timer->remaining_ms = pomodoro_timer_phase_duration_ms(timer, timer->phase);
@@ -457,3 +510,9 @@ pomodoro_timer_stop(PomodoroTimer *timer)
 
   pomodoro_timer_fire_tick(timer);
 }
+
+void
+pomodoro_timer_abort_phase(PomodoroTimer *timer)
+{
+  pomodoro_timer_end_phase(timer, POMODORO_PHASE_ABORTED);
+}
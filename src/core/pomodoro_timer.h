@@ -14,6 +14,24 @@ typedef enum {
   POMODORO_TIMER_PAUSED = 2
 } PomodoroTimerState;
 
+typedef enum {
+  POMODORO_PHASE_COMPLETED = 0,
+  POMODORO_PHASE_SKIPPED = 1,
+  POMODORO_PHASE_ABORTED = 2
+} PomodoroPhaseOutcome;
+
+/* How a phase went, reported once it ends. active_ms counts only running
+ * time; interruptions is the number of pauses. Phases that never ran are
+ * not reported. */
+typedef struct {
+  PomodoroPhase phase;
+  PomodoroPhaseOutcome outcome;
+  gint64 started_at_utc;
+  gint64 ended_at_utc;
+  gint64 active_ms;
+  guint interruptions;
+} PomodoroPhaseRecord;
+
 typedef struct {
   guint focus_minutes;
   guint short_break_minutes;
@@ -23,6 +41,9 @@ typedef struct {
 
 typedef struct _PomodoroTimer PomodoroTimer;
 typedef void (*PomodoroTimerUpdateFn)(PomodoroTimer *timer, gpointer user_data);
+typedef void (*PomodoroTimerPhaseEndFn)(PomodoroTimer *timer,
+                                        const PomodoroPhaseRecord *record,
+                                        gpointer user_data);
 
 PomodoroTimerConfig pomodoro_timer_config_default(void);
 PomodoroTimerConfig pomodoro_timer_config_normalize(PomodoroTimerConfig config);
@@ -35,6 +56,11 @@ void pomodoro_timer_set_update_callback(PomodoroTimer *timer,
                                         PomodoroTimerUpdateFn phase_cb,
                                         gpointer user_data);
 
+/* Called before the timer moves on, so the phase's task is still active. */
+void pomodoro_timer_set_phase_end_callback(PomodoroTimer *timer,
+                                           PomodoroTimerPhaseEndFn phase_end_cb,
+                                           gpointer user_data);
+
 void pomodoro_timer_apply_config(PomodoroTimer *timer, PomodoroTimerConfig config);
 PomodoroTimerConfig pomodoro_timer_get_config(const PomodoroTimer *timer);
 void pomodoro_timer_set_test_durations(PomodoroTimer *timer,
@@ -60,3 +86,6 @@ void pomodoro_timer_pause(PomodoroTimer *timer);
 void pomodoro_timer_toggle(PomodoroTimer *timer);
 void pomodoro_timer_skip(PomodoroTimer *timer);
 void pomodoro_timer_stop(PomodoroTimer *timer);
+/* Reports the current phase as aborted without touching the timer state,
+ * for shutdown. */
+void pomodoro_timer_abort_phase(PomodoroTimer *timer);
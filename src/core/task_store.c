@@ -10,11 +10,22 @@ struct _PomodoroTask {
   GDateTime *created_at;
   GDateTime *completed_at;
   GDateTime *archived_at;
+  /* Cached from the task_focus index in the stats database. */
+  gint64 focus_ms;
+  guint focus_sessions;
+  /* Node in TaskStore.completed while the task is completed. */
+  GList *completed_link;
 };
 
 struct _TaskStore {
   GPtrArray *tasks;
   TaskArchiveStrategy archive;
+  /* Completed tasks, oldest completion first (undated ones at the head), so
+   * the archive policy only ever looks at the tasks it archives. */
+  GQueue completed;
+  /* Real time at which the oldest dated completed task falls due under
+   * TASK_ARCHIVE_AFTER_DAYS; 0 when it has to be worked out again. */
+  gint64 archive_due_us;
 };
 
 static void
@@ -59,13 +70,63 @@ normalize_repeat_count(guint repeat_count)
   return repeat_count;
 }
 
+static gboolean
+completed_before(const PomodoroTask *a, const PomodoroTask *b)
+{
+  if (a->completed_at == NULL) {
+    return b->completed_at != NULL;
+  }
+  if (b->completed_at == NULL) {
+    return FALSE;
+  }
+  return g_date_time_compare(a->completed_at, b->completed_at) < 0;
+}
+
+static void
+task_store_track_completed(TaskStore *store, PomodoroTask *task)
+{
+  if (task->completed_link != NULL) {
+    return;
+  }
+
+  /* Fresh completions are the newest, so this stops at the tail. */
+  GList *sibling = store->completed.tail;
+  while (sibling != NULL && completed_before(task, sibling->data)) {
+    sibling = sibling->prev;
+  }
+
+  if (sibling == store->completed.tail) {
+    g_queue_push_tail(&store->completed, task);
+    task->completed_link = store->completed.tail;
+    return;
+  }
+
+  g_queue_insert_after(&store->completed, sibling, task);
+  task->completed_link = sibling != NULL ? sibling->next : store->completed.head;
+  store->archive_due_us = 0;
+}
+
 static void
-task_store_clear_completion(PomodoroTask *task)
+task_store_untrack_completed(TaskStore *store, PomodoroTask *task)
+{
+  if (task->completed_link == NULL) {
+    return;
+  }
+
+  g_queue_delete_link(&store->completed, task->completed_link);
+  task->completed_link = NULL;
+  store->archive_due_us = 0;
+}
+
+static void
+task_store_clear_completion(TaskStore *store, PomodoroTask *task)
 {
   if (task == NULL) {
     return;
   }
 
+  task_store_untrack_completed(store, task);
+
   if (task->completed_at != NULL) {
     g_date_time_unref(task->completed_at);
     task->completed_at = NULL;
@@ -109,7 +170,7 @@ task_store_demote_other_active(TaskStore *store, PomodoroTask *keep)
 
     if (task->status == TASK_STATUS_ACTIVE) {
       task->status = TASK_STATUS_PENDING;
-      task_store_clear_completion(task);
+      task_store_clear_completion(store, task);
     }
   }
 }
@@ -123,7 +184,7 @@ task_store_set_active(TaskStore *store, PomodoroTask *task)
 
   task_store_demote_other_active(store, task);
   task->status = TASK_STATUS_ACTIVE;
-  task_store_clear_completion(task);
+  task_store_clear_completion(store, task);
 }
 
 void
@@ -134,7 +195,7 @@ task_store_set_pending(TaskStore *store, PomodoroTask *task)
   }
 
   task->status = TASK_STATUS_PENDING;
-  task_store_clear_completion(task);
+  task_store_clear_completion(store, task);
 }
 
 TaskStore *
@@ -155,6 +216,7 @@ task_store_free(TaskStore *store)
     return;
   }
 
+  g_queue_clear(&store->completed);
   g_ptr_array_free(store->tasks, TRUE);
   g_free(store);
 }
@@ -166,6 +228,8 @@ task_store_clear(TaskStore *store)
     return;
   }
 
+  g_queue_clear(&store->completed);
+  store->archive_due_us = 0;
   g_ptr_array_free(store->tasks, TRUE);
   store->tasks = g_ptr_array_new_with_free_func((GDestroyNotify)pomodoro_task_free);
 }
@@ -230,6 +294,9 @@ task_store_import(TaskStore *store,
   task->archived_at = archived_at;
 
   g_ptr_array_add(store->tasks, task);
+  if (status == TASK_STATUS_COMPLETED) {
+    task_store_track_completed(store, task);
+  }
   return task;
 }
 
@@ -281,6 +348,7 @@ task_store_complete(TaskStore *store, PomodoroTask *task)
     g_date_time_unref(task->completed_at);
   }
   task->completed_at = g_date_time_new_now_local();
+  task_store_track_completed(store, task);
 }
 
 void
@@ -308,6 +376,7 @@ task_store_archive_task(TaskStore *store, PomodoroTask *task)
     return;
   }
 
+  task_store_untrack_completed(store, task);
   task->status = TASK_STATUS_ARCHIVED;
   if (task->archived_at != NULL) {
     g_date_time_unref(task->archived_at);
@@ -322,6 +391,7 @@ task_store_remove(TaskStore *store, PomodoroTask *task)
     return FALSE;
   }
 
+  task_store_untrack_completed(store, task);
   return g_ptr_array_remove(store->tasks, task);
 }
 
@@ -333,6 +403,7 @@ task_store_set_archive_strategy(TaskStore *store, TaskArchiveStrategy strategy)
   }
 
   store->archive = normalize_archive_strategy(strategy);
+  store->archive_due_us = 0;
 }
 
 TaskArchiveStrategy
@@ -350,33 +421,41 @@ task_store_get_archive_strategy(TaskStore *store)
   return store->archive;
 }
 
-static gint
-compare_completed_desc(gconstpointer a, gconstpointer b)
+static gint64
+archive_due_us(const PomodoroTask *task, guint days)
 {
-  const PomodoroTask *task_a = a;
-  const PomodoroTask *task_b = b;
+  GDateTime *due = g_date_time_add_days(task->completed_at, (gint)days);
+  gint64 due_us = g_date_time_to_unix(due) * G_USEC_PER_SEC +
+                  g_date_time_get_microsecond(due);
+  g_date_time_unref(due);
+  return due_us;
+}
 
-  if (task_a == NULL && task_b == NULL) {
-    return 0;
-  }
-  if (task_a == NULL) {
-    return 1;
-  }
-  if (task_b == NULL) {
-    return -1;
+static void
+task_store_archive_expired(TaskStore *store, guint days)
+{
+  gint64 now_us = g_get_real_time();
+  if (store->archive_due_us != 0 && now_us <= store->archive_due_us) {
+    return;
   }
 
-  if (task_a->completed_at == NULL && task_b->completed_at == NULL) {
-    return 0;
-  }
-  if (task_a->completed_at == NULL) {
-    return 1;
-  }
-  if (task_b->completed_at == NULL) {
-    return -1;
+  /* Undated completions never expire; skip past them to the oldest dated one. */
+  GList *link = store->completed.head;
+  while (link != NULL && ((PomodoroTask *)link->data)->completed_at == NULL) {
+    link = link->next;
   }
 
-  return -g_date_time_compare(task_a->completed_at, task_b->completed_at);
+  while (link != NULL) {
+    PomodoroTask *task = link->data;
+    link = link->next;
+    gint64 due_us = archive_due_us(task, days);
+    if (now_us <= due_us) {
+      store->archive_due_us = due_us;
+      return;
+    }
+    task_store_archive_task(store, task);
+  }
+  store->archive_due_us = 0;
 }
 
 void
@@ -390,53 +469,21 @@ task_store_apply_archive_policy(TaskStore *store)
   store->archive = strategy;
 
   if (strategy.type == TASK_ARCHIVE_IMMEDIATE) {
-    for (guint i = 0; i < store->tasks->len; i++) {
-      PomodoroTask *task = g_ptr_array_index(store->tasks, i);
-      if (task != NULL && task->status == TASK_STATUS_COMPLETED) {
-        task_store_archive_task(store, task);
-      }
+    while (!g_queue_is_empty(&store->completed)) {
+      task_store_archive_task(store, g_queue_peek_head(&store->completed));
     }
     return;
   }
 
   if (strategy.type == TASK_ARCHIVE_AFTER_DAYS) {
-    GDateTime *now = g_date_time_new_now_local();
-    GDateTime *cutoff = g_date_time_add_days(now, -(gint)strategy.days);
-
-    for (guint i = 0; i < store->tasks->len; i++) {
-      PomodoroTask *task = g_ptr_array_index(store->tasks, i);
-      if (task == NULL || task->status != TASK_STATUS_COMPLETED ||
-          task->completed_at == NULL) {
-        continue;
-      }
-
-      if (g_date_time_compare(task->completed_at, cutoff) < 0) {
-        task_store_archive_task(store, task);
-      }
-    }
-
-    g_date_time_unref(cutoff);
-    g_date_time_unref(now);
+    task_store_archive_expired(store, strategy.days);
     return;
   }
 
   if (strategy.type == TASK_ARCHIVE_KEEP_LATEST) {
-    GPtrArray *completed = g_ptr_array_new();
-    for (guint i = 0; i < store->tasks->len; i++) {
-      PomodoroTask *task = g_ptr_array_index(store->tasks, i);
-      if (task != NULL && task->status == TASK_STATUS_COMPLETED) {
-        g_ptr_array_add(completed, task);
-      }
+    while (store->completed.length > strategy.keep_latest) {
+      task_store_archive_task(store, g_queue_peek_head(&store->completed));
     }
-
-    g_ptr_array_sort(completed, compare_completed_desc);
-
-    for (guint i = strategy.keep_latest; i < completed->len; i++) {
-      PomodoroTask *task = g_ptr_array_index(completed, i);
-      task_store_archive_task(store, task);
-    }
-
-    g_ptr_array_free(completed, TRUE);
   }
 }
 
@@ -558,6 +605,42 @@ pomodoro_task_set_repeat_count(PomodoroTask *task, guint repeat_count)
   task->repeat_count = normalize_repeat_count(repeat_count);
 }
 
+gint64
+pomodoro_task_get_focus_seconds(const PomodoroTask *task)
+{
+  return task ? task->focus_ms / 1000 : 0;
+}
+
+guint
+pomodoro_task_get_focus_sessions(const PomodoroTask *task)
+{
+  return task ? task->focus_sessions : 0;
+}
+
+void
+pomodoro_task_set_focus_totals(PomodoroTask *task, gint64 focus_ms, guint sessions)
+{
+  if (task == NULL) {
+    return;
+  }
+
+  task->focus_ms = MAX(focus_ms, 0);
+  task->focus_sessions = sessions;
+}
+
+void
+pomodoro_task_add_focus(PomodoroTask *task, gint64 focus_ms, gboolean completed)
+{
+  if (task == NULL || focus_ms <= 0) {
+    return;
+  }
+
+  task->focus_ms += focus_ms;
+  if (completed) {
+    task->focus_sessions++;
+  }
+}
+
 TaskStatus
 pomodoro_task_get_status(const PomodoroTask *task)
 {
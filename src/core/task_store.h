@@ -65,5 +65,11 @@ TaskStatus pomodoro_task_get_status(const PomodoroTask *task);
 GDateTime *pomodoro_task_get_created_at(const PomodoroTask *task);
 GDateTime *pomodoro_task_get_completed_at(const PomodoroTask *task);
 GDateTime *pomodoro_task_get_archived_at(const PomodoroTask *task);
+/* Focus time and completed focus sessions, kept in step with the session
+ * history: loaded once, then bumped at the end of each focus phase. */
+gint64 pomodoro_task_get_focus_seconds(const PomodoroTask *task);
+guint pomodoro_task_get_focus_sessions(const PomodoroTask *task);
+void pomodoro_task_set_focus_totals(PomodoroTask *task, gint64 focus_ms, guint sessions);
+void pomodoro_task_add_focus(PomodoroTask *task, gint64 focus_ms, gboolean completed);
 
 #endif
@@ -7,7 +7,15 @@
 #include <json-glib/json-glib.h>
 #include <string.h>
 
+#include "focus/chrome_cdp_internal.h"
+#include "focus/focus_http.h"
+#include "focus/focus_latency.h"
+
 #define CHROME_CDP_MAX_TEXT 8000
+#define CHROME_CDP_MAX_HTML (1024 * 1024)
+/* The evaluate reply carries the HTML JSON-escaped, which can double it;
+ * libsoup's default 128 KiB frame limit would drop most pages. */
+#define CHROME_CDP_MAX_PAYLOAD (4 * CHROME_CDP_MAX_HTML)
 #define CHROME_CDP_TIMEOUT_SEC 5
 
 typedef struct {
@@ -17,6 +25,9 @@ typedef struct {
   guint timeout_id;
   gboolean completed;
   SoupWebsocketConnection *connection;
+  ChromeCdpFetchFlags flags;
+  gint64 start_us;
+  gint64 connected_us;
 } ChromeCdpWsContext;
 
 static void
@@ -80,7 +91,7 @@ chrome_cdp_strip_suffix(const char *title)
   return trimmed;
 }
 
-static char *
+char *
 chrome_cdp_normalize_title(const char *title, gboolean strip_suffix)
 {
   char *base = strip_suffix ? chrome_cdp_strip_suffix(title) : g_strdup(title);
@@ -94,6 +105,25 @@ chrome_cdp_normalize_title(const char *title, gboolean strip_suffix)
   return lower;
 }
 
+int
+chrome_cdp_score_normalized(const char *window_norm, const char *tab_norm)
+{
+  if (window_norm == NULL || *window_norm == '\0' || tab_norm == NULL) {
+    return 0;
+  }
+
+  if (g_strcmp0(window_norm, tab_norm) == 0) {
+    return 3;
+  }
+  if (g_strstr_len(window_norm, -1, tab_norm) != NULL) {
+    return 2;
+  }
+  if (g_strstr_len(tab_norm, -1, window_norm) != NULL) {
+    return 1;
+  }
+  return 0;
+}
+
 static int
 chrome_cdp_score_title(const char *window_title, const char *tab_title)
 {
@@ -102,30 +132,15 @@ chrome_cdp_score_title(const char *window_title, const char *tab_title)
   }
 
   char *window_norm = chrome_cdp_normalize_title(window_title, TRUE);
-  if (window_norm == NULL || *window_norm == '\0') {
-    g_free(window_norm);
-    return 0;
-  }
-
   char *tab_norm = chrome_cdp_normalize_title(tab_title, FALSE);
-  int score = 0;
-
-  if (tab_norm != NULL) {
-    if (g_strcmp0(window_norm, tab_norm) == 0) {
-      score = 3;
-    } else if (g_strstr_len(window_norm, -1, tab_norm) != NULL) {
-      score = 2;
-    } else if (g_strstr_len(tab_norm, -1, window_norm) != NULL) {
-      score = 1;
-    }
-  }
+  int score = chrome_cdp_score_normalized(window_norm, tab_norm);
 
   g_free(tab_norm);
   g_free(window_norm);
   return score;
 }
 
-static const char *
+const char *
 chrome_cdp_json_get_string(JsonObject *object, const char *member)
 {
   if (object == NULL || member == NULL) {
@@ -252,11 +267,13 @@ chrome_cdp_parse_evaluate_result(const char *payload,
   const char *title = chrome_cdp_json_get_string(value_obj, "title");
   const char *url = chrome_cdp_json_get_string(value_obj, "url");
   const char *text = chrome_cdp_json_get_string(value_obj, "text");
+  const char *html = chrome_cdp_json_get_string(value_obj, "html");
 
   ChromeCdpPage *page = g_new0(ChromeCdpPage, 1);
   page->title = g_strdup(title != NULL ? title : "");
   page->url = g_strdup(url != NULL ? url : "");
   page->text = g_strdup(text != NULL ? text : "");
+  page->html = g_strdup(html);
 
   *page_out = page;
   g_object_unref(parser);
@@ -299,6 +316,7 @@ chrome_cdp_ws_on_message(SoupWebsocketConnection *connection,
   }
 
   context->page = page;
+  focus_latency_record(FOCUS_LATENCY_CDP_EVALUATE, context->connected_us);
   chrome_cdp_ws_context_finish(context, NULL);
 }
 
@@ -318,17 +336,26 @@ chrome_cdp_ws_on_closed(SoupWebsocketConnection *connection,
 }
 
 static void
-chrome_cdp_ws_send_evaluate(SoupWebsocketConnection *connection)
+chrome_cdp_ws_send_evaluate(SoupWebsocketConnection *connection,
+                            ChromeCdpFetchFlags flags)
 {
   const char *expression_template =
-      "(function(){const max=%d;"
+      "(function(){const max=%d,maxHtml=%d,wantHtml=%s;"
       "let text='';"
       "if(document.body&&document.body.innerText)"
       "{text=document.body.innerText.replace(/\\s+/g,' ').trim();}"
       "if(text.length>max){text=text.slice(0,max);}"
-      "return{title:document.title||'',url:location.href||'',text:text};})()";
-
-  char *expression = g_strdup_printf(expression_template, CHROME_CDP_MAX_TEXT);
+      "const page={title:document.title||'',url:location.href||'',text:text};"
+      "if(wantHtml&&document.documentElement)"
+      "{const html=document.documentElement.outerHTML"
+      ".replace(/<(script|style|noscript|svg)\\b[\\s\\S]*?<\\/\\1>/gi,'');"
+      "if(html.length<=maxHtml){page.html=html;}}"
+      "return page;})()";
+
+  char *expression = g_strdup_printf(expression_template,
+                                     CHROME_CDP_MAX_TEXT,
+                                     CHROME_CDP_MAX_HTML,
+                                     (flags & CHROME_CDP_FETCH_HTML) ? "true" : "false");
 
   JsonBuilder *builder = json_builder_new();
   json_builder_begin_object(builder);
@@ -377,7 +404,11 @@ chrome_cdp_ws_on_connected(GObject *source_object,
     return;
   }
 
+  focus_latency_record(FOCUS_LATENCY_CDP_CONNECT, context->start_us);
+  context->connected_us = g_get_monotonic_time();
   context->connection = connection;
+  soup_websocket_connection_set_max_incoming_payload_size(connection,
+                                                          CHROME_CDP_MAX_PAYLOAD);
   g_signal_connect(connection,
                    "message",
                    G_CALLBACK(chrome_cdp_ws_on_message),
@@ -387,16 +418,16 @@ chrome_cdp_ws_on_connected(GObject *source_object,
                    G_CALLBACK(chrome_cdp_ws_on_closed),
                    context);
 
-  chrome_cdp_ws_send_evaluate(connection);
+  chrome_cdp_ws_send_evaluate(connection, context->flags);
 }
 
 static ChromeCdpPage *
-chrome_cdp_fetch_page_via_ws(SoupSession *session,
-                             const char *ws_url,
+chrome_cdp_fetch_page_via_ws(const char *ws_url,
+                             ChromeCdpFetchFlags flags,
                              GCancellable *cancellable,
                              GError **error)
 {
-  if (session == NULL || ws_url == NULL) {
+  if (ws_url == NULL) {
     g_set_error(error,
                 G_IO_ERROR,
                 G_IO_ERROR_INVALID_ARGUMENT,
@@ -415,10 +446,13 @@ chrome_cdp_fetch_page_via_ws(SoupSession *session,
       .timeout_id = 0,
       .completed = FALSE,
       .connection = NULL,
+      .flags = flags,
+      .start_us = g_get_monotonic_time(),
+      .connected_us = 0,
   };
 
   SoupMessage *message = soup_message_new("GET", ws_url);
-  soup_session_websocket_connect_async(session,
+  soup_session_websocket_connect_async(focus_http_get_session(FOCUS_HTTP_CHROME),
                                        message,
                                        NULL,
                                        NULL,
@@ -451,6 +485,7 @@ chrome_cdp_fetch_page_via_ws(SoupSession *session,
   g_main_context_pop_thread_default(context);
   g_main_context_unref(context);
 
+  focus_http_record(FOCUS_HTTP_CHROME, ws_context.start_us, ws_context.error == NULL);
   if (ws_context.error != NULL) {
     g_propagate_error(error, ws_context.error);
     return NULL;
@@ -462,6 +497,7 @@ chrome_cdp_fetch_page_via_ws(SoupSession *session,
 ChromeCdpPage *
 chrome_cdp_fetch_page_sync(guint port,
                            const char *window_title,
+                           ChromeCdpFetchFlags flags,
                            GCancellable *cancellable,
                            GError **error)
 {
@@ -474,16 +510,17 @@ chrome_cdp_fetch_page_sync(guint port,
   }
 
   char *url = g_strdup_printf("http://127.0.0.1:%u/json/list", port);
-  SoupSession *session = soup_session_new();
   SoupMessage *message = soup_message_new("GET", url);
-  GBytes *bytes = soup_session_send_and_read(session, message, cancellable, error);
+  gint64 start_us = g_get_monotonic_time();
+  GBytes *bytes =
+      focus_http_send_and_read(FOCUS_HTTP_CHROME, message, cancellable, error);
   g_free(url);
 
   if (bytes == NULL) {
     g_object_unref(message);
-    g_object_unref(session);
     return NULL;
   }
+  focus_latency_record(FOCUS_LATENCY_CDP_LIST, start_us);
 
   if (soup_message_get_status(message) != SOUP_STATUS_OK) {
     g_set_error(error,
@@ -493,7 +530,6 @@ chrome_cdp_fetch_page_sync(guint port,
                 soup_message_get_status(message));
     g_bytes_unref(bytes);
     g_object_unref(message);
-    g_object_unref(session);
     return NULL;
   }
 
@@ -505,7 +541,6 @@ chrome_cdp_fetch_page_sync(guint port,
   if (!json_parser_load_from_data(parser, data, (gssize)len, error)) {
     g_object_unref(parser);
     g_bytes_unref(bytes);
-    g_object_unref(session);
     return NULL;
   }
 
@@ -517,7 +552,6 @@ chrome_cdp_fetch_page_sync(guint port,
                 "Chrome CDP response missing tab list");
     g_object_unref(parser);
     g_bytes_unref(bytes);
-    g_object_unref(session);
     return NULL;
   }
 
@@ -528,7 +562,7 @@ chrome_cdp_fetch_page_sync(guint port,
 
   ChromeCdpPage *page = NULL;
   if (ws_url != NULL) {
-    page = chrome_cdp_fetch_page_via_ws(session, ws_url, cancellable, error);
+    page = chrome_cdp_fetch_page_via_ws(ws_url, flags, cancellable, error);
     if (page != NULL && page->title != NULL && *page->title == '\0' &&
         tab_title != NULL) {
       g_free(page->title);
@@ -543,7 +577,44 @@ chrome_cdp_fetch_page_sync(guint port,
 
   g_object_unref(parser);
   g_bytes_unref(bytes);
-  g_object_unref(session);
+  return page;
+}
+
+ChromeCdpPage *
+chrome_cdp_fetch_target_sync(guint port,
+                             const char *target_id,
+                             const char *tab_title,
+                             ChromeCdpFetchFlags flags,
+                             GCancellable *cancellable,
+                             GError **error)
+{
+  if (port == 0 || port > 65535) {
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_INVALID_ARGUMENT,
+                "Chrome debug port invalid");
+    return NULL;
+  }
+
+  if (target_id == NULL || *target_id == '\0') {
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_INVALID_ARGUMENT,
+                "Chrome target id missing");
+    return NULL;
+  }
+
+  char *ws_url = g_strdup_printf("ws://127.0.0.1:%u/devtools/page/%s",
+                                 port,
+                                 target_id);
+  ChromeCdpPage *page = chrome_cdp_fetch_page_via_ws(ws_url, flags, cancellable, error);
+  if (page != NULL && page->title != NULL && *page->title == '\0' &&
+      tab_title != NULL) {
+    g_free(page->title);
+    page->title = g_strdup(tab_title);
+  }
+
+  g_free(ws_url);
   return page;
 }
 
@@ -557,6 +628,7 @@ chrome_cdp_page_free(ChromeCdpPage *page)
   g_free(page->title);
   g_free(page->url);
   g_free(page->text);
+  g_free(page->html);
   g_free(page);
 }
 
@@ -565,11 +637,33 @@ chrome_cdp_page_free(ChromeCdpPage *page)
 ChromeCdpPage *
 chrome_cdp_fetch_page_sync(guint port,
                            const char *window_title,
+                           ChromeCdpFetchFlags flags,
                            GCancellable *cancellable,
                            GError **error)
 {
   (void)port;
   (void)window_title;
+  (void)flags;
+  (void)cancellable;
+  g_set_error(error,
+              G_IO_ERROR,
+              G_IO_ERROR_NOT_SUPPORTED,
+              "Chrome CDP support unavailable (libsoup/json-glib missing)");
+  return NULL;
+}
+
+ChromeCdpPage *
+chrome_cdp_fetch_target_sync(guint port,
+                             const char *target_id,
+                             const char *tab_title,
+                             ChromeCdpFetchFlags flags,
+                             GCancellable *cancellable,
+                             GError **error)
+{
+  (void)port;
+  (void)target_id;
+  (void)tab_title;
+  (void)flags;
   (void)cancellable;
   g_set_error(error,
               G_IO_ERROR,
@@ -588,6 +682,7 @@ chrome_cdp_page_free(ChromeCdpPage *page)
   g_free(page->title);
   g_free(page->url);
   g_free(page->text);
+  g_free(page->html);
   g_free(page);
 }
 
@@ -3,14 +3,28 @@
 #include <gio/gio.h>
 #include <glib.h>
 
+typedef enum {
+  CHROME_CDP_FETCH_TEXT = 0,
+  /* Also return the page's outerHTML for main-content extraction. */
+  CHROME_CDP_FETCH_HTML = 1 << 0
+} ChromeCdpFetchFlags;
+
 typedef struct {
   char *title;
   char *url;
   char *text;
+  char *html;
 } ChromeCdpPage;
 
 ChromeCdpPage *chrome_cdp_fetch_page_sync(guint port,
                                           const char *window_title,
+                                          ChromeCdpFetchFlags flags,
                                           GCancellable *cancellable,
                                           GError **error);
+ChromeCdpPage *chrome_cdp_fetch_target_sync(guint port,
+                                            const char *target_id,
+                                            const char *tab_title,
+                                            ChromeCdpFetchFlags flags,
+                                            GCancellable *cancellable,
+                                            GError **error);
 void chrome_cdp_page_free(ChromeCdpPage *page);
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <glib.h>
+#include <json-glib/json-glib.h>
+
+char *chrome_cdp_normalize_title(const char *title, gboolean strip_suffix);
+int chrome_cdp_score_normalized(const char *window_norm, const char *tab_norm);
+const char *chrome_cdp_json_get_string(JsonObject *object, const char *member);
@@ -0,0 +1,627 @@
+#include "focus/chrome_cdp_tabs.h"
+#include "config.h"
+
+char *
+chrome_cdp_url_domain(const char *url)
+{
+  if (url == NULL || *url == '\0') {
+    return NULL;
+  }
+
+  GUri *uri = g_uri_parse(url, G_URI_FLAGS_NONE, NULL);
+  if (uri == NULL) {
+    return NULL;
+  }
+
+  const char *host = g_uri_get_host(uri);
+  char *domain = NULL;
+  if (host != NULL && *host != '\0') {
+    domain = g_ascii_strdown(g_str_has_prefix(host, "www.") ? host + 4 : host, -1);
+  }
+
+  g_uri_unref(uri);
+  return domain;
+}
+
+#if HAVE_CHROME_OLLAMA
+
+#include <libsoup/soup.h>
+#include <json-glib/json-glib.h>
+
+#include "focus/chrome_cdp_internal.h"
+#include "focus/focus_http.h"
+
+char *
+chrome_cdp_url_registrable_domain(const char *url)
+{
+  if (url == NULL ||
+      !(g_str_has_prefix(url, "http://") || g_str_has_prefix(url, "https://"))) {
+    return NULL;
+  }
+
+  char *host = chrome_cdp_url_domain(url);
+  if (host == NULL) {
+    return NULL;
+  }
+
+  const char *base = soup_tld_get_base_domain(host, NULL);
+  if (base == NULL) {
+    return host;
+  }
+
+  char *domain = g_strdup(base);
+  g_free(host);
+  return domain;
+}
+
+#define CHROME_CDP_TABS_RETRY_MIN_SEC 5
+#define CHROME_CDP_TABS_RETRY_MAX_SEC 60
+/* Chrome reports a navigation's URL before the new page's title; a title
+ * change this soon after one still belongs to that navigation. */
+#define CHROME_CDP_TABS_TITLE_SETTLE_US (10 * G_USEC_PER_SEC)
+
+typedef struct {
+  ChromeCdpTab tab;
+  char *title_norm;
+  gint64 navigated_us;
+} ChromeCdpTabEntry;
+
+struct _ChromeCdpTabTracker {
+  guint port;
+  SoupSession *session;
+  SoupWebsocketConnection *connection;
+  GCancellable *cancellable;
+  GHashTable *tabs;
+  guint reconnect_source_id;
+  guint retry_seconds;
+  ChromeCdpTabNavigatedFunc on_navigated;
+  gpointer user_data;
+};
+
+static void chrome_cdp_tab_tracker_connect(ChromeCdpTabTracker *tracker);
+
+static void
+chrome_cdp_tab_entry_free(gpointer data)
+{
+  ChromeCdpTabEntry *entry = data;
+  if (entry == NULL) {
+    return;
+  }
+
+  g_free(entry->tab.id);
+  g_free(entry->tab.title);
+  g_free(entry->tab.url);
+  g_free(entry->title_norm);
+  g_free(entry);
+}
+
+static gboolean
+chrome_cdp_tab_tracker_on_retry(gpointer user_data)
+{
+  ChromeCdpTabTracker *tracker = user_data;
+  tracker->reconnect_source_id = 0;
+  chrome_cdp_tab_tracker_connect(tracker);
+  return G_SOURCE_REMOVE;
+}
+
+static void
+chrome_cdp_tab_tracker_drop_connection(ChromeCdpTabTracker *tracker)
+{
+  if (tracker->connection == NULL) {
+    return;
+  }
+
+  g_signal_handlers_disconnect_by_data(tracker->connection, tracker);
+  if (soup_websocket_connection_get_state(tracker->connection) ==
+      SOUP_WEBSOCKET_STATE_OPEN) {
+    soup_websocket_connection_close(tracker->connection,
+                                    SOUP_WEBSOCKET_CLOSE_NORMAL,
+                                    NULL);
+  }
+  g_clear_object(&tracker->connection);
+}
+
+static void
+chrome_cdp_tab_tracker_schedule_retry(ChromeCdpTabTracker *tracker)
+{
+  chrome_cdp_tab_tracker_drop_connection(tracker);
+  g_hash_table_remove_all(tracker->tabs);
+
+  if (tracker->reconnect_source_id != 0) {
+    return;
+  }
+
+  guint delay = tracker->retry_seconds;
+  if (delay < CHROME_CDP_TABS_RETRY_MIN_SEC) {
+    delay = CHROME_CDP_TABS_RETRY_MIN_SEC;
+  }
+  tracker->retry_seconds = MIN(delay * 2, CHROME_CDP_TABS_RETRY_MAX_SEC);
+  tracker->reconnect_source_id =
+      g_timeout_add_seconds_full(G_PRIORITY_LOW,
+                                 delay,
+                                 chrome_cdp_tab_tracker_on_retry,
+                                 tracker,
+                                 NULL);
+}
+
+static void
+chrome_cdp_tab_tracker_update(ChromeCdpTabTracker *tracker,
+                              JsonObject *info,
+                              gboolean created)
+{
+  if (info == NULL) {
+    return;
+  }
+
+  const char *type = chrome_cdp_json_get_string(info, "type");
+  const char *id = chrome_cdp_json_get_string(info, "targetId");
+  if (id == NULL || g_strcmp0(type, "page") != 0) {
+    return;
+  }
+
+  const char *title = chrome_cdp_json_get_string(info, "title");
+  const char *url = chrome_cdp_json_get_string(info, "url");
+
+  ChromeCdpTabEntry *entry = g_hash_table_lookup(tracker->tabs, id);
+  if (entry == NULL) {
+    entry = g_new0(ChromeCdpTabEntry, 1);
+    entry->tab.id = g_strdup(id);
+    g_hash_table_insert(tracker->tabs, entry->tab.id, entry);
+  }
+
+  gboolean retitled = g_strcmp0(entry->tab.title, title) != 0;
+  if (retitled) {
+    g_free(entry->tab.title);
+    g_free(entry->title_norm);
+    entry->tab.title = g_strdup(title != NULL ? title : "");
+    entry->title_norm = chrome_cdp_normalize_title(entry->tab.title, FALSE);
+  }
+
+  gboolean navigated = g_strcmp0(entry->tab.url, url) != 0;
+  if (navigated) {
+    g_free(entry->tab.url);
+    entry->tab.url = g_strdup(url != NULL ? url : "");
+    char *domain = chrome_cdp_url_registrable_domain(entry->tab.url);
+    entry->tab.domain = domain != NULL ? g_intern_string(domain) : NULL;
+    g_free(domain);
+  }
+
+  /* CDP has no tab-focus event; new tabs and navigations almost always
+   * happen in the foreground tab, so use them as the activation signal. */
+  if (created || navigated) {
+    entry->tab.last_activated_us = g_get_monotonic_time();
+  }
+
+  /* The navigation is reported again once its title arrives, since the
+   * window title only matches the tab from then on. */
+  gint64 now_us = g_get_monotonic_time();
+  gboolean settling = retitled && entry->navigated_us > 0 &&
+                      now_us - entry->navigated_us < CHROME_CDP_TABS_TITLE_SETTLE_US;
+  if (navigated && !created) {
+    entry->navigated_us = now_us;
+  }
+  if ((navigated || settling) && !created && tracker->on_navigated != NULL) {
+    tracker->on_navigated(&entry->tab, tracker->user_data);
+  }
+}
+
+static void
+chrome_cdp_tab_tracker_handle_event(ChromeCdpTabTracker *tracker,
+                                    const char *method,
+                                    JsonObject *params)
+{
+  if (method == NULL || params == NULL) {
+    return;
+  }
+
+  if (g_strcmp0(method, "Target.targetCreated") == 0 ||
+      g_strcmp0(method, "Target.targetInfoChanged") == 0) {
+    JsonObject *info = json_object_has_member(params, "targetInfo")
+                           ? json_object_get_object_member(params, "targetInfo")
+                           : NULL;
+    chrome_cdp_tab_tracker_update(tracker,
+                                  info,
+                                  g_str_has_suffix(method, "Created"));
+    return;
+  }
+
+  if (g_strcmp0(method, "Target.targetDestroyed") == 0) {
+    const char *id = chrome_cdp_json_get_string(params, "targetId");
+    if (id != NULL) {
+      g_hash_table_remove(tracker->tabs, id);
+    }
+  }
+}
+
+static void
+chrome_cdp_tab_tracker_on_message(SoupWebsocketConnection *connection,
+                                  SoupWebsocketDataType data_type,
+                                  GBytes *message,
+                                  gpointer user_data)
+{
+  (void)connection;
+  ChromeCdpTabTracker *tracker = user_data;
+  if (data_type != SOUP_WEBSOCKET_DATA_TEXT) {
+    return;
+  }
+
+  gsize length = 0;
+  const gchar *data = g_bytes_get_data(message, &length);
+  if (data == NULL || length == 0) {
+    return;
+  }
+
+  JsonParser *parser = json_parser_new();
+  if (!json_parser_load_from_data(parser, data, (gssize)length, NULL)) {
+    g_object_unref(parser);
+    return;
+  }
+
+  JsonNode *root = json_parser_get_root(parser);
+  if (root != NULL && JSON_NODE_HOLDS_OBJECT(root)) {
+    JsonObject *root_obj = json_node_get_object(root);
+    const char *method = chrome_cdp_json_get_string(root_obj, "method");
+    JsonObject *params = json_object_has_member(root_obj, "params")
+                             ? json_object_get_object_member(root_obj, "params")
+                             : NULL;
+    chrome_cdp_tab_tracker_handle_event(tracker, method, params);
+  }
+
+  g_object_unref(parser);
+}
+
+static void
+chrome_cdp_tab_tracker_on_closed(SoupWebsocketConnection *connection,
+                                 gpointer user_data)
+{
+  (void)connection;
+  ChromeCdpTabTracker *tracker = user_data;
+  g_debug("Chrome CDP target stream closed; retrying");
+  chrome_cdp_tab_tracker_schedule_retry(tracker);
+}
+
+static void
+chrome_cdp_tab_tracker_send_discover(ChromeCdpTabTracker *tracker)
+{
+  JsonBuilder *builder = json_builder_new();
+  json_builder_begin_object(builder);
+  json_builder_set_member_name(builder, "id");
+  json_builder_add_int_value(builder, 1);
+  json_builder_set_member_name(builder, "method");
+  json_builder_add_string_value(builder, "Target.setDiscoverTargets");
+  json_builder_set_member_name(builder, "params");
+  json_builder_begin_object(builder);
+  json_builder_set_member_name(builder, "discover");
+  json_builder_add_boolean_value(builder, TRUE);
+  json_builder_end_object(builder);
+  json_builder_end_object(builder);
+
+  JsonGenerator *generator = json_generator_new();
+  JsonNode *root = json_builder_get_root(builder);
+  json_generator_set_root(generator, root);
+  gchar *payload = json_generator_to_data(generator, NULL);
+  soup_websocket_connection_send_text(tracker->connection, payload);
+
+  json_node_free(root);
+  g_object_unref(generator);
+  g_object_unref(builder);
+  g_free(payload);
+}
+
+static void
+chrome_cdp_tab_tracker_on_connected(GObject *source_object,
+                                    GAsyncResult *res,
+                                    gpointer user_data)
+{
+  GError *error = NULL;
+  SoupWebsocketConnection *connection =
+      soup_session_websocket_connect_finish(SOUP_SESSION(source_object),
+                                            res,
+                                            &error);
+  if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    g_clear_error(&error);
+    return;
+  }
+
+  ChromeCdpTabTracker *tracker = user_data;
+  if (connection == NULL) {
+    g_debug("Chrome CDP target stream connect failed: %s",
+            error != NULL ? error->message : "unknown error");
+    g_clear_error(&error);
+    chrome_cdp_tab_tracker_schedule_retry(tracker);
+    return;
+  }
+
+  tracker->connection = connection;
+  tracker->retry_seconds = CHROME_CDP_TABS_RETRY_MIN_SEC;
+  g_signal_connect(connection,
+                   "message",
+                   G_CALLBACK(chrome_cdp_tab_tracker_on_message),
+                   tracker);
+  g_signal_connect(connection,
+                   "closed",
+                   G_CALLBACK(chrome_cdp_tab_tracker_on_closed),
+                   tracker);
+
+  chrome_cdp_tab_tracker_send_discover(tracker);
+}
+
+static char *
+chrome_cdp_tab_tracker_parse_browser_url(GBytes *bytes)
+{
+  gsize len = 0;
+  const gchar *data = g_bytes_get_data(bytes, &len);
+  if (data == NULL || len == 0) {
+    return NULL;
+  }
+
+  JsonParser *parser = json_parser_new();
+  char *ws_url = NULL;
+  if (json_parser_load_from_data(parser, data, (gssize)len, NULL)) {
+    JsonNode *root = json_parser_get_root(parser);
+    if (root != NULL && JSON_NODE_HOLDS_OBJECT(root)) {
+      ws_url = g_strdup(chrome_cdp_json_get_string(json_node_get_object(root),
+                                                   "webSocketDebuggerUrl"));
+    }
+  }
+
+  g_object_unref(parser);
+  return ws_url;
+}
+
+static void
+chrome_cdp_tab_tracker_on_version(GObject *source_object,
+                                  GAsyncResult *res,
+                                  gpointer user_data)
+{
+  SoupSession *session = SOUP_SESSION(source_object);
+  GError *error = NULL;
+  GBytes *bytes = soup_session_send_and_read_finish(session, res, &error);
+  if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    g_clear_error(&error);
+    return;
+  }
+
+  ChromeCdpTabTracker *tracker = user_data;
+  SoupMessage *message = soup_session_get_async_result_message(session, res);
+  char *ws_url = NULL;
+  if (bytes != NULL && message != NULL &&
+      soup_message_get_status(message) == SOUP_STATUS_OK) {
+    ws_url = chrome_cdp_tab_tracker_parse_browser_url(bytes);
+  }
+
+  g_clear_error(&error);
+  if (bytes != NULL) {
+    g_bytes_unref(bytes);
+  }
+
+  if (ws_url == NULL) {
+    chrome_cdp_tab_tracker_schedule_retry(tracker);
+    return;
+  }
+
+  SoupMessage *ws_message = soup_message_new("GET", ws_url);
+  g_free(ws_url);
+  if (ws_message == NULL) {
+    chrome_cdp_tab_tracker_schedule_retry(tracker);
+    return;
+  }
+
+  soup_session_websocket_connect_async(session,
+                                       ws_message,
+                                       NULL,
+                                       NULL,
+                                       G_PRIORITY_DEFAULT,
+                                       tracker->cancellable,
+                                       chrome_cdp_tab_tracker_on_connected,
+                                       tracker);
+  g_object_unref(ws_message);
+}
+
+static void
+chrome_cdp_tab_tracker_connect(ChromeCdpTabTracker *tracker)
+{
+  char *url = g_strdup_printf("http://127.0.0.1:%u/json/version", tracker->port);
+  SoupMessage *message = soup_message_new("GET", url);
+  g_free(url);
+
+  soup_session_send_and_read_async(tracker->session,
+                                   message,
+                                   G_PRIORITY_DEFAULT,
+                                   tracker->cancellable,
+                                   chrome_cdp_tab_tracker_on_version,
+                                   tracker);
+  g_object_unref(message);
+}
+
+ChromeCdpTabTracker *
+chrome_cdp_tab_tracker_new(guint port,
+                           ChromeCdpTabNavigatedFunc on_navigated,
+                           gpointer user_data)
+{
+  if (port == 0 || port > 65535) {
+    return NULL;
+  }
+
+  ChromeCdpTabTracker *tracker = g_new0(ChromeCdpTabTracker, 1);
+  tracker->port = port;
+  tracker->session = g_object_ref(focus_http_get_session(FOCUS_HTTP_CHROME));
+  tracker->cancellable = g_cancellable_new();
+  tracker->tabs = g_hash_table_new_full(g_str_hash,
+                                        g_str_equal,
+                                        NULL,
+                                        chrome_cdp_tab_entry_free);
+  tracker->retry_seconds = CHROME_CDP_TABS_RETRY_MIN_SEC;
+  tracker->on_navigated = on_navigated;
+  tracker->user_data = user_data;
+
+  chrome_cdp_tab_tracker_connect(tracker);
+  return tracker;
+}
+
+void
+chrome_cdp_tab_tracker_free(ChromeCdpTabTracker *tracker)
+{
+  if (tracker == NULL) {
+    return;
+  }
+
+  if (tracker->reconnect_source_id != 0) {
+    g_source_remove(tracker->reconnect_source_id);
+    tracker->reconnect_source_id = 0;
+  }
+
+  g_cancellable_cancel(tracker->cancellable);
+  chrome_cdp_tab_tracker_drop_connection(tracker);
+  g_clear_object(&tracker->cancellable);
+  g_clear_object(&tracker->session);
+  g_hash_table_destroy(tracker->tabs);
+  g_free(tracker);
+}
+
+guint
+chrome_cdp_tab_tracker_get_port(const ChromeCdpTabTracker *tracker)
+{
+  return tracker != NULL ? tracker->port : 0;
+}
+
+gboolean
+chrome_cdp_tab_tracker_is_connected(const ChromeCdpTabTracker *tracker)
+{
+  return tracker != NULL && tracker->connection != NULL &&
+         soup_websocket_connection_get_state(tracker->connection) ==
+             SOUP_WEBSOCKET_STATE_OPEN;
+}
+
+const ChromeCdpTab *
+chrome_cdp_tab_tracker_find_active(ChromeCdpTabTracker *tracker,
+                                   const char *window_title)
+{
+  if (!chrome_cdp_tab_tracker_is_connected(tracker) ||
+      g_hash_table_size(tracker->tabs) == 0) {
+    return NULL;
+  }
+
+  char *window_norm =
+      window_title != NULL ? chrome_cdp_normalize_title(window_title, TRUE) : NULL;
+
+  /* Only a title match counts: a focused devtools or untracked Chrome window
+   * matches no tab, and its time is then recorded without a domain. */
+  ChromeCdpTabEntry *best = NULL;
+  int best_score = 0;
+  GHashTableIter iter;
+  gpointer value = NULL;
+  g_hash_table_iter_init(&iter, tracker->tabs);
+  while (g_hash_table_iter_next(&iter, NULL, &value)) {
+    ChromeCdpTabEntry *entry = value;
+    int score = chrome_cdp_score_normalized(window_norm, entry->title_norm);
+    if (score > best_score ||
+        (best != NULL && score == best_score &&
+         entry->tab.last_activated_us > best->tab.last_activated_us)) {
+      best = entry;
+      best_score = score;
+    }
+  }
+
+  g_free(window_norm);
+
+  /* The X11 window title names the tab on screen, so a match is an
+   * activation even if the user only switched tabs. */
+  if (best != NULL) {
+    best->tab.last_activated_us = g_get_monotonic_time();
+  }
+
+  return best != NULL ? &best->tab : NULL;
+}
+
+static gint
+chrome_cdp_tab_compare_recent(gconstpointer left, gconstpointer right)
+{
+  const ChromeCdpTab *left_tab = *(const ChromeCdpTab *const *)left;
+  const ChromeCdpTab *right_tab = *(const ChromeCdpTab *const *)right;
+  if (left_tab->last_activated_us != right_tab->last_activated_us) {
+    return left_tab->last_activated_us > right_tab->last_activated_us ? -1 : 1;
+  }
+  return g_strcmp0(left_tab->id, right_tab->id);
+}
+
+GPtrArray *
+chrome_cdp_tab_tracker_list_tabs(ChromeCdpTabTracker *tracker)
+{
+  GPtrArray *tabs = g_ptr_array_new();
+  if (!chrome_cdp_tab_tracker_is_connected(tracker)) {
+    return tabs;
+  }
+
+  GHashTableIter iter;
+  gpointer value = NULL;
+  g_hash_table_iter_init(&iter, tracker->tabs);
+  while (g_hash_table_iter_next(&iter, NULL, &value)) {
+    ChromeCdpTabEntry *entry = value;
+    g_ptr_array_add(tabs, &entry->tab);
+  }
+  g_ptr_array_sort(tabs, chrome_cdp_tab_compare_recent);
+  return tabs;
+}
+
+#else
+
+ChromeCdpTabTracker *
+chrome_cdp_tab_tracker_new(guint port,
+                           ChromeCdpTabNavigatedFunc on_navigated,
+                           gpointer user_data)
+{
+  (void)port;
+  (void)on_navigated;
+  (void)user_data;
+  return NULL;
+}
+
+void
+chrome_cdp_tab_tracker_free(ChromeCdpTabTracker *tracker)
+{
+  (void)tracker;
+}
+
+guint
+chrome_cdp_tab_tracker_get_port(const ChromeCdpTabTracker *tracker)
+{
+  (void)tracker;
+  return 0;
+}
+
+gboolean
+chrome_cdp_tab_tracker_is_connected(const ChromeCdpTabTracker *tracker)
+{
+  (void)tracker;
+  return FALSE;
+}
+
+const ChromeCdpTab *
+chrome_cdp_tab_tracker_find_active(ChromeCdpTabTracker *tracker,
+                                   const char *window_title)
+{
+  (void)tracker;
+  (void)window_title;
+  return NULL;
+}
+
+GPtrArray *
+chrome_cdp_tab_tracker_list_tabs(ChromeCdpTabTracker *tracker)
+{
+  (void)tracker;
+  return g_ptr_array_new();
+}
+
+char *
+chrome_cdp_url_registrable_domain(const char *url)
+{
+  if (url == NULL ||
+      !(g_str_has_prefix(url, "http://") || g_str_has_prefix(url, "https://"))) {
+    return NULL;
+  }
+
+  return chrome_cdp_url_domain(url);
+}
+
+#endif
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <glib.h>
+
+typedef struct _ChromeCdpTabTracker ChromeCdpTabTracker;
+
+typedef struct {
+  char *id;
+  char *title;
+  char *url;
+  /* Interned registrable domain of an http(s) URL, or NULL. */
+  const char *domain;
+  gint64 last_activated_us;
+} ChromeCdpTab;
+
+/* Called when a tab navigates, and again when the new page's title arrives
+ * shortly after. */
+typedef void (*ChromeCdpTabNavigatedFunc)(const ChromeCdpTab *tab,
+                                          gpointer user_data);
+
+ChromeCdpTabTracker *chrome_cdp_tab_tracker_new(guint port,
+                                                ChromeCdpTabNavigatedFunc on_navigated,
+                                                gpointer user_data);
+void chrome_cdp_tab_tracker_free(ChromeCdpTabTracker *tracker);
+guint chrome_cdp_tab_tracker_get_port(const ChromeCdpTabTracker *tracker);
+gboolean chrome_cdp_tab_tracker_is_connected(const ChromeCdpTabTracker *tracker);
+/* The tab whose title best matches the focused window's, or NULL when no
+ * tab title matches it. */
+const ChromeCdpTab *chrome_cdp_tab_tracker_find_active(ChromeCdpTabTracker *tracker,
+                                                       const char *window_title);
+/* Open tabs, most recently activated first. The array holds borrowed
+ * pointers that stay valid until the main loop next runs. */
+GPtrArray *chrome_cdp_tab_tracker_list_tabs(ChromeCdpTabTracker *tracker);
+
+/* Lowercase host of url without a leading "www.", or NULL when the URL has
+ * no host (file://, about:blank). */
+char *chrome_cdp_url_domain(const char *url);
+/* The registrable part of an http(s) URL's host ("mail.google.com" gives
+ * "google.com"), or NULL for other schemes. Falls back to the plain host
+ * when the public suffix list does not apply (IP addresses, localhost). */
+char *chrome_cdp_url_registrable_domain(const char *url);
@@ -0,0 +1,852 @@
+#include "focus/content_extractor.h"
+
+#include <string.h>
+
+/* A scoring pass modelled on Mozilla's Readability: paragraphs vote for
+ * their parent and grandparent containers, links and boilerplate class
+ * names count against them, and the winning container (plus siblings that
+ * score nearly as well) is the main content. */
+
+#define CONTENT_EXTRACTOR_CHARS_PER_TOKEN 4
+#define CONTENT_EXTRACTOR_MIN_BLOCK_CHARS 25
+#define CONTENT_EXTRACTOR_MIN_RESULT_CHARS 140
+#define CONTENT_EXTRACTOR_MAX_DEPTH 512
+#define CONTENT_EXTRACTOR_TAG_MAX 16
+
+typedef struct {
+  gint parent;
+  gboolean scored;
+  double score;
+  gint initial_score;
+  guint text_len;
+  guint link_len;
+} ExtractorNode;
+
+typedef struct {
+  gint node;
+  char *text;
+  guint text_len;
+  guint link_len;
+  gboolean heading;
+} ExtractorBlock;
+
+typedef struct {
+  char tag[CONTENT_EXTRACTOR_TAG_MAX];
+  gint node;
+  gboolean skip;
+  gboolean link;
+} ExtractorOpen;
+
+typedef struct {
+  GArray *nodes;
+  GArray *blocks;
+  GArray *stack;
+  GString *text;
+  guint text_chars;
+  guint text_link_chars;
+  gint text_node;
+  gboolean text_heading;
+  gboolean pending_space;
+  guint skip_depth;
+  guint link_depth;
+} ExtractorState;
+
+typedef struct {
+  GString *class_id;
+  gboolean hidden;
+  char role[24];
+} ExtractorAttrs;
+
+static const char *const content_extractor_container_tags[] = {
+    "address", "article", "aside", "blockquote", "body", "center", "dd",
+    "details", "div", "dl", "dt", "figcaption", "figure", "footer", "form",
+    "h1", "h2", "h3", "h4", "h5", "h6", "header", "li", "main", "nav", "ol",
+    "p", "pre", "section", "summary", "table", "tbody", "td", "tfoot", "th",
+    "thead", "tr", "ul", NULL,
+};
+
+static const char *const content_extractor_skip_tags[] = {
+    "aside", "button", "canvas", "dialog", "embed", "footer", "iframe",
+    "math", "nav", "object", "select", "svg", "template", NULL,
+};
+
+static const char *const content_extractor_raw_tags[] = {
+    "noscript", "script", "style", "textarea", "title", "xmp", NULL,
+};
+
+static const char *const content_extractor_void_tags[] = {
+    "area", "base", "br", "col", "embed", "hr", "img", "input", "link",
+    "meta", "param", "source", "track", "wbr", NULL,
+};
+
+/* Tags the HTML parser closes implicitly when the same tag opens again. */
+static const char *const content_extractor_self_closing_tags[] = {
+    "dd", "dt", "li", "p", "td", "th", "tr", NULL,
+};
+
+static const char *const content_extractor_unlikely[] = {
+    "ad-break", "agegate", "banner", "breadcrumb", "combx", "comment",
+    "community", "consent", "cookie", "cover-wrap", "disqus", "extra",
+    "gdpr", "legends", "menu", "newsletter", "pager", "pagination", "popup",
+    "related", "remark", "replies", "rss", "share", "shoutbox", "sidebar",
+    "skyscraper", "social", "sponsor", "supplemental", NULL,
+};
+
+static const char *const content_extractor_maybe[] = {
+    "article", "body", "column", "content", "main", "shadow", NULL,
+};
+
+static const char *const content_extractor_positive[] = {
+    "article", "blog", "body", "content", "entry", "hentry", "main", "page",
+    "post", "story", "text", NULL,
+};
+
+static const char *const content_extractor_negative[] = {
+    "advert", "banner", "breadcrumb", "combx", "comment", "contact",
+    "cookie", "foot", "masthead", "media", "meta", "modal", "nav",
+    "outbrain", "popup", "promo", "related", "scroll", "share", "shopping",
+    "sidebar", "skyscraper", "social", "sponsor", "tags", "tool", "widget",
+    NULL,
+};
+
+static const char *const content_extractor_skip_roles[] = {
+    "alertdialog", "banner", "complementary", "contentinfo", "dialog",
+    "menu", "menubar", "navigation", NULL,
+};
+
+static gboolean
+content_extractor_in_list(const char *value, const char *const *list)
+{
+  for (guint i = 0; list[i] != NULL; i++) {
+    if (strcmp(value, list[i]) == 0) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+static gboolean
+content_extractor_matches_any(const char *haystack, const char *const *needles)
+{
+  if (haystack == NULL || *haystack == '\0') {
+    return FALSE;
+  }
+
+  for (guint i = 0; needles[i] != NULL; i++) {
+    if (strstr(haystack, needles[i]) != NULL) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+static gboolean
+content_extractor_is_heading(const char *tag)
+{
+  return tag[0] == 'h' && tag[1] >= '1' && tag[1] <= '6' && tag[2] == '\0';
+}
+
+static gint
+content_extractor_tag_score(const char *tag)
+{
+  if (strcmp(tag, "div") == 0) {
+    return 5;
+  }
+  if (strcmp(tag, "article") == 0 || strcmp(tag, "main") == 0) {
+    return 10;
+  }
+  if (strcmp(tag, "pre") == 0 || strcmp(tag, "td") == 0 ||
+      strcmp(tag, "blockquote") == 0) {
+    return 3;
+  }
+  if (strcmp(tag, "address") == 0 || strcmp(tag, "ol") == 0 ||
+      strcmp(tag, "ul") == 0 || strcmp(tag, "dl") == 0 ||
+      strcmp(tag, "dd") == 0 || strcmp(tag, "dt") == 0 ||
+      strcmp(tag, "li") == 0 || strcmp(tag, "form") == 0) {
+    return -3;
+  }
+  if (content_extractor_is_heading(tag) || strcmp(tag, "th") == 0) {
+    return -5;
+  }
+  return 0;
+}
+
+static gint
+content_extractor_class_weight(const char *class_id)
+{
+  gint weight = 0;
+  if (content_extractor_matches_any(class_id, content_extractor_negative)) {
+    weight -= 25;
+  }
+  if (content_extractor_matches_any(class_id, content_extractor_positive)) {
+    weight += 25;
+  }
+  return weight;
+}
+
+static gint
+content_extractor_current_node(const ExtractorState *state)
+{
+  for (guint i = state->stack->len; i > 0; i--) {
+    const ExtractorOpen *open = &g_array_index(state->stack, ExtractorOpen, i - 1);
+    if (open->node >= 0) {
+      return open->node;
+    }
+  }
+  return 0;
+}
+
+static gboolean
+content_extractor_current_is_heading(const ExtractorState *state)
+{
+  for (guint i = state->stack->len; i > 0; i--) {
+    const ExtractorOpen *open = &g_array_index(state->stack, ExtractorOpen, i - 1);
+    if (open->node >= 0) {
+      return content_extractor_is_heading(open->tag);
+    }
+  }
+  return FALSE;
+}
+
+static void
+content_extractor_flush(ExtractorState *state)
+{
+  if (state->text->len > 0) {
+    ExtractorBlock block = {
+        .node = state->text_node,
+        .text = g_strndup(state->text->str, state->text->len),
+        .text_len = state->text_chars,
+        .link_len = state->text_link_chars,
+        .heading = state->text_heading,
+    };
+    g_array_append_val(state->blocks, block);
+
+    for (gint node = block.node; node >= 0;) {
+      ExtractorNode *entry = &g_array_index(state->nodes, ExtractorNode, node);
+      entry->text_len += block.text_len;
+      entry->link_len += block.link_len;
+      node = entry->parent;
+    }
+  }
+
+  g_string_truncate(state->text, 0);
+  state->text_chars = 0;
+  state->text_link_chars = 0;
+  state->pending_space = FALSE;
+}
+
+static void
+content_extractor_put_char(ExtractorState *state, const char *utf8, gsize length)
+{
+  if (state->text->len == 0) {
+    state->text_node = content_extractor_current_node(state);
+    state->text_heading = content_extractor_current_is_heading(state);
+  } else if (state->pending_space) {
+    g_string_append_c(state->text, ' ');
+    state->text_chars++;
+  }
+  state->pending_space = FALSE;
+
+  g_string_append_len(state->text, utf8, (gssize)length);
+  state->text_chars++;
+  if (state->link_depth > 0) {
+    state->text_link_chars++;
+  }
+}
+
+static gunichar
+content_extractor_named_entity(const char *name, gsize length)
+{
+  static const struct {
+    const char *name;
+    gunichar value;
+  } entities[] = {
+      {"amp", '&'},      {"lt", '<'},        {"gt", '>'},
+      {"quot", '"'},     {"apos", '\''},     {"nbsp", ' '},
+      {"mdash", 0x2014}, {"ndash", 0x2013},  {"hellip", 0x2026},
+      {"lsquo", 0x2018}, {"rsquo", 0x2019},  {"ldquo", 0x201C},
+      {"rdquo", 0x201D}, {"copy", 0x00A9},   {"middot", 0x00B7},
+  };
+
+  for (guint i = 0; i < G_N_ELEMENTS(entities); i++) {
+    if (strlen(entities[i].name) == length &&
+        strncmp(entities[i].name, name, length) == 0) {
+      return entities[i].value;
+    }
+  }
+  return 0;
+}
+
+/* Decodes the entity at p (pointing at '&'). Returns the bytes consumed,
+ * or 0 when it is not a recognised entity. */
+static gsize
+content_extractor_decode_entity(const char *p, const char *end, gunichar *out)
+{
+  const char *semi = memchr(p, ';', (gsize)MIN(end - p, 12));
+  if (semi == NULL || semi - p < 2) {
+    return 0;
+  }
+
+  gunichar value = 0;
+  if (p[1] == '#') {
+    char *parse_end = NULL;
+    if (p[2] == 'x' || p[2] == 'X') {
+      value = (gunichar)g_ascii_strtoull(p + 3, &parse_end, 16);
+    } else {
+      value = (gunichar)g_ascii_strtoull(p + 2, &parse_end, 10);
+    }
+    if (parse_end != semi) {
+      return 0;
+    }
+  } else {
+    value = content_extractor_named_entity(p + 1, (gsize)(semi - p - 1));
+  }
+
+  if (value == 0 || !g_unichar_validate(value)) {
+    return 0;
+  }
+
+  *out = value;
+  return (gsize)(semi - p + 1);
+}
+
+static void
+content_extractor_append_text(ExtractorState *state, const char *p, const char *end)
+{
+  if (state->skip_depth > 0) {
+    return;
+  }
+
+  while (p < end) {
+    guchar c = (guchar)*p;
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f') {
+      state->pending_space = TRUE;
+      p++;
+      continue;
+    }
+
+    if (c == '&') {
+      gunichar value = 0;
+      gsize consumed = content_extractor_decode_entity(p, end, &value);
+      if (consumed > 0) {
+        if (value == ' ' || value == 0x00A0) {
+          state->pending_space = TRUE;
+        } else {
+          char utf8[6];
+          gint length = g_unichar_to_utf8(value, utf8);
+          content_extractor_put_char(state, utf8, (gsize)length);
+        }
+        p += consumed;
+        continue;
+      }
+    }
+
+    /* Non-breaking space as UTF-8. */
+    if (c == 0xC2 && p + 1 < end && (guchar)p[1] == 0xA0) {
+      state->pending_space = TRUE;
+      p += 2;
+      continue;
+    }
+
+    gsize length = 1;
+    if (c >= 0xC0) {
+      while (p + length < end && ((guchar)p[length] & 0xC0) == 0x80 && length < 4) {
+        length++;
+      }
+    }
+    content_extractor_put_char(state, p, length);
+    p += length;
+  }
+}
+
+static gboolean
+content_extractor_should_skip(const char *tag, const ExtractorAttrs *attrs)
+{
+  if (content_extractor_in_list(tag, content_extractor_skip_tags) || attrs->hidden) {
+    return TRUE;
+  }
+  if (attrs->role[0] != '\0' &&
+      content_extractor_in_list(attrs->role, content_extractor_skip_roles)) {
+    return TRUE;
+  }
+  if (strcmp(tag, "body") == 0 || strcmp(tag, "html") == 0 ||
+      strcmp(tag, "article") == 0 || strcmp(tag, "main") == 0 ||
+      strcmp(tag, "a") == 0) {
+    return FALSE;
+  }
+  return content_extractor_matches_any(attrs->class_id->str, content_extractor_unlikely) &&
+         !content_extractor_matches_any(attrs->class_id->str, content_extractor_maybe);
+}
+
+static void
+content_extractor_pop_to(ExtractorState *state, guint index)
+{
+  while (state->stack->len > index) {
+    ExtractorOpen *open =
+        &g_array_index(state->stack, ExtractorOpen, state->stack->len - 1);
+    if (open->skip) {
+      state->skip_depth--;
+    }
+    if (open->link) {
+      state->link_depth--;
+    }
+    g_array_set_size(state->stack, state->stack->len - 1);
+  }
+}
+
+static void
+content_extractor_start_tag(ExtractorState *state,
+                            const char *tag,
+                            const ExtractorAttrs *attrs,
+                            gboolean self_closing)
+{
+  gboolean container = content_extractor_in_list(tag, content_extractor_container_tags);
+  if (container || strcmp(tag, "br") == 0) {
+    content_extractor_flush(state);
+  }
+
+  if (container && content_extractor_in_list(tag, content_extractor_self_closing_tags) &&
+      state->stack->len > 0) {
+    ExtractorOpen *top =
+        &g_array_index(state->stack, ExtractorOpen, state->stack->len - 1);
+    if (strcmp(top->tag, tag) == 0) {
+      content_extractor_pop_to(state, state->stack->len - 1);
+    }
+  }
+
+  if (self_closing || content_extractor_in_list(tag, content_extractor_void_tags) ||
+      state->stack->len >= CONTENT_EXTRACTOR_MAX_DEPTH) {
+    return;
+  }
+
+  ExtractorOpen open = {
+      .node = -1,
+      .skip = state->skip_depth > 0 || content_extractor_should_skip(tag, attrs),
+      .link = strcmp(tag, "a") == 0,
+  };
+  g_strlcpy(open.tag, tag, sizeof(open.tag));
+
+  if (container && !open.skip) {
+    ExtractorNode node = {
+        .parent = content_extractor_current_node(state),
+        .initial_score = content_extractor_tag_score(tag) +
+                         content_extractor_class_weight(attrs->class_id->str),
+    };
+    g_array_append_val(state->nodes, node);
+    open.node = (gint)state->nodes->len - 1;
+  }
+
+  if (open.skip) {
+    state->skip_depth++;
+  }
+  if (open.link) {
+    state->link_depth++;
+  }
+  g_array_append_val(state->stack, open);
+}
+
+static void
+content_extractor_end_tag(ExtractorState *state, const char *tag)
+{
+  for (guint i = state->stack->len; i > 0; i--) {
+    ExtractorOpen *open = &g_array_index(state->stack, ExtractorOpen, i - 1);
+    if (strcmp(open->tag, tag) == 0) {
+      if (content_extractor_in_list(tag, content_extractor_container_tags)) {
+        content_extractor_flush(state);
+      }
+      content_extractor_pop_to(state, i - 1);
+      return;
+    }
+  }
+}
+
+static const char *
+content_extractor_read_name(const char *p, const char *end, char *out, gsize out_size)
+{
+  gsize length = 0;
+  while (p < end && (g_ascii_isalnum(*p) || *p == '-' || *p == '_' || *p == ':')) {
+    if (length + 1 < out_size) {
+      out[length++] = g_ascii_tolower(*p);
+    }
+    p++;
+  }
+  out[length] = '\0';
+  return p;
+}
+
+static void
+content_extractor_note_attr(ExtractorAttrs *attrs,
+                            const char *name,
+                            const char *value,
+                            gsize value_length)
+{
+  if (strcmp(name, "class") == 0 || strcmp(name, "id") == 0) {
+    gsize start = attrs->class_id->len;
+    g_string_append_len(attrs->class_id, value, (gssize)value_length);
+    g_string_append_c(attrs->class_id, ' ');
+    for (gsize i = start; i < attrs->class_id->len; i++) {
+      attrs->class_id->str[i] = g_ascii_tolower(attrs->class_id->str[i]);
+    }
+  } else if (strcmp(name, "hidden") == 0) {
+    attrs->hidden = TRUE;
+  } else if (strcmp(name, "aria-hidden") == 0) {
+    attrs->hidden = value_length == 4 && g_ascii_strncasecmp(value, "true", 4) == 0;
+  } else if (strcmp(name, "role") == 0) {
+    gsize length = MIN(value_length, sizeof(attrs->role) - 1);
+    for (gsize i = 0; i < length; i++) {
+      attrs->role[i] = g_ascii_tolower(value[i]);
+    }
+    attrs->role[length] = '\0';
+  }
+}
+
+/* Parses attributes up to the closing '>' and returns the position after
+ * it. Quoted values may contain '>'. */
+static const char *
+content_extractor_read_attrs(const char *p,
+                             const char *end,
+                             ExtractorAttrs *attrs,
+                             gboolean *self_closing)
+{
+  *self_closing = FALSE;
+  while (p < end) {
+    while (p < end && (g_ascii_isspace(*p) || *p == '/')) {
+      *self_closing = *p == '/';
+      p++;
+    }
+    if (p >= end) {
+      break;
+    }
+    if (*p == '>') {
+      return p + 1;
+    }
+
+    char name[CONTENT_EXTRACTOR_TAG_MAX];
+    const char *name_end = content_extractor_read_name(p, end, name, sizeof(name));
+    if (name_end == p) {
+      /* Junk such as a stray quote; step over it. */
+      p++;
+      continue;
+    }
+    p = name_end;
+    *self_closing = FALSE;
+
+    while (p < end && g_ascii_isspace(*p)) {
+      p++;
+    }
+    const char *value = "";
+    gsize value_length = 0;
+    if (p < end && *p == '=') {
+      p++;
+      while (p < end && g_ascii_isspace(*p)) {
+        p++;
+      }
+      if (p < end && (*p == '"' || *p == '\'')) {
+        char quote = *p++;
+        value = p;
+        const char *close = memchr(p, quote, (gsize)(end - p));
+        p = close != NULL ? close : end;
+        value_length = (gsize)(p - value);
+        if (p < end) {
+          p++;
+        }
+      } else {
+        value = p;
+        while (p < end && !g_ascii_isspace(*p) && *p != '>') {
+          p++;
+        }
+        value_length = (gsize)(p - value);
+      }
+    }
+    content_extractor_note_attr(attrs, name, value, value_length);
+  }
+  return end;
+}
+
+/* Skips raw text up to and including the matching end tag. */
+static const char *
+content_extractor_skip_raw(const char *p, const char *end, const char *tag)
+{
+  gsize tag_length = strlen(tag);
+  while (p < end) {
+    const char *lt = memchr(p, '<', (gsize)(end - p));
+    if (lt == NULL) {
+      return end;
+    }
+    if (lt + 2 + tag_length <= end && lt[1] == '/' &&
+        g_ascii_strncasecmp(lt + 2, tag, tag_length) == 0) {
+      const char *gt = memchr(lt, '>', (gsize)(end - lt));
+      return gt != NULL ? gt + 1 : end;
+    }
+    p = lt + 1;
+  }
+  return end;
+}
+
+static void
+content_extractor_parse(ExtractorState *state, const char *html, gsize length)
+{
+  const char *p = html;
+  const char *end = html + length;
+  ExtractorAttrs attrs = {.class_id = g_string_new(NULL)};
+
+  while (p < end) {
+    const char *lt = memchr(p, '<', (gsize)(end - p));
+    if (lt == NULL) {
+      content_extractor_append_text(state, p, end);
+      break;
+    }
+    content_extractor_append_text(state, p, lt);
+    p = lt;
+
+    if (end - p >= 4 && strncmp(p, "<!--", 4) == 0) {
+      const char *close = g_strstr_len(p + 4, end - p - 4, "-->");
+      p = close != NULL ? close + 3 : end;
+      continue;
+    }
+
+    if (end - p >= 2 && (p[1] == '!' || p[1] == '?')) {
+      const char *gt = memchr(p, '>', (gsize)(end - p));
+      p = gt != NULL ? gt + 1 : end;
+      continue;
+    }
+
+    char tag[CONTENT_EXTRACTOR_TAG_MAX];
+    if (end - p >= 3 && p[1] == '/' && g_ascii_isalpha(p[2])) {
+      content_extractor_read_name(p + 2, end, tag, sizeof(tag));
+      content_extractor_end_tag(state, tag);
+      const char *gt = memchr(p, '>', (gsize)(end - p));
+      p = gt != NULL ? gt + 1 : end;
+      continue;
+    }
+
+    if (end - p >= 2 && g_ascii_isalpha(p[1])) {
+      const char *name_end = content_extractor_read_name(p + 1, end, tag, sizeof(tag));
+      g_string_truncate(attrs.class_id, 0);
+      attrs.hidden = FALSE;
+      attrs.role[0] = '\0';
+      gboolean self_closing = FALSE;
+      p = content_extractor_read_attrs(name_end, end, &attrs, &self_closing);
+
+      if (content_extractor_in_list(tag, content_extractor_raw_tags)) {
+        if (!self_closing) {
+          p = content_extractor_skip_raw(p, end, tag);
+        }
+        continue;
+      }
+      content_extractor_start_tag(state, tag, &attrs, self_closing);
+      continue;
+    }
+
+    /* A bare '<' in text. */
+    content_extractor_append_text(state, p, p + 1);
+    p++;
+  }
+
+  content_extractor_flush(state);
+  g_string_free(attrs.class_id, TRUE);
+}
+
+static void
+content_extractor_add_score(ExtractorState *state, gint node, double score)
+{
+  if (node <= 0) {
+    return;
+  }
+
+  ExtractorNode *entry = &g_array_index(state->nodes, ExtractorNode, node);
+  if (!entry->scored) {
+    entry->scored = TRUE;
+    entry->score = entry->initial_score;
+  }
+  entry->score += score;
+}
+
+static double
+content_extractor_final_score(const ExtractorNode *node)
+{
+  double link_density =
+      node->text_len > 0 ? (double)node->link_len / (double)node->text_len : 0.0;
+  return node->score * (1.0 - link_density);
+}
+
+static gint
+content_extractor_pick_candidate(ExtractorState *state, double *score_out)
+{
+  for (guint i = 0; i < state->blocks->len; i++) {
+    const ExtractorBlock *block = &g_array_index(state->blocks, ExtractorBlock, i);
+    if (block->heading || block->text_len < CONTENT_EXTRACTOR_MIN_BLOCK_CHARS) {
+      continue;
+    }
+
+    guint commas = 0;
+    for (const char *c = block->text; *c != '\0'; c++) {
+      if (*c == ',') {
+        commas++;
+      }
+    }
+    double score = 1.0 + commas + MIN(block->text_len / 100, 3u);
+    gint parent = g_array_index(state->nodes, ExtractorNode, block->node).parent;
+    content_extractor_add_score(state, parent, score);
+    if (parent > 0) {
+      gint grandparent = g_array_index(state->nodes, ExtractorNode, parent).parent;
+      content_extractor_add_score(state, grandparent, score / 2.0);
+    }
+  }
+
+  gint best = -1;
+  double best_score = 0.0;
+  for (guint i = 1; i < state->nodes->len; i++) {
+    const ExtractorNode *node = &g_array_index(state->nodes, ExtractorNode, i);
+    if (!node->scored) {
+      continue;
+    }
+    double score = content_extractor_final_score(node);
+    if (best < 0 || score > best_score) {
+      best = (gint)i;
+      best_score = score;
+    }
+  }
+
+  *score_out = best_score;
+  return best;
+}
+
+static char *
+content_extractor_clip_chars(const char *text, guint max_chars)
+{
+  if ((guint)g_utf8_strlen(text, -1) <= max_chars) {
+    return g_strdup(text);
+  }
+
+  const char *cut = g_utf8_offset_to_pointer(text, max_chars);
+  const char *space = cut;
+  while (space > text && *space != ' ') {
+    space--;
+  }
+  if (space > text) {
+    cut = space;
+  }
+
+  char *clipped = g_strndup(text, (gsize)(cut - text));
+  return g_strchomp(clipped);
+}
+
+guint
+content_extractor_estimate_tokens(const char *text)
+{
+  if (text == NULL) {
+    return 0;
+  }
+
+  glong chars = g_utf8_strlen(text, -1);
+  return (guint)((chars + CONTENT_EXTRACTOR_CHARS_PER_TOKEN - 1) /
+                 CONTENT_EXTRACTOR_CHARS_PER_TOKEN);
+}
+
+char *
+content_extractor_clip(const char *text, guint token_budget)
+{
+  if (text == NULL) {
+    return NULL;
+  }
+  if (token_budget == 0) {
+    return g_strdup(text);
+  }
+
+  return content_extractor_clip_chars(text, token_budget * CONTENT_EXTRACTOR_CHARS_PER_TOKEN);
+}
+
+char *
+content_extractor_extract(const char *html, gsize length, guint token_budget)
+{
+  if (html == NULL || length == 0) {
+    return NULL;
+  }
+
+  ExtractorState state = {
+      .nodes = g_array_new(FALSE, TRUE, sizeof(ExtractorNode)),
+      .blocks = g_array_new(FALSE, TRUE, sizeof(ExtractorBlock)),
+      .stack = g_array_new(FALSE, TRUE, sizeof(ExtractorOpen)),
+      .text = g_string_new(NULL),
+  };
+  ExtractorNode root = {.parent = -1};
+  g_array_append_val(state.nodes, root);
+
+  content_extractor_parse(&state, html, length);
+
+  double best_score = 0.0;
+  gint best = content_extractor_pick_candidate(&state, &best_score);
+  GString *out = NULL;
+  guint out_chars = 0;
+
+  if (best > 0) {
+    gboolean *accepted = g_new0(gboolean, state.nodes->len);
+    accepted[best] = TRUE;
+    gint best_parent = g_array_index(state.nodes, ExtractorNode, best).parent;
+    double threshold = MAX(10.0, best_score * 0.2);
+    for (guint i = 1; i < state.nodes->len; i++) {
+      const ExtractorNode *node = &g_array_index(state.nodes, ExtractorNode, i);
+      if (node->scored && node->parent == best_parent &&
+          content_extractor_final_score(node) >= threshold) {
+        accepted[i] = TRUE;
+      }
+    }
+
+    guint max_chars = token_budget * CONTENT_EXTRACTOR_CHARS_PER_TOKEN;
+    out = g_string_new(NULL);
+    for (guint i = 0; i < state.blocks->len; i++) {
+      const ExtractorBlock *block = &g_array_index(state.blocks, ExtractorBlock, i);
+      if (block->link_len * 2 > block->text_len) {
+        continue;
+      }
+
+      gint node = block->node;
+      while (node >= 0 && !accepted[node]) {
+        node = g_array_index(state.nodes, ExtractorNode, node).parent;
+      }
+      if (node < 0) {
+        continue;
+      }
+
+      guint separator = out->len > 0 ? 1 : 0;
+      if (max_chars > 0 && out_chars + separator + block->text_len > max_chars) {
+        if (out_chars + separator < max_chars) {
+          char *clipped =
+              content_extractor_clip_chars(block->text, max_chars - out_chars - separator);
+          if (separator > 0) {
+            g_string_append_c(out, '\n');
+          }
+          g_string_append(out, clipped);
+          out_chars += separator + (guint)g_utf8_strlen(clipped, -1);
+          g_free(clipped);
+        }
+        break;
+      }
+
+      if (separator > 0) {
+        g_string_append_c(out, '\n');
+      }
+      g_string_append(out, block->text);
+      out_chars += separator + block->text_len;
+    }
+    g_free(accepted);
+  }
+
+  for (guint i = 0; i < state.blocks->len; i++) {
+    g_free(g_array_index(state.blocks, ExtractorBlock, i).text);
+  }
+  g_array_free(state.blocks, TRUE);
+  g_array_free(state.nodes, TRUE);
+  g_array_free(state.stack, TRUE);
+  g_string_free(state.text, TRUE);
+
+  if (out == NULL) {
+    return NULL;
+  }
+  if (out_chars < CONTENT_EXTRACTOR_MIN_RESULT_CHARS) {
+    g_string_free(out, TRUE);
+    return NULL;
+  }
+  return g_string_free(out, FALSE);
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <glib.h>
+
+/* Rough prompt-size estimate: about four characters per token. */
+guint content_extractor_estimate_tokens(const char *text);
+
+/* Readability-style main-content extraction. Returns the headings and
+ * paragraphs of the densest text region, clipped to token_budget, or NULL
+ * when the page has no clear main content. */
+char *content_extractor_extract(const char *html, gsize length, guint token_budget);
+
+/* Clips plain text to token_budget on a word boundary. */
+char *content_extractor_clip(const char *text, guint token_budget);
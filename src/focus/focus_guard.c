@@ -1,6 +1,8 @@
 #include "focus/focus_guard_internal.h"
 
-#include "focus/ollama_client.h"
+#define FOCUS_GUARD_RELEVANCE_CACHE_CAPACITY 256
+/* One slot for the current page, one for a superseded check winding down. */
+#define FOCUS_GUARD_SCHEDULER_WORKERS 2
 
 static void
 focus_guard_restart_timer(FocusGuard *guard)
@@ -51,11 +53,13 @@ focus_guard_create(AppState *state, FocusGuardConfig config)
   guard->bucket_task = focus_guard_bucket_task_table_new();
   guard->bucket_start_utc = 0;
   guard->day_start_utc = 0;
+  guard->day_end_utc = 0;
+  guard->heatmap_stale = TRUE;
   guard->config = focus_guard_config_copy(&config);
   focus_guard_build_blacklist(guard);
-  guard->ollama_available = ollama_client_detect_available();
-  if (!guard->ollama_available ||
-      guard->config.ollama_model == NULL ||
+  guard->ollama_catalog = ollama_catalog_new();
+  ollama_catalog_refresh_async(guard->ollama_catalog, FALSE, NULL, NULL, NULL);
+  if (guard->config.ollama_model == NULL ||
       *guard->config.ollama_model == '\0') {
     guard->config.chrome_ollama_enabled = FALSE;
   }
@@ -64,8 +68,30 @@ focus_guard_create(AppState *state, FocusGuardConfig config)
   guard->relevance_state = FOCUS_GUARD_RELEVANCE_UNKNOWN;
   guard->last_relevance_check_us = 0;
   guard->relevance_check_id = 0;
-  guard->relevance_inflight = FALSE;
-  guard->relevance_cancellable = NULL;
+  guard->relevance_page_key = NULL;
+  guard->last_tab_batch_us = 0;
+  guard->scheduler = focus_scheduler_new(FOCUS_GUARD_SCHEDULER_WORKERS);
+  guard->residency_scheduler = focus_scheduler_new(1);
+  guard->chrome_tabs = NULL;
+  guard->relevance_cache = relevance_cache_new(FOCUS_GUARD_RELEVANCE_CACHE_CAPACITY);
+  guard->relevance_embeddings = relevance_embeddings_new();
+  guard->trafilatura = trafilatura_client_new(guard->config.trafilatura_python_path);
+  relevance_cache_load_from_store(guard->relevance_cache,
+                                  guard->stats_store,
+                                  g_get_real_time() / G_USEC_PER_SEC);
+  guard->relevance_classifier = relevance_classifier_new();
+  relevance_classifier_load_from_store(guard->relevance_classifier,
+                                       guard->stats_store,
+                                       FOCUS_GUARD_RELEVANCE_RELEVANT,
+                                       FOCUS_GUARD_RELEVANCE_IRRELEVANT);
+  focus_guard_sync_chrome_tabs(guard);
+  guint replayed = usage_stats_store_replay_checkpoint(guard->stats_store);
+  if (replayed > 0) {
+    g_info("Recovered %u usage rows from an unfinished stats bucket", replayed);
+  }
+  focus_guard_sync_bucket_seconds(guard);
+  focus_guard_load_task_focus(guard);
+  focus_guard_watch_timezone(guard);
   focus_guard_refresh_day(guard);
   focus_guard_prune_history(guard);
   if (guard->usage_global != NULL) {
@@ -89,7 +115,24 @@ focus_guard_destroy(FocusGuard *guard)
   }
 
   focus_guard_cancel_relevance_check(guard);
+  if (guard->stats_transfer_cancellable != NULL) {
+    g_cancellable_cancel(guard->stats_transfer_cancellable);
+    g_clear_object(&guard->stats_transfer_cancellable);
+    guard->stats_import_active = FALSE;
+  }
+  g_clear_pointer(&guard->scheduler, focus_scheduler_free);
   g_clear_pointer(&guard->relevance_warning_text, g_free);
+  g_clear_pointer(&guard->chrome_tabs, chrome_cdp_tab_tracker_free);
+  g_clear_pointer(&guard->relevance_cache, relevance_cache_unref);
+  g_clear_pointer(&guard->relevance_classifier, relevance_classifier_unref);
+  g_clear_pointer(&guard->relevance_embeddings, relevance_embeddings_unref);
+  /* Cancels a warm-up still in flight; the release then runs detached. */
+  g_clear_pointer(&guard->residency_scheduler, focus_scheduler_free);
+  focus_guard_release_model(guard);
+  g_clear_pointer(&guard->trafilatura, trafilatura_client_unref);
+  g_clear_pointer(&guard->ollama_catalog, ollama_catalog_unref);
+  g_clear_object(&guard->localtime_monitor);
+  g_clear_pointer(&guard->local_timezone, g_time_zone_unref);
 
   focus_guard_flush_bucket(guard);
 
@@ -116,6 +159,9 @@ focus_guard_destroy(FocusGuard *guard)
   g_free(guard->warning_app);
   g_free(guard->view_task_id);
   g_free(guard->view_task_title);
+  g_free(guard->stats_expanded_app);
+  focus_guard_release_stats_rows(guard);
+  focus_guard_heatmap_clear(guard);
   g_free(guard->day_label);
   g_free(guard);
 }
@@ -133,20 +179,31 @@ focus_guard_apply_config(FocusGuard *guard, FocusGuardConfig config)
   char *previous_model =
       guard->config.ollama_model != NULL ? g_strdup(guard->config.ollama_model)
                                          : NULL;
+  gboolean python_changed = g_strcmp0(guard->config.trafilatura_python_path,
+                                      config.trafilatura_python_path) != 0;
 
   focus_guard_config_clear(&guard->config);
   guard->config = focus_guard_config_copy(&config);
   focus_guard_build_blacklist(guard);
 
-  if (!guard->ollama_available ||
-      guard->config.ollama_model == NULL ||
+  if (guard->config.ollama_model == NULL ||
       *guard->config.ollama_model == '\0') {
     guard->config.chrome_ollama_enabled = FALSE;
   }
 
+  focus_guard_sync_chrome_tabs(guard);
+
+  if (python_changed) {
+    /* In-flight checks keep their own ref to the old helper. */
+    trafilatura_client_stop(guard->trafilatura);
+    trafilatura_client_unref(guard->trafilatura);
+    guard->trafilatura = trafilatura_client_new(guard->config.trafilatura_python_path);
+  }
+
   if (was_global_enabled && !guard->config.global_stats_enabled) {
     focus_guard_flush_bucket(guard);
   }
+  focus_guard_sync_bucket_seconds(guard);
 
   focus_guard_restart_timer(guard);
 
@@ -162,13 +219,17 @@ focus_guard_apply_config(FocusGuard *guard, FocusGuardConfig config)
     focus_guard_cancel_relevance_check(guard);
   }
 
+  if (!guard->config.batch_tabs_enabled || !guard->config.chrome_ollama_enabled) {
+    focus_guard_cancel_tab_batch(guard);
+  }
+
   if (guard->config.global_stats_enabled && !was_global_enabled &&
       guard->usage_global != NULL) {
     focus_guard_load_usage_map_from_db(guard, guard->usage_global, "global", NULL);
   }
 
   g_free(previous_model);
-  guard->usage_dirty = TRUE;
+  focus_guard_invalidate_stats_rank(guard);
   focus_guard_update_stats_ui(guard);
 }
 
@@ -185,5 +246,11 @@ focus_guard_get_config(const FocusGuard *guard)
 gboolean
 focus_guard_is_ollama_available(const FocusGuard *guard)
 {
-  return guard != NULL && guard->ollama_available;
+  return guard != NULL && ollama_catalog_is_server_up(guard->ollama_catalog);
+}
+
+OllamaCatalog *
+focus_guard_get_ollama_catalog(const FocusGuard *guard)
+{
+  return guard != NULL ? guard->ollama_catalog : NULL;
 }
@@ -4,6 +4,7 @@
 
 #include "app/app_state.h"
 #include "focus/focus_guard_config.h"
+#include "focus/ollama_catalog.h"
 
 typedef struct _FocusGuard FocusGuard;
 
@@ -12,6 +13,28 @@ void focus_guard_destroy(FocusGuard *guard);
 void focus_guard_apply_config(FocusGuard *guard, FocusGuardConfig config);
 FocusGuardConfig focus_guard_get_config(const FocusGuard *guard);
 gboolean focus_guard_is_ollama_available(const FocusGuard *guard);
+OllamaCatalog *focus_guard_get_ollama_catalog(const FocusGuard *guard);
+char *focus_guard_dup_latency_report(const FocusGuard *guard);
 void focus_guard_clear_stats(FocusGuard *guard);
 void focus_guard_select_global(FocusGuard *guard);
 void focus_guard_select_task(FocusGuard *guard, PomodoroTask *task);
+void focus_guard_toggle_app_details(FocusGuard *guard, const char *app_key);
+
+/* Export or import the usage stats on a worker thread; progress and the
+ * outcome are shown in status_label. Only one transfer runs at a time. */
+gboolean focus_guard_export_stats(FocusGuard *guard, GFile *file, GtkLabel *status_label);
+gboolean focus_guard_import_stats(FocusGuard *guard, GFile *file, GtkLabel *status_label);
+gboolean focus_guard_is_transferring_stats(const FocusGuard *guard);
+
+/* Draw and tooltip callbacks for the focus heatmap; user_data is AppState. */
+void focus_guard_heatmap_draw(GtkDrawingArea *area,
+                              cairo_t *cr,
+                              int width,
+                              int height,
+                              gpointer user_data);
+gboolean focus_guard_heatmap_query_tooltip(GtkWidget *widget,
+                                           int x,
+                                           int y,
+                                           gboolean keyboard_mode,
+                                           GtkTooltip *tooltip,
+                                           gpointer user_data);
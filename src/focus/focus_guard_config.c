@@ -57,7 +57,13 @@ focus_guard_config_default(void)
   config.chrome_ollama_enabled = FALSE;
   config.chrome_debug_port = 9222;
   config.ollama_model = NULL;
+  config.ollama_embed_model = g_strdup("nomic-embed-text");
+  config.embed_relevant_threshold = 0.65;
+  config.embed_irrelevant_threshold = 0.35;
   config.trafilatura_python_path = NULL;
+  config.batch_tabs_enabled = FALSE;
+  config.batch_tabs_interval_seconds = 120;
+  config.usage_bucket_seconds = 0;
   return config;
 }
 
@@ -84,6 +90,20 @@ focus_guard_config_normalize(FocusGuardConfig *config)
     }
   }
 
+  if (config->ollama_embed_model != NULL) {
+    char *trimmed = g_strstrip(config->ollama_embed_model);
+    if (*trimmed == '\0') {
+      g_free(config->ollama_embed_model);
+      config->ollama_embed_model = NULL;
+    }
+  }
+
+  /* Cosine similarity, so the whole of [-1, 1] is a valid threshold. */
+  config->embed_relevant_threshold =
+      CLAMP(config->embed_relevant_threshold, -1.0, 1.0);
+  config->embed_irrelevant_threshold =
+      CLAMP(config->embed_irrelevant_threshold, -1.0, config->embed_relevant_threshold);
+
   if (config->trafilatura_python_path != NULL) {
     char *trimmed = g_strstrip(config->trafilatura_python_path);
     if (*trimmed == '\0') {
@@ -92,6 +112,23 @@ focus_guard_config_normalize(FocusGuardConfig *config)
     }
   }
 
+  /* Batch verdicts are cached by URL for five minutes; scoring less often
+   * than that would leave gaps between rounds. */
+  config->batch_tabs_interval_seconds =
+      CLAMP(config->batch_tabs_interval_seconds, 30, 240);
+
+  /* Only grains that divide each other, so a migration never splits a bucket.
+   * Unset stays unset: the database's grain only changes on request. */
+  if (config->usage_bucket_seconds > 0) {
+    if (config->usage_bucket_seconds <= 120) {
+      config->usage_bucket_seconds = 60;
+    } else if (config->usage_bucket_seconds <= 600) {
+      config->usage_bucket_seconds = 300;
+    } else {
+      config->usage_bucket_seconds = 900;
+    }
+  }
+
   focus_guard_config_normalize_blacklist(config);
 }
 
@@ -112,10 +149,18 @@ focus_guard_config_copy(const FocusGuardConfig *config)
   copy.blacklist = config->blacklist ? g_strdupv(config->blacklist) : g_new0(char *, 1);
   g_free(copy.ollama_model);
   copy.ollama_model = config->ollama_model ? g_strdup(config->ollama_model) : NULL;
+  g_free(copy.ollama_embed_model);
+  copy.ollama_embed_model =
+      config->ollama_embed_model ? g_strdup(config->ollama_embed_model) : NULL;
+  copy.embed_relevant_threshold = config->embed_relevant_threshold;
+  copy.embed_irrelevant_threshold = config->embed_irrelevant_threshold;
   g_free(copy.trafilatura_python_path);
   copy.trafilatura_python_path = config->trafilatura_python_path
                                      ? g_strdup(config->trafilatura_python_path)
                                      : NULL;
+  copy.batch_tabs_enabled = config->batch_tabs_enabled;
+  copy.batch_tabs_interval_seconds = config->batch_tabs_interval_seconds;
+  copy.usage_bucket_seconds = config->usage_bucket_seconds;
   focus_guard_config_normalize(&copy);
   return copy;
 }
@@ -130,5 +175,6 @@ focus_guard_config_clear(FocusGuardConfig *config)
   g_strfreev(config->blacklist);
   config->blacklist = NULL;
   g_clear_pointer(&config->ollama_model, g_free);
+  g_clear_pointer(&config->ollama_embed_model, g_free);
   g_clear_pointer(&config->trafilatura_python_path, g_free);
 }
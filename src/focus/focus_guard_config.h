@@ -10,7 +10,14 @@ typedef struct {
   gboolean chrome_ollama_enabled;
   guint chrome_debug_port;
   char *ollama_model;
+  char *ollama_embed_model;
+  double embed_relevant_threshold;
+  double embed_irrelevant_threshold;
   char *trafilatura_python_path;
+  gboolean batch_tabs_enabled;
+  guint batch_tabs_interval_seconds;
+  /* 0 keeps the grain recorded in the stats database. */
+  guint usage_bucket_seconds;
 } FocusGuardConfig;
 
 FocusGuardConfig focus_guard_config_default(void);
@@ -0,0 +1,269 @@
+#include "focus/focus_guard_internal.h"
+
+#include <math.h>
+
+/* Weekday x hour grid of focus time (the "task" scope, all tasks together)
+ * over the retention window. Cells come from the hour_usage aggregate, are
+ * reloaded only when a bucket is written, and are painted once into an
+ * image surface that draws reuse until the data or the size changes. Each
+ * cell's top apps load with the cells, so tooltips never touch the
+ * database. */
+
+#define FOCUS_GUARD_HEATMAP_LABEL_WIDTH 30.0
+#define FOCUS_GUARD_HEATMAP_AXIS_HEIGHT 14.0
+#define FOCUS_GUARD_HEATMAP_GAP 1.0
+#define FOCUS_GUARD_HEATMAP_TOP_APPS 3
+
+static const char *const focus_guard_heatmap_days[USAGE_STATS_WEEKDAYS] = {
+    "Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun",
+};
+
+static gint64
+focus_guard_heatmap_since(const FocusGuard *guard)
+{
+  return guard->day_start_utc - (gint64)USAGE_STATS_RETENTION_DAYS * 24 * 3600;
+}
+
+static void
+focus_guard_heatmap_clear_apps(FocusGuard *guard)
+{
+  for (guint day = 0; day < USAGE_STATS_WEEKDAYS; day++) {
+    for (guint hour = 0; hour < USAGE_STATS_HOURS; hour++) {
+      g_clear_pointer(&guard->heatmap_apps[day][hour], g_ptr_array_unref);
+    }
+  }
+}
+
+static void
+focus_guard_heatmap_reload(FocusGuard *guard)
+{
+  gint64 since_utc = focus_guard_heatmap_since(guard);
+  usage_stats_store_query_heatmap(guard->stats_store, "task", since_utc, guard->heatmap_cells);
+  focus_guard_heatmap_clear_apps(guard);
+  usage_stats_store_query_heatmap_apps(guard->stats_store,
+                                       "task",
+                                       since_utc,
+                                       FOCUS_GUARD_HEATMAP_TOP_APPS,
+                                       guard->heatmap_apps);
+
+  guard->heatmap_max = 0;
+  for (guint day = 0; day < USAGE_STATS_WEEKDAYS; day++) {
+    for (guint hour = 0; hour < USAGE_STATS_HOURS; hour++) {
+      guard->heatmap_max = MAX(guard->heatmap_max, guard->heatmap_cells[day][hour]);
+    }
+  }
+  guard->heatmap_stale = FALSE;
+}
+
+static void
+focus_guard_heatmap_cell_size(int width, int height, double *cell_w, double *cell_h)
+{
+  *cell_w = MAX(width - FOCUS_GUARD_HEATMAP_LABEL_WIDTH, 0.0) / USAGE_STATS_HOURS;
+  *cell_h = MAX(height - FOCUS_GUARD_HEATMAP_AXIS_HEIGHT, 0.0) / USAGE_STATS_WEEKDAYS;
+}
+
+static gboolean
+focus_guard_heatmap_cell_at(int width,
+                            int height,
+                            double x,
+                            double y,
+                            guint *weekday_out,
+                            guint *hour_out)
+{
+  double cell_w = 0.0;
+  double cell_h = 0.0;
+  focus_guard_heatmap_cell_size(width, height, &cell_w, &cell_h);
+  if (cell_w <= 0.0 || cell_h <= 0.0 || x < FOCUS_GUARD_HEATMAP_LABEL_WIDTH) {
+    return FALSE;
+  }
+
+  gint hour = (gint)((x - FOCUS_GUARD_HEATMAP_LABEL_WIDTH) / cell_w);
+  gint weekday = (gint)(y / cell_h);
+  if (hour < 0 || hour >= USAGE_STATS_HOURS || weekday < 0 ||
+      weekday >= USAGE_STATS_WEEKDAYS) {
+    return FALSE;
+  }
+
+  *weekday_out = (guint)weekday;
+  *hour_out = (guint)hour;
+  return TRUE;
+}
+
+static void
+focus_guard_heatmap_draw_text(cairo_t *cr,
+                              PangoLayout *layout,
+                              const char *text,
+                              double x,
+                              double y)
+{
+  pango_layout_set_text(layout, text, -1);
+  cairo_move_to(cr, x, y);
+  pango_cairo_show_layout(cr, layout);
+}
+
+static cairo_surface_t *
+focus_guard_heatmap_render(FocusGuard *guard, GtkWidget *widget, int width, int height)
+{
+  int scale = gtk_widget_get_scale_factor(widget);
+  cairo_surface_t *surface =
+      cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width * scale, height * scale);
+  cairo_surface_set_device_scale(surface, scale, scale);
+  cairo_t *cr = cairo_create(surface);
+
+  GdkRGBA cell_color = {0.06, 0.30, 0.36, 1.0};
+  GdkRGBA text_color = {0.36, 0.36, 0.36, 0.9};
+
+  double cell_w = 0.0;
+  double cell_h = 0.0;
+  focus_guard_heatmap_cell_size(width, height, &cell_w, &cell_h);
+
+  for (guint day = 0; day < USAGE_STATS_WEEKDAYS; day++) {
+    for (guint hour = 0; hour < USAGE_STATS_HOURS; hour++) {
+      gint64 value = guard->heatmap_cells[day][hour];
+      /* Square root so a few long sessions do not wash out the rest. */
+      double level = guard->heatmap_max > 0 && value > 0
+                         ? 0.18 + 0.82 * sqrt((double)value / guard->heatmap_max)
+                         : 0.06;
+      cairo_set_source_rgba(cr, cell_color.red, cell_color.green, cell_color.blue, level);
+      cairo_rectangle(cr,
+                      FOCUS_GUARD_HEATMAP_LABEL_WIDTH + hour * cell_w,
+                      day * cell_h,
+                      MAX(cell_w - FOCUS_GUARD_HEATMAP_GAP, 0.5),
+                      MAX(cell_h - FOCUS_GUARD_HEATMAP_GAP, 0.5));
+      cairo_fill(cr);
+    }
+  }
+
+  PangoLayout *layout = gtk_widget_create_pango_layout(widget, NULL);
+  gdk_cairo_set_source_rgba(cr, &text_color);
+  for (guint day = 0; day < USAGE_STATS_WEEKDAYS; day++) {
+    focus_guard_heatmap_draw_text(cr, layout, focus_guard_heatmap_days[day], 0.0, day * cell_h);
+  }
+  for (guint hour = 0; hour < USAGE_STATS_HOURS; hour += 6) {
+    char label[8];
+    g_snprintf(label, sizeof(label), "%02u", hour);
+    focus_guard_heatmap_draw_text(cr,
+                                  layout,
+                                  label,
+                                  FOCUS_GUARD_HEATMAP_LABEL_WIDTH + hour * cell_w,
+                                  height - FOCUS_GUARD_HEATMAP_AXIS_HEIGHT);
+  }
+  g_object_unref(layout);
+
+  cairo_destroy(cr);
+  return surface;
+}
+
+void
+focus_guard_heatmap_draw(GtkDrawingArea *area,
+                         cairo_t *cr,
+                         int width,
+                         int height,
+                         gpointer user_data)
+{
+  AppState *state = user_data;
+  FocusGuard *guard = state != NULL ? state->focus_guard : NULL;
+  if (guard == NULL || width <= 0 || height <= 0) {
+    return;
+  }
+
+  GtkWidget *widget = GTK_WIDGET(area);
+  int scale = gtk_widget_get_scale_factor(widget);
+  if (guard->heatmap_stale) {
+    focus_guard_heatmap_reload(guard);
+    g_clear_pointer(&guard->heatmap_surface, cairo_surface_destroy);
+  }
+  if (guard->heatmap_surface != NULL &&
+      (guard->heatmap_width != width || guard->heatmap_height != height ||
+       guard->heatmap_scale != scale)) {
+    g_clear_pointer(&guard->heatmap_surface, cairo_surface_destroy);
+  }
+  if (guard->heatmap_surface == NULL) {
+    guard->heatmap_surface = focus_guard_heatmap_render(guard, widget, width, height);
+    guard->heatmap_width = width;
+    guard->heatmap_height = height;
+    guard->heatmap_scale = scale;
+  }
+
+  cairo_set_source_surface(cr, guard->heatmap_surface, 0, 0);
+  cairo_paint(cr);
+}
+
+gboolean
+focus_guard_heatmap_query_tooltip(GtkWidget *widget,
+                                  int x,
+                                  int y,
+                                  gboolean keyboard_mode,
+                                  GtkTooltip *tooltip,
+                                  gpointer user_data)
+{
+  (void)keyboard_mode;
+  AppState *state = user_data;
+  FocusGuard *guard = state != NULL ? state->focus_guard : NULL;
+  guint weekday = 0;
+  guint hour = 0;
+  if (guard == NULL ||
+      !focus_guard_heatmap_cell_at(gtk_widget_get_width(widget),
+                                   gtk_widget_get_height(widget),
+                                   x,
+                                   y,
+                                   &weekday,
+                                   &hour)) {
+    return FALSE;
+  }
+  if (guard->heatmap_stale) {
+    focus_guard_heatmap_reload(guard);
+  }
+
+  GString *text = g_string_new(NULL);
+  char *total = focus_guard_format_duration(guard->heatmap_cells[weekday][hour]);
+  g_string_append_printf(text,
+                         "%s %02u:00-%02u:00: %s focused",
+                         focus_guard_heatmap_days[weekday],
+                         hour,
+                         (hour + 1) % USAGE_STATS_HOURS,
+                         total);
+  g_free(total);
+
+  GPtrArray *apps = guard->heatmap_apps[weekday][hour];
+  for (guint i = 0; apps != NULL && i < apps->len; i++) {
+    const UsageStatsEntry *entry = g_ptr_array_index(apps, i);
+    char *duration = focus_guard_format_duration(entry->duration_sec);
+    g_string_append_printf(text,
+                           "\n%s  %s%s",
+                           entry->app_name,
+                           duration,
+                           focus_guard_is_blacklisted(guard, entry->app_key)
+                               ? "  (distracting)"
+                               : "");
+    g_free(duration);
+  }
+
+  gtk_tooltip_set_text(tooltip, text->str);
+  g_string_free(text, TRUE);
+  return TRUE;
+}
+
+void
+focus_guard_heatmap_invalidate(FocusGuard *guard)
+{
+  if (guard == NULL) {
+    return;
+  }
+
+  guard->heatmap_stale = TRUE;
+  if (guard->state != NULL && guard->state->focus_heatmap != NULL) {
+    gtk_widget_queue_draw(guard->state->focus_heatmap);
+  }
+}
+
+void
+focus_guard_heatmap_clear(FocusGuard *guard)
+{
+  if (guard == NULL) {
+    return;
+  }
+
+  focus_guard_heatmap_clear_apps(guard);
+  g_clear_pointer(&guard->heatmap_surface, cairo_surface_destroy);
+}
@@ -3,24 +3,31 @@
 #include <gio/gio.h>
 #include <gtk/gtk.h>
 
+#include "focus/chrome_cdp_client.h"
+#include "focus/chrome_cdp_tabs.h"
 #include "focus/focus_guard.h"
+#include "focus/focus_scheduler.h"
+#include "focus/ollama_catalog.h"
+#include "focus/relevance_cache.h"
+#include "focus/relevance_classifier.h"
+#include "focus/relevance_embeddings.h"
+#include "focus/relevance_prompt.h"
+#include "focus/trafilatura_client.h"
 #include "storage/usage_stats_storage.h"
 
+#define USAGE_STATS_RETENTION_DAYS 35
+
 typedef enum {
   FOCUS_GUARD_VIEW_GLOBAL = 0,
   FOCUS_GUARD_VIEW_TASK = 1
 } FocusGuardView;
 
-typedef enum {
-  FOCUS_GUARD_RELEVANCE_UNKNOWN = 0,
-  FOCUS_GUARD_RELEVANCE_RELEVANT = 1,
-  FOCUS_GUARD_RELEVANCE_UNSURE = 2,
-  FOCUS_GUARD_RELEVANCE_IRRELEVANT = 3
-} FocusGuardRelevance;
-
 typedef struct {
+  const char *key;
   char *display_name;
   gint64 usec_total;
+  /* Browser time per interned domain (FocusGuardUsage), or NULL. */
+  GHashTable *domains;
 } FocusGuardUsage;
 
 typedef struct {
@@ -28,6 +35,7 @@ typedef struct {
   char *app_key;
   char *app_name;
   gint64 usec_total;
+  GHashTable *domains;
 } FocusGuardBucketTaskEntry;
 
 struct _FocusGuard {
@@ -40,26 +48,67 @@ struct _FocusGuard {
   GHashTable *bucket_global;
   GHashTable *bucket_task;
   gint64 bucket_start_utc;
+  gboolean bucket_checkpoint_dirty;
+  gint64 last_checkpoint_us;
+  guint64 checkpoint_count;
+  gint64 checkpoint_total_us;
+  gint64 checkpoint_max_us;
+  /* Set while an export/import runs on its own connection; an import holds
+   * the write lock, so the open bucket is neither flushed nor checkpointed
+   * until it finishes. */
+  GCancellable *stats_transfer_cancellable;
+  gboolean stats_import_active;
   guint tick_source_id;
   gint64 last_tick_us;
   gint64 last_tick_real_us;
   gint64 last_warning_check_us;
   gint64 day_start_utc;
+  gint64 day_end_utc;
+  /* Set when the boundary moved to another day and not yet handled by a
+   * tick; callers that only need the bounds leave it alone. */
+  gboolean day_changed;
+  GTimeZone *local_timezone;
+  GFileMonitor *localtime_monitor;
   char *day_label;
   FocusGuardView view;
   char *view_task_id;
   char *view_task_title;
+  char *stats_expanded_app;
+  GPtrArray *stats_top;
+  gboolean stats_rank_stale;
+  GPtrArray *stats_rows;
+  gint64 heatmap_cells[USAGE_STATS_WEEKDAYS][USAGE_STATS_HOURS];
+  /* Top apps per cell for the tooltip, loaded with the cells. */
+  GPtrArray *heatmap_apps[USAGE_STATS_WEEKDAYS][USAGE_STATS_HOURS];
+  gint64 heatmap_max;
+  gboolean heatmap_stale;
+  cairo_surface_t *heatmap_surface;
+  int heatmap_width;
+  int heatmap_height;
+  int heatmap_scale;
   gboolean warning_active;
   char *warning_app;
   gboolean usage_dirty;
-  gboolean ollama_available;
+  OllamaCatalog *ollama_catalog;
   gboolean relevance_warning_active;
   char *relevance_warning_text;
   FocusGuardRelevance relevance_state;
   gint64 last_relevance_check_us;
   guint64 relevance_check_id;
-  gboolean relevance_inflight;
-  GCancellable *relevance_cancellable;
+  char *relevance_page_key;
+  gint64 last_tab_batch_us;
+  guint64 tab_batch_rounds;
+  guint64 tab_batch_decided;
+  FocusScheduler *scheduler;
+  ChromeCdpTabTracker *chrome_tabs;
+  RelevanceCache *relevance_cache;
+  RelevanceClassifier *relevance_classifier;
+  RelevanceEmbeddings *relevance_embeddings;
+  TrafilaturaClient *trafilatura;
+  /* Serializes model warm-up and release; see focus_guard_warmup.c. */
+  FocusScheduler *residency_scheduler;
+  char *warm_model;
+  gint64 warm_refresh_us;
 };
 
 GHashTable *focus_guard_usage_table_new(void);
@@ -67,7 +116,11 @@ GHashTable *focus_guard_bucket_task_table_new(void);
 FocusGuardUsage *focus_guard_usage_get_or_create(GHashTable *table,
                                                  const char *key,
                                                  const char *display);
+void focus_guard_usage_add_domain(GHashTable **domains,
+                                  const char *domain,
+                                  gint64 usec);
 gboolean focus_guard_refresh_day(FocusGuard *guard);
+void focus_guard_watch_timezone(FocusGuard *guard);
 void focus_guard_prune_history(FocusGuard *guard);
 void focus_guard_load_usage_map_from_db(FocusGuard *guard,
                                         GHashTable *table,
@@ -77,7 +130,18 @@ void focus_guard_merge_bucket_task(FocusGuard *guard,
                                    const char *task_id,
                                    GHashTable *table);
 void focus_guard_flush_bucket(FocusGuard *guard);
+void focus_guard_checkpoint_bucket(FocusGuard *guard);
+void focus_guard_sync_bucket_seconds(FocusGuard *guard);
+void focus_guard_reload_stats(FocusGuard *guard);
+/* Fills every task's cached focus totals from the task_focus index. */
+void focus_guard_load_task_focus(FocusGuard *guard);
 void focus_guard_update_stats_ui(FocusGuard *guard);
+void focus_guard_invalidate_stats_rank(FocusGuard *guard);
+void focus_guard_stats_rank_bump(FocusGuard *guard, FocusGuardUsage *usage);
+void focus_guard_release_stats_rows(FocusGuard *guard);
+char *focus_guard_format_duration(gint64 seconds);
+void focus_guard_heatmap_invalidate(FocusGuard *guard);
+void focus_guard_heatmap_clear(FocusGuard *guard);
 gboolean focus_guard_on_tick(gpointer data);
 
 void focus_guard_build_blacklist(FocusGuard *guard);
@@ -92,8 +156,30 @@ gboolean focus_guard_should_track(const FocusGuard *guard);
 gboolean focus_guard_is_blacklisted(FocusGuard *guard, const char *app_key);
 gboolean focus_guard_is_chrome_app(const char *app_key);
 
+gboolean focus_guard_chrome_relevance_allowed(const FocusGuard *guard,
+                                              const char *app_key);
+void focus_guard_sync_chrome_tabs(FocusGuard *guard);
 void focus_guard_clear_relevance_warning(FocusGuard *guard);
+char *focus_guard_relevance_page_key(FocusGuard *guard, const char *window_title);
+gboolean focus_guard_relevance_busy(FocusGuard *guard);
 void focus_guard_start_relevance_check(FocusGuard *guard,
                                        const char *window_title,
-                                       const char *task_title);
+                                       const char *task_title,
+                                       FocusSchedulerPriority priority);
 void focus_guard_cancel_relevance_check(FocusGuard *guard);
+gboolean focus_guard_apply_cached_relevance(FocusGuard *guard,
+                                            const char *window_title,
+                                            const char *task_title);
+void focus_guard_extract_main_content(TrafilaturaClient *trafilatura,
+                                      ChromeCdpPage *page,
+                                      GCancellable *cancellable);
+
+void focus_guard_maybe_score_tabs(FocusGuard *guard,
+                                  const char *task_title,
+                                  gint64 now_us);
+void focus_guard_cancel_tab_batch(FocusGuard *guard);
+
+guint focus_guard_model_keep_alive_seconds(const FocusGuard *guard);
+void focus_guard_poll_ollama(FocusGuard *guard);
+void focus_guard_update_model_residency(FocusGuard *guard);
+void focus_guard_release_model(FocusGuard *guard);
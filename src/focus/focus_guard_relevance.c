@@ -1,42 +1,51 @@
 #include "focus/focus_guard_internal.h"
 
+#include <string.h>
+
+#include "core/task_store.h"
 #include "focus/chrome_cdp_client.h"
+#include "focus/content_extractor.h"
+#include "focus/focus_guard_x11.h"
+#include "focus/focus_http.h"
+#include "focus/focus_latency.h"
 #include "focus/ollama_client.h"
+#include "focus/relevance_cache.h"
+#include "focus/relevance_embeddings.h"
+#include "focus/relevance_prompt.h"
+#include "focus/trafilatura_client.h"
 
 typedef struct {
   GWeakRef window_ref;
   guint64 check_id;
   char *task_title;
   char *window_title;
+  char *target_id;
+  char *tab_title;
+  char *task_key;
   char *model;
+  char *embed_model;
+  double embed_relevant_threshold;
+  double embed_irrelevant_threshold;
   guint port;
+  guint keep_alive_seconds;
+  gint64 submitted_us;
+  RelevanceCache *cache;
+  RelevanceClassifier *classifier;
+  RelevanceEmbeddings *embeddings;
+  TrafilaturaClient *trafilatura;
 } FocusGuardRelevanceContext;
 
 typedef struct {
   FocusGuardRelevance verdict;
   ChromeCdpPage *page;
   char *raw_response;
+  guint64 fingerprint;
 } FocusGuardRelevanceResult;
 
-static FocusGuardRelevance
-focus_guard_parse_relevance_response(const char *response)
-{
-  if (response == NULL) {
-    return FOCUS_GUARD_RELEVANCE_UNKNOWN;
-  }
-
-  char *lower = g_ascii_strdown(response, -1);
-  FocusGuardRelevance verdict = FOCUS_GUARD_RELEVANCE_UNSURE;
-  if (g_strstr_len(lower, -1, "clearly irrelevant") != NULL) {
-    verdict = FOCUS_GUARD_RELEVANCE_IRRELEVANT;
-  } else if (g_strstr_len(lower, -1, "directly relevant") != NULL) {
-    verdict = FOCUS_GUARD_RELEVANCE_RELEVANT;
-  } else if (g_strstr_len(lower, -1, "not sure") != NULL) {
-    verdict = FOCUS_GUARD_RELEVANCE_UNSURE;
-  }
-  g_free(lower);
-  return verdict;
-}
+#define FOCUS_GUARD_RELEVANCE_JOB "relevance"
+/* Fetch, extraction and inference together; a verdict later than this is
+ * about a page the user has most likely moved on from. */
+#define FOCUS_GUARD_RELEVANCE_DEADLINE_SECONDS 45
 
 static void
 focus_guard_relevance_result_free(gpointer data)
@@ -62,79 +71,140 @@ focus_guard_relevance_context_free(gpointer data)
   g_weak_ref_clear(&context->window_ref);
   g_free(context->task_title);
   g_free(context->window_title);
+  g_free(context->target_id);
+  g_free(context->tab_title);
+  g_free(context->task_key);
   g_free(context->model);
+  g_free(context->embed_model);
+  relevance_cache_unref(context->cache);
+  relevance_classifier_unref(context->classifier);
+  relevance_embeddings_unref(context->embeddings);
+  trafilatura_client_unref(context->trafilatura);
   g_free(context);
 }
 
-static const char *
-focus_guard_system_prompt(void)
+/* Asks the classifier trained on earlier model verdicts. Only confident
+ * answers count; the rest go on to the embedding and chat stages. */
+static FocusGuardRelevance
+focus_guard_classifier_verdict(RelevanceClassifier *classifier,
+                               const char *task_title,
+                               const char *page_title,
+                               const char *url)
 {
-  return "You are a focus assistant that checks if a web page is relevant to the user's task."
-         " Reply with exactly one label: directly relevant, not sure, or clearly irrelevant."
-         " Use the content inside XML-like tags to decide.\n"
-         "\n"
-         "Examples:\n"
-         "<task-title>Draft Q4 budget report</task-title>\n"
-         "<page-title>Q4 Budget — Google Sheets</page-title>\n"
-         "<page-content>Revenue, expenses, forecasts, variance notes...</page-content>\n"
-         "Answer: directly relevant\n"
-         "---\n"
-         "<task-title>Draft Q4 budget report</task-title>\n"
-         "<page-title>YouTube — Lo-fi hip hop</page-title>\n"
-         "<page-content>Playlists, comments, music channels...</page-content>\n"
-         "Answer: clearly irrelevant\n"
-         "---\n"
-         "<task-title>Study GTK4 layout</task-title>\n"
-         "<page-title>GTK4 Box and Grid — GNOME Developer</page-title>\n"
-         "<page-content>GtkBox, GtkGrid, layout examples...</page-content>\n"
-         "Answer: directly relevant\n"
-         "---\n"
-         "<task-title>Plan a workshop agenda</task-title>\n"
-         "<page-title>Hacker News</page-title>\n"
-         "<page-content>Top stories, comments, unrelated news...</page-content>\n"
-         "Answer: not sure\n"
-         "\n"
-         "Return only the label.";
+  char *domain = chrome_cdp_url_domain(url);
+  gboolean relevant = FALSE;
+  double probability = 0.0;
+  gboolean confident = relevance_classifier_predict(classifier,
+                                                    task_title,
+                                                    domain,
+                                                    page_title,
+                                                    &relevant,
+                                                    &probability);
+  g_free(domain);
+
+  if (!confident) {
+    return FOCUS_GUARD_RELEVANCE_UNKNOWN;
+  }
+
+  g_debug("Local classifier decided (p=%.3f)", probability);
+  return relevant ? FOCUS_GUARD_RELEVANCE_RELEVANT : FOCUS_GUARD_RELEVANCE_IRRELEVANT;
 }
 
-static char *
-focus_guard_escape_xml(const char *text)
+/* Scores the page against the task title by embedding similarity. Only a
+ * score outside the uncertain band is trusted; anything in between (or any
+ * failure) leaves the decision to the chat model. */
+static FocusGuardRelevance
+focus_guard_embedding_verdict(FocusGuardRelevanceContext *context,
+                              const ChromeCdpPage *page,
+                              GCancellable *cancellable)
 {
-  if (text == NULL) {
-    return g_strdup("");
+  if (context->embed_model == NULL || context->embeddings == NULL) {
+    return FOCUS_GUARD_RELEVANCE_UNKNOWN;
+  }
+
+  char *page_text = relevance_embeddings_page_text(page->title, page->url, page->text);
+  double similarity = 0.0;
+  GError *error = NULL;
+  gint64 start_us = g_get_monotonic_time();
+  gboolean scored = relevance_embeddings_score_sync(context->embeddings,
+                                                    context->embed_model,
+                                                    context->task_key,
+                                                    context->task_title,
+                                                    page_text,
+                                                    &similarity,
+                                                    cancellable,
+                                                    &error);
+  g_free(page_text);
+
+  if (!scored) {
+    g_debug("Embedding relevance skipped: %s", error->message);
+    g_clear_error(&error);
+    return FOCUS_GUARD_RELEVANCE_UNKNOWN;
   }
+  focus_latency_record(FOCUS_LATENCY_EMBEDDING, start_us);
 
-  return g_markup_escape_text(text, -1);
+  FocusGuardRelevance verdict = FOCUS_GUARD_RELEVANCE_UNKNOWN;
+  if (similarity >= context->embed_relevant_threshold) {
+    verdict = FOCUS_GUARD_RELEVANCE_RELEVANT;
+  } else if (similarity <= context->embed_irrelevant_threshold) {
+    verdict = FOCUS_GUARD_RELEVANCE_IRRELEVANT;
+  }
+
+  g_debug("Embedding similarity %.3f (%" G_GINT64_FORMAT " ms): %s",
+          similarity,
+          (g_get_monotonic_time() - start_us) / 1000,
+          verdict == FOCUS_GUARD_RELEVANCE_UNKNOWN ? "asking chat model" : "decided");
+  return verdict;
 }
 
-static char *
-focus_guard_build_user_prompt(const char *task_title, const ChromeCdpPage *page)
+/* Reduces the page to its main content within the prompt token budget:
+ * trafilatura when its helper is usable, the built-in extractor otherwise,
+ * and clipped innerText when neither finds an article. */
+void
+focus_guard_extract_main_content(TrafilaturaClient *trafilatura,
+                                 ChromeCdpPage *page,
+                                 GCancellable *cancellable)
 {
-  char *task = focus_guard_escape_xml(task_title);
-  char *title = focus_guard_escape_xml(page != NULL ? page->title : NULL);
-  char *url = focus_guard_escape_xml(page != NULL ? page->url : NULL);
-  char *content = focus_guard_escape_xml(page != NULL ? page->text : NULL);
-
-  GString *prompt = g_string_new(NULL);
-  g_string_append(prompt, "<context>\n");
-  g_string_append_printf(prompt, "  <task-title>%s</task-title>\n", task);
-  g_string_append(prompt, "  <page>\n");
-  g_string_append_printf(prompt, "    <page-title>%s</page-title>\n", title);
-  g_string_append_printf(prompt, "    <page-url>%s</page-url>\n", url);
-  g_string_append(prompt, "    <page-content>\n");
-  g_string_append(prompt, content);
-  g_string_append(prompt, "\n    </page-content>\n");
-  g_string_append(prompt, "  </page>\n");
-  g_string_append(prompt, "</context>\n\n");
-  g_string_append(prompt,
-                  "Answer with exactly one label: directly relevant, not sure, or clearly irrelevant.");
-
-  g_free(task);
-  g_free(title);
-  g_free(url);
-  g_free(content);
-
-  return g_string_free(prompt, FALSE);
+  char *text = NULL;
+  if (page->html != NULL) {
+    gint64 start_us = g_get_monotonic_time();
+    if (trafilatura != NULL) {
+      GError *error = NULL;
+      char *extracted = trafilatura_client_extract_sync(trafilatura,
+                                                        page->html,
+                                                        page->url,
+                                                        cancellable,
+                                                        &error);
+      if (extracted == NULL) {
+        g_debug("Trafilatura extraction skipped: %s", error->message);
+        g_clear_error(&error);
+      } else {
+        g_strstrip(extracted);
+        if (*extracted != '\0') {
+          text = content_extractor_clip(extracted, RELEVANCE_PROMPT_TOKEN_BUDGET);
+        }
+        g_free(extracted);
+      }
+    }
+
+    if (text == NULL && !g_cancellable_is_cancelled(cancellable)) {
+      text = content_extractor_extract(page->html,
+                                       strlen(page->html),
+                                       RELEVANCE_PROMPT_TOKEN_BUDGET);
+    }
+    if (text != NULL) {
+      focus_latency_record(FOCUS_LATENCY_EXTRACT, start_us);
+    }
+    g_clear_pointer(&page->html, g_free);
+  }
+
+  if (text == NULL && page->text != NULL) {
+    text = content_extractor_clip(page->text, RELEVANCE_PROMPT_TOKEN_BUDGET);
+  }
+  if (text != NULL) {
+    g_free(page->text);
+    page->text = text;
+  }
 }
 
 static void
@@ -153,23 +223,107 @@ focus_guard_relevance_task(GTask *task,
     return;
   }
 
+  focus_latency_record(FOCUS_LATENCY_QUEUE, context->submitted_us);
+
   GError *error = NULL;
-  ChromeCdpPage *page = chrome_cdp_fetch_page_sync(context->port,
-                                                   context->window_title,
-                                                   cancellable,
-                                                   &error);
+  ChromeCdpPage *page = NULL;
+  if (context->target_id != NULL) {
+    page = chrome_cdp_fetch_target_sync(context->port,
+                                        context->target_id,
+                                        context->tab_title,
+                                        CHROME_CDP_FETCH_HTML,
+                                        cancellable,
+                                        &error);
+  } else {
+    page = chrome_cdp_fetch_page_sync(context->port,
+                                      context->window_title,
+                                      CHROME_CDP_FETCH_HTML,
+                                      cancellable,
+                                      &error);
+  }
   if (page == NULL) {
     g_task_return_error(task, error);
     return;
   }
 
-  char *user_prompt = focus_guard_build_user_prompt(context->task_title, page);
+  if (g_cancellable_set_error_if_cancelled(cancellable, &error)) {
+    chrome_cdp_page_free(page);
+    g_task_return_error(task, error);
+    return;
+  }
+
+  focus_guard_extract_main_content(context->trafilatura, page, cancellable);
+
+  /* A check with a tracked tab was already counted by its URL lookup. */
+  guint64 fingerprint = relevance_cache_fingerprint(page->text);
+  gint cached_verdict = FOCUS_GUARD_RELEVANCE_UNKNOWN;
+  if (relevance_cache_lookup_content(context->cache,
+                                     context->task_key,
+                                     page->url,
+                                     fingerprint,
+                                     g_get_real_time() / G_USEC_PER_SEC,
+                                     context->target_id == NULL,
+                                     &cached_verdict)) {
+    FocusGuardRelevanceResult *result = g_new0(FocusGuardRelevanceResult, 1);
+    result->page = page;
+    result->fingerprint = fingerprint;
+    result->verdict = (FocusGuardRelevance)cached_verdict;
+    g_task_return_pointer(task, result, focus_guard_relevance_result_free);
+    return;
+  }
+
+  /* With a tracked tab the classifier already ran before the fetch. */
+  if (context->target_id == NULL) {
+    FocusGuardRelevance classifier_verdict =
+        focus_guard_classifier_verdict(context->classifier,
+                                       context->task_title,
+                                       page->title,
+                                       page->url);
+    if (classifier_verdict != FOCUS_GUARD_RELEVANCE_UNKNOWN) {
+      FocusGuardRelevanceResult *result = g_new0(FocusGuardRelevanceResult, 1);
+      result->page = page;
+      result->fingerprint = fingerprint;
+      result->verdict = classifier_verdict;
+      g_task_return_pointer(task, result, focus_guard_relevance_result_free);
+      return;
+    }
+  }
+
+  FocusGuardRelevance embedding_verdict =
+      focus_guard_embedding_verdict(context, page, cancellable);
+  if (embedding_verdict != FOCUS_GUARD_RELEVANCE_UNKNOWN) {
+    FocusGuardRelevanceResult *result = g_new0(FocusGuardRelevanceResult, 1);
+    result->page = page;
+    result->fingerprint = fingerprint;
+    result->verdict = embedding_verdict;
+    g_task_return_pointer(task, result, focus_guard_relevance_result_free);
+    return;
+  }
+
+  if (g_cancellable_set_error_if_cancelled(cancellable, &error)) {
+    chrome_cdp_page_free(page);
+    g_task_return_error(task, error);
+    return;
+  }
+
+  gint64 stage_us = g_get_monotonic_time();
+  char *user_prompt = relevance_prompt_build_user(context->task_title, page);
+  focus_latency_record(FOCUS_LATENCY_PROMPT, stage_us);
+  OllamaChatOptions options = {
+      .num_predict = RELEVANCE_PROMPT_MAX_TOKENS,
+      .stop = relevance_prompt_stop,
+      .labels = relevance_prompt_labels,
+      .structured = TRUE,
+      .keep_alive_seconds = context->keep_alive_seconds,
+  };
+  stage_us = g_get_monotonic_time();
   char *response =
-      ollama_client_chat_sync(context->model,
-                              focus_guard_system_prompt(),
-                              user_prompt,
-                              cancellable,
-                              &error);
+      ollama_client_chat_stream_sync(context->model,
+                                     relevance_prompt_system(),
+                                     user_prompt,
+                                     &options,
+                                     cancellable,
+                                     &error);
   g_free(user_prompt);
 
   if (response == NULL) {
@@ -177,11 +331,13 @@ focus_guard_relevance_task(GTask *task,
     g_task_return_error(task, error);
     return;
   }
+  focus_latency_record(FOCUS_LATENCY_INFERENCE, stage_us);
 
   FocusGuardRelevanceResult *result = g_new0(FocusGuardRelevanceResult, 1);
   result->raw_response = response;
   result->page = page;
-  result->verdict = focus_guard_parse_relevance_response(response);
+  result->fingerprint = fingerprint;
+  result->verdict = relevance_prompt_parse_response(response);
   g_task_return_pointer(task, result, focus_guard_relevance_result_free);
 }
 
@@ -220,6 +376,109 @@ focus_guard_format_relevance_warning(const ChromeCdpPage *page)
   return g_strdup("Chrome off-task");
 }
 
+static void
+focus_guard_apply_relevance_verdict(FocusGuard *guard,
+                                    FocusGuardRelevance verdict,
+                                    const ChromeCdpPage *page)
+{
+  guard->relevance_state = verdict;
+  if (verdict == FOCUS_GUARD_RELEVANCE_IRRELEVANT) {
+    guard->relevance_warning_active = TRUE;
+    g_free(guard->relevance_warning_text);
+    guard->relevance_warning_text = focus_guard_format_relevance_warning(page);
+  } else {
+    focus_guard_clear_relevance_warning(guard);
+  }
+
+  focus_guard_refresh_warning_from_active(guard);
+}
+
+static void
+focus_guard_log_relevance_cache(FocusGuard *guard)
+{
+  RelevanceCacheStats stats;
+  relevance_cache_get_stats(guard->relevance_cache, &stats);
+  guint64 hits = stats.url_hits + stats.content_hits;
+  g_debug("Relevance cache: %" G_GUINT64_FORMAT " of %" G_GUINT64_FORMAT
+          " checks skipped inference (%" G_GUINT64_FORMAT " by URL, %"
+          G_GUINT64_FORMAT " by content)",
+          hits,
+          stats.lookups,
+          stats.url_hits,
+          stats.content_hits);
+}
+
+char *
+focus_guard_dup_latency_report(const FocusGuard *guard)
+{
+  GString *report = g_string_new(NULL);
+  focus_latency_append_report(report);
+
+  for (guint i = 0; i < FOCUS_HTTP_ENDPOINT_COUNT; i++) {
+    FocusHttpStats stats;
+    focus_http_get_stats((FocusHttpEndpoint)i, &stats);
+    if (stats.requests == 0) {
+      continue;
+    }
+
+    g_string_append_printf(report,
+                           "HTTP %-12s avg %6.0f ms  max %6.0f ms  (%" G_GUINT64_FORMAT
+                           " requests, %" G_GUINT64_FORMAT " failed)\n",
+                           focus_http_endpoint_name((FocusHttpEndpoint)i),
+                           stats.total_us / 1000.0 / stats.requests,
+                           stats.max_us / 1000.0,
+                           stats.requests,
+                           stats.failures);
+  }
+
+  if (guard != NULL && guard->relevance_cache != NULL) {
+    RelevanceCacheStats stats;
+    relevance_cache_get_stats(guard->relevance_cache, &stats);
+    guint64 hits = stats.url_hits + stats.content_hits;
+    g_string_append_printf(report,
+                           "Cache hits        %" G_GUINT64_FORMAT " of %" G_GUINT64_FORMAT
+                           " (%.0f%%)\n",
+                           hits,
+                           stats.lookups,
+                           relevance_cache_stats_hit_rate(&stats));
+  }
+
+  if (guard != NULL && guard->relevance_classifier != NULL) {
+    RelevanceClassifierStats stats;
+    relevance_classifier_get_stats(guard->relevance_classifier, &stats);
+    g_string_append_printf(report,
+                           "Classifier        %" G_GUINT64_FORMAT " of %" G_GUINT64_FORMAT
+                           " answered locally (trained on %" G_GUINT64_FORMAT " relevant, %"
+                           G_GUINT64_FORMAT " irrelevant)\n",
+                           stats.confident,
+                           stats.predictions,
+                           stats.relevant_examples,
+                           stats.irrelevant_examples);
+  }
+
+  if (guard != NULL && guard->tab_batch_rounds > 0) {
+    g_string_append_printf(report,
+                           "Tab batches       %" G_GUINT64_FORMAT " rounds, %" G_GUINT64_FORMAT
+                           " tab verdicts cached\n",
+                           guard->tab_batch_rounds,
+                           guard->tab_batch_decided);
+  }
+
+  if (guard != NULL && guard->checkpoint_count > 0) {
+    g_string_append_printf(report,
+                           "Stats checkpoint  %" G_GUINT64_FORMAT " writes, avg %" G_GINT64_FORMAT
+                           " us, max %" G_GINT64_FORMAT " us\n",
+                           guard->checkpoint_count,
+                           guard->checkpoint_total_us / (gint64)guard->checkpoint_count,
+                           guard->checkpoint_max_us);
+  }
+
+  if (report->len > 0 && report->str[report->len - 1] == '\n') {
+    g_string_truncate(report, report->len - 1);
+  }
+  return g_string_free(report, FALSE);
+}
+
 static void
 focus_guard_on_relevance_task_complete(GObject *source_object,
                                        GAsyncResult *res,
@@ -245,9 +504,6 @@ focus_guard_on_relevance_task_complete(GObject *source_object,
     return;
   }
 
-  guard->relevance_inflight = FALSE;
-  g_clear_object(&guard->relevance_cancellable);
-
   GError *error = NULL;
   FocusGuardRelevanceResult *result =
       g_task_propagate_pointer(G_TASK(res), &error);
@@ -263,21 +519,116 @@ focus_guard_on_relevance_task_complete(GObject *source_object,
     return;
   }
 
-  guard->relevance_state = result->verdict;
-  if (result->verdict == FOCUS_GUARD_RELEVANCE_IRRELEVANT) {
-    guard->relevance_warning_active = TRUE;
-    g_free(guard->relevance_warning_text);
-    guard->relevance_warning_text =
-        focus_guard_format_relevance_warning(result->page);
-  } else {
-    focus_guard_clear_relevance_warning(guard);
+  /* Submission to verdict on the main loop: the delay the user sees. */
+  focus_latency_record(FOCUS_LATENCY_TOTAL, context->submitted_us);
+
+  if (result->verdict != FOCUS_GUARD_RELEVANCE_UNKNOWN &&
+      result->page != NULL) {
+    gint64 now_utc = g_get_real_time() / G_USEC_PER_SEC;
+    relevance_cache_insert(guard->relevance_cache,
+                           context->task_key,
+                           result->page->url,
+                           result->fingerprint,
+                           result->verdict,
+                           now_utc);
+    usage_stats_store_put_verdict(guard->stats_store,
+                                  context->task_key,
+                                  result->page->url,
+                                  result->fingerprint,
+                                  result->verdict,
+                                  now_utc);
   }
 
-  focus_guard_refresh_warning_from_active(guard);
+  /* Only the chat model's own answers are training data; learning from
+   * the classifier's or the embeddings' verdicts would feed back on itself. */
+  if (result->raw_response != NULL && result->verdict != FOCUS_GUARD_RELEVANCE_UNKNOWN &&
+      result->page != NULL) {
+    char *domain = chrome_cdp_url_domain(result->page->url);
+    usage_stats_store_add_example(guard->stats_store,
+                                  context->task_title,
+                                  domain,
+                                  result->page->title,
+                                  result->verdict,
+                                  g_get_real_time() / G_USEC_PER_SEC);
+    if (result->verdict != FOCUS_GUARD_RELEVANCE_UNSURE) {
+      relevance_classifier_train(guard->relevance_classifier,
+                                 context->task_title,
+                                 domain,
+                                 result->page->title,
+                                 result->verdict == FOCUS_GUARD_RELEVANCE_RELEVANT);
+    }
+    g_free(domain);
+  }
+
+  focus_guard_apply_relevance_verdict(guard, result->verdict, result->page);
+  focus_guard_log_relevance_cache(guard);
   focus_guard_relevance_result_free(result);
   g_object_unref(window);
 }
 
+gboolean
+focus_guard_chrome_relevance_allowed(const FocusGuard *guard, const char *app_key)
+{
+  return guard != NULL && guard->config.warnings_enabled &&
+         focus_guard_is_ollama_available(guard) && guard->config.chrome_ollama_enabled &&
+         guard->config.ollama_model != NULL &&
+         app_key != NULL && focus_guard_is_chrome_app(app_key);
+}
+
+static void
+focus_guard_on_chrome_tab_navigated(const ChromeCdpTab *tab, gpointer user_data)
+{
+  FocusGuard *guard = user_data;
+  if (guard == NULL || tab == NULL || !focus_guard_should_track(guard)) {
+    return;
+  }
+
+  char *app_name = NULL;
+  char *app_key = NULL;
+  char *window_title = NULL;
+  if (focus_guard_x11_get_active_app(&app_name, &window_title) && app_name != NULL) {
+    app_key = g_ascii_strdown(app_name, -1);
+  }
+
+  if (focus_guard_chrome_relevance_allowed(guard, app_key) &&
+      chrome_cdp_tab_tracker_find_active(guard->chrome_tabs, window_title) == tab) {
+    PomodoroTask *task = task_store_get_active(guard->state->store);
+    guard->last_relevance_check_us = g_get_monotonic_time();
+    focus_guard_start_relevance_check(guard,
+                                      window_title,
+                                      task != NULL ? pomodoro_task_get_title(task)
+                                                   : NULL,
+                                      FOCUS_SCHEDULER_PRIORITY_HIGH);
+  }
+
+  g_free(window_title);
+  g_free(app_key);
+  g_free(app_name);
+}
+
+void
+focus_guard_sync_chrome_tabs(FocusGuard *guard)
+{
+  if (guard == NULL) {
+    return;
+  }
+
+  guint port = guard->config.chrome_ollama_enabled
+                   ? guard->config.chrome_debug_port
+                   : 0;
+  if (guard->chrome_tabs != NULL &&
+      chrome_cdp_tab_tracker_get_port(guard->chrome_tabs) == port) {
+    return;
+  }
+
+  g_clear_pointer(&guard->chrome_tabs, chrome_cdp_tab_tracker_free);
+  if (port != 0) {
+    guard->chrome_tabs = chrome_cdp_tab_tracker_new(port,
+                                                    focus_guard_on_chrome_tab_navigated,
+                                                    guard);
+  }
+}
+
 void
 focus_guard_clear_relevance_warning(FocusGuard *guard)
 {
@@ -290,19 +641,90 @@ focus_guard_clear_relevance_warning(FocusGuard *guard)
   g_clear_pointer(&guard->relevance_warning_text, g_free);
 }
 
+static char *
+focus_guard_make_page_key(const ChromeCdpTab *tab, const char *window_title)
+{
+  /* A tab is identified by target and URL, so navigating within a tab
+   * counts as a new page; without the tab tracker the title has to do. */
+  if (tab != NULL) {
+    return g_strconcat(tab->id, "\n", tab->url != NULL ? tab->url : "", NULL);
+  }
+
+  return g_strdup(window_title != NULL ? window_title : "");
+}
+
+char *
+focus_guard_relevance_page_key(FocusGuard *guard, const char *window_title)
+{
+  if (guard == NULL) {
+    return NULL;
+  }
+
+  const ChromeCdpTab *tab =
+      chrome_cdp_tab_tracker_find_active(guard->chrome_tabs, window_title);
+  return focus_guard_make_page_key(tab, window_title);
+}
+
+gboolean
+focus_guard_relevance_busy(FocusGuard *guard)
+{
+  return guard != NULL &&
+         focus_scheduler_is_busy(guard->scheduler, FOCUS_GUARD_RELEVANCE_JOB);
+}
+
+gboolean
+focus_guard_apply_cached_relevance(FocusGuard *guard,
+                                   const char *window_title,
+                                   const char *task_title)
+{
+  if (guard == NULL || task_title == NULL || *task_title == '\0') {
+    return FALSE;
+  }
+
+  const ChromeCdpTab *tab =
+      chrome_cdp_tab_tracker_find_active(guard->chrome_tabs, window_title);
+  if (tab == NULL) {
+    return FALSE;
+  }
+
+  char *task_key = relevance_cache_normalize_task(task_title);
+  gint cached_verdict = FOCUS_GUARD_RELEVANCE_UNKNOWN;
+  gboolean hit = relevance_cache_lookup_url(guard->relevance_cache,
+                                            task_key,
+                                            tab->url,
+                                            g_get_real_time() / G_USEC_PER_SEC,
+                                            &cached_verdict);
+  g_free(task_key);
+  if (!hit) {
+    return FALSE;
+  }
+
+  /* Whatever was running was for an older page; newest wins. */
+  focus_guard_cancel_relevance_check(guard);
+  guard->relevance_page_key = focus_guard_make_page_key(tab, window_title);
+
+  ChromeCdpPage page = {
+      .title = tab->title,
+      .url = tab->url,
+      .text = NULL,
+  };
+  focus_guard_apply_relevance_verdict(guard,
+                                      (FocusGuardRelevance)cached_verdict,
+                                      &page);
+  focus_guard_log_relevance_cache(guard);
+  return TRUE;
+}
+
 void
 focus_guard_start_relevance_check(FocusGuard *guard,
                                   const char *window_title,
-                                  const char *task_title)
+                                  const char *task_title,
+                                  FocusSchedulerPriority priority)
 {
   if (guard == NULL || guard->state == NULL) {
     return;
   }
 
-  if (guard->relevance_inflight) {
-    return;
-  }
-
   if (guard->config.ollama_model == NULL ||
       *guard->config.ollama_model == '\0') {
     return;
@@ -312,25 +734,71 @@ focus_guard_start_relevance_check(FocusGuard *guard,
     return;
   }
 
-  guard->relevance_inflight = TRUE;
-  guard->relevance_check_id++;
-  guard->relevance_cancellable = g_cancellable_new();
+  if (focus_guard_apply_cached_relevance(guard, window_title, task_title)) {
+    return;
+  }
+
+  char *task_key = relevance_cache_normalize_task(task_title);
+  const ChromeCdpTab *tab =
+      chrome_cdp_tab_tracker_find_active(guard->chrome_tabs, window_title);
+
+  /* Whatever was running was for an older page; newest wins. */
+  focus_guard_cancel_relevance_check(guard);
+  guard->relevance_page_key = focus_guard_make_page_key(tab, window_title);
+
+  /* The tab's title and URL are all the classifier needs, so a confident
+   * answer skips the page fetch as well as inference. */
+  FocusGuardRelevance classifier_verdict =
+      tab != NULL ? focus_guard_classifier_verdict(guard->relevance_classifier,
+                                                   task_title,
+                                                   tab->title,
+                                                   tab->url)
+                  : FOCUS_GUARD_RELEVANCE_UNKNOWN;
+  if (classifier_verdict != FOCUS_GUARD_RELEVANCE_UNKNOWN) {
+    ChromeCdpPage page = {
+        .title = tab->title,
+        .url = tab->url,
+        .text = NULL,
+    };
+    focus_guard_apply_relevance_verdict(guard, classifier_verdict, &page);
+    g_free(task_key);
+    return;
+  }
 
   FocusGuardRelevanceContext *context = g_new0(FocusGuardRelevanceContext, 1);
   g_weak_ref_init(&context->window_ref, G_OBJECT(guard->state->window));
   context->check_id = guard->relevance_check_id;
   context->task_title = g_strdup(task_title);
   context->window_title = g_strdup(window_title);
+  if (tab != NULL) {
+    context->target_id = g_strdup(tab->id);
+    context->tab_title = g_strdup(tab->title);
+  }
+  context->task_key = task_key;
   context->model = g_strdup(guard->config.ollama_model);
+  context->embed_model = g_strdup(guard->config.ollama_embed_model);
+  context->embed_relevant_threshold = guard->config.embed_relevant_threshold;
+  context->embed_irrelevant_threshold = guard->config.embed_irrelevant_threshold;
   context->port = guard->config.chrome_debug_port;
-
-  GTask *task = g_task_new(NULL,
-                           guard->relevance_cancellable,
-                           focus_guard_on_relevance_task_complete,
-                           NULL);
-  g_task_set_task_data(task, context, focus_guard_relevance_context_free);
-  g_task_run_in_thread(task, focus_guard_relevance_task);
-  g_object_unref(task);
+  context->keep_alive_seconds = focus_guard_model_keep_alive_seconds(guard);
+  context->cache = relevance_cache_ref(guard->relevance_cache);
+  context->classifier = relevance_classifier_ref(guard->relevance_classifier);
+  context->embeddings = relevance_embeddings_ref(guard->relevance_embeddings);
+  if (trafilatura_client_is_usable(guard->trafilatura)) {
+    context->trafilatura = trafilatura_client_ref(guard->trafilatura);
+  }
+  context->submitted_us = g_get_monotonic_time();
+
+  focus_scheduler_submit(guard->scheduler,
+                         FOCUS_GUARD_RELEVANCE_JOB,
+                         priority,
+                         g_get_monotonic_time() +
+                             FOCUS_GUARD_RELEVANCE_DEADLINE_SECONDS * G_USEC_PER_SEC,
+                         focus_guard_relevance_task,
+                         context,
+                         focus_guard_relevance_context_free,
+                         focus_guard_on_relevance_task_complete,
+                         NULL);
 }
 
 void
@@ -340,11 +808,7 @@ focus_guard_cancel_relevance_check(FocusGuard *guard)
     return;
   }
 
-  if (guard->relevance_cancellable != NULL) {
-    g_cancellable_cancel(guard->relevance_cancellable);
-    g_clear_object(&guard->relevance_cancellable);
-  }
-
-  guard->relevance_inflight = FALSE;
+  focus_scheduler_cancel(guard->scheduler, FOCUS_GUARD_RELEVANCE_JOB);
+  g_clear_pointer(&guard->relevance_page_key, g_free);
   guard->relevance_check_id++;
 }
@@ -1,8 +1,9 @@
 #include "focus/focus_guard_internal.h"
 
-#include "core/task_store.h"
+#include <string.h>
 
-#define USAGE_STATS_RETENTION_DAYS 35
+#include "core/task_store.h"
+#include "focus/focus_latency.h"
 
 static void
 focus_guard_usage_free(gpointer data)
@@ -13,6 +14,7 @@ focus_guard_usage_free(gpointer data)
   }
 
   g_free(usage->display_name);
+  g_clear_pointer(&usage->domains, g_hash_table_destroy);
   g_free(usage);
 }
 
@@ -36,6 +38,7 @@ focus_guard_bucket_task_free(gpointer data)
   g_free(entry->task_id);
   g_free(entry->app_key);
   g_free(entry->app_name);
+  g_clear_pointer(&entry->domains, g_hash_table_destroy);
   g_free(entry);
 }
 
@@ -63,14 +66,81 @@ focus_guard_usage_get_or_create(GHashTable *table,
   }
 
   usage = g_new0(FocusGuardUsage, 1);
+  usage->key = g_strdup(key);
   usage->display_name = g_strdup(display ? display : key);
   usage->usec_total = 0;
-  g_hash_table_insert(table, g_strdup(key), usage);
+  g_hash_table_insert(table, (char *)usage->key, usage);
   return usage;
 }
 
+void
+focus_guard_usage_add_domain(GHashTable **domains, const char *domain, gint64 usec)
+{
+  if (domains == NULL || domain == NULL || usec <= 0) {
+    return;
+  }
+
+  /* Domains come from g_intern_string(), so pointers compare directly. */
+  if (*domains == NULL) {
+    *domains = g_hash_table_new_full(g_direct_hash,
+                                     g_direct_equal,
+                                     NULL,
+                                     focus_guard_usage_free);
+  }
+
+  FocusGuardUsage *usage = g_hash_table_lookup(*domains, domain);
+  if (usage == NULL) {
+    usage = g_new0(FocusGuardUsage, 1);
+    usage->key = domain;
+    usage->display_name = g_strdup(domain);
+    g_hash_table_insert(*domains, (gpointer)domain, usage);
+  }
+  usage->usec_total += usec;
+}
+
 static void
-focus_guard_get_day_bounds(gint64 *start_utc,
+focus_guard_merge_domains(GHashTable **target, GHashTable *source)
+{
+  if (source == NULL) {
+    return;
+  }
+
+  GHashTableIter iter;
+  gpointer value = NULL;
+  g_hash_table_iter_init(&iter, source);
+  while (g_hash_table_iter_next(&iter, NULL, &value)) {
+    FocusGuardUsage *domain = value;
+    focus_guard_usage_add_domain(target, domain->key, domain->usec_total);
+  }
+}
+
+/* GLib resolves the local zone once per process, so after /etc/localtime
+ * is replaced the zone is looked up again by the name the link points to.
+ * That needs g_time_zone_new_identifier (GLib 2.68); older GLib keeps the
+ * zone it resolved at startup. */
+static GTimeZone *
+focus_guard_local_timezone_new(void)
+{
+#if GLIB_CHECK_VERSION(2, 68, 0)
+  if (g_getenv("TZ") == NULL) {
+    char *target = g_file_read_link("/etc/localtime", NULL);
+    const char *name = target != NULL ? strstr(target, "zoneinfo/") : NULL;
+    GTimeZone *timezone = name != NULL
+                              ? g_time_zone_new_identifier(name + strlen("zoneinfo/"))
+                              : NULL;
+    g_free(target);
+    if (timezone != NULL) {
+      return timezone;
+    }
+  }
+#endif
+
+  return g_time_zone_new_local();
+}
+
+static void
+focus_guard_get_day_bounds(GTimeZone *timezone,
+                           gint64 *start_utc,
                            gint64 *end_utc,
                            char **label)
 {
@@ -78,7 +148,7 @@ focus_guard_get_day_bounds(gint64 *start_utc,
     return;
   }
 
-  GDateTime *now_local = g_date_time_new_now_local();
+  GDateTime *now_local = g_date_time_new_now(timezone);
   if (now_local == NULL) {
     *start_utc = 0;
     *end_utc = 0;
@@ -92,8 +162,17 @@ focus_guard_get_day_bounds(gint64 *start_utc,
   gint month = g_date_time_get_month(now_local);
   gint day = g_date_time_get_day_of_month(now_local);
 
-  GDateTime *start_local = g_date_time_new_local(year, month, day, 0, 0, 0);
-  GDateTime *end_local = g_date_time_add_days(start_local, 1);
+  /* The next midnight is built from the calendar date, not start + 24h,
+   * so DST days of 23 or 25 hours end where they should. */
+  GDateTime *start_local = g_date_time_new(timezone, year, month, day, 0, 0, 0);
+  GDateTime *next_day = g_date_time_add_days(start_local, 1);
+  GDateTime *end_local = g_date_time_new(timezone,
+                                         g_date_time_get_year(next_day),
+                                         g_date_time_get_month(next_day),
+                                         g_date_time_get_day_of_month(next_day),
+                                         0,
+                                         0,
+                                         0);
 
   *start_utc = g_date_time_to_unix(start_local);
   *end_utc = g_date_time_to_unix(end_local);
@@ -103,35 +182,100 @@ focus_guard_get_day_bounds(gint64 *start_utc,
   }
 
   g_date_time_unref(end_local);
+  g_date_time_unref(next_day);
   g_date_time_unref(start_local);
   g_date_time_unref(now_local);
 }
 
-gboolean
-focus_guard_refresh_day(FocusGuard *guard)
+static void
+focus_guard_update_day_bounds(FocusGuard *guard)
 {
-  if (guard == NULL) {
-    return FALSE;
+  /* The hot path: still inside the day computed last time. */
+  gint64 now_utc = g_get_real_time() / G_USEC_PER_SEC;
+  if (guard->day_end_utc > 0 && now_utc >= guard->day_start_utc &&
+      now_utc < guard->day_end_utc) {
+    return;
+  }
+
+  if (guard->local_timezone == NULL) {
+    guard->local_timezone = focus_guard_local_timezone_new();
+    usage_stats_store_set_timezone(guard->stats_store, guard->local_timezone);
   }
 
   gint64 start_utc = 0;
   gint64 end_utc = 0;
   char *label = NULL;
-  focus_guard_get_day_bounds(&start_utc, &end_utc, &label);
+  focus_guard_get_day_bounds(guard->local_timezone, &start_utc, &end_utc, &label);
+
+  if (start_utc != guard->day_start_utc) {
+    guard->day_changed = TRUE;
+  }
+  guard->day_start_utc = start_utc;
+  guard->day_end_utc = end_utc;
+  g_clear_pointer(&guard->day_label, g_free);
+  guard->day_label = label;
+}
 
-  gboolean changed = (start_utc != guard->day_start_utc);
-  if (changed) {
-    guard->day_start_utc = start_utc;
-    g_clear_pointer(&guard->day_label, g_free);
-    guard->day_label = label;
-  } else {
-    g_free(label);
+gboolean
+focus_guard_refresh_day(FocusGuard *guard)
+{
+  if (guard == NULL) {
+    return FALSE;
   }
 
-  (void)end_utc;
+  focus_guard_update_day_bounds(guard);
+  gboolean changed = guard->day_changed;
+  guard->day_changed = FALSE;
   return changed;
 }
 
+static void
+focus_guard_on_localtime_changed(GFileMonitor *monitor,
+                                 GFile *file,
+                                 GFile *other_file,
+                                 GFileMonitorEvent event_type,
+                                 gpointer user_data)
+{
+  (void)monitor;
+  (void)file;
+  (void)other_file;
+  FocusGuard *guard = user_data;
+  if (event_type != G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT &&
+      event_type != G_FILE_MONITOR_EVENT_CREATED &&
+      event_type != G_FILE_MONITOR_EVENT_DELETED) {
+    return;
+  }
+
+  /* The next tick recomputes the boundary and handles a day change, even
+   * if a stats reload recomputes it first. */
+  g_clear_pointer(&guard->local_timezone, g_time_zone_unref);
+  guard->day_end_utc = 0;
+  g_debug("Local timezone changed; day boundary will be recomputed");
+}
+
+void
+focus_guard_watch_timezone(FocusGuard *guard)
+{
+  if (guard == NULL || guard->localtime_monitor != NULL) {
+    return;
+  }
+
+  GError *error = NULL;
+  GFile *file = g_file_new_for_path("/etc/localtime");
+  guard->localtime_monitor = g_file_monitor_file(file, G_FILE_MONITOR_NONE, NULL, &error);
+  g_object_unref(file);
+  if (guard->localtime_monitor == NULL) {
+    g_debug("Cannot watch /etc/localtime: %s", error->message);
+    g_clear_error(&error);
+    return;
+  }
+
+  g_signal_connect(guard->localtime_monitor,
+                   "changed",
+                   G_CALLBACK(focus_guard_on_localtime_changed),
+                   guard);
+}
+
 static void
 focus_guard_clear_usage_table(GHashTable *table)
 {
@@ -153,13 +297,18 @@ focus_guard_load_usage_map_from_db(FocusGuard *guard,
   }
 
   focus_guard_clear_usage_table(table);
+  focus_guard_invalidate_stats_rank(guard);
   if (guard->stats_store == NULL) {
     return;
   }
 
-  gint64 start_utc = 0;
-  gint64 end_utc = 0;
-  focus_guard_get_day_bounds(&start_utc, &end_utc, NULL);
+  /* Only the bounds are needed here; a pending day change is left for the
+   * next tick to flush, reload and prune. */
+  if (guard->day_end_utc <= 0) {
+    focus_guard_update_day_bounds(guard);
+  }
+  gint64 start_utc = guard->day_start_utc;
+  gint64 end_utc = guard->day_end_utc;
 
   GPtrArray *entries = usage_stats_store_query_day(guard->stats_store,
                                                    start_utc,
@@ -183,6 +332,28 @@ focus_guard_load_usage_map_from_db(FocusGuard *guard,
   }
 
   g_ptr_array_free(entries, TRUE);
+
+  GPtrArray *domains = usage_stats_store_query_domains_day(guard->stats_store,
+                                                           start_utc,
+                                                           end_utc,
+                                                           scope,
+                                                           task_id);
+  if (domains == NULL) {
+    return;
+  }
+
+  for (guint i = 0; i < domains->len; i++) {
+    UsageStatsDomainEntry *entry = g_ptr_array_index(domains, i);
+    FocusGuardUsage *usage = g_hash_table_lookup(table, entry->app_key);
+    if (usage == NULL) {
+      continue;
+    }
+    focus_guard_usage_add_domain(&usage->domains,
+                                 g_intern_string(entry->domain),
+                                 entry->duration_sec * G_USEC_PER_SEC);
+  }
+
+  g_ptr_array_free(domains, TRUE);
 }
 
 void
@@ -213,6 +384,7 @@ focus_guard_merge_bucket_task(FocusGuard *guard,
         focus_guard_usage_get_or_create(table, entry->app_key, entry->app_name);
     if (usage != NULL) {
       usage->usec_total += entry->usec_total;
+      focus_guard_merge_domains(&usage->domains, entry->domains);
     }
   }
 }
@@ -231,7 +403,7 @@ focus_guard_select_global(FocusGuard *guard)
     g_hash_table_destroy(guard->usage_task_view);
     guard->usage_task_view = NULL;
   }
-  guard->usage_dirty = TRUE;
+  focus_guard_invalidate_stats_rank(guard);
   focus_guard_update_stats_ui(guard);
 }
 
@@ -259,14 +431,180 @@ focus_guard_select_task(FocusGuard *guard, PomodoroTask *task)
                                      guard->view_task_id);
   focus_guard_merge_bucket_task(guard, guard->view_task_id, guard->usage_task_view);
 
+  focus_guard_invalidate_stats_rank(guard);
+  focus_guard_update_stats_ui(guard);
+}
+
+void
+focus_guard_toggle_app_details(FocusGuard *guard, const char *app_key)
+{
+  if (guard == NULL) {
+    return;
+  }
+
+  gboolean collapse = g_strcmp0(guard->stats_expanded_app, app_key) == 0;
+  g_free(guard->stats_expanded_app);
+  guard->stats_expanded_app = collapse ? NULL : g_strdup(app_key);
   guard->usage_dirty = TRUE;
   focus_guard_update_stats_ui(guard);
 }
 
+static void
+focus_guard_flush_domains(FocusGuard *guard,
+                          const char *scope,
+                          const char *task_id,
+                          const char *app_key,
+                          GHashTable *domains)
+{
+  if (domains == NULL) {
+    return;
+  }
+
+  GHashTableIter iter;
+  gpointer value = NULL;
+  g_hash_table_iter_init(&iter, domains);
+  while (g_hash_table_iter_next(&iter, NULL, &value)) {
+    FocusGuardUsage *domain = value;
+    gint64 seconds = domain->usec_total / G_USEC_PER_SEC;
+    if (seconds <= 0) {
+      continue;
+    }
+    gint64 domain_id = usage_stats_store_intern_domain(guard->stats_store, domain->key);
+    usage_stats_store_add_domain(guard->stats_store,
+                                 guard->bucket_start_utc,
+                                 scope,
+                                 task_id,
+                                 app_key,
+                                 domain_id,
+                                 seconds);
+  }
+}
+
+static void
+focus_guard_checkpoint_domains(FocusGuard *guard,
+                               const char *scope,
+                               const char *task_id,
+                               const char *app_key,
+                               const char *app_name,
+                               GHashTable *domains)
+{
+  if (domains == NULL) {
+    return;
+  }
+
+  GHashTableIter iter;
+  gpointer value = NULL;
+  g_hash_table_iter_init(&iter, domains);
+  while (g_hash_table_iter_next(&iter, NULL, &value)) {
+    FocusGuardUsage *domain = value;
+    usage_stats_store_checkpoint_put(guard->stats_store,
+                                     guard->bucket_start_utc,
+                                     scope,
+                                     task_id,
+                                     app_key,
+                                     app_name,
+                                     domain->key,
+                                     domain->usec_total / G_USEC_PER_SEC);
+  }
+}
+
+void
+focus_guard_sync_bucket_seconds(FocusGuard *guard)
+{
+  if (guard == NULL || guard->stats_store == NULL || guard->config.usage_bucket_seconds == 0 ||
+      usage_stats_store_get_bucket_seconds(guard->stats_store) ==
+          guard->config.usage_bucket_seconds) {
+    return;
+  }
+
+  /* An import snaps its rows to the grain it started with and the open
+   * bucket cannot be flushed meanwhile; the import's completion syncs. */
+  if (guard->stats_import_active) {
+    return;
+  }
+
+  /* The open bucket was started on the old grain. */
+  focus_guard_flush_bucket(guard);
+  usage_stats_store_set_bucket_seconds(guard->stats_store,
+                                       guard->config.usage_bucket_seconds);
+}
+
+void
+focus_guard_checkpoint_bucket(FocusGuard *guard)
+{
+  if (guard == NULL || guard->stats_store == NULL || guard->bucket_start_utc <= 0 ||
+      guard->stats_import_active) {
+    return;
+  }
+
+  gint64 start_us = g_get_monotonic_time();
+  if (!usage_stats_store_begin(guard->stats_store)) {
+    return;
+  }
+
+  usage_stats_store_checkpoint_reset(guard->stats_store);
+
+  GHashTableIter iter;
+  gpointer key = NULL;
+  gpointer value = NULL;
+  if (guard->bucket_global != NULL) {
+    g_hash_table_iter_init(&iter, guard->bucket_global);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+      FocusGuardUsage *usage = value;
+      const char *app_name = usage->display_name ? usage->display_name : usage->key;
+      usage_stats_store_checkpoint_put(guard->stats_store,
+                                       guard->bucket_start_utc,
+                                       "global",
+                                       NULL,
+                                       usage->key,
+                                       app_name,
+                                       NULL,
+                                       usage->usec_total / G_USEC_PER_SEC);
+      focus_guard_checkpoint_domains(guard, "global", NULL, usage->key, app_name, usage->domains);
+    }
+  }
+
+  if (guard->bucket_task != NULL) {
+    g_hash_table_iter_init(&iter, guard->bucket_task);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+      FocusGuardBucketTaskEntry *entry = value;
+      if (entry->task_id == NULL || entry->app_key == NULL) {
+        continue;
+      }
+      const char *app_name = entry->app_name ? entry->app_name : entry->app_key;
+      usage_stats_store_checkpoint_put(guard->stats_store,
+                                       guard->bucket_start_utc,
+                                       "task",
+                                       entry->task_id,
+                                       entry->app_key,
+                                       app_name,
+                                       NULL,
+                                       entry->usec_total / G_USEC_PER_SEC);
+      focus_guard_checkpoint_domains(guard,
+                                     "task",
+                                     entry->task_id,
+                                     entry->app_key,
+                                     app_name,
+                                     entry->domains);
+    }
+  }
+
+  if (!usage_stats_store_commit(guard->stats_store)) {
+    return;
+  }
+
+  gint64 elapsed_us = g_get_monotonic_time() - start_us;
+  guard->bucket_checkpoint_dirty = FALSE;
+  guard->checkpoint_count++;
+  guard->checkpoint_total_us += elapsed_us;
+  guard->checkpoint_max_us = MAX(guard->checkpoint_max_us, elapsed_us);
+}
+
 void
 focus_guard_flush_bucket(FocusGuard *guard)
 {
-  if (guard == NULL) {
+  /* The bucket keeps growing and is written once the import is done. */
+  if (guard == NULL || guard->stats_import_active) {
     return;
   }
 
@@ -287,6 +625,10 @@ focus_guard_flush_bucket(FocusGuard *guard)
     return;
   }
 
+  /* The bucket and the removal of its checkpoint land together, so a crash
+   * either replays the checkpoint or finds it already folded in. */
+  gboolean in_transaction = usage_stats_store_begin(guard->stats_store);
+
   GHashTableIter iter;
   gpointer key = NULL;
   gpointer value = NULL;
@@ -309,6 +651,7 @@ focus_guard_flush_bucket(FocusGuard *guard)
                             app_key,
                             usage->display_name ? usage->display_name : app_key,
                             seconds);
+      focus_guard_flush_domains(guard, "global", NULL, app_key, usage->domains);
     }
   }
 
@@ -331,24 +674,97 @@ focus_guard_flush_bucket(FocusGuard *guard)
                             entry->app_key,
                             entry->app_name ? entry->app_name : entry->app_key,
                             seconds);
+      focus_guard_flush_domains(guard,
+                                "task",
+                                entry->task_id,
+                                entry->app_key,
+                                entry->domains);
     }
   }
 
+  usage_stats_store_checkpoint_reset(guard->stats_store);
+  if (in_transaction) {
+    usage_stats_store_commit(guard->stats_store);
+  }
+  focus_guard_heatmap_invalidate(guard);
+
   focus_guard_clear_usage_table(guard->bucket_global);
   if (guard->bucket_task != NULL) {
     g_hash_table_remove_all(guard->bucket_task);
   }
   guard->bucket_start_utc = 0;
+  guard->bucket_checkpoint_dirty = FALSE;
+}
+
+void
+focus_guard_reload_stats(FocusGuard *guard)
+{
+  if (guard == NULL) {
+    return;
+  }
+
+  focus_guard_flush_bucket(guard);
+  if (guard->usage_global != NULL) {
+    focus_guard_clear_usage_table(guard->usage_global);
+    focus_guard_load_usage_map_from_db(guard, guard->usage_global, "global", NULL);
+  }
+  if (guard->usage_task_view != NULL && guard->view_task_id != NULL) {
+    focus_guard_clear_usage_table(guard->usage_task_view);
+    focus_guard_load_usage_map_from_db(guard,
+                                       guard->usage_task_view,
+                                       "task",
+                                       guard->view_task_id);
+  }
+  focus_guard_invalidate_stats_rank(guard);
+  focus_guard_heatmap_invalidate(guard);
+  focus_guard_update_stats_ui(guard);
+}
+
+void
+focus_guard_load_task_focus(FocusGuard *guard)
+{
+  if (guard == NULL || guard->state == NULL || guard->state->store == NULL) {
+    return;
+  }
+
+  const GPtrArray *tasks = task_store_get_tasks(guard->state->store);
+  GHashTable *by_id = g_hash_table_new(g_str_hash, g_str_equal);
+  for (guint i = 0; i < tasks->len; i++) {
+    PomodoroTask *task = g_ptr_array_index(tasks, i);
+    pomodoro_task_set_focus_totals(task, 0, 0);
+    const char *id = pomodoro_task_get_id(task);
+    if (id != NULL) {
+      g_hash_table_insert(by_id, (gpointer)id, task);
+    }
+  }
+
+  GPtrArray *entries = usage_stats_store_load_task_focus(guard->stats_store);
+  for (guint i = 0; entries != NULL && i < entries->len; i++) {
+    UsageStatsTaskFocus *entry = g_ptr_array_index(entries, i);
+    PomodoroTask *task = g_hash_table_lookup(by_id, entry->task_id);
+    pomodoro_task_set_focus_totals(task, entry->focus_ms, entry->sessions);
+  }
+
+  if (entries != NULL) {
+    g_ptr_array_unref(entries);
+  }
+  g_hash_table_destroy(by_id);
 }
 
 void
 focus_guard_prune_history(FocusGuard *guard)
 {
-  if (guard == NULL || guard->stats_store == NULL || guard->day_start_utc <= 0) {
+  if (guard == NULL || guard->stats_store == NULL || guard->day_start_utc <= 0 ||
+      guard->local_timezone == NULL) {
     return;
   }
 
-  GDateTime *day_start_local = g_date_time_new_from_unix_local(guard->day_start_utc);
+  GDateTime *day_start_utc = g_date_time_new_from_unix_utc(guard->day_start_utc);
+  if (day_start_utc == NULL) {
+    return;
+  }
+  GDateTime *day_start_local = g_date_time_to_timezone(day_start_utc, guard->local_timezone);
+  g_date_time_unref(day_start_utc);
   if (day_start_local == NULL) {
     return;
   }
@@ -373,6 +789,8 @@ focus_guard_clear_stats(FocusGuard *guard)
   if (guard->stats_store != NULL) {
     usage_stats_store_clear(guard->stats_store);
   }
+  relevance_cache_clear(guard->relevance_cache);
+  relevance_classifier_reset(guard->relevance_classifier);
 
   focus_guard_clear_usage_table(guard->usage_global);
   focus_guard_clear_usage_table(guard->usage_task_view);
@@ -381,6 +799,9 @@ focus_guard_clear_stats(FocusGuard *guard)
     g_hash_table_remove_all(guard->bucket_task);
   }
   guard->bucket_start_utc = 0;
-  guard->usage_dirty = TRUE;
+  focus_guard_load_task_focus(guard);
+  focus_guard_invalidate_stats_rank(guard);
+  focus_guard_heatmap_invalidate(guard);
+  focus_latency_reset();
   focus_guard_update_stats_ui(guard);
 }
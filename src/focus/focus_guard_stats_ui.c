@@ -1,10 +1,31 @@
 #include "focus/focus_guard_internal.h"
 
+/* The panel shows the top apps of the viewed table. Their ranking is kept
+ * as an ordered list of keys that each tick's increment bubbles up, and the
+ * row widgets persist: labels change in place and rows are only moved when
+ * the ranking does. A full scan happens only after a table is reloaded. */
+#define FOCUS_GUARD_STATS_TOP_K 5
+
+typedef struct {
+  char *key;
+  GtkWidget *row;
+  GtkWidget *name_label;
+  GtkWidget *time_label;
+  char *name;
+  gint64 seconds;
+} FocusGuardStatsRow;
+
+typedef struct {
+  char *key;
+  char *name;
+  gint64 usec_total;
+  gboolean is_domain;
+  gboolean activatable;
+} FocusGuardStatsWanted;
+
 static gint
-focus_guard_usage_compare_desc(gconstpointer a, gconstpointer b)
+focus_guard_usage_compare(const FocusGuardUsage *left, const FocusGuardUsage *right)
 {
-  const FocusGuardUsage *left = *(const FocusGuardUsage *const *)a;
-  const FocusGuardUsage *right = *(const FocusGuardUsage *const *)b;
   if (left == right) {
     return 0;
   }
@@ -30,7 +51,130 @@ focus_guard_usage_compare_desc(gconstpointer a, gconstpointer b)
   return g_strcmp0(left_name, right_name);
 }
 
-static char *
+/* Bounded insertion: O(n * k) with no copy or sort of the whole table. */
+static guint
+focus_guard_select_top(GHashTable *table, FocusGuardUsage **top, guint k)
+{
+  guint count = 0;
+  if (table == NULL) {
+    return 0;
+  }
+
+  GHashTableIter iter;
+  gpointer value = NULL;
+  g_hash_table_iter_init(&iter, table);
+  while (g_hash_table_iter_next(&iter, NULL, &value)) {
+    FocusGuardUsage *usage = value;
+    if (usage == NULL || usage->usec_total <= 0) {
+      continue;
+    }
+    if (count == k && focus_guard_usage_compare(usage, top[k - 1]) >= 0) {
+      continue;
+    }
+
+    guint pos = count < k ? count++ : k - 1;
+    while (pos > 0 && focus_guard_usage_compare(usage, top[pos - 1]) < 0) {
+      top[pos] = top[pos - 1];
+      pos--;
+    }
+    top[pos] = usage;
+  }
+
+  return count;
+}
+
+static GHashTable *
+focus_guard_stats_source(FocusGuard *guard, const char **empty_text)
+{
+  if (guard->view == FOCUS_GUARD_VIEW_TASK) {
+    *empty_text = guard->view_task_id != NULL ? "No app activity yet for this task."
+                                              : "Select a task to view stats.";
+    return guard->usage_task_view;
+  }
+  if (!guard->config.global_stats_enabled) {
+    *empty_text = "Global stats disabled.";
+    return NULL;
+  }
+  *empty_text = "No app activity yet.";
+  return guard->usage_global;
+}
+
+static void
+focus_guard_stats_rank_rebuild(FocusGuard *guard, GHashTable *source)
+{
+  FocusGuardUsage *top[FOCUS_GUARD_STATS_TOP_K];
+  guint count = focus_guard_select_top(source, top, FOCUS_GUARD_STATS_TOP_K);
+
+  g_ptr_array_set_size(guard->stats_top, 0);
+  for (guint i = 0; i < count; i++) {
+    g_ptr_array_add(guard->stats_top, g_strdup(top[i]->key));
+  }
+  guard->stats_rank_stale = FALSE;
+}
+
+void
+focus_guard_invalidate_stats_rank(FocusGuard *guard)
+{
+  if (guard == NULL) {
+    return;
+  }
+
+  guard->stats_rank_stale = TRUE;
+  guard->usage_dirty = TRUE;
+}
+
+void
+focus_guard_stats_rank_bump(FocusGuard *guard, FocusGuardUsage *usage)
+{
+  if (guard == NULL || usage == NULL || guard->stats_rank_stale) {
+    return;
+  }
+
+  const char *empty_text = NULL;
+  GHashTable *source = focus_guard_stats_source(guard, &empty_text);
+  if (source == NULL) {
+    return;
+  }
+
+  /* Totals only grow between reloads, so an app can only enter or climb
+   * the ranking through its own increment. */
+  GPtrArray *top = guard->stats_top;
+  guint pos = 0;
+  while (pos < top->len && g_strcmp0(g_ptr_array_index(top, pos), usage->key) != 0) {
+    pos++;
+  }
+
+  if (pos == top->len) {
+    if (top->len < FOCUS_GUARD_STATS_TOP_K) {
+      g_ptr_array_add(top, g_strdup(usage->key));
+    } else {
+      pos = top->len - 1;
+      FocusGuardUsage *last = g_hash_table_lookup(source, g_ptr_array_index(top, pos));
+      if (last != NULL && focus_guard_usage_compare(usage, last) >= 0) {
+        return;
+      }
+      g_free(top->pdata[pos]);
+      top->pdata[pos] = g_strdup(usage->key);
+    }
+  }
+
+  while (pos > 0) {
+    FocusGuardUsage *previous = g_hash_table_lookup(source, g_ptr_array_index(top, pos - 1));
+    if (previous == NULL) {
+      guard->stats_rank_stale = TRUE;
+      return;
+    }
+    if (focus_guard_usage_compare(usage, previous) >= 0) {
+      break;
+    }
+    gpointer swap = top->pdata[pos - 1];
+    top->pdata[pos - 1] = top->pdata[pos];
+    top->pdata[pos] = swap;
+    pos--;
+  }
+}
+
+char *
 focus_guard_format_duration(gint64 seconds)
 {
   if (seconds < 0) {
@@ -53,18 +197,167 @@ focus_guard_format_duration(gint64 seconds)
 }
 
 static void
-focus_guard_clear_list(GtkWidget *list)
+focus_guard_stats_row_free(gpointer data)
 {
-  if (list == NULL) {
+  FocusGuardStatsRow *row = data;
+  if (row == NULL) {
     return;
   }
 
-  GtkWidget *child = gtk_widget_get_first_child(list);
-  while (child != NULL) {
-    GtkWidget *next = gtk_widget_get_next_sibling(child);
-    gtk_list_box_remove(GTK_LIST_BOX(list), child);
-    child = next;
+  g_free(row->key);
+  g_free(row->name);
+  g_object_unref(row->row);
+  g_free(row);
+}
+
+static void
+focus_guard_stats_wanted_free(gpointer data)
+{
+  FocusGuardStatsWanted *wanted = data;
+  if (wanted == NULL) {
+    return;
   }
+
+  g_free(wanted->key);
+  g_free(wanted->name);
+  g_free(wanted);
+}
+
+static FocusGuardStatsRow *
+focus_guard_stats_row_new(const FocusGuardStatsWanted *wanted)
+{
+  FocusGuardStatsRow *row = g_new0(FocusGuardStatsRow, 1);
+  row->key = g_strdup(wanted->key);
+  row->seconds = -1;
+  /* Held across reorders, when the row is briefly out of the list. */
+  row->row = g_object_ref_sink(gtk_list_box_row_new());
+  GtkWidget *box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 8);
+  gtk_widget_set_hexpand(box, TRUE);
+
+  row->name_label = gtk_label_new(NULL);
+  gtk_widget_add_css_class(row->name_label,
+                           wanted->is_domain ? "focus-guard-domain" : "focus-guard-app");
+  gtk_widget_set_halign(row->name_label, GTK_ALIGN_START);
+  gtk_label_set_ellipsize(GTK_LABEL(row->name_label), PANGO_ELLIPSIZE_END);
+  gtk_widget_set_hexpand(row->name_label, TRUE);
+
+  row->time_label = gtk_label_new(NULL);
+  gtk_widget_add_css_class(row->time_label, "focus-guard-time");
+  gtk_widget_set_halign(row->time_label, GTK_ALIGN_END);
+
+  gtk_box_append(GTK_BOX(box), row->name_label);
+  gtk_box_append(GTK_BOX(box), row->time_label);
+  gtk_list_box_row_set_child(GTK_LIST_BOX_ROW(row->row), box);
+  if (!wanted->is_domain) {
+    g_object_set_data_full(G_OBJECT(row->row), "app-key", g_strdup(wanted->key), g_free);
+  }
+  return row;
+}
+
+static void
+focus_guard_stats_row_update(FocusGuardStatsRow *row, const FocusGuardStatsWanted *wanted)
+{
+  if (g_strcmp0(row->name, wanted->name) != 0) {
+    g_free(row->name);
+    row->name = g_strdup(wanted->name);
+    gtk_label_set_text(GTK_LABEL(row->name_label), row->name);
+  }
+
+  gint64 seconds = wanted->usec_total / G_USEC_PER_SEC;
+  if (seconds != row->seconds) {
+    row->seconds = seconds;
+    char *duration = focus_guard_format_duration(seconds);
+    gtk_label_set_text(GTK_LABEL(row->time_label), duration);
+    g_free(duration);
+  }
+
+  GtkListBoxRow *list_row = GTK_LIST_BOX_ROW(row->row);
+  if (gtk_list_box_row_get_activatable(list_row) != wanted->activatable) {
+    gtk_list_box_row_set_activatable(list_row, wanted->activatable);
+  }
+}
+
+static void
+focus_guard_sync_stats_rows(FocusGuard *guard, GPtrArray *wanted)
+{
+  GtkListBox *list = GTK_LIST_BOX(guard->state->focus_stats_list);
+  GPtrArray *rows = guard->stats_rows;
+
+  gboolean same_order = rows->len == wanted->len;
+  for (guint i = 0; same_order && i < wanted->len; i++) {
+    const FocusGuardStatsRow *row = g_ptr_array_index(rows, i);
+    const FocusGuardStatsWanted *entry = g_ptr_array_index(wanted, i);
+    same_order = g_strcmp0(row->key, entry->key) == 0;
+  }
+
+  if (!same_order) {
+    GPtrArray *next = g_ptr_array_new_with_free_func(focus_guard_stats_row_free);
+    for (guint i = 0; i < wanted->len; i++) {
+      const FocusGuardStatsWanted *entry = g_ptr_array_index(wanted, i);
+      FocusGuardStatsRow *row = NULL;
+      for (guint j = 0; j < rows->len; j++) {
+        FocusGuardStatsRow *candidate = g_ptr_array_index(rows, j);
+        if (g_strcmp0(candidate->key, entry->key) == 0) {
+          row = g_ptr_array_steal_index(rows, j);
+          break;
+        }
+      }
+      g_ptr_array_add(next, row != NULL ? row : focus_guard_stats_row_new(entry));
+    }
+
+    for (guint i = 0; i < rows->len; i++) {
+      FocusGuardStatsRow *row = g_ptr_array_index(rows, i);
+      gtk_list_box_remove(list, row->row);
+    }
+    for (guint i = 0; i < next->len; i++) {
+      FocusGuardStatsRow *row = g_ptr_array_index(next, i);
+      if (gtk_widget_get_parent(row->row) != NULL) {
+        gtk_list_box_remove(list, row->row);
+      }
+    }
+    for (guint i = 0; i < next->len; i++) {
+      FocusGuardStatsRow *row = g_ptr_array_index(next, i);
+      gtk_list_box_append(list, row->row);
+    }
+
+    g_ptr_array_unref(rows);
+    guard->stats_rows = next;
+    rows = next;
+  }
+
+  for (guint i = 0; i < wanted->len; i++) {
+    focus_guard_stats_row_update(g_ptr_array_index(rows, i), g_ptr_array_index(wanted, i));
+  }
+}
+
+static void
+focus_guard_append_domain_wanted(GPtrArray *wanted, const FocusGuardUsage *app)
+{
+  FocusGuardUsage *top[FOCUS_GUARD_STATS_TOP_K];
+  guint count = focus_guard_select_top(app->domains, top, FOCUS_GUARD_STATS_TOP_K);
+  for (guint i = 0; i < count; i++) {
+    if (top[i]->usec_total < G_USEC_PER_SEC) {
+      continue;
+    }
+
+    FocusGuardStatsWanted *entry = g_new0(FocusGuardStatsWanted, 1);
+    entry->key = g_strconcat(app->key, "\n", top[i]->key, NULL);
+    entry->name = g_strdup(top[i]->display_name);
+    entry->usec_total = top[i]->usec_total;
+    entry->is_domain = TRUE;
+    g_ptr_array_add(wanted, entry);
+  }
+}
+
+void
+focus_guard_release_stats_rows(FocusGuard *guard)
+{
+  if (guard == NULL) {
+    return;
+  }
+
+  g_clear_pointer(&guard->stats_rows, g_ptr_array_unref);
+  g_clear_pointer(&guard->stats_top, g_ptr_array_unref);
 }
 
 static void
@@ -114,74 +407,57 @@ focus_guard_update_stats_ui(FocusGuard *guard)
     return;
   }
 
-  focus_guard_refresh_day(guard);
   focus_guard_update_stats_header(guard);
 
   const char *empty_text = NULL;
-  GHashTable *source = NULL;
-  if (guard->view == FOCUS_GUARD_VIEW_TASK) {
-    source = guard->usage_task_view;
-    empty_text = guard->view_task_id != NULL
-                     ? "No app activity yet for this task."
-                     : "Select a task to view stats.";
-  } else if (!guard->config.global_stats_enabled) {
-    source = NULL;
-    empty_text = "Global stats disabled.";
-  } else {
-    source = guard->usage_global;
-    empty_text = "No app activity yet.";
-  }
-
-  GPtrArray *entries = g_ptr_array_new();
-  if (source != NULL) {
-    GHashTableIter iter;
-    gpointer key = NULL;
-    gpointer value = NULL;
-    g_hash_table_iter_init(&iter, source);
-    while (g_hash_table_iter_next(&iter, &key, &value)) {
-      FocusGuardUsage *usage = value;
-      if (usage == NULL || usage->usec_total <= 0) {
-        continue;
-      }
-      g_ptr_array_add(entries, usage);
-    }
-  }
+  GHashTable *source = focus_guard_stats_source(guard, &empty_text);
 
-  g_ptr_array_sort(entries, focus_guard_usage_compare_desc);
-
-  focus_guard_clear_list(guard->state->focus_stats_list);
+  if (guard->stats_top == NULL) {
+    guard->stats_top = g_ptr_array_new_with_free_func(g_free);
+    guard->stats_rank_stale = TRUE;
+  }
+  if (guard->stats_rows == NULL) {
+    guard->stats_rows = g_ptr_array_new_with_free_func(focus_guard_stats_row_free);
+  }
+  /* A key missing from the table means it was reloaded under the ranking. */
+  for (guint i = 0; !guard->stats_rank_stale && i < guard->stats_top->len; i++) {
+    guard->stats_rank_stale =
+        source == NULL ||
+        !g_hash_table_contains(source, g_ptr_array_index(guard->stats_top, i));
+  }
+  if (guard->stats_rank_stale) {
+    focus_guard_stats_rank_rebuild(guard, source);
+  }
 
-  const guint max_rows = 5;
+  GPtrArray *wanted = g_ptr_array_new_with_free_func(focus_guard_stats_wanted_free);
   guint shown = 0;
-  for (guint i = 0; i < entries->len && shown < max_rows; i++) {
-    FocusGuardUsage *usage = g_ptr_array_index(entries, i);
-    if (usage == NULL) {
-      continue;
-    }
-
-    GtkWidget *row = gtk_list_box_row_new();
-    GtkWidget *box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 8);
-    gtk_widget_set_hexpand(box, TRUE);
+  for (guint i = 0; i < guard->stats_top->len; i++) {
+    FocusGuardUsage *usage = g_hash_table_lookup(source, g_ptr_array_index(guard->stats_top, i));
 
-    GtkWidget *app_label = gtk_label_new(usage->display_name);
-    gtk_widget_add_css_class(app_label, "focus-guard-app");
-    gtk_widget_set_halign(app_label, GTK_ALIGN_START);
-    gtk_label_set_ellipsize(GTK_LABEL(app_label), PANGO_ELLIPSIZE_END);
-    gtk_widget_set_hexpand(app_label, TRUE);
+    /* Apps with per-domain time (the browser) expand on activation. */
+    gboolean has_domains =
+        usage->domains != NULL && g_hash_table_size(usage->domains) > 0;
+    gboolean expanded =
+        has_domains && g_strcmp0(guard->stats_expanded_app, usage->key) == 0;
 
-    char *duration = focus_guard_format_duration(usage->usec_total / G_USEC_PER_SEC);
-    GtkWidget *time_label = gtk_label_new(duration);
-    gtk_widget_add_css_class(time_label, "focus-guard-time");
-    gtk_widget_set_halign(time_label, GTK_ALIGN_END);
-    g_free(duration);
-
-    gtk_box_append(GTK_BOX(box), app_label);
-    gtk_box_append(GTK_BOX(box), time_label);
-    gtk_list_box_row_set_child(GTK_LIST_BOX_ROW(row), box);
-    gtk_list_box_append(GTK_LIST_BOX(guard->state->focus_stats_list), row);
+    FocusGuardStatsWanted *entry = g_new0(FocusGuardStatsWanted, 1);
+    entry->key = g_strdup(usage->key);
+    entry->name = has_domains ? g_strdup_printf("%s %s",
+                                                expanded ? "\u25BE" : "\u25B8",
+                                                usage->display_name)
+                              : g_strdup(usage->display_name);
+    entry->usec_total = usage->usec_total;
+    entry->activatable = has_domains;
+    g_ptr_array_add(wanted, entry);
+    if (expanded) {
+      focus_guard_append_domain_wanted(wanted, usage);
+    }
     shown++;
   }
 
+  focus_guard_sync_stats_rows(guard, wanted);
+  g_ptr_array_unref(wanted);
+
   if (guard->state->focus_stats_empty_label != NULL) {
     gtk_label_set_text(GTK_LABEL(guard->state->focus_stats_empty_label),
                        empty_text ? empty_text : "No app activity yet.");
@@ -189,5 +465,4 @@ focus_guard_update_stats_ui(FocusGuard *guard)
   }
 
   guard->usage_dirty = FALSE;
-  g_ptr_array_free(entries, TRUE);
 }
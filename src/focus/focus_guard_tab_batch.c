@@ -0,0 +1,344 @@
+#include "focus/focus_guard_internal.h"
+
+#include "focus/relevance_cache.h"
+#include "focus/relevance_embeddings.h"
+
+/* Scores every open tab against the task in one embedding request so that
+ * switching to a tab can show its verdict from the cache right away. Tabs
+ * that land in the uncertain band are left to the per-page check. */
+
+#define FOCUS_GUARD_TAB_BATCH_JOB "tab-batch"
+/* Each tab is still fetched over CDP (up to 5 s when it hangs), so a round
+ * is capped; the most recently used tabs go first and the rest follow in
+ * the next round. */
+#define FOCUS_GUARD_TAB_BATCH_MAX_TABS 16
+#define FOCUS_GUARD_TAB_BATCH_DEADLINE_SECONDS 90
+
+typedef struct {
+  GWeakRef window_ref;
+  char *task_title;
+  char *task_key;
+  char *embed_model;
+  double embed_relevant_threshold;
+  double embed_irrelevant_threshold;
+  guint port;
+  GPtrArray *tabs;
+  RelevanceEmbeddings *embeddings;
+  TrafilaturaClient *trafilatura;
+} FocusGuardTabBatchContext;
+
+typedef struct {
+  char *url;
+  guint64 fingerprint;
+  FocusGuardRelevance verdict;
+} FocusGuardTabVerdict;
+
+typedef struct {
+  GPtrArray *verdicts;
+  guint scored;
+} FocusGuardTabBatchResult;
+
+static void
+focus_guard_tab_copy_free(gpointer data)
+{
+  ChromeCdpTab *tab = data;
+  if (tab == NULL) {
+    return;
+  }
+
+  g_free(tab->id);
+  g_free(tab->title);
+  g_free(tab->url);
+  g_free(tab);
+}
+
+static void
+focus_guard_tab_verdict_free(gpointer data)
+{
+  FocusGuardTabVerdict *verdict = data;
+  if (verdict == NULL) {
+    return;
+  }
+
+  g_free(verdict->url);
+  g_free(verdict);
+}
+
+static void
+focus_guard_tab_batch_result_free(gpointer data)
+{
+  FocusGuardTabBatchResult *result = data;
+  if (result == NULL) {
+    return;
+  }
+
+  g_ptr_array_unref(result->verdicts);
+  g_free(result);
+}
+
+static void
+focus_guard_tab_batch_context_free(gpointer data)
+{
+  FocusGuardTabBatchContext *context = data;
+  if (context == NULL) {
+    return;
+  }
+
+  g_weak_ref_clear(&context->window_ref);
+  g_free(context->task_title);
+  g_free(context->task_key);
+  g_free(context->embed_model);
+  g_ptr_array_unref(context->tabs);
+  relevance_embeddings_unref(context->embeddings);
+  trafilatura_client_unref(context->trafilatura);
+  g_free(context);
+}
+
+static void
+focus_guard_tab_batch_task(GTask *task,
+                           gpointer source_object,
+                           gpointer task_data,
+                           GCancellable *cancellable)
+{
+  (void)source_object;
+  FocusGuardTabBatchContext *context = task_data;
+
+  GPtrArray *urls = g_ptr_array_new();
+  GArray *fingerprints = g_array_new(FALSE, FALSE, sizeof(guint64));
+  GPtrArray *page_texts = g_ptr_array_new_with_free_func(g_free);
+  GError *error = NULL;
+
+  for (guint i = 0; i < context->tabs->len; i++) {
+    const ChromeCdpTab *tab = g_ptr_array_index(context->tabs, i);
+    ChromeCdpPage *page = chrome_cdp_fetch_target_sync(context->port,
+                                                       tab->id,
+                                                       tab->title,
+                                                       CHROME_CDP_FETCH_HTML,
+                                                       cancellable,
+                                                       &error);
+    if (page == NULL) {
+      if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        break;
+      }
+      g_debug("Tab batch skipped %s: %s", tab->url, error->message);
+      g_clear_error(&error);
+      continue;
+    }
+
+    focus_guard_extract_main_content(context->trafilatura, page, cancellable);
+
+    /* Keyed by the tracker's URL, which is what a tab switch looks up. */
+    guint64 fingerprint = relevance_cache_fingerprint(page->text);
+    g_ptr_array_add(urls, tab->url);
+    g_array_append_val(fingerprints, fingerprint);
+    g_ptr_array_add(page_texts,
+                    relevance_embeddings_page_text(page->title, page->url, page->text));
+    chrome_cdp_page_free(page);
+  }
+
+  if (error == NULL) {
+    g_cancellable_set_error_if_cancelled(cancellable, &error);
+  }
+
+  double *similarities = g_new0(double, MAX(page_texts->len, 1));
+  guint scored = page_texts->len;
+  g_ptr_array_add(page_texts, NULL);
+  if (error == NULL && scored > 0) {
+    relevance_embeddings_score_batch_sync(context->embeddings,
+                                          context->embed_model,
+                                          context->task_key,
+                                          context->task_title,
+                                          (const char *const *)page_texts->pdata,
+                                          similarities,
+                                          cancellable,
+                                          &error);
+  }
+
+  if (error != NULL) {
+    g_free(similarities);
+    g_ptr_array_unref(page_texts);
+    g_array_unref(fingerprints);
+    g_ptr_array_unref(urls);
+    g_task_return_error(task, error);
+    return;
+  }
+
+  FocusGuardTabBatchResult *result = g_new0(FocusGuardTabBatchResult, 1);
+  result->verdicts = g_ptr_array_new_with_free_func(focus_guard_tab_verdict_free);
+  result->scored = scored;
+  for (guint i = 0; i < scored; i++) {
+    FocusGuardRelevance verdict = FOCUS_GUARD_RELEVANCE_UNKNOWN;
+    if (similarities[i] >= context->embed_relevant_threshold) {
+      verdict = FOCUS_GUARD_RELEVANCE_RELEVANT;
+    } else if (similarities[i] <= context->embed_irrelevant_threshold) {
+      verdict = FOCUS_GUARD_RELEVANCE_IRRELEVANT;
+    }
+    if (verdict == FOCUS_GUARD_RELEVANCE_UNKNOWN) {
+      continue;
+    }
+
+    FocusGuardTabVerdict *entry = g_new0(FocusGuardTabVerdict, 1);
+    entry->url = g_strdup(g_ptr_array_index(urls, i));
+    entry->fingerprint = g_array_index(fingerprints, guint64, i);
+    entry->verdict = verdict;
+    g_ptr_array_add(result->verdicts, entry);
+  }
+
+  g_free(similarities);
+  g_ptr_array_unref(page_texts);
+  g_array_unref(fingerprints);
+  g_ptr_array_unref(urls);
+  g_task_return_pointer(task, result, focus_guard_tab_batch_result_free);
+}
+
+static void
+focus_guard_on_tab_batch_complete(GObject *source_object,
+                                  GAsyncResult *res,
+                                  gpointer user_data)
+{
+  (void)source_object;
+  (void)user_data;
+  FocusGuardTabBatchContext *context = g_task_get_task_data(G_TASK(res));
+  if (context == NULL) {
+    return;
+  }
+
+  GtkWindow *window = g_weak_ref_get(&context->window_ref);
+  if (window == NULL) {
+    return;
+  }
+
+  AppState *state = g_object_get_data(G_OBJECT(window), "app-state");
+  FocusGuard *guard = state != NULL ? state->focus_guard : NULL;
+  if (guard == NULL) {
+    g_object_unref(window);
+    return;
+  }
+
+  GError *error = NULL;
+  FocusGuardTabBatchResult *result = g_task_propagate_pointer(G_TASK(res), &error);
+  if (result == NULL) {
+    if (error != NULL) {
+      g_debug("Tab batch failed: %s", error->message);
+      g_clear_error(&error);
+    }
+    g_object_unref(window);
+    return;
+  }
+
+  gint64 now_utc = g_get_real_time() / G_USEC_PER_SEC;
+  for (guint i = 0; i < result->verdicts->len; i++) {
+    const FocusGuardTabVerdict *entry = g_ptr_array_index(result->verdicts, i);
+    relevance_cache_insert(guard->relevance_cache,
+                           context->task_key,
+                           entry->url,
+                           entry->fingerprint,
+                           entry->verdict,
+                           now_utc);
+    usage_stats_store_put_verdict(guard->stats_store,
+                                  context->task_key,
+                                  entry->url,
+                                  entry->fingerprint,
+                                  entry->verdict,
+                                  now_utc);
+  }
+
+  guard->tab_batch_rounds++;
+  guard->tab_batch_decided += result->verdicts->len;
+  g_debug("Tab batch scored %u of %u tabs in one request, %u decided",
+          result->scored,
+          context->tabs->len,
+          result->verdicts->len);
+
+  focus_guard_tab_batch_result_free(result);
+  g_object_unref(window);
+}
+
+static gboolean
+focus_guard_tab_batch_wanted(const FocusGuard *guard, gint64 now_us)
+{
+  return guard->config.batch_tabs_enabled && guard->config.warnings_enabled &&
+         guard->config.chrome_ollama_enabled && guard->config.ollama_embed_model != NULL &&
+         focus_guard_is_ollama_available(guard) &&
+         chrome_cdp_tab_tracker_is_connected(guard->chrome_tabs) &&
+         (guard->last_tab_batch_us == 0 ||
+          now_us - guard->last_tab_batch_us >=
+              (gint64)guard->config.batch_tabs_interval_seconds * G_USEC_PER_SEC);
+}
+
+void
+focus_guard_maybe_score_tabs(FocusGuard *guard, const char *task_title, gint64 now_us)
+{
+  if (guard == NULL || guard->state == NULL || task_title == NULL ||
+      *task_title == '\0' || !focus_guard_tab_batch_wanted(guard, now_us) ||
+      focus_scheduler_is_busy(guard->scheduler, FOCUS_GUARD_TAB_BATCH_JOB)) {
+    return;
+  }
+
+  guard->last_tab_batch_us = now_us;
+
+  char *task_key = relevance_cache_normalize_task(task_title);
+  gint64 now_utc = g_get_real_time() / G_USEC_PER_SEC;
+  GPtrArray *tabs = g_ptr_array_new_with_free_func(focus_guard_tab_copy_free);
+  GPtrArray *open_tabs = chrome_cdp_tab_tracker_list_tabs(guard->chrome_tabs);
+  for (guint i = 0; i < open_tabs->len && tabs->len < FOCUS_GUARD_TAB_BATCH_MAX_TABS; i++) {
+    const ChromeCdpTab *tab = g_ptr_array_index(open_tabs, i);
+    if (tab->url == NULL ||
+        !(g_str_has_prefix(tab->url, "http://") || g_str_has_prefix(tab->url, "https://"))) {
+      continue;
+    }
+    if (relevance_cache_has_fresh_url(guard->relevance_cache, task_key, tab->url, now_utc)) {
+      continue;
+    }
+
+    ChromeCdpTab *copy = g_new0(ChromeCdpTab, 1);
+    copy->id = g_strdup(tab->id);
+    copy->title = g_strdup(tab->title);
+    copy->url = g_strdup(tab->url);
+    copy->last_activated_us = tab->last_activated_us;
+    g_ptr_array_add(tabs, copy);
+  }
+  g_ptr_array_unref(open_tabs);
+
+  if (tabs->len == 0) {
+    g_ptr_array_unref(tabs);
+    g_free(task_key);
+    return;
+  }
+
+  FocusGuardTabBatchContext *context = g_new0(FocusGuardTabBatchContext, 1);
+  g_weak_ref_init(&context->window_ref, G_OBJECT(guard->state->window));
+  context->task_title = g_strdup(task_title);
+  context->task_key = task_key;
+  context->embed_model = g_strdup(guard->config.ollama_embed_model);
+  context->embed_relevant_threshold = guard->config.embed_relevant_threshold;
+  context->embed_irrelevant_threshold = guard->config.embed_irrelevant_threshold;
+  context->port = guard->config.chrome_debug_port;
+  context->tabs = tabs;
+  context->embeddings = relevance_embeddings_ref(guard->relevance_embeddings);
+  if (trafilatura_client_is_usable(guard->trafilatura)) {
+    context->trafilatura = trafilatura_client_ref(guard->trafilatura);
+  }
+
+  focus_scheduler_submit(guard->scheduler,
+                         FOCUS_GUARD_TAB_BATCH_JOB,
+                         FOCUS_SCHEDULER_PRIORITY_LOW,
+                         g_get_monotonic_time() +
+                             FOCUS_GUARD_TAB_BATCH_DEADLINE_SECONDS * G_USEC_PER_SEC,
+                         focus_guard_tab_batch_task,
+                         context,
+                         focus_guard_tab_batch_context_free,
+                         focus_guard_on_tab_batch_complete,
+                         NULL);
+}
+
+void
+focus_guard_cancel_tab_batch(FocusGuard *guard)
+{
+  if (guard == NULL) {
+    return;
+  }
+
+  focus_scheduler_cancel(guard->scheduler, FOCUS_GUARD_TAB_BATCH_JOB);
+  guard->last_tab_batch_us = 0;
+}
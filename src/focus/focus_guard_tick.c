@@ -3,8 +3,11 @@
 #include "core/task_store.h"
 #include "focus/focus_guard_x11.h"
 
-#define USAGE_BUCKET_SECONDS 300
+/* How much of the open bucket a crash can lose at most. */
+#define USAGE_CHECKPOINT_SECONDS 5
 #define CHROME_RELEVANCE_INTERVAL_SECONDS 15
+/* Switching pages re-checks right away, but not more often than this. */
+#define CHROME_RELEVANCE_MIN_GAP_SECONDS 2
 
 static void
 focus_guard_clear_usage_table(GHashTable *table)
@@ -58,15 +61,17 @@ focus_guard_rotate_bucket(FocusGuard *guard, gint64 now_utc_sec)
     now_utc_sec = 0;
   }
 
-  gint64 bucket_start =
-      (now_utc_sec / USAGE_BUCKET_SECONDS) * USAGE_BUCKET_SECONDS;
+  gint64 bucket_seconds = usage_stats_store_get_bucket_seconds(guard->stats_store);
+  gint64 bucket_start = (now_utc_sec / bucket_seconds) * bucket_seconds;
 
   if (guard->bucket_start_utc == 0) {
     guard->bucket_start_utc = bucket_start;
     return;
   }
 
-  if (bucket_start != guard->bucket_start_utc) {
+  /* An import defers the flush, so the open bucket keeps its start until the
+   * import is done rather than being written under a later one. */
+  if (bucket_start != guard->bucket_start_utc && !guard->stats_import_active) {
     focus_guard_flush_bucket(guard);
     guard->bucket_start_utc = bucket_start;
   }
@@ -121,12 +126,15 @@ focus_guard_on_tick(gpointer data)
       }
     }
     focus_guard_prune_history(guard);
-    guard->usage_dirty = TRUE;
+    focus_guard_invalidate_stats_rank(guard);
   }
 
   gint64 now_utc_sec = now_real_us / G_USEC_PER_SEC;
   focus_guard_rotate_bucket(guard, now_utc_sec);
 
+  focus_guard_poll_ollama(guard);
+  focus_guard_update_model_residency(guard);
+
   gboolean tracking = focus_guard_should_track(guard);
   PomodoroTask *active_task =
       tracking ? task_store_get_active(guard->state->store) : NULL;
@@ -143,13 +151,27 @@ focus_guard_on_tick(gpointer data)
     }
   }
 
+  /* Browser time is split by the active tab's domain, read from the tab
+   * tracker's table rather than asking Chrome again. A window title that
+   * matches no tab (DevTools, a dialog) counts as time without a domain. */
+  const char *domain = NULL;
+  if (elapsed_us > 0 && app_key != NULL && focus_guard_is_chrome_app(app_key)) {
+    const ChromeCdpTab *tab =
+        chrome_cdp_tab_tracker_find_active(guard->chrome_tabs, window_title);
+    domain = tab != NULL ? tab->domain : NULL;
+  }
+
   if (elapsed_us > 0 && app_key != NULL) {
     if (guard->config.global_stats_enabled && guard->usage_global != NULL) {
       FocusGuardUsage *usage =
           focus_guard_usage_get_or_create(guard->usage_global, app_key, app_name);
       if (usage != NULL) {
         usage->usec_total += elapsed_us;
-        guard->usage_dirty |= (guard->view == FOCUS_GUARD_VIEW_GLOBAL);
+        focus_guard_usage_add_domain(&usage->domains, domain, elapsed_us);
+        if (guard->view == FOCUS_GUARD_VIEW_GLOBAL) {
+          focus_guard_stats_rank_bump(guard, usage);
+          guard->usage_dirty = TRUE;
+        }
       }
 
       if (guard->bucket_global != NULL) {
@@ -157,6 +179,8 @@ focus_guard_on_tick(gpointer data)
             focus_guard_usage_get_or_create(guard->bucket_global, app_key, app_name);
         if (bucket_usage != NULL) {
           bucket_usage->usec_total += elapsed_us;
+          guard->bucket_checkpoint_dirty = TRUE;
+          focus_guard_usage_add_domain(&bucket_usage->domains, domain, elapsed_us);
         }
       }
     }
@@ -167,6 +191,8 @@ focus_guard_on_tick(gpointer data)
           focus_guard_bucket_task_get_or_create(guard, task_id, app_key, app_name);
       if (entry != NULL) {
         entry->usec_total += elapsed_us;
+        guard->bucket_checkpoint_dirty = TRUE;
+        focus_guard_usage_add_domain(&entry->domains, domain, elapsed_us);
       }
 
       if (guard->view == FOCUS_GUARD_VIEW_TASK &&
@@ -177,31 +203,61 @@ focus_guard_on_tick(gpointer data)
             focus_guard_usage_get_or_create(guard->usage_task_view, app_key, app_name);
         if (usage != NULL) {
           usage->usec_total += elapsed_us;
+          focus_guard_usage_add_domain(&usage->domains, domain, elapsed_us);
+          focus_guard_stats_rank_bump(guard, usage);
           guard->usage_dirty = TRUE;
         }
       }
     }
   }
 
+  if (guard->bucket_checkpoint_dirty &&
+      now_us - guard->last_checkpoint_us >= (gint64)USAGE_CHECKPOINT_SECONDS * G_USEC_PER_SEC) {
+    guard->last_checkpoint_us = now_us;
+    focus_guard_checkpoint_bucket(guard);
+  }
+
   const char *task_title =
       active_task != NULL ? pomodoro_task_get_title(active_task) : NULL;
 
   gboolean chrome_relevance_allowed =
-      tracking && guard->config.warnings_enabled && guard->ollama_available &&
-      guard->config.chrome_ollama_enabled &&
-      guard->config.ollama_model != NULL &&
-      app_key != NULL && focus_guard_is_chrome_app(app_key);
+      tracking && focus_guard_chrome_relevance_allowed(guard, app_key);
 
   if (!chrome_relevance_allowed) {
     focus_guard_clear_relevance_warning(guard);
-    if (guard->relevance_inflight) {
+    if (guard->relevance_page_key != NULL) {
       focus_guard_cancel_relevance_check(guard);
     }
-  } else if (!guard->relevance_inflight &&
-             now_us - guard->last_relevance_check_us >=
-                 (gint64)CHROME_RELEVANCE_INTERVAL_SECONDS * G_USEC_PER_SEC) {
-    guard->last_relevance_check_us = now_us;
-    focus_guard_start_relevance_check(guard, window_title, task_title);
+  } else {
+    gint64 since_last_us = now_us - guard->last_relevance_check_us;
+    char *page_key = focus_guard_relevance_page_key(guard, window_title);
+    if (g_strcmp0(page_key, guard->relevance_page_key) != 0) {
+      /* A cached verdict (from an earlier check or a tab batch) costs
+       * nothing, so it is shown even inside the minimum gap. */
+      if (focus_guard_apply_cached_relevance(guard, window_title, task_title)) {
+        guard->last_relevance_check_us = now_us;
+      } else if (since_last_us >=
+                 (gint64)CHROME_RELEVANCE_MIN_GAP_SECONDS * G_USEC_PER_SEC) {
+        guard->last_relevance_check_us = now_us;
+        focus_guard_start_relevance_check(guard,
+                                          window_title,
+                                          task_title,
+                                          FOCUS_SCHEDULER_PRIORITY_HIGH);
+      }
+    } else if (!focus_guard_relevance_busy(guard) &&
+               since_last_us >=
+                   (gint64)CHROME_RELEVANCE_INTERVAL_SECONDS * G_USEC_PER_SEC) {
+      guard->last_relevance_check_us = now_us;
+      focus_guard_start_relevance_check(guard,
+                                        window_title,
+                                        task_title,
+                                        FOCUS_SCHEDULER_PRIORITY_NORMAL);
+    }
+    g_free(page_key);
+  }
+
+  if (tracking && task_title != NULL) {
+    focus_guard_maybe_score_tabs(guard, task_title, now_us);
   }
 
   if (!tracking || !guard->config.warnings_enabled || app_key == NULL) {
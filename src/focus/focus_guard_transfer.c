@@ -0,0 +1,251 @@
+#include "focus/focus_guard_internal.h"
+
+#include "storage/usage_stats_export.h"
+
+/* Export and import run on a GIO worker with their own connection (WAL lets
+ * an export read beside the guard's writes). Progress is published through
+ * atomics and picked up by a main-loop timer, so the worker never touches
+ * widgets. */
+
+#define FOCUS_GUARD_TRANSFER_PROGRESS_MS 250
+
+typedef struct {
+  GWeakRef window_ref;
+  GWeakRef label_ref;
+  GFile *file;
+  UsageStatsFormat format;
+  gboolean import;
+  GTimeZone *timezone;
+  gint rows_done;
+  gint rows_total;
+  guint progress_source;
+} FocusGuardTransferContext;
+
+static void
+focus_guard_transfer_context_free(gpointer data)
+{
+  FocusGuardTransferContext *context = data;
+  if (context == NULL) {
+    return;
+  }
+
+  if (context->progress_source != 0) {
+    g_source_remove(context->progress_source);
+  }
+  g_weak_ref_clear(&context->window_ref);
+  g_weak_ref_clear(&context->label_ref);
+  g_object_unref(context->file);
+  g_clear_pointer(&context->timezone, g_time_zone_unref);
+  g_free(context);
+}
+
+static void
+focus_guard_transfer_set_status(FocusGuardTransferContext *context, const char *text)
+{
+  GtkLabel *label = g_weak_ref_get(&context->label_ref);
+  if (label == NULL) {
+    return;
+  }
+
+  gtk_label_set_text(label, text);
+  gtk_widget_set_visible(GTK_WIDGET(label), TRUE);
+  g_object_unref(label);
+}
+
+static void
+focus_guard_transfer_progress(guint64 rows_done, gint64 rows_total, gpointer user_data)
+{
+  FocusGuardTransferContext *context = user_data;
+  g_atomic_int_set(&context->rows_done, (gint)MIN(rows_done, (guint64)G_MAXINT));
+  g_atomic_int_set(&context->rows_total, (gint)MIN(rows_total, (gint64)G_MAXINT));
+}
+
+static gboolean
+focus_guard_transfer_on_progress_timeout(gpointer user_data)
+{
+  FocusGuardTransferContext *context = user_data;
+  gint rows_done = g_atomic_int_get(&context->rows_done);
+  gint rows_total = g_atomic_int_get(&context->rows_total);
+
+  char *text = rows_total >= 0
+                   ? g_strdup_printf("%s %d of %d rows...",
+                                     context->import ? "Importing" : "Exporting",
+                                     rows_done,
+                                     rows_total)
+                   : g_strdup_printf("%s %d rows...",
+                                     context->import ? "Importing" : "Exporting",
+                                     rows_done);
+  focus_guard_transfer_set_status(context, text);
+  g_free(text);
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+focus_guard_transfer_task(GTask *task,
+                          gpointer source_object,
+                          gpointer task_data,
+                          GCancellable *cancellable)
+{
+  (void)source_object;
+  FocusGuardTransferContext *context = task_data;
+
+  UsageStatsStore *store = usage_stats_store_new();
+  if (store == NULL) {
+    g_task_return_new_error(task,
+                            G_IO_ERROR,
+                            G_IO_ERROR_FAILED,
+                            "Could not open the usage stats database");
+    return;
+  }
+  usage_stats_store_set_timezone(store, context->timezone);
+
+  guint64 rows = 0;
+  GError *error = NULL;
+  gboolean ok = context->import
+                    ? usage_stats_import_file(store,
+                                              context->file,
+                                              context->format,
+                                              focus_guard_transfer_progress,
+                                              context,
+                                              cancellable,
+                                              &rows,
+                                              &error)
+                    : usage_stats_export_file(store,
+                                              context->file,
+                                              context->format,
+                                              NULL,
+                                              0,
+                                              0,
+                                              focus_guard_transfer_progress,
+                                              context,
+                                              cancellable,
+                                              &rows,
+                                              &error);
+  usage_stats_store_free(store);
+
+  if (!ok) {
+    g_task_return_error(task, error);
+    return;
+  }
+  g_task_return_int(task, (gssize)MIN(rows, (guint64)G_MAXSSIZE));
+}
+
+static void
+focus_guard_on_transfer_complete(GObject *source_object,
+                                 GAsyncResult *res,
+                                 gpointer user_data)
+{
+  (void)source_object;
+  (void)user_data;
+  FocusGuardTransferContext *context = g_task_get_task_data(G_TASK(res));
+  if (context->progress_source != 0) {
+    g_source_remove(context->progress_source);
+    context->progress_source = 0;
+  }
+
+  GError *error = NULL;
+  gssize rows = g_task_propagate_int(G_TASK(res), &error);
+  if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    g_clear_error(&error);
+    return;
+  }
+
+  char *text = NULL;
+  if (error != NULL) {
+    g_warning("Stats %s failed: %s", context->import ? "import" : "export", error->message);
+    text = g_strdup_printf("%s failed: %s",
+                           context->import ? "Import" : "Export",
+                           error->message);
+    g_clear_error(&error);
+  } else {
+    char *name = g_file_get_basename(context->file);
+    text = g_strdup_printf("%s %" G_GSSIZE_FORMAT " rows %s %s",
+                           context->import ? "Imported" : "Exported",
+                           rows,
+                           context->import ? "from" : "to",
+                           name);
+    g_free(name);
+  }
+  focus_guard_transfer_set_status(context, text);
+  g_free(text);
+
+  GtkWindow *window = g_weak_ref_get(&context->window_ref);
+  if (window == NULL) {
+    return;
+  }
+
+  AppState *state = g_object_get_data(G_OBJECT(window), "app-state");
+  FocusGuard *guard = state != NULL ? state->focus_guard : NULL;
+  if (guard != NULL) {
+    g_clear_object(&guard->stats_transfer_cancellable);
+    if (context->import) {
+      guard->stats_import_active = FALSE;
+      focus_guard_sync_bucket_seconds(guard);
+      focus_guard_reload_stats(guard);
+    }
+  }
+  g_object_unref(window);
+}
+
+static gboolean
+focus_guard_start_transfer(FocusGuard *guard,
+                           GFile *file,
+                           GtkLabel *status_label,
+                           gboolean import)
+{
+  if (guard == NULL || guard->state == NULL || file == NULL ||
+      guard->stats_transfer_cancellable != NULL) {
+    return FALSE;
+  }
+
+  FocusGuardTransferContext *context = g_new0(FocusGuardTransferContext, 1);
+  g_weak_ref_init(&context->window_ref, G_OBJECT(guard->state->window));
+  g_weak_ref_init(&context->label_ref, status_label != NULL ? G_OBJECT(status_label) : NULL);
+  context->file = g_object_ref(file);
+  char *path = g_file_get_path(file);
+  context->format = usage_stats_format_for_path(path);
+  g_free(path);
+  context->import = import;
+  if (guard->local_timezone != NULL) {
+    context->timezone = g_time_zone_ref(guard->local_timezone);
+  }
+  context->rows_total = -1;
+
+  /* Write what is pending so an export includes it. During an import the
+   * open bucket is held back, so the buckets it replaces cannot swallow it. */
+  focus_guard_flush_bucket(guard);
+  guard->stats_import_active = import;
+
+  guard->stats_transfer_cancellable = g_cancellable_new();
+  focus_guard_transfer_set_status(context, import ? "Importing..." : "Exporting...");
+  context->progress_source = g_timeout_add(FOCUS_GUARD_TRANSFER_PROGRESS_MS,
+                                           focus_guard_transfer_on_progress_timeout,
+                                           context);
+
+  GTask *task = g_task_new(NULL,
+                           guard->stats_transfer_cancellable,
+                           focus_guard_on_transfer_complete,
+                           NULL);
+  g_task_set_task_data(task, context, focus_guard_transfer_context_free);
+  g_task_run_in_thread(task, focus_guard_transfer_task);
+  g_object_unref(task);
+  return TRUE;
+}
+
+gboolean
+focus_guard_export_stats(FocusGuard *guard, GFile *file, GtkLabel *status_label)
+{
+  return focus_guard_start_transfer(guard, file, status_label, FALSE);
+}
+
+gboolean
+focus_guard_import_stats(FocusGuard *guard, GFile *file, GtkLabel *status_label)
+{
+  return focus_guard_start_transfer(guard, file, status_label, TRUE);
+}
+
+gboolean
+focus_guard_is_transferring_stats(const FocusGuard *guard)
+{
+  return guard != NULL && guard->stats_transfer_cancellable != NULL;
+}
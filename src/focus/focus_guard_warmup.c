@@ -0,0 +1,249 @@
+#include "focus/focus_guard_internal.h"
+
+#include "core/pomodoro_timer.h"
+#include "core/task_store.h"
+#include "focus/ollama_client.h"
+
+#define FOCUS_GUARD_KEEP_ALIVE_MARGIN_SECONDS 120
+/* A paused phase stops the remaining time, so the keep-alive sent at
+ * warm-up runs out after the margin; re-check well before that. */
+#define FOCUS_GUARD_WARM_REFRESH_SECONDS 60
+#define FOCUS_GUARD_WARM_RETRY_SECONDS 15
+#define FOCUS_GUARD_RESIDENCY_JOB_PREFIX "model-residency:"
+
+typedef struct {
+  char *model;
+  guint keep_alive_seconds;
+  gboolean refresh;
+} FocusGuardWarmupContext;
+
+static void
+focus_guard_warmup_context_free(gpointer data)
+{
+  FocusGuardWarmupContext *context = data;
+  if (context == NULL) {
+    return;
+  }
+
+  g_free(context->model);
+  g_free(context);
+}
+
+static void
+focus_guard_warmup_task(GTask *task,
+                        gpointer source_object,
+                        gpointer task_data,
+                        GCancellable *cancellable)
+{
+  (void)source_object;
+  FocusGuardWarmupContext *context = task_data;
+  GError *error = NULL;
+
+  if (context->keep_alive_seconds > 0) {
+    gboolean loaded =
+        ollama_client_is_model_loaded_sync(context->model, cancellable, &error);
+    if (error != NULL) {
+      g_debug("Ollama warm-up skipped: %s", error->message);
+      g_task_return_error(task, error);
+      return;
+    }
+
+    gint64 start_us = g_get_monotonic_time();
+    if (!ollama_client_keep_alive_sync(context->model,
+                                       context->keep_alive_seconds,
+                                       cancellable,
+                                       &error)) {
+      g_debug("Ollama warm-up failed: %s", error->message);
+      g_task_return_error(task, error);
+      return;
+    }
+
+    g_debug("Ollama model %s %s for %us (%" G_GINT64_FORMAT " ms)",
+            context->model,
+            loaded ? "already resident, kept" : "loaded",
+            context->keep_alive_seconds,
+            (g_get_monotonic_time() - start_us) / 1000);
+    g_task_return_boolean(task, loaded);
+    return;
+  }
+
+  if (!ollama_client_keep_alive_sync(context->model, 0, cancellable, &error)) {
+    g_debug("Ollama release failed: %s", error->message);
+    g_task_return_error(task, error);
+    return;
+  }
+
+  g_task_return_boolean(task, TRUE);
+}
+
+static void
+focus_guard_on_residency_done(GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  (void)source_object;
+  FocusGuard *guard = user_data;
+  FocusGuardWarmupContext *context = g_task_get_task_data(G_TASK(res));
+  GError *error = NULL;
+  gboolean was_loaded = g_task_propagate_boolean(G_TASK(res), &error);
+  if (context == NULL || context->keep_alive_seconds == 0 ||
+      g_strcmp0(context->model, guard->warm_model) != 0) {
+    g_clear_error(&error);
+    return;
+  }
+
+  /* A failed warm-up is retried sooner than the regular refresh. A refresh
+   * that did not find the model in /api/ps has just loaded it again. */
+  if (error != NULL) {
+    if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+      guard->warm_refresh_us =
+          g_get_monotonic_time() + FOCUS_GUARD_WARM_RETRY_SECONDS * G_USEC_PER_SEC;
+    }
+    g_error_free(error);
+    return;
+  }
+
+  if (context->refresh && !was_loaded) {
+    g_info("Ollama had unloaded %s during the focus phase; loaded it again", context->model);
+  }
+}
+
+/* Jobs are keyed by model: a newer request for a model supersedes its older
+ * one, while releasing one model never drops the warm-up of the next. */
+static char *
+focus_guard_residency_job_key(const char *model)
+{
+  return g_strconcat(FOCUS_GUARD_RESIDENCY_JOB_PREFIX, model, NULL);
+}
+
+/* Warm-up, refresh and release share one single-worker scheduler, so they
+ * reach Ollama in the order they were decided. Without a scheduler
+ * (shutdown) the job runs detached. */
+static void
+focus_guard_run_warmup(FocusGuard *guard,
+                       const char *model,
+                       guint keep_alive_seconds,
+                       gboolean refresh)
+{
+  FocusGuardWarmupContext *context = g_new0(FocusGuardWarmupContext, 1);
+  context->model = g_strdup(model);
+  context->keep_alive_seconds = keep_alive_seconds;
+  context->refresh = refresh;
+
+  if (keep_alive_seconds > 0) {
+    guard->warm_refresh_us =
+        g_get_monotonic_time() + FOCUS_GUARD_WARM_REFRESH_SECONDS * G_USEC_PER_SEC;
+  }
+
+  if (guard->residency_scheduler == NULL) {
+    GTask *task = g_task_new(NULL, NULL, NULL, NULL);
+    g_task_set_task_data(task, context, focus_guard_warmup_context_free);
+    g_task_run_in_thread(task, focus_guard_warmup_task);
+    g_object_unref(task);
+    return;
+  }
+
+  char *key = focus_guard_residency_job_key(model);
+  focus_scheduler_submit(guard->residency_scheduler,
+                         key,
+                         FOCUS_SCHEDULER_PRIORITY_NORMAL,
+                         0,
+                         focus_guard_warmup_task,
+                         context,
+                         focus_guard_warmup_context_free,
+                         focus_guard_on_residency_done,
+                         guard);
+  g_free(key);
+}
+
+static gboolean
+focus_guard_model_wanted(const FocusGuard *guard)
+{
+  if (guard == NULL || guard->state == NULL || guard->state->timer == NULL ||
+      guard->state->store == NULL) {
+    return FALSE;
+  }
+
+  if (!guard->config.warnings_enabled || !focus_guard_is_ollama_available(guard) ||
+      !guard->config.chrome_ollama_enabled || guard->config.ollama_model == NULL) {
+    return FALSE;
+  }
+
+  /* A paused focus phase keeps the model; breaks and stop release it. */
+  PomodoroTimer *timer = guard->state->timer;
+  return pomodoro_timer_get_state(timer) != POMODORO_TIMER_STOPPED &&
+         pomodoro_timer_get_phase(timer) == POMODORO_PHASE_FOCUS &&
+         task_store_get_active(guard->state->store) != NULL;
+}
+
+void
+focus_guard_poll_ollama(FocusGuard *guard)
+{
+  if (guard == NULL || !guard->config.chrome_ollama_enabled) {
+    return;
+  }
+
+  /* Cheap when the catalog is fresh; otherwise starts one async probe. */
+  ollama_catalog_refresh_async(guard->ollama_catalog, FALSE, NULL, NULL, NULL);
+}
+
+guint
+focus_guard_model_keep_alive_seconds(const FocusGuard *guard)
+{
+  gint64 remaining = 0;
+  if (guard != NULL && guard->state != NULL && guard->state->timer != NULL) {
+    remaining = pomodoro_timer_get_remaining_seconds(guard->state->timer);
+  }
+
+  return (guint)MAX(remaining, 0) + FOCUS_GUARD_KEEP_ALIVE_MARGIN_SECONDS;
+}
+
+void
+focus_guard_release_model(FocusGuard *guard)
+{
+  if (guard == NULL || guard->warm_model == NULL) {
+    return;
+  }
+
+  focus_guard_run_warmup(guard, guard->warm_model, 0, FALSE);
+  g_clear_pointer(&guard->warm_model, g_free);
+}
+
+void
+focus_guard_update_model_residency(FocusGuard *guard)
+{
+  if (guard == NULL) {
+    return;
+  }
+
+  if (!focus_guard_model_wanted(guard)) {
+    /* The extraction helper follows the model: resident only while focusing. */
+    trafilatura_client_stop(guard->trafilatura);
+    focus_guard_release_model(guard);
+    return;
+  }
+
+  if (g_strcmp0(guard->warm_model, guard->config.ollama_model) == 0) {
+    /* Re-extend the keep-alive so a long pause does not let Ollama unload
+     * the model; an in-flight warm-up is left to finish. */
+    if (g_get_monotonic_time() < guard->warm_refresh_us) {
+      return;
+    }
+
+    char *key = focus_guard_residency_job_key(guard->warm_model);
+    gboolean busy = focus_scheduler_is_busy(guard->residency_scheduler, key);
+    g_free(key);
+    if (!busy) {
+      focus_guard_run_warmup(guard,
+                             guard->warm_model,
+                             focus_guard_model_keep_alive_seconds(guard),
+                             TRUE);
+    }
+    return;
+  }
+
+  focus_guard_release_model(guard);
+  guard->warm_model = g_strdup(guard->config.ollama_model);
+  focus_guard_run_warmup(guard,
+                         guard->warm_model,
+                         focus_guard_model_keep_alive_seconds(guard),
+                         FALSE);
+}
@@ -0,0 +1,196 @@
+#include "focus/focus_http.h"
+
+/* One long-lived session per endpoint keeps its connections alive between
+ * relevance checks. Sessions are never freed; they live as long as the
+ * process. Sharing a session between worker threads (sync requests, the CDP
+ * websocket) and the main loop (async requests) needs libsoup 3.2 or newer,
+ * which meson.build requires; async requests run in the caller's
+ * thread-default main context. */
+
+typedef struct {
+  const char *name;
+  guint timeout_seconds;
+} FocusHttpEndpointInfo;
+
+static const FocusHttpEndpointInfo focus_http_endpoints[FOCUS_HTTP_ENDPOINT_COUNT] = {
+    [FOCUS_HTTP_OLLAMA_PROBE] = {"ollama-probe", 3},
+    /* Generation can sit silent while a model loads. */
+    [FOCUS_HTTP_OLLAMA] = {"ollama", 120},
+    [FOCUS_HTTP_CHROME] = {"chrome", 5},
+};
+
+static GMutex focus_http_mutex;
+static FocusHttpStats focus_http_stats[FOCUS_HTTP_ENDPOINT_COUNT];
+
+const char *
+focus_http_endpoint_name(FocusHttpEndpoint endpoint)
+{
+  if (endpoint >= FOCUS_HTTP_ENDPOINT_COUNT) {
+    return "unknown";
+  }
+
+  return focus_http_endpoints[endpoint].name;
+}
+
+void
+focus_http_record(FocusHttpEndpoint endpoint, gint64 start_us, gboolean ok)
+{
+  if (endpoint >= FOCUS_HTTP_ENDPOINT_COUNT) {
+    return;
+  }
+
+  guint64 elapsed_us = (guint64)MAX(g_get_monotonic_time() - start_us, 0);
+  g_mutex_lock(&focus_http_mutex);
+  FocusHttpStats *stats = &focus_http_stats[endpoint];
+  stats->requests++;
+  if (!ok) {
+    stats->failures++;
+  }
+  stats->total_us += elapsed_us;
+  stats->max_us = MAX(stats->max_us, elapsed_us);
+  g_mutex_unlock(&focus_http_mutex);
+}
+
+void
+focus_http_get_stats(FocusHttpEndpoint endpoint, FocusHttpStats *stats_out)
+{
+  if (stats_out == NULL) {
+    return;
+  }
+
+  if (endpoint >= FOCUS_HTTP_ENDPOINT_COUNT) {
+    *stats_out = (FocusHttpStats){0};
+    return;
+  }
+
+  g_mutex_lock(&focus_http_mutex);
+  *stats_out = focus_http_stats[endpoint];
+  g_mutex_unlock(&focus_http_mutex);
+}
+
+#if HAVE_CHROME_OLLAMA
+
+static SoupSession *focus_http_sessions[FOCUS_HTTP_ENDPOINT_COUNT];
+
+SoupSession *
+focus_http_get_session(FocusHttpEndpoint endpoint)
+{
+  g_return_val_if_fail(endpoint < FOCUS_HTTP_ENDPOINT_COUNT, NULL);
+
+  g_mutex_lock(&focus_http_mutex);
+  if (focus_http_sessions[endpoint] == NULL) {
+    focus_http_sessions[endpoint] =
+        soup_session_new_with_options("timeout",
+                                      focus_http_endpoints[endpoint].timeout_seconds,
+                                      "idle-timeout",
+                                      0,
+                                      NULL);
+  }
+  SoupSession *session = focus_http_sessions[endpoint];
+  g_mutex_unlock(&focus_http_mutex);
+  return session;
+}
+
+static gboolean
+focus_http_message_ok(SoupMessage *message)
+{
+  guint status = soup_message_get_status(message);
+  return status >= 200 && status < 400;
+}
+
+GBytes *
+focus_http_send_and_read(FocusHttpEndpoint endpoint,
+                         SoupMessage *message,
+                         GCancellable *cancellable,
+                         GError **error)
+{
+  gint64 start_us = g_get_monotonic_time();
+  GBytes *bytes = soup_session_send_and_read(focus_http_get_session(endpoint),
+                                             message,
+                                             cancellable,
+                                             error);
+  focus_http_record(endpoint, start_us, bytes != NULL && focus_http_message_ok(message));
+  return bytes;
+}
+
+GInputStream *
+focus_http_send(FocusHttpEndpoint endpoint,
+                SoupMessage *message,
+                GCancellable *cancellable,
+                GError **error)
+{
+  /* Latency here is time to response headers; the body is streamed by the
+   * caller. */
+  gint64 start_us = g_get_monotonic_time();
+  GInputStream *stream = soup_session_send(focus_http_get_session(endpoint),
+                                           message,
+                                           cancellable,
+                                           error);
+  focus_http_record(endpoint, start_us, stream != NULL && focus_http_message_ok(message));
+  return stream;
+}
+
+typedef struct {
+  FocusHttpEndpoint endpoint;
+  gint64 start_us;
+  SoupMessage *message;
+} FocusHttpAsyncContext;
+
+static void
+focus_http_async_context_free(gpointer data)
+{
+  FocusHttpAsyncContext *context = data;
+  g_clear_object(&context->message);
+  g_free(context);
+}
+
+static void
+focus_http_on_read(GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  GTask *task = user_data;
+  FocusHttpAsyncContext *context = g_task_get_task_data(task);
+  GError *error = NULL;
+  GBytes *bytes =
+      soup_session_send_and_read_finish(SOUP_SESSION(source_object), res, &error);
+  focus_http_record(context->endpoint,
+                    context->start_us,
+                    bytes != NULL && focus_http_message_ok(context->message));
+
+  if (bytes == NULL) {
+    g_task_return_error(task, error);
+  } else {
+    g_task_return_pointer(task, bytes, (GDestroyNotify)g_bytes_unref);
+  }
+  g_object_unref(task);
+}
+
+void
+focus_http_send_and_read_async(FocusHttpEndpoint endpoint,
+                               SoupMessage *message,
+                               GCancellable *cancellable,
+                               GAsyncReadyCallback callback,
+                               gpointer user_data)
+{
+  FocusHttpAsyncContext *context = g_new0(FocusHttpAsyncContext, 1);
+  context->endpoint = endpoint;
+  context->start_us = g_get_monotonic_time();
+  context->message = g_object_ref(message);
+
+  GTask *task = g_task_new(NULL, cancellable, callback, user_data);
+  g_task_set_source_tag(task, focus_http_send_and_read_async);
+  g_task_set_task_data(task, context, focus_http_async_context_free);
+  soup_session_send_and_read_async(focus_http_get_session(endpoint),
+                                   message,
+                                   G_PRIORITY_DEFAULT,
+                                   cancellable,
+                                   focus_http_on_read,
+                                   task);
+}
+
+GBytes *
+focus_http_send_and_read_finish(GAsyncResult *result, GError **error)
+{
+  return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <gio/gio.h>
+#include <glib.h>
+
+#include "config.h"
+
+#if HAVE_CHROME_OLLAMA
+#include <libsoup/soup.h>
+#endif
+
+typedef enum {
+  FOCUS_HTTP_OLLAMA_PROBE = 0,
+  FOCUS_HTTP_OLLAMA,
+  FOCUS_HTTP_CHROME,
+  FOCUS_HTTP_ENDPOINT_COUNT
+} FocusHttpEndpoint;
+
+typedef struct {
+  guint64 requests;
+  guint64 failures;
+  guint64 total_us;
+  guint64 max_us;
+} FocusHttpStats;
+
+const char *focus_http_endpoint_name(FocusHttpEndpoint endpoint);
+void focus_http_record(FocusHttpEndpoint endpoint, gint64 start_us, gboolean ok);
+void focus_http_get_stats(FocusHttpEndpoint endpoint, FocusHttpStats *stats_out);
+
+#if HAVE_CHROME_OLLAMA
+SoupSession *focus_http_get_session(FocusHttpEndpoint endpoint);
+GBytes *focus_http_send_and_read(FocusHttpEndpoint endpoint,
+                                 SoupMessage *message,
+                                 GCancellable *cancellable,
+                                 GError **error);
+GInputStream *focus_http_send(FocusHttpEndpoint endpoint,
+                              SoupMessage *message,
+                              GCancellable *cancellable,
+                              GError **error);
+void focus_http_send_and_read_async(FocusHttpEndpoint endpoint,
+                                    SoupMessage *message,
+                                    GCancellable *cancellable,
+                                    GAsyncReadyCallback callback,
+                                    gpointer user_data);
+GBytes *focus_http_send_and_read_finish(GAsyncResult *result, GError **error);
+#endif
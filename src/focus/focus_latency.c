@@ -0,0 +1,141 @@
+#include "focus/focus_latency.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Each stage keeps its most recent samples in a ring; percentiles are taken
+ * over that window when asked for, so recording stays a few stores under a
+ * lock and old runs (a cold model, a restarted Chrome) age out on their own. */
+#define FOCUS_LATENCY_WINDOW 128
+
+typedef struct {
+  guint64 samples[FOCUS_LATENCY_WINDOW];
+  guint next;
+  guint filled;
+  guint64 total;
+} FocusLatencyRing;
+
+static const char *const focus_latency_stage_names[FOCUS_LATENCY_STAGE_COUNT] = {
+    [FOCUS_LATENCY_QUEUE] = "queue wait",
+    [FOCUS_LATENCY_CDP_LIST] = "CDP /json/list",
+    [FOCUS_LATENCY_CDP_CONNECT] = "CDP connect",
+    [FOCUS_LATENCY_CDP_EVALUATE] = "CDP evaluate",
+    [FOCUS_LATENCY_EXTRACT] = "extraction",
+    [FOCUS_LATENCY_EMBEDDING] = "embedding",
+    [FOCUS_LATENCY_PROMPT] = "prompt build",
+    [FOCUS_LATENCY_INFERENCE] = "Ollama inference",
+    [FOCUS_LATENCY_TOTAL] = "total",
+};
+
+static GMutex focus_latency_mutex;
+static FocusLatencyRing focus_latency_rings[FOCUS_LATENCY_STAGE_COUNT];
+
+const char *
+focus_latency_stage_name(FocusLatencyStage stage)
+{
+  if (stage >= FOCUS_LATENCY_STAGE_COUNT) {
+    return "unknown";
+  }
+
+  return focus_latency_stage_names[stage];
+}
+
+void
+focus_latency_record(FocusLatencyStage stage, gint64 start_us)
+{
+  if (stage >= FOCUS_LATENCY_STAGE_COUNT || start_us <= 0) {
+    return;
+  }
+
+  guint64 elapsed_us = (guint64)MAX(g_get_monotonic_time() - start_us, 0);
+  g_mutex_lock(&focus_latency_mutex);
+  FocusLatencyRing *ring = &focus_latency_rings[stage];
+  ring->samples[ring->next] = elapsed_us;
+  ring->next = (ring->next + 1) % FOCUS_LATENCY_WINDOW;
+  ring->filled = MIN(ring->filled + 1, FOCUS_LATENCY_WINDOW);
+  ring->total++;
+  g_mutex_unlock(&focus_latency_mutex);
+}
+
+static int
+focus_latency_compare(const void *a, const void *b)
+{
+  guint64 left = *(const guint64 *)a;
+  guint64 right = *(const guint64 *)b;
+  return (left > right) - (left < right);
+}
+
+static guint64
+focus_latency_percentile(const guint64 *sorted, guint count, guint percent)
+{
+  /* Nearest-rank: the smallest sample with at least percent% at or below it. */
+  guint rank = (count * percent + 99) / 100;
+  return sorted[MAX(rank, 1) - 1];
+}
+
+void
+focus_latency_get_summary(FocusLatencyStage stage,
+                          FocusLatencySummary *summary_out)
+{
+  if (summary_out == NULL) {
+    return;
+  }
+
+  *summary_out = (FocusLatencySummary){0};
+  if (stage >= FOCUS_LATENCY_STAGE_COUNT) {
+    return;
+  }
+
+  guint64 sorted[FOCUS_LATENCY_WINDOW];
+  g_mutex_lock(&focus_latency_mutex);
+  FocusLatencyRing *ring = &focus_latency_rings[stage];
+  guint count = ring->filled;
+  memcpy(sorted, ring->samples, sizeof(guint64) * count);
+  summary_out->samples = ring->total;
+  g_mutex_unlock(&focus_latency_mutex);
+
+  summary_out->window = count;
+  if (count == 0) {
+    return;
+  }
+
+  qsort(sorted, count, sizeof(guint64), focus_latency_compare);
+  summary_out->p50_us = focus_latency_percentile(sorted, count, 50);
+  summary_out->p95_us = focus_latency_percentile(sorted, count, 95);
+  summary_out->max_us = sorted[count - 1];
+}
+
+void
+focus_latency_append_report(GString *report)
+{
+  if (report == NULL) {
+    return;
+  }
+
+  for (guint i = 0; i < FOCUS_LATENCY_STAGE_COUNT; i++) {
+    FocusLatencySummary summary;
+    focus_latency_get_summary((FocusLatencyStage)i, &summary);
+    if (summary.window == 0) {
+      g_string_append_printf(report, "%-17s no samples\n",
+                             focus_latency_stage_name((FocusLatencyStage)i));
+      continue;
+    }
+
+    g_string_append_printf(report,
+                           "%-17s p50 %6.0f ms  p95 %6.0f ms  max %6.0f ms  (%"
+                           G_GUINT64_FORMAT " runs)\n",
+                           focus_latency_stage_name((FocusLatencyStage)i),
+                           summary.p50_us / 1000.0,
+                           summary.p95_us / 1000.0,
+                           summary.max_us / 1000.0,
+                           summary.samples);
+  }
+}
+
+void
+focus_latency_reset(void)
+{
+  g_mutex_lock(&focus_latency_mutex);
+  memset(focus_latency_rings, 0, sizeof(focus_latency_rings));
+  g_mutex_unlock(&focus_latency_mutex);
+}
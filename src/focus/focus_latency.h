@@ -0,0 +1,31 @@
+#pragma once
+
+#include <glib.h>
+
+typedef enum {
+  FOCUS_LATENCY_QUEUE = 0,
+  FOCUS_LATENCY_CDP_LIST,
+  FOCUS_LATENCY_CDP_CONNECT,
+  FOCUS_LATENCY_CDP_EVALUATE,
+  FOCUS_LATENCY_EXTRACT,
+  FOCUS_LATENCY_EMBEDDING,
+  FOCUS_LATENCY_PROMPT,
+  FOCUS_LATENCY_INFERENCE,
+  FOCUS_LATENCY_TOTAL,
+  FOCUS_LATENCY_STAGE_COUNT
+} FocusLatencyStage;
+
+typedef struct {
+  guint64 samples;
+  guint window;
+  guint64 p50_us;
+  guint64 p95_us;
+  guint64 max_us;
+} FocusLatencySummary;
+
+const char *focus_latency_stage_name(FocusLatencyStage stage);
+void focus_latency_record(FocusLatencyStage stage, gint64 start_us);
+void focus_latency_get_summary(FocusLatencyStage stage,
+                               FocusLatencySummary *summary_out);
+void focus_latency_append_report(GString *report);
+void focus_latency_reset(void);
@@ -0,0 +1,249 @@
+#include "focus/focus_scheduler.h"
+
+/* Runs focus-guard background jobs on at most max_workers threads.
+ *
+ * Jobs carry a key; submitting a job for a key that already has one queued
+ * or running supersedes it (newest wins), so work for a page the user has
+ * left is dropped instead of delaying the current one. A job that has not
+ * finished by its deadline is cancelled. Used from the main thread only;
+ * callbacks run there too. */
+
+typedef struct _FocusSchedulerJob FocusSchedulerJob;
+
+struct _FocusScheduler {
+  gint ref_count;
+  guint max_workers;
+  guint running;
+  gboolean shutdown;
+  GQueue pending;
+  GPtrArray *active;
+};
+
+struct _FocusSchedulerJob {
+  FocusScheduler *scheduler;
+  char *key;
+  FocusSchedulerPriority priority;
+  gint64 deadline_us;
+  GTaskThreadFunc func;
+  GTask *task;
+  GCancellable *cancellable;
+  GAsyncReadyCallback callback;
+  gpointer user_data;
+  guint deadline_source_id;
+};
+
+static void focus_scheduler_pump(FocusScheduler *scheduler);
+
+static void
+focus_scheduler_unref(FocusScheduler *scheduler)
+{
+  if (--scheduler->ref_count > 0) {
+    return;
+  }
+
+  g_ptr_array_unref(scheduler->active);
+  g_free(scheduler);
+}
+
+static void
+focus_scheduler_job_free(FocusSchedulerJob *job)
+{
+  if (job->deadline_source_id != 0) {
+    g_source_remove(job->deadline_source_id);
+  }
+  g_clear_object(&job->task);
+  g_clear_object(&job->cancellable);
+  g_free(job->key);
+  focus_scheduler_unref(job->scheduler);
+  g_free(job);
+}
+
+static void
+focus_scheduler_drop(FocusSchedulerJob *job, gint code, const char *reason)
+{
+  g_debug("Focus job %s dropped: %s", job->key, reason);
+  g_task_return_new_error(job->task, G_IO_ERROR, code, "%s", reason);
+}
+
+static gboolean
+focus_scheduler_on_deadline(gpointer user_data)
+{
+  FocusSchedulerJob *job = user_data;
+  job->deadline_source_id = 0;
+  g_debug("Focus job %s missed its deadline", job->key);
+  g_cancellable_cancel(job->cancellable);
+  return G_SOURCE_REMOVE;
+}
+
+static void
+focus_scheduler_on_job_done(GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  FocusSchedulerJob *job = user_data;
+  FocusScheduler *scheduler = job->scheduler;
+
+  if (g_ptr_array_remove(scheduler->active, job)) {
+    scheduler->running--;
+  }
+
+  if (!scheduler->shutdown && job->callback != NULL) {
+    job->callback(source_object, res, job->user_data);
+  }
+
+  focus_scheduler_pump(scheduler);
+  focus_scheduler_job_free(job);
+}
+
+static void
+focus_scheduler_start(FocusScheduler *scheduler, FocusSchedulerJob *job)
+{
+  gint64 remaining_us = job->deadline_us - g_get_monotonic_time();
+  if (job->deadline_us > 0 && remaining_us <= 0) {
+    focus_scheduler_drop(job, G_IO_ERROR_TIMED_OUT, "deadline passed while queued");
+    return;
+  }
+
+  scheduler->running++;
+  g_ptr_array_add(scheduler->active, job);
+  if (job->deadline_us > 0) {
+    job->deadline_source_id =
+        g_timeout_add((guint)MAX(remaining_us / 1000, 1), focus_scheduler_on_deadline, job);
+  }
+  g_task_run_in_thread(job->task, job->func);
+}
+
+static void
+focus_scheduler_pump(FocusScheduler *scheduler)
+{
+  while (!scheduler->shutdown && scheduler->running < scheduler->max_workers &&
+         !g_queue_is_empty(&scheduler->pending)) {
+    focus_scheduler_start(scheduler, g_queue_pop_head(&scheduler->pending));
+  }
+}
+
+static gint
+focus_scheduler_compare(gconstpointer queued, gconstpointer incoming, gpointer user_data)
+{
+  (void)user_data;
+  const FocusSchedulerJob *left = queued;
+  const FocusSchedulerJob *right = incoming;
+  /* The new job goes after every queued job of equal or higher priority, so
+   * equal priorities keep submission order. */
+  return left->priority >= right->priority ? -1 : 1;
+}
+
+FocusScheduler *
+focus_scheduler_new(guint max_workers)
+{
+  FocusScheduler *scheduler = g_new0(FocusScheduler, 1);
+  scheduler->ref_count = 1;
+  scheduler->max_workers = MAX(max_workers, 1);
+  g_queue_init(&scheduler->pending);
+  scheduler->active = g_ptr_array_new();
+  return scheduler;
+}
+
+void
+focus_scheduler_free(FocusScheduler *scheduler)
+{
+  if (scheduler == NULL) {
+    return;
+  }
+
+  scheduler->shutdown = TRUE;
+  for (guint i = 0; i < scheduler->active->len; i++) {
+    FocusSchedulerJob *job = g_ptr_array_index(scheduler->active, i);
+    g_cancellable_cancel(job->cancellable);
+  }
+
+  FocusSchedulerJob *job = NULL;
+  while ((job = g_queue_pop_head(&scheduler->pending)) != NULL) {
+    g_cancellable_cancel(job->cancellable);
+    focus_scheduler_drop(job, G_IO_ERROR_CANCELLED, "scheduler shut down");
+  }
+
+  /* Running jobs hold their own reference and finish in the background. */
+  focus_scheduler_unref(scheduler);
+}
+
+void
+focus_scheduler_cancel(FocusScheduler *scheduler, const char *key)
+{
+  if (scheduler == NULL || key == NULL) {
+    return;
+  }
+
+  for (guint i = 0; i < scheduler->active->len; i++) {
+    FocusSchedulerJob *job = g_ptr_array_index(scheduler->active, i);
+    if (g_strcmp0(job->key, key) == 0) {
+      g_cancellable_cancel(job->cancellable);
+    }
+  }
+
+  GList *link = scheduler->pending.head;
+  while (link != NULL) {
+    GList *next = link->next;
+    FocusSchedulerJob *job = link->data;
+    if (g_strcmp0(job->key, key) == 0) {
+      g_queue_delete_link(&scheduler->pending, link);
+      g_cancellable_cancel(job->cancellable);
+      focus_scheduler_drop(job, G_IO_ERROR_CANCELLED, "superseded");
+    }
+    link = next;
+  }
+}
+
+gboolean
+focus_scheduler_is_busy(FocusScheduler *scheduler, const char *key)
+{
+  if (scheduler == NULL || key == NULL) {
+    return FALSE;
+  }
+
+  for (guint i = 0; i < scheduler->active->len; i++) {
+    FocusSchedulerJob *job = g_ptr_array_index(scheduler->active, i);
+    if (g_strcmp0(job->key, key) == 0 && !g_cancellable_is_cancelled(job->cancellable)) {
+      return TRUE;
+    }
+  }
+
+  for (GList *link = scheduler->pending.head; link != NULL; link = link->next) {
+    FocusSchedulerJob *job = link->data;
+    if (g_strcmp0(job->key, key) == 0) {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+void
+focus_scheduler_submit(FocusScheduler *scheduler,
+                       const char *key,
+                       FocusSchedulerPriority priority,
+                       gint64 deadline_us,
+                       GTaskThreadFunc func,
+                       gpointer task_data,
+                       GDestroyNotify task_data_free,
+                       GAsyncReadyCallback callback,
+                       gpointer user_data)
+{
+  g_return_if_fail(scheduler != NULL && key != NULL && func != NULL);
+
+  focus_scheduler_cancel(scheduler, key);
+
+  FocusSchedulerJob *job = g_new0(FocusSchedulerJob, 1);
+  scheduler->ref_count++;
+  job->scheduler = scheduler;
+  job->key = g_strdup(key);
+  job->priority = priority;
+  job->deadline_us = deadline_us;
+  job->func = func;
+  job->cancellable = g_cancellable_new();
+  job->callback = callback;
+  job->user_data = user_data;
+  job->task = g_task_new(NULL, job->cancellable, focus_scheduler_on_job_done, job);
+  g_task_set_task_data(job->task, task_data, task_data_free);
+
+  g_queue_insert_sorted(&scheduler->pending, job, focus_scheduler_compare, NULL);
+  focus_scheduler_pump(scheduler);
+}
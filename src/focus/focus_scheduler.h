@@ -0,0 +1,27 @@
+#pragma once
+
+#include <gio/gio.h>
+#include <glib.h>
+
+typedef struct _FocusScheduler FocusScheduler;
+
+typedef enum {
+  FOCUS_SCHEDULER_PRIORITY_LOW = 0,
+  FOCUS_SCHEDULER_PRIORITY_NORMAL = 1,
+  FOCUS_SCHEDULER_PRIORITY_HIGH = 2
+} FocusSchedulerPriority;
+
+FocusScheduler *focus_scheduler_new(guint max_workers);
+void focus_scheduler_free(FocusScheduler *scheduler);
+
+void focus_scheduler_submit(FocusScheduler *scheduler,
+                            const char *key,
+                            FocusSchedulerPriority priority,
+                            gint64 deadline_us,
+                            GTaskThreadFunc func,
+                            gpointer task_data,
+                            GDestroyNotify task_data_free,
+                            GAsyncReadyCallback callback,
+                            gpointer user_data);
+void focus_scheduler_cancel(FocusScheduler *scheduler, const char *key);
+gboolean focus_scheduler_is_busy(FocusScheduler *scheduler, const char *key);
@@ -0,0 +1,217 @@
+#include "focus/ollama_catalog.h"
+
+/* Installed models rarely change; a reachable server is re-listed every
+ * minute, an unreachable one is probed more often so it shows up quickly. */
+#define OLLAMA_CATALOG_REFRESH_SECONDS 60
+#define OLLAMA_CATALOG_RETRY_SECONDS 15
+
+/* Used from the main thread only. */
+struct _OllamaCatalog {
+  gint ref_count;
+  OllamaServerInfo *info;
+  gboolean server_up;
+  char *last_error;
+  gint64 checked_us;
+  gboolean fetching;
+  GPtrArray *waiters;
+};
+
+OllamaCatalog *
+ollama_catalog_new(void)
+{
+  OllamaCatalog *catalog = g_new0(OllamaCatalog, 1);
+  catalog->ref_count = 1;
+  catalog->waiters = g_ptr_array_new();
+  return catalog;
+}
+
+OllamaCatalog *
+ollama_catalog_ref(OllamaCatalog *catalog)
+{
+  if (catalog != NULL) {
+    catalog->ref_count++;
+  }
+  return catalog;
+}
+
+void
+ollama_catalog_unref(OllamaCatalog *catalog)
+{
+  if (catalog == NULL || --catalog->ref_count > 0) {
+    return;
+  }
+
+  g_ptr_array_unref(catalog->waiters);
+  ollama_server_info_free(catalog->info);
+  g_free(catalog->last_error);
+  g_free(catalog);
+}
+
+static gboolean
+ollama_catalog_is_fresh(const OllamaCatalog *catalog)
+{
+  if (catalog->checked_us == 0) {
+    return FALSE;
+  }
+
+  gint64 max_age = catalog->server_up ? OLLAMA_CATALOG_REFRESH_SECONDS
+                                      : OLLAMA_CATALOG_RETRY_SECONDS;
+  return g_get_monotonic_time() - catalog->checked_us < max_age * G_USEC_PER_SEC;
+}
+
+static void
+ollama_catalog_on_fetched(GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  (void)source_object;
+  OllamaCatalog *catalog = user_data;
+  GError *error = NULL;
+  OllamaServerInfo *info = ollama_client_fetch_server_info_finish(res, &error);
+
+  catalog->fetching = FALSE;
+  catalog->checked_us = g_get_monotonic_time();
+  g_clear_pointer(&catalog->last_error, g_free);
+  if (info != NULL) {
+    if (!catalog->server_up) {
+      g_debug("Ollama server %s is up", info->version);
+    }
+    ollama_server_info_free(catalog->info);
+    catalog->info = info;
+    catalog->server_up = TRUE;
+  } else {
+    /* Keep the last model list so a restarting server does not wipe the
+     * settings dropdown; only availability changes. */
+    if (catalog->server_up) {
+      g_debug("Ollama server unreachable: %s", error->message);
+    }
+    catalog->server_up = FALSE;
+    catalog->last_error = g_strdup(error->message);
+  }
+
+  GPtrArray *waiters = catalog->waiters;
+  catalog->waiters = g_ptr_array_new();
+  for (guint i = 0; i < waiters->len; i++) {
+    GTask *task = g_ptr_array_index(waiters, i);
+    if (error != NULL) {
+      g_task_return_error(task, g_error_copy(error));
+    } else {
+      g_task_return_boolean(task, TRUE);
+    }
+    g_object_unref(task);
+  }
+  g_ptr_array_unref(waiters);
+
+  g_clear_error(&error);
+  ollama_catalog_unref(catalog);
+}
+
+void
+ollama_catalog_refresh_async(OllamaCatalog *catalog,
+                             gboolean force,
+                             GCancellable *cancellable,
+                             GAsyncReadyCallback callback,
+                             gpointer user_data)
+{
+  GTask *task = g_task_new(NULL, cancellable, callback, user_data);
+  g_task_set_source_tag(task, ollama_catalog_refresh_async);
+  if (catalog == NULL) {
+    g_task_return_new_error(task,
+                            G_IO_ERROR,
+                            G_IO_ERROR_INVALID_ARGUMENT,
+                            "Ollama catalog missing");
+    g_object_unref(task);
+    return;
+  }
+
+  if (!force && !catalog->fetching && ollama_catalog_is_fresh(catalog)) {
+    if (catalog->server_up) {
+      g_task_return_boolean(task, TRUE);
+    } else {
+      g_task_return_new_error(task,
+                              G_IO_ERROR,
+                              G_IO_ERROR_CONNECTION_REFUSED,
+                              "%s",
+                              catalog->last_error != NULL
+                                  ? catalog->last_error
+                                  : "Ollama server unreachable");
+    }
+    g_object_unref(task);
+    return;
+  }
+
+  /* Concurrent callers share one in-flight fetch. */
+  g_ptr_array_add(catalog->waiters, task);
+  if (catalog->fetching) {
+    return;
+  }
+
+  catalog->fetching = TRUE;
+  ollama_client_fetch_server_info_async(NULL,
+                                        ollama_catalog_on_fetched,
+                                        ollama_catalog_ref(catalog));
+}
+
+gboolean
+ollama_catalog_refresh_finish(OllamaCatalog *catalog,
+                              GAsyncResult *result,
+                              GError **error)
+{
+  (void)catalog;
+  return g_task_propagate_boolean(G_TASK(result), error);
+}
+
+gboolean
+ollama_catalog_is_server_up(const OllamaCatalog *catalog)
+{
+  return catalog != NULL && catalog->server_up;
+}
+
+gboolean
+ollama_catalog_has_models(const OllamaCatalog *catalog)
+{
+  return catalog != NULL && catalog->info != NULL && catalog->info->models != NULL;
+}
+
+const char *
+ollama_catalog_get_version(const OllamaCatalog *catalog)
+{
+  return catalog != NULL && catalog->info != NULL ? catalog->info->version : NULL;
+}
+
+const char *
+ollama_catalog_get_error(const OllamaCatalog *catalog)
+{
+  return catalog != NULL ? catalog->last_error : NULL;
+}
+
+GPtrArray *
+ollama_catalog_dup_model_names(const OllamaCatalog *catalog)
+{
+  if (!ollama_catalog_has_models(catalog)) {
+    return NULL;
+  }
+
+  GPtrArray *models = catalog->info->models;
+  GPtrArray *names = g_ptr_array_new_with_free_func(g_free);
+  for (guint i = 0; i < models->len; i++) {
+    OllamaModelInfo *info = g_ptr_array_index(models, i);
+    g_ptr_array_add(names, g_strdup(info->name));
+  }
+  return names;
+}
+
+const OllamaModelInfo *
+ollama_catalog_find_model(const OllamaCatalog *catalog, const char *name)
+{
+  if (!ollama_catalog_has_models(catalog) || name == NULL) {
+    return NULL;
+  }
+
+  GPtrArray *models = catalog->info->models;
+  for (guint i = 0; i < models->len; i++) {
+    OllamaModelInfo *info = g_ptr_array_index(models, i);
+    if (g_strcmp0(info->name, name) == 0) {
+      return info;
+    }
+  }
+  return NULL;
+}
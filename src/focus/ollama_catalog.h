@@ -0,0 +1,29 @@
+#pragma once
+
+#include <gio/gio.h>
+#include <glib.h>
+
+#include "focus/ollama_client.h"
+
+typedef struct _OllamaCatalog OllamaCatalog;
+
+OllamaCatalog *ollama_catalog_new(void);
+OllamaCatalog *ollama_catalog_ref(OllamaCatalog *catalog);
+void ollama_catalog_unref(OllamaCatalog *catalog);
+
+void ollama_catalog_refresh_async(OllamaCatalog *catalog,
+                                  gboolean force,
+                                  GCancellable *cancellable,
+                                  GAsyncReadyCallback callback,
+                                  gpointer user_data);
+gboolean ollama_catalog_refresh_finish(OllamaCatalog *catalog,
+                                       GAsyncResult *result,
+                                       GError **error);
+
+gboolean ollama_catalog_is_server_up(const OllamaCatalog *catalog);
+gboolean ollama_catalog_has_models(const OllamaCatalog *catalog);
+const char *ollama_catalog_get_version(const OllamaCatalog *catalog);
+const char *ollama_catalog_get_error(const OllamaCatalog *catalog);
+GPtrArray *ollama_catalog_dup_model_names(const OllamaCatalog *catalog);
+const OllamaModelInfo *ollama_catalog_find_model(const OllamaCatalog *catalog,
+                                                 const char *name);
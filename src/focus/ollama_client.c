@@ -1,129 +1,396 @@
 #include "focus/ollama_client.h"
 #include "config.h"
 
+#define OLLAMA_CLIENT_DEFAULT_BASE_URL "http://127.0.0.1:11434"
+
+/* Tests point the client at an in-process server; the app never changes it. */
+static char *ollama_client_base_url;
+G_LOCK_DEFINE_STATIC(ollama_client_base_url);
+
+void
+ollama_client_set_base_url(const char *base_url)
+{
+  G_LOCK(ollama_client_base_url);
+  g_free(ollama_client_base_url);
+  ollama_client_base_url =
+      base_url != NULL && *base_url != '\0' ? g_strdup(base_url) : NULL;
+  G_UNLOCK(ollama_client_base_url);
+}
+
 #if HAVE_CHROME_OLLAMA
 
 #include <libsoup/soup.h>
 #include <json-glib/json-glib.h>
+#include <string.h>
 
-gboolean
-ollama_client_detect_available(void)
+#include "focus/focus_http.h"
+
+typedef struct {
+  SoupMessage *message;
+  OllamaServerInfo *info;
+} OllamaClientFetchContext;
+
+static char *
+ollama_client_uri(const char *path)
 {
-  char *path = g_find_program_in_path("ollama");
-  if (path == NULL) {
-    return FALSE;
-  }
-  g_free(path);
-  return TRUE;
+  G_LOCK(ollama_client_base_url);
+  char *uri = g_strconcat(ollama_client_base_url != NULL
+                              ? ollama_client_base_url
+                              : OLLAMA_CLIENT_DEFAULT_BASE_URL,
+                          path,
+                          NULL);
+  G_UNLOCK(ollama_client_base_url);
+  return uri;
 }
 
-GPtrArray *
-ollama_client_list_models_sync(GError **error)
+static SoupMessage *
+ollama_client_new_message(const char *method, const char *path)
 {
-  gchar *stdout_data = NULL;
-  gchar *stderr_data = NULL;
-  int status = 0;
+  char *uri = ollama_client_uri(path);
+  SoupMessage *message = soup_message_new(method, uri);
+  g_free(uri);
+  return message;
+}
 
-  if (!g_spawn_command_line_sync("ollama list",
-                                 &stdout_data,
-                                 &stderr_data,
-                                 &status,
-                                 error)) {
-    g_free(stdout_data);
-    g_free(stderr_data);
+static JsonObject *
+ollama_client_parse_object(GBytes *bytes, JsonParser *parser, GError **error)
+{
+  gsize len = 0;
+  const gchar *data = g_bytes_get_data(bytes, &len);
+  if (!json_parser_load_from_data(parser, data, (gssize)len, error)) {
     return NULL;
   }
 
-  if (status != 0) {
+  JsonNode *root = json_parser_get_root(parser);
+  if (root == NULL || !JSON_NODE_HOLDS_OBJECT(root)) {
     g_set_error(error,
                 G_IO_ERROR,
-                G_IO_ERROR_FAILED,
-                "ollama list failed: %s",
-                stderr_data != NULL && *stderr_data != '\0'
-                    ? stderr_data
-                    : "unknown error");
-    g_free(stdout_data);
-    g_free(stderr_data);
+                G_IO_ERROR_INVALID_DATA,
+                "Ollama response missing JSON object");
     return NULL;
   }
 
-  GPtrArray *models = g_ptr_array_new_with_free_func(g_free);
-  if (stdout_data == NULL) {
-    g_free(stderr_data);
-    return models;
+  return json_node_get_object(root);
+}
+
+static const char *
+ollama_client_get_string(JsonObject *object, const char *member)
+{
+  if (object == NULL || !json_object_has_member(object, member)) {
+    return NULL;
   }
 
-  gchar **lines = g_strsplit(stdout_data, "\n", -1);
-  gboolean header_checked = FALSE;
-  for (guint i = 0; lines != NULL && lines[i] != NULL; i++) {
-    gchar *line = g_strstrip(lines[i]);
-    if (line == NULL || *line == '\0') {
-      continue;
-    }
+  JsonNode *node = json_object_get_member(object, member);
+  return JSON_NODE_HOLDS_VALUE(node) ? json_node_get_string(node) : NULL;
+}
 
-    if (!header_checked) {
-      header_checked = TRUE;
-      if (g_ascii_strncasecmp(line, "name", 4) == 0) {
-        continue;
-      }
-    }
+static char *
+ollama_client_parse_version(GBytes *bytes, GError **error)
+{
+  JsonParser *parser = json_parser_new();
+  JsonObject *root = ollama_client_parse_object(bytes, parser, error);
+  char *version = root != NULL
+                      ? g_strdup(ollama_client_get_string(root, "version"))
+                      : NULL;
+  if (root != NULL && version == NULL) {
+    version = g_strdup("unknown");
+  }
+  g_object_unref(parser);
+  return version;
+}
+
+static GPtrArray *
+ollama_client_parse_tags(GBytes *bytes, GError **error)
+{
+  JsonParser *parser = json_parser_new();
+  JsonObject *root = ollama_client_parse_object(bytes, parser, error);
+  if (root == NULL) {
+    g_object_unref(parser);
+    return NULL;
+  }
 
-    gchar **tokens = g_strsplit_set(line, " \t", 0);
-    if (tokens != NULL && tokens[0] != NULL && *tokens[0] != '\0') {
-      g_ptr_array_add(models, g_strdup(tokens[0]));
+  GPtrArray *models =
+      g_ptr_array_new_with_free_func((GDestroyNotify)ollama_model_info_free);
+  JsonArray *entries = json_object_has_member(root, "models")
+                           ? json_object_get_array_member(root, "models")
+                           : NULL;
+  guint count = entries != NULL ? json_array_get_length(entries) : 0;
+  for (guint i = 0; i < count; i++) {
+    JsonObject *entry = json_array_get_object_element(entries, i);
+    const char *name = ollama_client_get_string(entry, "name");
+    if (name == NULL || *name == '\0') {
+      continue;
     }
-    g_strfreev(tokens);
+
+    JsonObject *details = json_object_has_member(entry, "details")
+                              ? json_object_get_object_member(entry, "details")
+                              : NULL;
+    OllamaModelInfo *info = g_new0(OllamaModelInfo, 1);
+    info->name = g_strdup(name);
+    info->size_bytes = json_object_has_member(entry, "size")
+                           ? json_object_get_int_member(entry, "size")
+                           : 0;
+    info->parameter_size = g_strdup(ollama_client_get_string(details, "parameter_size"));
+    info->quantization =
+        g_strdup(ollama_client_get_string(details, "quantization_level"));
+    g_ptr_array_add(models, info);
   }
 
-  g_strfreev(lines);
-  g_free(stdout_data);
-  g_free(stderr_data);
+  g_object_unref(parser);
   return models;
 }
 
-char *
-ollama_client_chat_sync(const char *model,
-                        const char *system_prompt,
-                        const char *user_prompt,
-                        GCancellable *cancellable,
-                        GError **error)
+static GBytes *
+ollama_client_get_sync(const char *path,
+                       GCancellable *cancellable,
+                       GError **error)
 {
-  if (model == NULL || *model == '\0') {
+  char *uri = ollama_client_uri(path);
+  SoupMessage *message = soup_message_new("GET", uri);
+  g_free(uri);
+  GBytes *bytes =
+      focus_http_send_and_read(FOCUS_HTTP_OLLAMA_PROBE, message, cancellable, error);
+  if (bytes != NULL && soup_message_get_status(message) != SOUP_STATUS_OK) {
     g_set_error(error,
                 G_IO_ERROR,
-                G_IO_ERROR_INVALID_ARGUMENT,
-                "Ollama model not set");
+                G_IO_ERROR_FAILED,
+                "Ollama HTTP error: %u",
+                soup_message_get_status(message));
+    g_clear_pointer(&bytes, g_bytes_unref);
+  }
+  g_object_unref(message);
+  return bytes;
+}
+
+gboolean
+ollama_client_detect_available(void)
+{
+  GBytes *bytes = ollama_client_get_sync("/api/version", NULL, NULL);
+  gboolean available = bytes != NULL;
+  if (bytes != NULL) {
+    g_bytes_unref(bytes);
+  }
+  return available;
+}
+
+GPtrArray *
+ollama_client_list_models_sync(GError **error)
+{
+  GBytes *bytes = ollama_client_get_sync("/api/tags", NULL, error);
+  if (bytes == NULL) {
     return NULL;
   }
 
-  SoupSession *session = soup_session_new();
-  SoupMessage *message =
-      soup_message_new("POST", "http://127.0.0.1:11434/api/chat");
+  GPtrArray *infos = ollama_client_parse_tags(bytes, error);
+  g_bytes_unref(bytes);
+  if (infos == NULL) {
+    return NULL;
+  }
 
-  JsonBuilder *builder = json_builder_new();
-  json_builder_begin_object(builder);
-  json_builder_set_member_name(builder, "model");
-  json_builder_add_string_value(builder, model);
-  json_builder_set_member_name(builder, "messages");
-  json_builder_begin_array(builder);
+  GPtrArray *models = g_ptr_array_new_with_free_func(g_free);
+  for (guint i = 0; i < infos->len; i++) {
+    OllamaModelInfo *info = g_ptr_array_index(infos, i);
+    g_ptr_array_add(models, g_strdup(info->name));
+  }
+  g_ptr_array_unref(infos);
+  return models;
+}
+
+static void
+ollama_client_fetch_context_free(gpointer data)
+{
+  OllamaClientFetchContext *context = data;
+  if (context == NULL) {
+    return;
+  }
+
+  g_clear_object(&context->message);
+  ollama_server_info_free(context->info);
+  g_free(context);
+}
+
+static GBytes *
+ollama_client_read_finish(OllamaClientFetchContext *context,
+                          GAsyncResult *res,
+                          GError **error)
+{
+  GBytes *bytes = focus_http_send_and_read_finish(res, error);
+  if (bytes != NULL && soup_message_get_status(context->message) != SOUP_STATUS_OK) {
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_FAILED,
+                "Ollama HTTP error: %u",
+                soup_message_get_status(context->message));
+    g_clear_pointer(&bytes, g_bytes_unref);
+  }
+  return bytes;
+}
+
+static void
+ollama_client_on_tags_read(GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  (void)source_object;
+  GTask *task = user_data;
+  OllamaClientFetchContext *context = g_task_get_task_data(task);
+  GError *error = NULL;
+  GBytes *bytes = ollama_client_read_finish(context, res, &error);
+  GPtrArray *models = bytes != NULL ? ollama_client_parse_tags(bytes, &error) : NULL;
+  if (bytes != NULL) {
+    g_bytes_unref(bytes);
+  }
+
+  if (models == NULL) {
+    g_task_return_error(task, error);
+  } else {
+    context->info->models = models;
+    g_task_return_pointer(task,
+                          g_steal_pointer(&context->info),
+                          (GDestroyNotify)ollama_server_info_free);
+  }
+  g_object_unref(task);
+}
+
+static void
+ollama_client_on_version_read(GObject *source_object,
+                              GAsyncResult *res,
+                              gpointer user_data)
+{
+  (void)source_object;
+  GTask *task = user_data;
+  OllamaClientFetchContext *context = g_task_get_task_data(task);
+  GError *error = NULL;
+  GBytes *bytes = ollama_client_read_finish(context, res, &error);
+  char *version = bytes != NULL ? ollama_client_parse_version(bytes, &error) : NULL;
+  if (bytes != NULL) {
+    g_bytes_unref(bytes);
+  }
+
+  if (version == NULL) {
+    g_task_return_error(task, error);
+    g_object_unref(task);
+    return;
+  }
+
+  context->info->version = version;
+  g_object_unref(context->message);
+  context->message = ollama_client_new_message("GET", "/api/tags");
+  focus_http_send_and_read_async(FOCUS_HTTP_OLLAMA_PROBE,
+                                 context->message,
+                                 g_task_get_cancellable(task),
+                                 ollama_client_on_tags_read,
+                                 task);
+}
+
+void
+ollama_client_fetch_server_info_async(GCancellable *cancellable,
+                                      GAsyncReadyCallback callback,
+                                      gpointer user_data)
+{
+  OllamaClientFetchContext *context = g_new0(OllamaClientFetchContext, 1);
+  context->message = ollama_client_new_message("GET", "/api/version");
+  context->info = g_new0(OllamaServerInfo, 1);
+
+  GTask *task = g_task_new(NULL, cancellable, callback, user_data);
+  g_task_set_source_tag(task, ollama_client_fetch_server_info_async);
+  g_task_set_task_data(task, context, ollama_client_fetch_context_free);
+
+  focus_http_send_and_read_async(FOCUS_HTTP_OLLAMA_PROBE,
+                                 context->message,
+                                 cancellable,
+                                 ollama_client_on_version_read,
+                                 task);
+}
 
+static void
+ollama_client_add_message(JsonBuilder *builder, const char *role, const char *content)
+{
   json_builder_begin_object(builder);
   json_builder_set_member_name(builder, "role");
-  json_builder_add_string_value(builder, "system");
+  json_builder_add_string_value(builder, role);
   json_builder_set_member_name(builder, "content");
-  json_builder_add_string_value(builder, system_prompt != NULL ? system_prompt : "");
+  json_builder_add_string_value(builder, content != NULL ? content : "");
   json_builder_end_object(builder);
+}
 
+static void
+ollama_client_add_label_format(JsonBuilder *builder, const char *const *labels)
+{
+  json_builder_set_member_name(builder, "format");
   json_builder_begin_object(builder);
-  json_builder_set_member_name(builder, "role");
-  json_builder_add_string_value(builder, "user");
-  json_builder_set_member_name(builder, "content");
-  json_builder_add_string_value(builder, user_prompt != NULL ? user_prompt : "");
+  json_builder_set_member_name(builder, "type");
+  json_builder_add_string_value(builder, "object");
+  json_builder_set_member_name(builder, "properties");
+  json_builder_begin_object(builder);
+  json_builder_set_member_name(builder, "label");
+  json_builder_begin_object(builder);
+  json_builder_set_member_name(builder, "type");
+  json_builder_add_string_value(builder, "string");
+  json_builder_set_member_name(builder, "enum");
+  json_builder_begin_array(builder);
+  for (guint i = 0; labels[i] != NULL; i++) {
+    json_builder_add_string_value(builder, labels[i]);
+  }
+  json_builder_end_array(builder);
+  json_builder_end_object(builder);
+  json_builder_end_object(builder);
+  json_builder_set_member_name(builder, "required");
+  json_builder_begin_array(builder);
+  json_builder_add_string_value(builder, "label");
+  json_builder_end_array(builder);
   json_builder_end_object(builder);
+}
+
+static SoupMessage *
+ollama_client_new_chat_message(const char *model,
+                               const char *system_prompt,
+                               const char *user_prompt,
+                               gboolean stream,
+                               const OllamaChatOptions *options)
+{
+  SoupMessage *message =
+      ollama_client_new_message("POST", "/api/chat");
 
+  JsonBuilder *builder = json_builder_new();
+  json_builder_begin_object(builder);
+  json_builder_set_member_name(builder, "model");
+  json_builder_add_string_value(builder, model);
+  json_builder_set_member_name(builder, "messages");
+  json_builder_begin_array(builder);
+  ollama_client_add_message(builder, "system", system_prompt);
+  ollama_client_add_message(builder, "user", user_prompt);
   json_builder_end_array(builder);
   json_builder_set_member_name(builder, "stream");
-  json_builder_add_boolean_value(builder, FALSE);
+  json_builder_add_boolean_value(builder, stream);
+
+  if (options != NULL && options->keep_alive_seconds > 0) {
+    json_builder_set_member_name(builder, "keep_alive");
+    json_builder_add_int_value(builder, options->keep_alive_seconds);
+  }
+
+  if (options != NULL && options->structured && options->labels != NULL) {
+    ollama_client_add_label_format(builder, options->labels);
+  }
+
+  if (options != NULL && (options->num_predict > 0 || options->stop != NULL)) {
+    json_builder_set_member_name(builder, "options");
+    json_builder_begin_object(builder);
+    json_builder_set_member_name(builder, "temperature");
+    json_builder_add_double_value(builder, 0.0);
+    if (options->num_predict > 0) {
+      json_builder_set_member_name(builder, "num_predict");
+      json_builder_add_int_value(builder, options->num_predict);
+    }
+    if (options->stop != NULL) {
+      json_builder_set_member_name(builder, "stop");
+      json_builder_begin_array(builder);
+      for (guint i = 0; options->stop[i] != NULL; i++) {
+        json_builder_add_string_value(builder, options->stop[i]);
+      }
+      json_builder_end_array(builder);
+    }
+    json_builder_end_object(builder);
+  }
+
   json_builder_end_object(builder);
 
   JsonGenerator *generator = json_generator_new();
@@ -138,16 +405,38 @@ ollama_client_chat_sync(const char *model,
                                            payload_bytes);
   g_bytes_unref(payload_bytes);
 
-  GBytes *response_bytes =
-      soup_session_send_and_read(session, message, cancellable, error);
-
   json_node_free(root);
   g_object_unref(generator);
   g_object_unref(builder);
+  return message;
+}
+
+char *
+ollama_client_chat_sync(const char *model,
+                        const char *system_prompt,
+                        const char *user_prompt,
+                        GCancellable *cancellable,
+                        GError **error)
+{
+  if (model == NULL || *model == '\0') {
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_INVALID_ARGUMENT,
+                "Ollama model not set");
+    return NULL;
+  }
+
+  SoupMessage *message = ollama_client_new_chat_message(model,
+                                                        system_prompt,
+                                                        user_prompt,
+                                                        FALSE,
+                                                        NULL);
+
+  GBytes *response_bytes =
+      focus_http_send_and_read(FOCUS_HTTP_OLLAMA, message, cancellable, error);
 
   if (response_bytes == NULL) {
     g_object_unref(message);
-    g_object_unref(session);
     return NULL;
   }
 
@@ -159,7 +448,6 @@ ollama_client_chat_sync(const char *model,
                 soup_message_get_status(message));
     g_bytes_unref(response_bytes);
     g_object_unref(message);
-    g_object_unref(session);
     return NULL;
   }
 
@@ -175,7 +463,6 @@ ollama_client_chat_sync(const char *model,
                                   error)) {
     g_object_unref(parser);
     g_object_unref(message);
-    g_object_unref(session);
     g_free(response_text);
     return NULL;
   }
@@ -188,7 +475,6 @@ ollama_client_chat_sync(const char *model,
                 "Ollama response missing JSON object");
     g_object_unref(parser);
     g_object_unref(message);
-    g_object_unref(session);
     g_free(response_text);
     return NULL;
   }
@@ -210,13 +496,482 @@ ollama_client_chat_sync(const char *model,
 
   g_object_unref(parser);
   g_object_unref(message);
-  g_object_unref(session);
   g_free(response_text);
   return result;
 }
 
+static gboolean
+ollama_client_has_label(const char *content, const char *const *labels)
+{
+  if (labels == NULL) {
+    return FALSE;
+  }
+
+  char *lower = g_ascii_strdown(content, -1);
+  gboolean found = FALSE;
+  for (guint i = 0; labels[i] != NULL && !found; i++) {
+    found = g_strstr_len(lower, -1, labels[i]) != NULL;
+  }
+  g_free(lower);
+  return found;
+}
+
+/* Reads one NDJSON chunk of a streamed chat response. Returns FALSE on a
+ * parse or server error; *done_out is set once Ollama reports completion. */
+static gboolean
+ollama_client_read_chunk(JsonParser *parser,
+                         const char *line,
+                         gsize length,
+                         GString *content,
+                         OllamaChatUsage *usage,
+                         gboolean *done_out,
+                         GError **error)
+{
+  if (!json_parser_load_from_data(parser, line, (gssize)length, error)) {
+    return FALSE;
+  }
+
+  JsonNode *root = json_parser_get_root(parser);
+  if (root == NULL || !JSON_NODE_HOLDS_OBJECT(root)) {
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_INVALID_DATA,
+                "Ollama stream chunk missing JSON object");
+    return FALSE;
+  }
+
+  JsonObject *root_obj = json_node_get_object(root);
+  if (json_object_has_member(root_obj, "error")) {
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_FAILED,
+                "Ollama error: %s",
+                json_object_get_string_member(root_obj, "error"));
+    return FALSE;
+  }
+
+  JsonObject *message_obj = json_object_has_member(root_obj, "message")
+                                ? json_object_get_object_member(root_obj, "message")
+                                : NULL;
+  if (message_obj != NULL && json_object_has_member(message_obj, "content")) {
+    const char *piece = json_object_get_string_member(message_obj, "content");
+    if (piece != NULL) {
+      g_string_append(content, piece);
+    }
+  }
+
+  *done_out = json_object_has_member(root_obj, "done") &&
+              json_object_get_boolean_member(root_obj, "done");
+  if (usage != NULL && *done_out) {
+    if (json_object_has_member(root_obj, "prompt_eval_count")) {
+      usage->prompt_tokens =
+          (guint)json_object_get_int_member(root_obj, "prompt_eval_count");
+    }
+    if (json_object_has_member(root_obj, "eval_count")) {
+      usage->output_tokens = (guint)json_object_get_int_member(root_obj, "eval_count");
+    }
+  }
+  return TRUE;
+}
+
+static char *
+ollama_client_stream_once(const char *model,
+                          const char *system_prompt,
+                          const char *user_prompt,
+                          const OllamaChatOptions *options,
+                          GCancellable *cancellable,
+                          guint *status_out,
+                          GError **error)
+{
+  OllamaChatUsage *usage = options != NULL ? options->usage : NULL;
+  if (usage != NULL) {
+    memset(usage, 0, sizeof(*usage));
+  }
+  gint64 start_us = g_get_monotonic_time();
+  SoupMessage *message = ollama_client_new_chat_message(model,
+                                                        system_prompt,
+                                                        user_prompt,
+                                                        TRUE,
+                                                        options);
+  GInputStream *stream = focus_http_send(FOCUS_HTTP_OLLAMA, message, cancellable, error);
+  if (stream == NULL) {
+    g_object_unref(message);
+    return NULL;
+  }
+
+  *status_out = soup_message_get_status(message);
+  if (*status_out != SOUP_STATUS_OK) {
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_FAILED,
+                "Ollama HTTP error: %u",
+                *status_out);
+    g_input_stream_close(stream, NULL, NULL);
+    g_object_unref(stream);
+    g_object_unref(message);
+    return NULL;
+  }
+
+  GDataInputStream *lines = g_data_input_stream_new(stream);
+  JsonParser *parser = json_parser_new();
+  GString *content = g_string_new(NULL);
+  gboolean done = FALSE;
+  gboolean ok = TRUE;
+
+  while (!done) {
+    gsize length = 0;
+    GError *read_error = NULL;
+    char *line =
+        g_data_input_stream_read_line_utf8(lines, &length, cancellable, &read_error);
+    if (line == NULL) {
+      if (read_error != NULL) {
+        g_propagate_error(error, read_error);
+        ok = FALSE;
+      }
+      break;
+    }
+
+    if (length > 0) {
+      ok = ollama_client_read_chunk(parser, line, length, content, usage, &done, error);
+      if (ok && usage != NULL) {
+        if (usage->chunks == 0) {
+          usage->first_chunk_us = g_get_monotonic_time() - start_us;
+        }
+        usage->chunks++;
+      }
+    }
+    g_free(line);
+
+    if (!ok) {
+      break;
+    }
+
+    /* Stop as soon as the answer is known; closing the unfinished body drops
+     * the connection, which makes Ollama abort the rest of the generation. */
+    if (options != NULL && ollama_client_has_label(content->str, options->labels)) {
+      break;
+    }
+  }
+
+  g_input_stream_close(G_INPUT_STREAM(lines), NULL, NULL);
+  g_object_unref(parser);
+  g_object_unref(lines);
+  g_object_unref(stream);
+  g_object_unref(message);
+
+  if (!ok) {
+    g_string_free(content, TRUE);
+    return NULL;
+  }
+
+  return g_string_free(content, FALSE);
+}
+
+char *
+ollama_client_chat_stream_sync(const char *model,
+                               const char *system_prompt,
+                               const char *user_prompt,
+                               const OllamaChatOptions *options,
+                               GCancellable *cancellable,
+                               GError **error)
+{
+  if (model == NULL || *model == '\0') {
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_INVALID_ARGUMENT,
+                "Ollama model not set");
+    return NULL;
+  }
+
+  guint status = 0;
+  GError *local_error = NULL;
+  char *result = ollama_client_stream_once(model,
+                                           system_prompt,
+                                           user_prompt,
+                                           options,
+                                           cancellable,
+                                           &status,
+                                           &local_error);
+
+  /* Servers older than structured outputs reject a schema "format"; retry
+   * once as plain text so label streaming still works. */
+  if (result == NULL && status == SOUP_STATUS_BAD_REQUEST && options != NULL &&
+      options->structured) {
+    OllamaChatOptions plain = *options;
+    plain.structured = FALSE;
+    g_clear_error(&local_error);
+    result = ollama_client_stream_once(model,
+                                       system_prompt,
+                                       user_prompt,
+                                       &plain,
+                                       cancellable,
+                                       &status,
+                                       &local_error);
+  }
+
+  if (local_error != NULL) {
+    g_propagate_error(error, local_error);
+  }
+
+  return result;
+}
+
+static gboolean
+ollama_client_model_matches(const char *configured, const char *loaded)
+{
+  if (configured == NULL || loaded == NULL) {
+    return FALSE;
+  }
+
+  if (g_strcmp0(configured, loaded) == 0) {
+    return TRUE;
+  }
+
+  /* "llama3" and "llama3:latest" name the same model. */
+  if (strchr(configured, ':') == NULL && g_str_has_prefix(loaded, configured) &&
+      g_strcmp0(loaded + strlen(configured), ":latest") == 0) {
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+gboolean
+ollama_client_is_model_loaded_sync(const char *model,
+                                   GCancellable *cancellable,
+                                   GError **error)
+{
+  SoupMessage *message = ollama_client_new_message("GET", "/api/ps");
+  GBytes *bytes = focus_http_send_and_read(FOCUS_HTTP_OLLAMA_PROBE, message, cancellable, error);
+  if (bytes == NULL) {
+    g_object_unref(message);
+    return FALSE;
+  }
+
+  gboolean loaded = FALSE;
+  if (soup_message_get_status(message) != SOUP_STATUS_OK) {
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_FAILED,
+                "Ollama HTTP error: %u",
+                soup_message_get_status(message));
+  } else {
+    gsize len = 0;
+    const gchar *data = g_bytes_get_data(bytes, &len);
+    JsonParser *parser = json_parser_new();
+    if (json_parser_load_from_data(parser, data, (gssize)len, error)) {
+      JsonNode *root = json_parser_get_root(parser);
+      JsonObject *root_obj =
+          root != NULL && JSON_NODE_HOLDS_OBJECT(root) ? json_node_get_object(root)
+                                                       : NULL;
+      JsonArray *models = root_obj != NULL && json_object_has_member(root_obj, "models")
+                              ? json_object_get_array_member(root_obj, "models")
+                              : NULL;
+      guint count = models != NULL ? json_array_get_length(models) : 0;
+      for (guint i = 0; i < count && !loaded; i++) {
+        JsonObject *entry = json_array_get_object_element(models, i);
+        if (entry == NULL) {
+          continue;
+        }
+        const char *name = json_object_has_member(entry, "name")
+                               ? json_object_get_string_member(entry, "name")
+                               : NULL;
+        loaded = ollama_client_model_matches(model, name);
+      }
+    }
+    g_object_unref(parser);
+  }
+
+  g_bytes_unref(bytes);
+  g_object_unref(message);
+  return loaded;
+}
+
+gboolean
+ollama_client_keep_alive_sync(const char *model,
+                              guint keep_alive_seconds,
+                              GCancellable *cancellable,
+                              GError **error)
+{
+  if (model == NULL || *model == '\0') {
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_INVALID_ARGUMENT,
+                "Ollama model not set");
+    return FALSE;
+  }
+
+  /* A generate request without a prompt only loads (or, with a zero
+   * keep_alive, unloads) the model. */
+  JsonBuilder *builder = json_builder_new();
+  json_builder_begin_object(builder);
+  json_builder_set_member_name(builder, "model");
+  json_builder_add_string_value(builder, model);
+  json_builder_set_member_name(builder, "keep_alive");
+  json_builder_add_int_value(builder, keep_alive_seconds);
+  json_builder_end_object(builder);
+
+  JsonGenerator *generator = json_generator_new();
+  JsonNode *root = json_builder_get_root(builder);
+  json_generator_set_root(generator, root);
+  gsize payload_len = 0;
+  gchar *payload = json_generator_to_data(generator, &payload_len);
+  GBytes *payload_bytes = g_bytes_new_take(payload, payload_len);
+
+  SoupMessage *message =
+      ollama_client_new_message("POST", "/api/generate");
+  soup_message_set_request_body_from_bytes(message,
+                                           "application/json",
+                                           payload_bytes);
+  GBytes *bytes = focus_http_send_and_read(FOCUS_HTTP_OLLAMA, message, cancellable, error);
+
+  gboolean ok = bytes != NULL;
+  if (ok && soup_message_get_status(message) != SOUP_STATUS_OK) {
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_FAILED,
+                "Ollama HTTP error: %u",
+                soup_message_get_status(message));
+    ok = FALSE;
+  }
+
+  if (bytes != NULL) {
+    g_bytes_unref(bytes);
+  }
+  g_bytes_unref(payload_bytes);
+  json_node_free(root);
+  g_object_unref(generator);
+  g_object_unref(builder);
+  g_object_unref(message);
+  return ok;
+}
+
+static GArray *
+ollama_client_parse_vector(JsonArray *values)
+{
+  guint count = values != NULL ? json_array_get_length(values) : 0;
+  GArray *vector = g_array_sized_new(FALSE, FALSE, sizeof(float), count);
+  for (guint i = 0; i < count; i++) {
+    float value = (float)json_array_get_double_element(values, i);
+    g_array_append_val(vector, value);
+  }
+  return vector;
+}
+
+GPtrArray *
+ollama_client_embed_sync(const char *model,
+                         const char *const *inputs,
+                         GCancellable *cancellable,
+                         GError **error)
+{
+  if (model == NULL || *model == '\0') {
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_INVALID_ARGUMENT,
+                "Ollama embedding model not set");
+    return NULL;
+  }
+
+  guint input_count = inputs != NULL ? g_strv_length((gchar **)inputs) : 0;
+  if (input_count == 0) {
+    return g_ptr_array_new_with_free_func((GDestroyNotify)g_array_unref);
+  }
+
+  JsonBuilder *builder = json_builder_new();
+  json_builder_begin_object(builder);
+  json_builder_set_member_name(builder, "model");
+  json_builder_add_string_value(builder, model);
+  json_builder_set_member_name(builder, "input");
+  json_builder_begin_array(builder);
+  for (guint i = 0; i < input_count; i++) {
+    json_builder_add_string_value(builder, inputs[i]);
+  }
+  json_builder_end_array(builder);
+  json_builder_set_member_name(builder, "truncate");
+  json_builder_add_boolean_value(builder, TRUE);
+  json_builder_end_object(builder);
+
+  JsonGenerator *generator = json_generator_new();
+  JsonNode *root = json_builder_get_root(builder);
+  json_generator_set_root(generator, root);
+  gsize payload_len = 0;
+  gchar *payload = json_generator_to_data(generator, &payload_len);
+  GBytes *payload_bytes = g_bytes_new_take(payload, payload_len);
+  json_node_free(root);
+  g_object_unref(generator);
+  g_object_unref(builder);
+
+  SoupMessage *message =
+      ollama_client_new_message("POST", "/api/embed");
+  soup_message_set_request_body_from_bytes(message,
+                                           "application/json",
+                                           payload_bytes);
+  g_bytes_unref(payload_bytes);
+  GBytes *bytes = focus_http_send_and_read(FOCUS_HTTP_OLLAMA, message, cancellable, error);
+  if (bytes == NULL) {
+    g_object_unref(message);
+    return NULL;
+  }
+
+  GPtrArray *vectors = NULL;
+  if (soup_message_get_status(message) != SOUP_STATUS_OK) {
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_FAILED,
+                "Ollama HTTP error: %u",
+                soup_message_get_status(message));
+  } else {
+    gsize len = 0;
+    const gchar *data = g_bytes_get_data(bytes, &len);
+    JsonParser *parser = json_parser_new();
+    if (json_parser_load_from_data(parser, data, (gssize)len, error)) {
+      JsonNode *node = json_parser_get_root(parser);
+      JsonObject *root_obj =
+          node != NULL && JSON_NODE_HOLDS_OBJECT(node) ? json_node_get_object(node)
+                                                       : NULL;
+      JsonArray *embeddings =
+          root_obj != NULL && json_object_has_member(root_obj, "embeddings")
+              ? json_object_get_array_member(root_obj, "embeddings")
+              : NULL;
+      if (embeddings == NULL || json_array_get_length(embeddings) != input_count) {
+        g_set_error(error,
+                    G_IO_ERROR,
+                    G_IO_ERROR_INVALID_DATA,
+                    "Ollama response missing embeddings");
+      } else {
+        vectors = g_ptr_array_new_with_free_func((GDestroyNotify)g_array_unref);
+        for (guint i = 0; i < input_count; i++) {
+          g_ptr_array_add(vectors,
+                          ollama_client_parse_vector(
+                              json_array_get_array_element(embeddings, i)));
+        }
+      }
+    }
+    g_object_unref(parser);
+  }
+
+  g_bytes_unref(bytes);
+  g_object_unref(message);
+  return vectors;
+}
+
 #else
 
+void
+ollama_client_fetch_server_info_async(GCancellable *cancellable,
+                                      GAsyncReadyCallback callback,
+                                      gpointer user_data)
+{
+  (void)cancellable;
+  g_task_report_new_error(NULL,
+                          callback,
+                          user_data,
+                          ollama_client_fetch_server_info_async,
+                          G_IO_ERROR,
+                          G_IO_ERROR_NOT_SUPPORTED,
+                          "Ollama support unavailable (libsoup/json-glib missing)");
+}
+
 gboolean
 ollama_client_detect_available(void)
 {
@@ -251,4 +1006,103 @@ ollama_client_chat_sync(const char *model,
   return NULL;
 }
 
+char *
+ollama_client_chat_stream_sync(const char *model,
+                               const char *system_prompt,
+                               const char *user_prompt,
+                               const OllamaChatOptions *options,
+                               GCancellable *cancellable,
+                               GError **error)
+{
+  (void)model;
+  (void)system_prompt;
+  (void)user_prompt;
+  (void)options;
+  (void)cancellable;
+  g_set_error(error,
+              G_IO_ERROR,
+              G_IO_ERROR_NOT_SUPPORTED,
+              "Ollama support unavailable (libsoup/json-glib missing)");
+  return NULL;
+}
+
+gboolean
+ollama_client_is_model_loaded_sync(const char *model,
+                                   GCancellable *cancellable,
+                                   GError **error)
+{
+  (void)model;
+  (void)cancellable;
+  g_set_error(error,
+              G_IO_ERROR,
+              G_IO_ERROR_NOT_SUPPORTED,
+              "Ollama support unavailable (libsoup/json-glib missing)");
+  return FALSE;
+}
+
+gboolean
+ollama_client_keep_alive_sync(const char *model,
+                              guint keep_alive_seconds,
+                              GCancellable *cancellable,
+                              GError **error)
+{
+  (void)model;
+  (void)keep_alive_seconds;
+  (void)cancellable;
+  g_set_error(error,
+              G_IO_ERROR,
+              G_IO_ERROR_NOT_SUPPORTED,
+              "Ollama support unavailable (libsoup/json-glib missing)");
+  return FALSE;
+}
+
+GPtrArray *
+ollama_client_embed_sync(const char *model,
+                         const char *const *inputs,
+                         GCancellable *cancellable,
+                         GError **error)
+{
+  (void)model;
+  (void)inputs;
+  (void)cancellable;
+  g_set_error(error,
+              G_IO_ERROR,
+              G_IO_ERROR_NOT_SUPPORTED,
+              "Ollama support unavailable (libsoup/json-glib missing)");
+  return NULL;
+}
+
 #endif
+
+void
+ollama_model_info_free(OllamaModelInfo *info)
+{
+  if (info == NULL) {
+    return;
+  }
+
+  g_free(info->name);
+  g_free(info->parameter_size);
+  g_free(info->quantization);
+  g_free(info);
+}
+
+void
+ollama_server_info_free(OllamaServerInfo *info)
+{
+  if (info == NULL) {
+    return;
+  }
+
+  g_free(info->version);
+  if (info->models != NULL) {
+    g_ptr_array_unref(info->models);
+  }
+  g_free(info);
+}
+
+OllamaServerInfo *
+ollama_client_fetch_server_info_finish(GAsyncResult *result, GError **error)
+{
+  return g_task_propagate_pointer(G_TASK(result), error);
+}
@@ -3,10 +3,67 @@
 #include <gio/gio.h>
 #include <glib.h>
 
+/* Filled in when set on OllamaChatOptions. Ollama only reports its own
+ * token counts in the final chunk, which label streaming usually cuts off,
+ * so the counts stay 0 unless the reply ran to completion. */
+typedef struct {
+  guint prompt_tokens;
+  guint output_tokens;
+  guint chunks;
+  gint64 first_chunk_us;
+} OllamaChatUsage;
+
+typedef struct {
+  gint num_predict;
+  const char *const *stop;
+  const char *const *labels;
+  gboolean structured;
+  guint keep_alive_seconds;
+  OllamaChatUsage *usage;
+} OllamaChatOptions;
+
+typedef struct {
+  char *name;
+  gint64 size_bytes;
+  char *parameter_size;
+  char *quantization;
+} OllamaModelInfo;
+
+typedef struct {
+  char *version;
+  GPtrArray *models;
+} OllamaServerInfo;
+
+void ollama_model_info_free(OllamaModelInfo *info);
+void ollama_server_info_free(OllamaServerInfo *info);
+
+void ollama_client_set_base_url(const char *base_url);
 gboolean ollama_client_detect_available(void);
 GPtrArray *ollama_client_list_models_sync(GError **error);
+void ollama_client_fetch_server_info_async(GCancellable *cancellable,
+                                           GAsyncReadyCallback callback,
+                                           gpointer user_data);
+OllamaServerInfo *ollama_client_fetch_server_info_finish(GAsyncResult *result,
+                                                         GError **error);
 char *ollama_client_chat_sync(const char *model,
                               const char *system_prompt,
                               const char *user_prompt,
                               GCancellable *cancellable,
                               GError **error);
+char *ollama_client_chat_stream_sync(const char *model,
+                                     const char *system_prompt,
+                                     const char *user_prompt,
+                                     const OllamaChatOptions *options,
+                                     GCancellable *cancellable,
+                                     GError **error);
+gboolean ollama_client_is_model_loaded_sync(const char *model,
+                                            GCancellable *cancellable,
+                                            GError **error);
+gboolean ollama_client_keep_alive_sync(const char *model,
+                                       guint keep_alive_seconds,
+                                       GCancellable *cancellable,
+                                       GError **error);
+GPtrArray *ollama_client_embed_sync(const char *model,
+                                    const char *const *inputs,
+                                    GCancellable *cancellable,
+                                    GError **error);
@@ -0,0 +1,370 @@
+#include "focus/relevance_cache.h"
+
+/* A verdict for the same task and URL is trusted without looking at the page
+ * for a short while. After that the page is fetched again and the verdict is
+ * reused as long as the content fingerprint still matches. */
+#define RELEVANCE_CACHE_URL_TTL_SECONDS 300
+#define RELEVANCE_CACHE_CONTENT_TTL_SECONDS (24 * 60 * 60)
+#define RELEVANCE_CACHE_MAX_DISTANCE 3
+
+typedef struct {
+  char *key;
+  guint64 fingerprint;
+  gint verdict;
+  gint64 checked_at_utc;
+  GList link;
+} RelevanceCacheEntry;
+
+struct _RelevanceCache {
+  gint ref_count;
+  GMutex mutex;
+  guint capacity;
+  GHashTable *entries;
+  GQueue lru;
+  RelevanceCacheStats stats;
+};
+
+static void
+relevance_cache_entry_free(gpointer data)
+{
+  RelevanceCacheEntry *entry = data;
+  if (entry == NULL) {
+    return;
+  }
+
+  g_free(entry->key);
+  g_free(entry);
+}
+
+static char *
+relevance_cache_make_key(const char *task_key, const char *url)
+{
+  return g_strconcat(task_key != NULL ? task_key : "",
+                     "\n",
+                     url != NULL ? url : "",
+                     NULL);
+}
+
+static guint
+relevance_cache_distance(guint64 left, guint64 right)
+{
+  guint64 diff = left ^ right;
+  guint count = 0;
+  while (diff != 0) {
+    diff &= diff - 1;
+    count++;
+  }
+  return count;
+}
+
+static RelevanceCacheEntry *
+relevance_cache_lookup_locked(RelevanceCache *cache,
+                              const char *task_key,
+                              const char *url,
+                              gboolean count_lookup)
+{
+  char *key = relevance_cache_make_key(task_key, url);
+  RelevanceCacheEntry *entry = g_hash_table_lookup(cache->entries, key);
+  g_free(key);
+
+  if (count_lookup) {
+    cache->stats.lookups++;
+  }
+  if (entry != NULL) {
+    g_queue_unlink(&cache->lru, &entry->link);
+    g_queue_push_head_link(&cache->lru, &entry->link);
+  }
+  return entry;
+}
+
+RelevanceCache *
+relevance_cache_new(guint capacity)
+{
+  RelevanceCache *cache = g_new0(RelevanceCache, 1);
+  cache->ref_count = 1;
+  g_mutex_init(&cache->mutex);
+  cache->capacity = MAX(capacity, 1);
+  cache->entries = g_hash_table_new_full(g_str_hash,
+                                         g_str_equal,
+                                         NULL,
+                                         relevance_cache_entry_free);
+  g_queue_init(&cache->lru);
+  return cache;
+}
+
+RelevanceCache *
+relevance_cache_ref(RelevanceCache *cache)
+{
+  if (cache != NULL) {
+    g_atomic_int_inc(&cache->ref_count);
+  }
+  return cache;
+}
+
+void
+relevance_cache_unref(RelevanceCache *cache)
+{
+  if (cache == NULL || !g_atomic_int_dec_and_test(&cache->ref_count)) {
+    return;
+  }
+
+  g_hash_table_destroy(cache->entries);
+  g_mutex_clear(&cache->mutex);
+  g_free(cache);
+}
+
+char *
+relevance_cache_normalize_task(const char *task_title)
+{
+  if (task_title == NULL) {
+    return g_strdup("");
+  }
+
+  char *folded = g_utf8_casefold(task_title, -1);
+  char **words = g_strsplit_set(g_strstrip(folded), " \t\r\n", -1);
+  GString *normalized = g_string_new(NULL);
+  for (guint i = 0; words != NULL && words[i] != NULL; i++) {
+    if (*words[i] == '\0') {
+      continue;
+    }
+    if (normalized->len > 0) {
+      g_string_append_c(normalized, ' ');
+    }
+    g_string_append(normalized, words[i]);
+  }
+
+  g_strfreev(words);
+  g_free(folded);
+  return g_string_free(normalized, FALSE);
+}
+
+guint64
+relevance_cache_fingerprint(const char *text)
+{
+  if (text == NULL || *text == '\0') {
+    return 0;
+  }
+
+  /* 64-bit simhash over lowercased words: small edits (clocks, counters,
+   * rotating ads) only flip a few bits, so near-identical pages still match. */
+  gint weights[64] = {0};
+  const char *cursor = text;
+  while (*cursor != '\0') {
+    while (*cursor != '\0' && !g_ascii_isalnum(*cursor)) {
+      cursor++;
+    }
+
+    guint64 hash = G_GUINT64_CONSTANT(14695981039346656037);
+    gsize length = 0;
+    while (*cursor != '\0' && g_ascii_isalnum(*cursor)) {
+      hash ^= (guint64)(guchar)g_ascii_tolower(*cursor);
+      hash *= G_GUINT64_CONSTANT(1099511628211);
+      cursor++;
+      length++;
+    }
+
+    if (length == 0) {
+      continue;
+    }
+
+    for (guint bit = 0; bit < 64; bit++) {
+      weights[bit] += (hash >> bit) & 1 ? 1 : -1;
+    }
+  }
+
+  guint64 fingerprint = 0;
+  for (guint bit = 0; bit < 64; bit++) {
+    if (weights[bit] > 0) {
+      fingerprint |= G_GUINT64_CONSTANT(1) << bit;
+    }
+  }
+  return fingerprint;
+}
+
+gboolean
+relevance_cache_lookup_url(RelevanceCache *cache,
+                           const char *task_key,
+                           const char *url,
+                           gint64 now_utc,
+                           gint *verdict_out)
+{
+  if (cache == NULL || url == NULL || *url == '\0') {
+    return FALSE;
+  }
+
+  g_mutex_lock(&cache->mutex);
+  RelevanceCacheEntry *entry = relevance_cache_lookup_locked(cache, task_key, url, TRUE);
+  gboolean hit = entry != NULL &&
+                 now_utc - entry->checked_at_utc < RELEVANCE_CACHE_URL_TTL_SECONDS;
+  if (hit) {
+    cache->stats.url_hits++;
+    if (verdict_out != NULL) {
+      *verdict_out = entry->verdict;
+    }
+  }
+  g_mutex_unlock(&cache->mutex);
+  return hit;
+}
+
+gboolean
+relevance_cache_has_fresh_url(RelevanceCache *cache,
+                              const char *task_key,
+                              const char *url,
+                              gint64 now_utc)
+{
+  if (cache == NULL || url == NULL || *url == '\0') {
+    return FALSE;
+  }
+
+  char *key = relevance_cache_make_key(task_key, url);
+  g_mutex_lock(&cache->mutex);
+  RelevanceCacheEntry *entry = g_hash_table_lookup(cache->entries, key);
+  gboolean fresh = entry != NULL &&
+                   now_utc - entry->checked_at_utc < RELEVANCE_CACHE_URL_TTL_SECONDS;
+  g_mutex_unlock(&cache->mutex);
+  g_free(key);
+  return fresh;
+}
+
+gboolean
+relevance_cache_lookup_content(RelevanceCache *cache,
+                               const char *task_key,
+                               const char *url,
+                               guint64 fingerprint,
+                               gint64 now_utc,
+                               gboolean count_lookup,
+                               gint *verdict_out)
+{
+  if (cache == NULL || fingerprint == 0) {
+    return FALSE;
+  }
+
+  g_mutex_lock(&cache->mutex);
+  RelevanceCacheEntry *entry =
+      relevance_cache_lookup_locked(cache, task_key, url, count_lookup);
+  gboolean hit =
+      entry != NULL &&
+      now_utc - entry->checked_at_utc < RELEVANCE_CACHE_CONTENT_TTL_SECONDS &&
+      relevance_cache_distance(entry->fingerprint, fingerprint) <=
+          RELEVANCE_CACHE_MAX_DISTANCE;
+  if (hit) {
+    cache->stats.content_hits++;
+    if (verdict_out != NULL) {
+      *verdict_out = entry->verdict;
+    }
+  }
+  g_mutex_unlock(&cache->mutex);
+  return hit;
+}
+
+void
+relevance_cache_insert(RelevanceCache *cache,
+                       const char *task_key,
+                       const char *url,
+                       guint64 fingerprint,
+                       gint verdict,
+                       gint64 checked_at_utc)
+{
+  if (cache == NULL || url == NULL || *url == '\0') {
+    return;
+  }
+
+  char *key = relevance_cache_make_key(task_key, url);
+
+  g_mutex_lock(&cache->mutex);
+  RelevanceCacheEntry *entry = g_hash_table_lookup(cache->entries, key);
+  if (entry != NULL) {
+    g_free(key);
+    g_queue_unlink(&cache->lru, &entry->link);
+  } else {
+    entry = g_new0(RelevanceCacheEntry, 1);
+    entry->key = key;
+    entry->link.data = entry;
+    g_hash_table_insert(cache->entries, entry->key, entry);
+  }
+
+  entry->fingerprint = fingerprint;
+  entry->verdict = verdict;
+  entry->checked_at_utc = checked_at_utc;
+  g_queue_push_head_link(&cache->lru, &entry->link);
+  cache->stats.inserts++;
+
+  while (cache->lru.length > cache->capacity) {
+    GList *tail = g_queue_pop_tail_link(&cache->lru);
+    RelevanceCacheEntry *evicted = tail->data;
+    g_hash_table_remove(cache->entries, evicted->key);
+    cache->stats.evictions++;
+  }
+  g_mutex_unlock(&cache->mutex);
+}
+
+void
+relevance_cache_clear(RelevanceCache *cache)
+{
+  if (cache == NULL) {
+    return;
+  }
+
+  g_mutex_lock(&cache->mutex);
+  g_queue_init(&cache->lru);
+  g_hash_table_remove_all(cache->entries);
+  cache->stats = (RelevanceCacheStats){0};
+  g_mutex_unlock(&cache->mutex);
+}
+
+void
+relevance_cache_load_from_store(RelevanceCache *cache,
+                                UsageStatsStore *store,
+                                gint64 now_utc)
+{
+  if (cache == NULL || store == NULL) {
+    return;
+  }
+
+  gint64 cutoff_utc = now_utc - RELEVANCE_CACHE_CONTENT_TTL_SECONDS;
+  usage_stats_store_prune_verdicts(store, cutoff_utc);
+
+  GPtrArray *verdicts = usage_stats_store_load_verdicts(store, cutoff_utc);
+  if (verdicts == NULL) {
+    return;
+  }
+
+  for (guint i = 0; i < verdicts->len; i++) {
+    UsageStatsVerdict *verdict = g_ptr_array_index(verdicts, i);
+    relevance_cache_insert(cache,
+                           verdict->task_key,
+                           verdict->url,
+                           verdict->fingerprint,
+                           verdict->verdict,
+                           verdict->checked_at_utc);
+  }
+
+  g_ptr_array_free(verdicts, TRUE);
+}
+
+void
+relevance_cache_get_stats(RelevanceCache *cache, RelevanceCacheStats *stats_out)
+{
+  if (stats_out == NULL) {
+    return;
+  }
+
+  if (cache == NULL) {
+    *stats_out = (RelevanceCacheStats){0};
+    return;
+  }
+
+  g_mutex_lock(&cache->mutex);
+  *stats_out = cache->stats;
+  g_mutex_unlock(&cache->mutex);
+}
+
+double
+relevance_cache_stats_hit_rate(const RelevanceCacheStats *stats)
+{
+  if (stats == NULL || stats->lookups == 0) {
+    return 0.0;
+  }
+
+  return 100.0 * (stats->url_hits + stats->content_hits) / stats->lookups;
+}
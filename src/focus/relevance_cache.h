@@ -0,0 +1,56 @@
+#pragma once
+
+#include <glib.h>
+
+#include "storage/usage_stats_storage.h"
+
+typedef struct _RelevanceCache RelevanceCache;
+
+typedef struct {
+  guint64 lookups;
+  guint64 url_hits;
+  guint64 content_hits;
+  guint64 inserts;
+  guint64 evictions;
+} RelevanceCacheStats;
+
+RelevanceCache *relevance_cache_new(guint capacity);
+RelevanceCache *relevance_cache_ref(RelevanceCache *cache);
+void relevance_cache_unref(RelevanceCache *cache);
+
+char *relevance_cache_normalize_task(const char *task_title);
+guint64 relevance_cache_fingerprint(const char *text);
+
+gboolean relevance_cache_lookup_url(RelevanceCache *cache,
+                                    const char *task_key,
+                                    const char *url,
+                                    gint64 now_utc,
+                                    gint *verdict_out);
+/* Whether a URL verdict is still fresh, without counting as a lookup. */
+gboolean relevance_cache_has_fresh_url(RelevanceCache *cache,
+                                       const char *task_key,
+                                       const char *url,
+                                       gint64 now_utc);
+/* lookups counts checks, not calls: pass count_lookup FALSE when the same
+ * check already missed relevance_cache_lookup_url. */
+gboolean relevance_cache_lookup_content(RelevanceCache *cache,
+                                        const char *task_key,
+                                        const char *url,
+                                        guint64 fingerprint,
+                                        gint64 now_utc,
+                                        gboolean count_lookup,
+                                        gint *verdict_out);
+void relevance_cache_insert(RelevanceCache *cache,
+                            const char *task_key,
+                            const char *url,
+                            guint64 fingerprint,
+                            gint verdict,
+                            gint64 checked_at_utc);
+/* Drops every verdict and resets the counters. */
+void relevance_cache_clear(RelevanceCache *cache);
+void relevance_cache_load_from_store(RelevanceCache *cache,
+                                     UsageStatsStore *store,
+                                     gint64 now_utc);
+void relevance_cache_get_stats(RelevanceCache *cache, RelevanceCacheStats *stats_out);
+/* Percentage of checks answered from the cache, as the stats report shows. */
+double relevance_cache_stats_hit_rate(const RelevanceCacheStats *stats);
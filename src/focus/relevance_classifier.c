@@ -0,0 +1,355 @@
+#include "focus/relevance_classifier.h"
+
+#include <math.h>
+#include <string.h>
+
+/* Naive Bayes over hashed features of (task title, domain, page title),
+ * trained from the chat model's verdicts. It only answers when it has seen
+ * enough of both labels and the model has already judged this task on this
+ * domain; everything else still goes to the model. */
+#define RELEVANCE_CLASSIFIER_BUCKET_BITS 16
+#define RELEVANCE_CLASSIFIER_BUCKETS (1u << RELEVANCE_CLASSIFIER_BUCKET_BITS)
+#define RELEVANCE_CLASSIFIER_MAX_TOKENS 12
+#define RELEVANCE_CLASSIFIER_ALPHA 0.5
+#define RELEVANCE_CLASSIFIER_MIN_CLASS_EXAMPLES 5
+#define RELEVANCE_CLASSIFIER_MIN_EXAMPLES 20
+#define RELEVANCE_CLASSIFIER_MIN_TASK_DOMAIN_EXAMPLES 2
+#define RELEVANCE_CLASSIFIER_CONFIDENCE 0.97
+#define RELEVANCE_CLASSIFIER_MAX_STORED 5000
+
+enum {
+  RELEVANCE_CLASSIFIER_IRRELEVANT = 0,
+  RELEVANCE_CLASSIFIER_RELEVANT = 1,
+};
+
+struct _RelevanceClassifier {
+  gint ref_count;
+  GMutex mutex;
+  guint32 *counts[2];
+  guint64 feature_totals[2];
+  guint64 examples[2];
+  guint vocabulary;
+  RelevanceClassifierStats stats;
+};
+
+static const char *const relevance_classifier_stopwords[] = {
+    "a", "an", "and", "are", "for", "from", "in", "is", "of", "on", "or",
+    "the", "to", "with", "your", "you", NULL,
+};
+
+RelevanceClassifier *
+relevance_classifier_new(void)
+{
+  RelevanceClassifier *classifier = g_new0(RelevanceClassifier, 1);
+  classifier->ref_count = 1;
+  g_mutex_init(&classifier->mutex);
+  classifier->counts[RELEVANCE_CLASSIFIER_IRRELEVANT] =
+      g_new0(guint32, RELEVANCE_CLASSIFIER_BUCKETS);
+  classifier->counts[RELEVANCE_CLASSIFIER_RELEVANT] =
+      g_new0(guint32, RELEVANCE_CLASSIFIER_BUCKETS);
+  return classifier;
+}
+
+RelevanceClassifier *
+relevance_classifier_ref(RelevanceClassifier *classifier)
+{
+  if (classifier != NULL) {
+    g_atomic_int_inc(&classifier->ref_count);
+  }
+  return classifier;
+}
+
+void
+relevance_classifier_unref(RelevanceClassifier *classifier)
+{
+  if (classifier == NULL || !g_atomic_int_dec_and_test(&classifier->ref_count)) {
+    return;
+  }
+
+  g_free(classifier->counts[RELEVANCE_CLASSIFIER_IRRELEVANT]);
+  g_free(classifier->counts[RELEVANCE_CLASSIFIER_RELEVANT]);
+  g_mutex_clear(&classifier->mutex);
+  g_free(classifier);
+}
+
+void
+relevance_classifier_reset(RelevanceClassifier *classifier)
+{
+  if (classifier == NULL) {
+    return;
+  }
+
+  g_mutex_lock(&classifier->mutex);
+  for (guint label = 0; label < 2; label++) {
+    memset(classifier->counts[label], 0, RELEVANCE_CLASSIFIER_BUCKETS * sizeof(guint32));
+    classifier->feature_totals[label] = 0;
+    classifier->examples[label] = 0;
+  }
+  classifier->vocabulary = 0;
+  classifier->stats = (RelevanceClassifierStats){0};
+  g_mutex_unlock(&classifier->mutex);
+}
+
+static gboolean
+relevance_classifier_is_stopword(const char *token)
+{
+  for (guint i = 0; relevance_classifier_stopwords[i] != NULL; i++) {
+    if (strcmp(token, relevance_classifier_stopwords[i]) == 0) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/* Lowercase alphanumeric words of two or more characters, deduplicated. */
+static GPtrArray *
+relevance_classifier_tokenize(const char *text)
+{
+  GPtrArray *tokens = g_ptr_array_new_with_free_func(g_free);
+  if (text == NULL || !g_utf8_validate(text, -1, NULL)) {
+    return tokens;
+  }
+
+  char *lower = g_utf8_strdown(text, -1);
+  GString *word = g_string_new(NULL);
+  for (const char *p = lower;; p = g_utf8_next_char(p)) {
+    gunichar c = g_utf8_get_char(p);
+    if (c != 0 && g_unichar_isalnum(c)) {
+      g_string_append_unichar(word, c);
+      continue;
+    }
+
+    if (g_utf8_strlen(word->str, -1) >= 2 && !relevance_classifier_is_stopword(word->str)) {
+      gboolean seen = FALSE;
+      for (guint i = 0; i < tokens->len && !seen; i++) {
+        seen = strcmp(g_ptr_array_index(tokens, i), word->str) == 0;
+      }
+      if (!seen) {
+        g_ptr_array_add(tokens, g_strdup(word->str));
+      }
+    }
+    g_string_truncate(word, 0);
+
+    if (c == 0 || tokens->len >= RELEVANCE_CLASSIFIER_MAX_TOKENS) {
+      break;
+    }
+  }
+
+  g_string_free(word, TRUE);
+  g_free(lower);
+  return tokens;
+}
+
+static guint32
+relevance_classifier_add_feature(GArray *features,
+                                 const char *kind,
+                                 const char *a,
+                                 const char *b)
+{
+  /* FNV-1a over "kind\x1fa\x1fb". */
+  guint32 hash = 2166136261u;
+  const char *parts[] = {kind, a, b};
+  for (guint i = 0; i < G_N_ELEMENTS(parts); i++) {
+    for (const char *p = parts[i] != NULL ? parts[i] : ""; *p != '\0'; p++) {
+      hash = (hash ^ (guchar)*p) * 16777619u;
+    }
+    hash = (hash ^ 0x1f) * 16777619u;
+  }
+
+  guint32 bucket = hash & (RELEVANCE_CLASSIFIER_BUCKETS - 1);
+  g_array_append_val(features, bucket);
+  return bucket;
+}
+
+/* Site-wide features (domain, title words) carry what is distracting in
+ * general; the crossed ones carry what belongs to this particular task. */
+static GArray *
+relevance_classifier_features(const char *task_title,
+                              const char *domain,
+                              const char *page_title,
+                              guint32 *task_domain_out)
+{
+  GArray *features = g_array_new(FALSE, FALSE, sizeof(guint32));
+  GPtrArray *task_tokens = relevance_classifier_tokenize(task_title);
+  GPtrArray *title_tokens = relevance_classifier_tokenize(page_title);
+  const char *site = domain != NULL ? domain : "";
+
+  g_ptr_array_add(task_tokens, NULL);
+  char *task_key = g_strjoinv(" ", (char **)task_tokens->pdata);
+  g_ptr_array_remove_index(task_tokens, task_tokens->len - 1);
+
+  relevance_classifier_add_feature(features, "d", site, NULL);
+  guint32 task_domain = relevance_classifier_add_feature(features, "td", task_key, site);
+  if (task_domain_out != NULL) {
+    *task_domain_out = task_domain;
+  }
+  for (guint i = 0; i < title_tokens->len; i++) {
+    relevance_classifier_add_feature(features, "w", g_ptr_array_index(title_tokens, i), NULL);
+  }
+
+  for (guint k = 0; k < task_tokens->len; k++) {
+    const char *task_token = g_ptr_array_index(task_tokens, k);
+    relevance_classifier_add_feature(features, "kd", task_token, site);
+    for (guint i = 0; i < title_tokens->len; i++) {
+      relevance_classifier_add_feature(features,
+                                       "kw",
+                                       task_token,
+                                       g_ptr_array_index(title_tokens, i));
+    }
+  }
+
+  g_free(task_key);
+  g_ptr_array_free(task_tokens, TRUE);
+  g_ptr_array_free(title_tokens, TRUE);
+  return features;
+}
+
+void
+relevance_classifier_train(RelevanceClassifier *classifier,
+                           const char *task_title,
+                           const char *domain,
+                           const char *page_title,
+                           gboolean relevant)
+{
+  if (classifier == NULL || task_title == NULL) {
+    return;
+  }
+
+  GArray *features = relevance_classifier_features(task_title, domain, page_title, NULL);
+  guint label = relevant ? RELEVANCE_CLASSIFIER_RELEVANT : RELEVANCE_CLASSIFIER_IRRELEVANT;
+
+  g_mutex_lock(&classifier->mutex);
+  for (guint i = 0; i < features->len; i++) {
+    guint32 bucket = g_array_index(features, guint32, i);
+    if (classifier->counts[0][bucket] == 0 && classifier->counts[1][bucket] == 0) {
+      classifier->vocabulary++;
+    }
+    classifier->counts[label][bucket]++;
+  }
+  classifier->feature_totals[label] += features->len;
+  classifier->examples[label]++;
+  g_mutex_unlock(&classifier->mutex);
+
+  g_array_free(features, TRUE);
+}
+
+gboolean
+relevance_classifier_predict(RelevanceClassifier *classifier,
+                             const char *task_title,
+                             const char *domain,
+                             const char *page_title,
+                             gboolean *relevant_out,
+                             double *probability_out)
+{
+  if (classifier == NULL || task_title == NULL) {
+    return FALSE;
+  }
+
+  guint32 task_domain = 0;
+  GArray *features =
+      relevance_classifier_features(task_title, domain, page_title, &task_domain);
+
+  g_mutex_lock(&classifier->mutex);
+  classifier->stats.predictions++;
+  guint64 negatives = classifier->examples[RELEVANCE_CLASSIFIER_IRRELEVANT];
+  guint64 positives = classifier->examples[RELEVANCE_CLASSIFIER_RELEVANT];
+  if (negatives < RELEVANCE_CLASSIFIER_MIN_CLASS_EXAMPLES ||
+      positives < RELEVANCE_CLASSIFIER_MIN_CLASS_EXAMPLES ||
+      negatives + positives < RELEVANCE_CLASSIFIER_MIN_EXAMPLES) {
+    g_mutex_unlock(&classifier->mutex);
+    g_array_free(features, TRUE);
+    return FALSE;
+  }
+
+  double vocabulary = MAX(classifier->vocabulary, 1u);
+  double denominator[2];
+  for (guint label = 0; label < 2; label++) {
+    denominator[label] =
+        classifier->feature_totals[label] + RELEVANCE_CLASSIFIER_ALPHA * vocabulary;
+  }
+
+  double evidence = 0.0;
+  for (guint i = 0; i < features->len; i++) {
+    guint32 bucket = g_array_index(features, guint32, i);
+    guint32 negative = classifier->counts[RELEVANCE_CLASSIFIER_IRRELEVANT][bucket];
+    guint32 positive = classifier->counts[RELEVANCE_CLASSIFIER_RELEVANT][bucket];
+    evidence += log((positive + RELEVANCE_CLASSIFIER_ALPHA) / denominator[1]) -
+                log((negative + RELEVANCE_CLASSIFIER_ALPHA) / denominator[0]);
+  }
+  guint64 task_domain_examples =
+      (guint64)classifier->counts[RELEVANCE_CLASSIFIER_IRRELEVANT][task_domain] +
+      classifier->counts[RELEVANCE_CLASSIFIER_RELEVANT][task_domain];
+
+  /* Crossed features overlap heavily (one task word pairs with every title
+   * word), so their evidence is damped instead of summed as independent. */
+  double log_odds = log((positives + 1.0) / (negatives + 1.0)) +
+                    evidence / sqrt(MAX(features->len, 1u));
+  double probability = 1.0 / (1.0 + exp(-log_odds));
+  gboolean confident = task_domain_examples >= RELEVANCE_CLASSIFIER_MIN_TASK_DOMAIN_EXAMPLES &&
+                       (probability >= RELEVANCE_CLASSIFIER_CONFIDENCE ||
+                        probability <= 1.0 - RELEVANCE_CLASSIFIER_CONFIDENCE);
+  if (confident) {
+    classifier->stats.confident++;
+  }
+  g_mutex_unlock(&classifier->mutex);
+  g_array_free(features, TRUE);
+
+  if (relevant_out != NULL) {
+    *relevant_out = probability >= 0.5;
+  }
+  if (probability_out != NULL) {
+    *probability_out = probability;
+  }
+  return confident;
+}
+
+void
+relevance_classifier_load_from_store(RelevanceClassifier *classifier,
+                                     UsageStatsStore *store,
+                                     gint relevant_verdict,
+                                     gint irrelevant_verdict)
+{
+  if (classifier == NULL || store == NULL) {
+    return;
+  }
+
+  usage_stats_store_prune_examples(store, RELEVANCE_CLASSIFIER_MAX_STORED);
+  GPtrArray *examples = usage_stats_store_load_examples(store, RELEVANCE_CLASSIFIER_MAX_STORED);
+  if (examples == NULL) {
+    return;
+  }
+
+  for (guint i = 0; i < examples->len; i++) {
+    UsageStatsExample *example = g_ptr_array_index(examples, i);
+    if (example->verdict != relevant_verdict && example->verdict != irrelevant_verdict) {
+      continue;
+    }
+    relevance_classifier_train(classifier,
+                               example->task_title,
+                               example->domain,
+                               example->page_title,
+                               example->verdict == relevant_verdict);
+  }
+
+  g_ptr_array_free(examples, TRUE);
+}
+
+void
+relevance_classifier_get_stats(RelevanceClassifier *classifier,
+                               RelevanceClassifierStats *stats_out)
+{
+  if (stats_out == NULL) {
+    return;
+  }
+
+  if (classifier == NULL) {
+    *stats_out = (RelevanceClassifierStats){0};
+    return;
+  }
+
+  g_mutex_lock(&classifier->mutex);
+  *stats_out = classifier->stats;
+  stats_out->relevant_examples = classifier->examples[RELEVANCE_CLASSIFIER_RELEVANT];
+  stats_out->irrelevant_examples = classifier->examples[RELEVANCE_CLASSIFIER_IRRELEVANT];
+  g_mutex_unlock(&classifier->mutex);
+}
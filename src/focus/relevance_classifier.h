@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glib.h>
+
+#include "storage/usage_stats_storage.h"
+
+typedef struct _RelevanceClassifier RelevanceClassifier;
+
+typedef struct {
+  guint64 relevant_examples;
+  guint64 irrelevant_examples;
+  guint64 predictions;
+  guint64 confident;
+} RelevanceClassifierStats;
+
+RelevanceClassifier *relevance_classifier_new(void);
+RelevanceClassifier *relevance_classifier_ref(RelevanceClassifier *classifier);
+void relevance_classifier_unref(RelevanceClassifier *classifier);
+
+/* Forgets everything learned, as when the stored examples are deleted. */
+void relevance_classifier_reset(RelevanceClassifier *classifier);
+
+void relevance_classifier_train(RelevanceClassifier *classifier,
+                                const char *task_title,
+                                const char *domain,
+                                const char *page_title,
+                                gboolean relevant);
+gboolean relevance_classifier_predict(RelevanceClassifier *classifier,
+                                      const char *task_title,
+                                      const char *domain,
+                                      const char *page_title,
+                                      gboolean *relevant_out,
+                                      double *probability_out);
+
+void relevance_classifier_load_from_store(RelevanceClassifier *classifier,
+                                          UsageStatsStore *store,
+                                          gint relevant_verdict,
+                                          gint irrelevant_verdict);
+void relevance_classifier_get_stats(RelevanceClassifier *classifier,
+                                    RelevanceClassifierStats *stats_out);
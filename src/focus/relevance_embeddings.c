@@ -0,0 +1,287 @@
+#include "focus/relevance_embeddings.h"
+
+#include <math.h>
+
+#include "focus/ollama_client.h"
+
+/* Task vectors are cheap to keep; a handful of tasks is the common case. */
+#define RELEVANCE_EMBEDDINGS_MAX_TASKS 64
+/* Page text beyond this adds little signal and slows the embedding call. */
+#define RELEVANCE_EMBEDDINGS_MAX_PAGE_CHARS 2000
+/* After a failed call (model not pulled, server down) the embedding stage
+ * is skipped for a while instead of adding a failing request to every check. */
+#define RELEVANCE_EMBEDDINGS_RETRY_SECONDS 300
+
+struct _RelevanceEmbeddings {
+  gint ref_count;
+  GMutex mutex;
+  GHashTable *tasks;
+  gint64 retry_after_us;
+};
+
+RelevanceEmbeddings *
+relevance_embeddings_new(void)
+{
+  RelevanceEmbeddings *embeddings = g_new0(RelevanceEmbeddings, 1);
+  embeddings->ref_count = 1;
+  g_mutex_init(&embeddings->mutex);
+  embeddings->tasks = g_hash_table_new_full(g_str_hash,
+                                            g_str_equal,
+                                            g_free,
+                                            (GDestroyNotify)g_array_unref);
+  return embeddings;
+}
+
+RelevanceEmbeddings *
+relevance_embeddings_ref(RelevanceEmbeddings *embeddings)
+{
+  if (embeddings != NULL) {
+    g_atomic_int_inc(&embeddings->ref_count);
+  }
+  return embeddings;
+}
+
+void
+relevance_embeddings_unref(RelevanceEmbeddings *embeddings)
+{
+  if (embeddings == NULL || !g_atomic_int_dec_and_test(&embeddings->ref_count)) {
+    return;
+  }
+
+  g_hash_table_destroy(embeddings->tasks);
+  g_mutex_clear(&embeddings->mutex);
+  g_free(embeddings);
+}
+
+double
+relevance_embeddings_dot(const float *left, const float *right, guint length)
+{
+  /* Independent accumulators let the compiler vectorize the loop. */
+  float sum0 = 0.0f;
+  float sum1 = 0.0f;
+  float sum2 = 0.0f;
+  float sum3 = 0.0f;
+  guint i = 0;
+  for (; i + 4 <= length; i += 4) {
+    sum0 += left[i] * right[i];
+    sum1 += left[i + 1] * right[i + 1];
+    sum2 += left[i + 2] * right[i + 2];
+    sum3 += left[i + 3] * right[i + 3];
+  }
+  for (; i < length; i++) {
+    sum0 += left[i] * right[i];
+  }
+  return (double)((sum0 + sum1) + (sum2 + sum3));
+}
+
+static void
+relevance_embeddings_normalize(GArray *vector)
+{
+  float *values = (float *)vector->data;
+  double norm = sqrt(relevance_embeddings_dot(values, values, vector->len));
+  if (norm <= 0.0) {
+    return;
+  }
+
+  for (guint i = 0; i < vector->len; i++) {
+    values[i] = (float)(values[i] / norm);
+  }
+}
+
+char *
+relevance_embeddings_page_text(const char *title,
+                               const char *url,
+                               const char *content)
+{
+  GString *text = g_string_new(NULL);
+  if (title != NULL && *title != '\0') {
+    g_string_append_printf(text, "%s\n", title);
+  }
+  if (url != NULL && *url != '\0') {
+    g_string_append_printf(text, "%s\n", url);
+  }
+  if (content != NULL && *content != '\0') {
+    char *excerpt = g_utf8_substring(content,
+                                     0,
+                                     MIN(g_utf8_strlen(content, -1),
+                                         RELEVANCE_EMBEDDINGS_MAX_PAGE_CHARS));
+    g_string_append(text, excerpt);
+    g_free(excerpt);
+  }
+  return g_string_free(text, FALSE);
+}
+
+static char *
+relevance_embeddings_make_key(const char *model, const char *task_key)
+{
+  return g_strconcat(model, "\n", task_key != NULL ? task_key : "", NULL);
+}
+
+gboolean
+relevance_embeddings_score_batch_sync(RelevanceEmbeddings *embeddings,
+                                      const char *model,
+                                      const char *task_key,
+                                      const char *task_title,
+                                      const char *const *page_texts,
+                                      double *similarities_out,
+                                      GCancellable *cancellable,
+                                      GError **error)
+{
+  if (embeddings == NULL || model == NULL || *model == '\0' ||
+      task_title == NULL || page_texts == NULL || similarities_out == NULL) {
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_INVALID_ARGUMENT,
+                "Embedding request incomplete");
+    return FALSE;
+  }
+
+  guint page_count = g_strv_length((gchar **)page_texts);
+  if (page_count == 0) {
+    return TRUE;
+  }
+
+  char *key = relevance_embeddings_make_key(model, task_key);
+  GArray *task_vector = NULL;
+  gint64 now_us = g_get_monotonic_time();
+
+  g_mutex_lock(&embeddings->mutex);
+  gboolean backing_off = now_us < embeddings->retry_after_us;
+  task_vector = g_hash_table_lookup(embeddings->tasks, key);
+  if (task_vector != NULL) {
+    g_array_ref(task_vector);
+  }
+  g_mutex_unlock(&embeddings->mutex);
+
+  if (backing_off) {
+    if (task_vector != NULL) {
+      g_array_unref(task_vector);
+    }
+    g_free(key);
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_NOT_CONNECTED,
+                "Embedding model %s recently failed",
+                model);
+    return FALSE;
+  }
+
+  /* The task title rides along after the pages the first time only. */
+  const char **inputs = g_new0(const char *, page_count + 2);
+  for (guint i = 0; i < page_count; i++) {
+    inputs[i] = page_texts[i];
+  }
+  if (task_vector == NULL) {
+    inputs[page_count] = task_title;
+  }
+
+  GError *local_error = NULL;
+  GPtrArray *vectors = ollama_client_embed_sync(model,
+                                                inputs,
+                                                cancellable,
+                                                &local_error);
+  g_free(inputs);
+  if (vectors != NULL &&
+      vectors->len != page_count + (task_vector == NULL ? 1 : 0)) {
+    g_set_error(&local_error,
+                G_IO_ERROR,
+                G_IO_ERROR_INVALID_DATA,
+                "Expected %u embeddings, got %u",
+                page_count + (task_vector == NULL ? 1 : 0),
+                vectors->len);
+    g_clear_pointer(&vectors, g_ptr_array_unref);
+  }
+  /* An empty task vector is neither cached nor retried right away. */
+  GArray *new_task_vector =
+      vectors != NULL && task_vector == NULL ? g_ptr_array_index(vectors, page_count) : NULL;
+  if (new_task_vector != NULL && new_task_vector->len == 0) {
+    g_set_error(&local_error,
+                G_IO_ERROR,
+                G_IO_ERROR_INVALID_DATA,
+                "Embedding model %s returned empty vectors",
+                model);
+    g_clear_pointer(&vectors, g_ptr_array_unref);
+  }
+  if (vectors == NULL) {
+    if (!g_error_matches(local_error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+      g_mutex_lock(&embeddings->mutex);
+      embeddings->retry_after_us =
+          g_get_monotonic_time() + RELEVANCE_EMBEDDINGS_RETRY_SECONDS * G_USEC_PER_SEC;
+      g_mutex_unlock(&embeddings->mutex);
+    }
+    if (task_vector != NULL) {
+      g_array_unref(task_vector);
+    }
+    g_free(key);
+    g_propagate_error(error, local_error);
+    return FALSE;
+  }
+
+  if (task_vector == NULL) {
+    task_vector = g_array_ref(g_ptr_array_index(vectors, page_count));
+    relevance_embeddings_normalize(task_vector);
+
+    g_mutex_lock(&embeddings->mutex);
+    if (g_hash_table_size(embeddings->tasks) >= RELEVANCE_EMBEDDINGS_MAX_TASKS) {
+      g_hash_table_remove_all(embeddings->tasks);
+    }
+    g_hash_table_replace(embeddings->tasks,
+                         g_strdup(key),
+                         g_array_ref(task_vector));
+    g_mutex_unlock(&embeddings->mutex);
+  }
+
+  gboolean ok = TRUE;
+  for (guint i = 0; ok && i < page_count; i++) {
+    GArray *page_vector = g_ptr_array_index(vectors, i);
+    if (page_vector->len != task_vector->len) {
+      g_set_error(error,
+                  G_IO_ERROR,
+                  G_IO_ERROR_INVALID_DATA,
+                  "Embedding dimensions differ (%u vs %u)",
+                  task_vector->len,
+                  page_vector->len);
+      ok = FALSE;
+      break;
+    }
+
+    relevance_embeddings_normalize(page_vector);
+    similarities_out[i] = relevance_embeddings_dot((const float *)task_vector->data,
+                                                   (const float *)page_vector->data,
+                                                   task_vector->len);
+  }
+
+  g_array_unref(task_vector);
+  g_ptr_array_unref(vectors);
+  g_free(key);
+  return ok;
+}
+
+gboolean
+relevance_embeddings_score_sync(RelevanceEmbeddings *embeddings,
+                                const char *model,
+                                const char *task_key,
+                                const char *task_title,
+                                const char *page_text,
+                                double *similarity_out,
+                                GCancellable *cancellable,
+                                GError **error)
+{
+  if (page_text == NULL || similarity_out == NULL) {
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_INVALID_ARGUMENT,
+                "Embedding request incomplete");
+    return FALSE;
+  }
+
+  const char *page_texts[2] = {page_text, NULL};
+  return relevance_embeddings_score_batch_sync(embeddings,
+                                               model,
+                                               task_key,
+                                               task_title,
+                                               page_texts,
+                                               similarity_out,
+                                               cancellable,
+                                               error);
+}
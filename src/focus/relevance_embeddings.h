@@ -0,0 +1,34 @@
+#pragma once
+
+#include <gio/gio.h>
+#include <glib.h>
+
+typedef struct _RelevanceEmbeddings RelevanceEmbeddings;
+
+RelevanceEmbeddings *relevance_embeddings_new(void);
+RelevanceEmbeddings *relevance_embeddings_ref(RelevanceEmbeddings *embeddings);
+void relevance_embeddings_unref(RelevanceEmbeddings *embeddings);
+
+double relevance_embeddings_dot(const float *left, const float *right, guint length);
+char *relevance_embeddings_page_text(const char *title,
+                                     const char *url,
+                                     const char *content);
+
+gboolean relevance_embeddings_score_sync(RelevanceEmbeddings *embeddings,
+                                         const char *model,
+                                         const char *task_key,
+                                         const char *task_title,
+                                         const char *page_text,
+                                         double *similarity_out,
+                                         GCancellable *cancellable,
+                                         GError **error);
+/* Scores every entry of the NULL-terminated page_texts in one embedding
+ * request; similarities_out needs room for one value per page. */
+gboolean relevance_embeddings_score_batch_sync(RelevanceEmbeddings *embeddings,
+                                               const char *model,
+                                               const char *task_key,
+                                               const char *task_title,
+                                               const char *const *page_texts,
+                                               double *similarities_out,
+                                               GCancellable *cancellable,
+                                               GError **error);
@@ -0,0 +1,104 @@
+#include "focus/relevance_prompt.h"
+
+const char *const relevance_prompt_labels[] = {
+    "directly relevant",
+    "not sure",
+    "clearly irrelevant",
+    NULL,
+};
+
+const char *const relevance_prompt_stop[] = {
+    "}",
+    NULL,
+};
+
+FocusGuardRelevance
+relevance_prompt_parse_response(const char *response)
+{
+  if (response == NULL) {
+    return FOCUS_GUARD_RELEVANCE_UNKNOWN;
+  }
+
+  char *lower = g_ascii_strdown(response, -1);
+  FocusGuardRelevance verdict = FOCUS_GUARD_RELEVANCE_UNSURE;
+  if (g_strstr_len(lower, -1, "clearly irrelevant") != NULL) {
+    verdict = FOCUS_GUARD_RELEVANCE_IRRELEVANT;
+  } else if (g_strstr_len(lower, -1, "directly relevant") != NULL) {
+    verdict = FOCUS_GUARD_RELEVANCE_RELEVANT;
+  } else if (g_strstr_len(lower, -1, "not sure") != NULL) {
+    verdict = FOCUS_GUARD_RELEVANCE_UNSURE;
+  }
+  g_free(lower);
+  return verdict;
+}
+
+const char *
+relevance_prompt_system(void)
+{
+  return "You are a focus assistant that checks if a web page is relevant to the user's task."
+         " Reply with exactly one label: directly relevant, not sure, or clearly irrelevant."
+         " Use the content inside XML-like tags to decide.\n"
+         "\n"
+         "Examples:\n"
+         "<task-title>Draft Q4 budget report</task-title>\n"
+         "<page-title>Q4 Budget — Google Sheets</page-title>\n"
+         "<page-content>Revenue, expenses, forecasts, variance notes...</page-content>\n"
+         "Answer: directly relevant\n"
+         "---\n"
+         "<task-title>Draft Q4 budget report</task-title>\n"
+         "<page-title>YouTube — Lo-fi hip hop</page-title>\n"
+         "<page-content>Playlists, comments, music channels...</page-content>\n"
+         "Answer: clearly irrelevant\n"
+         "---\n"
+         "<task-title>Study GTK4 layout</task-title>\n"
+         "<page-title>GTK4 Box and Grid — GNOME Developer</page-title>\n"
+         "<page-content>GtkBox, GtkGrid, layout examples...</page-content>\n"
+         "Answer: directly relevant\n"
+         "---\n"
+         "<task-title>Plan a workshop agenda</task-title>\n"
+         "<page-title>Hacker News</page-title>\n"
+         "<page-content>Top stories, comments, unrelated news...</page-content>\n"
+         "Answer: not sure\n"
+         "\n"
+         "Return only the label.";
+}
+
+static char *
+relevance_prompt_escape_xml(const char *text)
+{
+  if (text == NULL) {
+    return g_strdup("");
+  }
+
+  return g_markup_escape_text(text, -1);
+}
+
+char *
+relevance_prompt_build_user(const char *task_title, const ChromeCdpPage *page)
+{
+  char *task = relevance_prompt_escape_xml(task_title);
+  char *title = relevance_prompt_escape_xml(page != NULL ? page->title : NULL);
+  char *url = relevance_prompt_escape_xml(page != NULL ? page->url : NULL);
+  char *content = relevance_prompt_escape_xml(page != NULL ? page->text : NULL);
+
+  GString *prompt = g_string_new(NULL);
+  g_string_append(prompt, "<context>\n");
+  g_string_append_printf(prompt, "  <task-title>%s</task-title>\n", task);
+  g_string_append(prompt, "  <page>\n");
+  g_string_append_printf(prompt, "    <page-title>%s</page-title>\n", title);
+  g_string_append_printf(prompt, "    <page-url>%s</page-url>\n", url);
+  g_string_append(prompt, "    <page-content>\n");
+  g_string_append(prompt, content);
+  g_string_append(prompt, "\n    </page-content>\n");
+  g_string_append(prompt, "  </page>\n");
+  g_string_append(prompt, "</context>\n\n");
+  g_string_append(prompt,
+                  "Answer with exactly one label: directly relevant, not sure, or clearly irrelevant.");
+
+  g_free(task);
+  g_free(title);
+  g_free(url);
+  g_free(content);
+
+  return g_string_free(prompt, FALSE);
+}
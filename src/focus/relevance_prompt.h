@@ -0,0 +1,27 @@
+#pragma once
+
+#include <glib.h>
+
+#include "focus/chrome_cdp_client.h"
+
+/* The chat-model prompt for relevance checks, shared by the focus guard
+ * and the offline evaluation harness so both measure the same thing. */
+
+typedef enum {
+  FOCUS_GUARD_RELEVANCE_UNKNOWN = 0,
+  FOCUS_GUARD_RELEVANCE_RELEVANT = 1,
+  FOCUS_GUARD_RELEVANCE_UNSURE = 2,
+  FOCUS_GUARD_RELEVANCE_IRRELEVANT = 3
+} FocusGuardRelevance;
+
+#define RELEVANCE_PROMPT_MAX_TOKENS 24
+/* Page content in the prompt, about 4 KB of text; main content rarely
+ * needs more to be judged. */
+#define RELEVANCE_PROMPT_TOKEN_BUDGET 1024
+
+extern const char *const relevance_prompt_labels[];
+extern const char *const relevance_prompt_stop[];
+
+const char *relevance_prompt_system(void);
+char *relevance_prompt_build_user(const char *task_title, const ChromeCdpPage *page);
+FocusGuardRelevance relevance_prompt_parse_response(const char *response);
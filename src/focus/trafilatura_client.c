@@ -1,6 +1,23 @@
 #include "focus/trafilatura_client.h"
+#include "config.h"
 
-#include <gio/gio.h>
+#if HAVE_CHROME_OLLAMA
+#include <json-glib/json-glib.h>
+#include <signal.h>
+#include <string.h>
+#endif
+
+/* Probe results per resolved interpreter. A missing module is re-checked
+ * after a minute so installing trafilatura does not need an app restart. */
+#define TRAFILATURA_PROBE_RETRY_SECONDS 60
+
+typedef struct {
+  TrafilaturaStatus status;
+  gint64 checked_us;
+} TrafilaturaProbe;
+
+static GHashTable *trafilatura_probes;
+G_LOCK_DEFINE_STATIC(trafilatura_probes);
 
 static char *
 trafilatura_client_expand_path(const char *path)
@@ -34,48 +51,80 @@ trafilatura_client_is_path(const char *path)
 static char *
 trafilatura_client_resolve_python(const char *python_path)
 {
-  if (python_path == NULL || *python_path == '\0') {
-    return g_find_program_in_path("python3");
+  char *trimmed = NULL;
+  if (python_path != NULL) {
+    trimmed = g_strstrip(g_strdup(python_path));
+    if (*trimmed == '\0') {
+      g_clear_pointer(&trimmed, g_free);
+    }
   }
 
-  if (trafilatura_client_is_path(python_path)) {
-    char *expanded = trafilatura_client_expand_path(python_path);
-    if (expanded == NULL) {
-      return NULL;
+  char *resolved = NULL;
+  if (trimmed == NULL) {
+    resolved = g_find_program_in_path("python3");
+  } else if (trafilatura_client_is_path(trimmed)) {
+    resolved = trafilatura_client_expand_path(trimmed);
+    if (resolved != NULL && !g_file_test(resolved, G_FILE_TEST_IS_EXECUTABLE)) {
+      g_clear_pointer(&resolved, g_free);
     }
+  } else {
+    resolved = g_find_program_in_path(trimmed);
+  }
 
-    if (!g_file_test(expanded, G_FILE_TEST_IS_EXECUTABLE)) {
-      g_free(expanded);
-      return NULL;
-    }
+  g_free(trimmed);
+  return resolved;
+}
 
-    return expanded;
+static gboolean
+trafilatura_client_lookup_probe(const char *python, TrafilaturaStatus *status_out)
+{
+  gboolean found = FALSE;
+  G_LOCK(trafilatura_probes);
+  TrafilaturaProbe *probe =
+      trafilatura_probes != NULL ? g_hash_table_lookup(trafilatura_probes, python) : NULL;
+  if (probe != NULL &&
+      (probe->status == TRAFILATURA_STATUS_AVAILABLE ||
+       g_get_monotonic_time() - probe->checked_us <
+           TRAFILATURA_PROBE_RETRY_SECONDS * G_USEC_PER_SEC)) {
+    *status_out = probe->status;
+    found = TRUE;
   }
+  G_UNLOCK(trafilatura_probes);
+  return found;
+}
 
-  return g_find_program_in_path(python_path);
+static void
+trafilatura_client_store_probe(const char *python, TrafilaturaStatus status)
+{
+  TrafilaturaProbe *probe = g_new0(TrafilaturaProbe, 1);
+  probe->status = status;
+  probe->checked_us = g_get_monotonic_time();
+
+  G_LOCK(trafilatura_probes);
+  if (trafilatura_probes == NULL) {
+    trafilatura_probes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+  }
+  g_hash_table_replace(trafilatura_probes, g_strdup(python), probe);
+  G_UNLOCK(trafilatura_probes);
 }
 
 TrafilaturaStatus
 trafilatura_client_get_status(const char *python_path)
 {
-  char *trimmed = NULL;
-  if (python_path != NULL) {
-    trimmed = g_strstrip(g_strdup(python_path));
-    if (*trimmed == '\0') {
-      g_free(trimmed);
-      trimmed = NULL;
-    }
-  }
-
-  char *python = trafilatura_client_resolve_python(trimmed);
-  g_free(trimmed);
+  char *python = trafilatura_client_resolve_python(python_path);
   if (python == NULL) {
     return TRAFILATURA_STATUS_NO_PYTHON;
   }
 
+  TrafilaturaStatus status = TRAFILATURA_STATUS_NO_MODULE;
+  if (trafilatura_client_lookup_probe(python, &status)) {
+    g_free(python);
+    return status;
+  }
+
   gchar *stdout_data = NULL;
   gchar *stderr_data = NULL;
-  int status = 0;
+  int exit_status = 0;
   char *argv[] = {
       python,
       "-c",
@@ -90,16 +139,556 @@ trafilatura_client_get_status(const char *python_path)
                              NULL,
                              &stdout_data,
                              &stderr_data,
-                             &status,
+                             &exit_status,
                              NULL);
 
   g_free(stdout_data);
   g_free(stderr_data);
+
+  status = ok && exit_status == 0 ? TRAFILATURA_STATUS_AVAILABLE
+                                  : TRAFILATURA_STATUS_NO_MODULE;
+  trafilatura_client_store_probe(python, status);
   g_free(python);
+  return status;
+}
+
+#if HAVE_CHROME_OLLAMA
+
+#define TRAFILATURA_START_TIMEOUT_MS 20000
+#define TRAFILATURA_REQUEST_TIMEOUT_MS 5000
+#define TRAFILATURA_PING_TIMEOUT_MS 2000
+/* A helper idle for longer than this is pinged before it gets real work. */
+#define TRAFILATURA_PING_IDLE_SECONDS 60
+#define TRAFILATURA_MAX_BACKOFF_SECONDS 300
+
+/* One request per line on stdin, one JSON reply per line on stdout. The
+ * first line out says whether the module imported. */
+static const char *const trafilatura_helper_script =
+    "import json, sys\n"
+    "def send(obj):\n"
+    "    sys.stdout.write(json.dumps(obj) + '\\n')\n"
+    "    sys.stdout.flush()\n"
+    "try:\n"
+    "    import trafilatura\n"
+    "except Exception as exc:\n"
+    "    send({'ready': False, 'error': str(exc)})\n"
+    "    sys.exit(3)\n"
+    "send({'ready': True, 'version': getattr(trafilatura, '__version__', '')})\n"
+    "for line in sys.stdin:\n"
+    "    try:\n"
+    "        req = json.loads(line)\n"
+    "    except ValueError:\n"
+    "        continue\n"
+    "    rid = req.get('id')\n"
+    "    if req.get('op') == 'ping':\n"
+    "        send({'id': rid, 'ok': True})\n"
+    "        continue\n"
+    "    try:\n"
+    "        text = trafilatura.extract(req.get('html') or '', url=req.get('url'),\n"
+    "                                   include_comments=False, include_tables=True)\n"
+    "        send({'id': rid, 'ok': True, 'text': text or ''})\n"
+    "    except Exception as exc:\n"
+    "        send({'id': rid, 'ok': False, 'error': str(exc)})\n";
+
+struct _TrafilaturaClient {
+  gint ref_count;
+  char *python;
+  GMutex lock;
+  GSubprocess *process;
+  GOutputStream *stdin_pipe;
+  GDataInputStream *stdout_lines;
+  gint64 next_id;
+  gint64 last_used_us;
+  guint failures;
+  gint64 retry_after_us;
+  gint unavailable_until_s;
+  gint stop_requested;
+};
+
+TrafilaturaClient *
+trafilatura_client_new(const char *python_path)
+{
+  TrafilaturaClient *client = g_new0(TrafilaturaClient, 1);
+  client->ref_count = 1;
+  client->python = trafilatura_client_resolve_python(python_path);
+  g_mutex_init(&client->lock);
+  return client;
+}
+
+TrafilaturaClient *
+trafilatura_client_ref(TrafilaturaClient *client)
+{
+  if (client != NULL) {
+    g_atomic_int_inc(&client->ref_count);
+  }
+  return client;
+}
+
+static void
+trafilatura_client_kill(TrafilaturaClient *client)
+{
+  if (client->process == NULL) {
+    return;
+  }
+
+  g_subprocess_force_exit(client->process);
+  g_clear_object(&client->stdout_lines);
+  client->stdin_pipe = NULL;
+  g_clear_object(&client->process);
+}
+
+void
+trafilatura_client_unref(TrafilaturaClient *client)
+{
+  if (client == NULL || !g_atomic_int_dec_and_test(&client->ref_count)) {
+    return;
+  }
+
+  trafilatura_client_kill(client);
+  g_mutex_clear(&client->lock);
+  g_free(client->python);
+  g_free(client);
+}
+
+gboolean
+trafilatura_client_is_usable(TrafilaturaClient *client)
+{
+  if (client == NULL || client->python == NULL) {
+    return FALSE;
+  }
+
+  gint now_s = (gint)(g_get_monotonic_time() / G_USEC_PER_SEC);
+  return now_s >= g_atomic_int_get(&client->unavailable_until_s);
+}
+
+static void
+trafilatura_client_note_failure(TrafilaturaClient *client, const char *reason)
+{
+  trafilatura_client_kill(client);
+  client->failures++;
+  guint backoff = MIN(1u << MIN(client->failures, 9u), TRAFILATURA_MAX_BACKOFF_SECONDS);
+  client->retry_after_us = g_get_monotonic_time() + (gint64)backoff * G_USEC_PER_SEC;
+  g_debug("Trafilatura helper failed (%s); retrying in %u s", reason, backoff);
+}
+
+static void
+trafilatura_client_forward_cancel(GCancellable *cancellable, gpointer user_data)
+{
+  (void)cancellable;
+  g_cancellable_cancel(G_CANCELLABLE(user_data));
+}
+
+static gboolean
+trafilatura_client_on_watchdog(gpointer user_data)
+{
+  g_cancellable_cancel(G_CANCELLABLE(user_data));
+  return G_SOURCE_REMOVE;
+}
+
+/* Reads one reply line, giving up after timeout_ms. The watchdog runs on
+ * the default main context, which the app keeps iterating. *timed_out is
+ * only set when the helper was too slow, not when the caller cancelled. */
+static char *
+trafilatura_client_read_line(TrafilaturaClient *client,
+                             guint timeout_ms,
+                             GCancellable *cancellable,
+                             gboolean *timed_out,
+                             GError **error)
+{
+  GCancellable *deadline = g_cancellable_new();
+  gulong handler_id = 0;
+  if (cancellable != NULL) {
+    handler_id = g_cancellable_connect(cancellable,
+                                       G_CALLBACK(trafilatura_client_forward_cancel),
+                                       deadline,
+                                       NULL);
+  }
+
+  GSource *watchdog = g_timeout_source_new(timeout_ms);
+  g_source_set_callback(watchdog,
+                        trafilatura_client_on_watchdog,
+                        g_object_ref(deadline),
+                        g_object_unref);
+  g_source_attach(watchdog, NULL);
+
+  char *line = g_data_input_stream_read_line_utf8(client->stdout_lines, NULL, deadline, error);
+
+  g_source_destroy(watchdog);
+  g_source_unref(watchdog);
+  if (cancellable != NULL) {
+    g_cancellable_disconnect(cancellable, handler_id);
+  }
+
+  *timed_out = line == NULL && g_cancellable_is_cancelled(deadline) &&
+               !g_cancellable_is_cancelled(cancellable);
+  g_object_unref(deadline);
+
+  if (line == NULL && error != NULL && *error == NULL) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_BROKEN_PIPE, "Trafilatura helper exited");
+  }
+  return line;
+}
+
+static JsonObject *
+trafilatura_client_parse_line(const char *line, JsonParser *parser)
+{
+  if (!json_parser_load_from_data(parser, line, -1, NULL)) {
+    return NULL;
+  }
+
+  JsonNode *root = json_parser_get_root(parser);
+  return root != NULL && JSON_NODE_HOLDS_OBJECT(root) ? json_node_get_object(root) : NULL;
+}
+
+static void
+trafilatura_client_ignore_sigpipe(void)
+{
+  static gsize once = 0;
+  if (g_once_init_enter(&once)) {
+    /* A helper that died between requests must surface as a write error,
+     * not take the app down with it. */
+    signal(SIGPIPE, SIG_IGN);
+    g_once_init_leave(&once, 1);
+  }
+}
+
+static gboolean
+trafilatura_client_start(TrafilaturaClient *client,
+                         GCancellable *cancellable,
+                         GError **error)
+{
+  trafilatura_client_ignore_sigpipe();
+
+  const char *argv[] = {
+      client->python,
+      "-c",
+      trafilatura_helper_script,
+      NULL,
+  };
+  client->process = g_subprocess_newv(argv,
+                                      G_SUBPROCESS_FLAGS_STDIN_PIPE |
+                                          G_SUBPROCESS_FLAGS_STDOUT_PIPE |
+                                          G_SUBPROCESS_FLAGS_STDERR_SILENCE,
+                                      error);
+  if (client->process == NULL) {
+    trafilatura_client_store_probe(client->python, TRAFILATURA_STATUS_NO_PYTHON);
+    return FALSE;
+  }
+
+  client->stdin_pipe = g_subprocess_get_stdin_pipe(client->process);
+  client->stdout_lines =
+      g_data_input_stream_new(g_subprocess_get_stdout_pipe(client->process));
+
+  gboolean timed_out = FALSE;
+  char *line = trafilatura_client_read_line(client,
+                                            TRAFILATURA_START_TIMEOUT_MS,
+                                            cancellable,
+                                            &timed_out,
+                                            error);
+  if (line == NULL) {
+    trafilatura_client_kill(client);
+    return FALSE;
+  }
+
+  JsonParser *parser = json_parser_new();
+  JsonObject *ready = trafilatura_client_parse_line(line, parser);
+  gboolean ok = ready != NULL && json_object_has_member(ready, "ready") &&
+                json_object_get_boolean_member(ready, "ready");
+  if (ok) {
+    trafilatura_client_store_probe(client->python, TRAFILATURA_STATUS_AVAILABLE);
+    g_debug("Trafilatura helper started (trafilatura %s)",
+            json_object_has_member(ready, "version")
+                ? json_object_get_string_member(ready, "version")
+                : "unknown");
+  } else {
+    trafilatura_client_store_probe(client->python, TRAFILATURA_STATUS_NO_MODULE);
+    g_atomic_int_set(&client->unavailable_until_s,
+                     (gint)(g_get_monotonic_time() / G_USEC_PER_SEC) +
+                         TRAFILATURA_PROBE_RETRY_SECONDS);
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_NOT_SUPPORTED,
+                "trafilatura not importable with %s",
+                client->python);
+    trafilatura_client_kill(client);
+  }
+
+  g_object_unref(parser);
+  g_free(line);
+  client->last_used_us = g_get_monotonic_time();
+  return ok;
+}
+
+/* Sends one request and waits for the reply carrying its id. Replies to
+ * requests whose callers gave up earlier are skipped. A timeout or broken
+ * pipe kills the helper; the next request starts a fresh one. */
+static JsonObject *
+trafilatura_client_call(TrafilaturaClient *client,
+                        JsonBuilder *request,
+                        gint64 id,
+                        guint timeout_ms,
+                        JsonParser *parser,
+                        GCancellable *cancellable,
+                        GError **error)
+{
+  JsonGenerator *generator = json_generator_new();
+  JsonNode *root = json_builder_get_root(request);
+  json_generator_set_root(generator, root);
+  gsize length = 0;
+  char *payload = json_generator_to_data(generator, &length);
+  json_node_free(root);
+  g_object_unref(generator);
+
+  GString *line = g_string_new_len(payload, (gssize)length);
+  g_string_append_c(line, '\n');
+  g_free(payload);
+
+  /* Never cancel a write halfway; a partial line would desync the helper. */
+  gboolean written = g_output_stream_write_all(client->stdin_pipe,
+                                               line->str,
+                                               line->len,
+                                               NULL,
+                                               NULL,
+                                               error);
+  g_string_free(line, TRUE);
+  if (!written) {
+    trafilatura_client_note_failure(client, "write");
+    return NULL;
+  }
+
+  while (TRUE) {
+    gboolean timed_out = FALSE;
+    char *reply = trafilatura_client_read_line(client, timeout_ms, cancellable, &timed_out, error);
+    if (reply == NULL) {
+      if (!g_cancellable_is_cancelled(cancellable)) {
+        trafilatura_client_note_failure(client, timed_out ? "timeout" : "read");
+      }
+      return NULL;
+    }
+
+    JsonObject *object = trafilatura_client_parse_line(reply, parser);
+    g_free(reply);
+    if (object != NULL && json_object_has_member(object, "id") &&
+        json_object_get_int_member(object, "id") == id) {
+      client->last_used_us = g_get_monotonic_time();
+      return object;
+    }
+  }
+}
+
+static gboolean
+trafilatura_client_ping(TrafilaturaClient *client, GCancellable *cancellable)
+{
+  gint64 id = ++client->next_id;
+  JsonBuilder *builder = json_builder_new();
+  json_builder_begin_object(builder);
+  json_builder_set_member_name(builder, "id");
+  json_builder_add_int_value(builder, id);
+  json_builder_set_member_name(builder, "op");
+  json_builder_add_string_value(builder, "ping");
+  json_builder_end_object(builder);
+
+  JsonParser *parser = json_parser_new();
+  JsonObject *reply = trafilatura_client_call(client,
+                                              builder,
+                                              id,
+                                              TRAFILATURA_PING_TIMEOUT_MS,
+                                              parser,
+                                              cancellable,
+                                              NULL);
+  g_object_unref(parser);
+  g_object_unref(builder);
+  return reply != NULL;
+}
+
+static gboolean
+trafilatura_client_ensure_running(TrafilaturaClient *client,
+                                  GCancellable *cancellable,
+                                  GError **error)
+{
+  if (g_atomic_int_compare_and_exchange(&client->stop_requested, TRUE, FALSE)) {
+    trafilatura_client_kill(client);
+  }
+
+  /* The identifier goes away once GLib has reaped the child. */
+  if (client->process != NULL && g_subprocess_get_identifier(client->process) == NULL) {
+    trafilatura_client_note_failure(client, "exited");
+  }
+
+  if (client->process != NULL &&
+      g_get_monotonic_time() - client->last_used_us >
+          TRAFILATURA_PING_IDLE_SECONDS * G_USEC_PER_SEC &&
+      !trafilatura_client_ping(client, cancellable)) {
+    if (g_cancellable_set_error_if_cancelled(cancellable, error)) {
+      return FALSE;
+    }
+  }
+
+  if (client->process != NULL) {
+    return TRUE;
+  }
+
+  if (!trafilatura_client_is_usable(client)) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED, "trafilatura not available");
+    return FALSE;
+  }
+
+  if (g_get_monotonic_time() < client->retry_after_us) {
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_BUSY,
+                "Trafilatura helper is backing off after a failure");
+    return FALSE;
+  }
+
+  return trafilatura_client_start(client, cancellable, error);
+}
+
+char *
+trafilatura_client_extract_sync(TrafilaturaClient *client,
+                                const char *html,
+                                const char *url,
+                                GCancellable *cancellable,
+                                GError **error)
+{
+  if (client == NULL || html == NULL) {
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_INVALID_ARGUMENT,
+                "Trafilatura request missing HTML");
+    return NULL;
+  }
+
+  g_mutex_lock(&client->lock);
+  if (!trafilatura_client_ensure_running(client, cancellable, error)) {
+    g_mutex_unlock(&client->lock);
+    return NULL;
+  }
+
+  gint64 id = ++client->next_id;
+  JsonBuilder *builder = json_builder_new();
+  json_builder_begin_object(builder);
+  json_builder_set_member_name(builder, "id");
+  json_builder_add_int_value(builder, id);
+  json_builder_set_member_name(builder, "op");
+  json_builder_add_string_value(builder, "extract");
+  json_builder_set_member_name(builder, "html");
+  json_builder_add_string_value(builder, html);
+  json_builder_set_member_name(builder, "url");
+  json_builder_add_string_value(builder, url != NULL ? url : "");
+  json_builder_end_object(builder);
+
+  JsonParser *parser = json_parser_new();
+  JsonObject *reply = trafilatura_client_call(client,
+                                              builder,
+                                              id,
+                                              TRAFILATURA_REQUEST_TIMEOUT_MS,
+                                              parser,
+                                              cancellable,
+                                              error);
+  g_object_unref(builder);
+
+  char *text = NULL;
+  if (reply != NULL && json_object_has_member(reply, "ok") &&
+      json_object_get_boolean_member(reply, "ok")) {
+    client->failures = 0;
+    text = g_strdup(json_object_has_member(reply, "text")
+                        ? json_object_get_string_member(reply, "text")
+                        : "");
+  } else if (reply != NULL) {
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_FAILED,
+                "Trafilatura extraction failed: %s",
+                json_object_has_member(reply, "error")
+                    ? json_object_get_string_member(reply, "error")
+                    : "unknown error");
+  }
+
+  g_object_unref(parser);
+  g_mutex_unlock(&client->lock);
+  return text;
+}
+
+void
+trafilatura_client_stop(TrafilaturaClient *client)
+{
+  if (client == NULL) {
+    return;
+  }
 
-  if (!ok || status != 0) {
-    return TRAFILATURA_STATUS_NO_MODULE;
+  /* Never block the main loop behind a running extraction; the worker
+   * stops the helper itself before its next request. */
+  if (!g_mutex_trylock(&client->lock)) {
+    g_atomic_int_set(&client->stop_requested, TRUE);
+    return;
   }
 
-  return TRAFILATURA_STATUS_AVAILABLE;
+  trafilatura_client_kill(client);
+  g_mutex_unlock(&client->lock);
 }
+
+#else
+
+struct _TrafilaturaClient {
+  gint ref_count;
+};
+
+TrafilaturaClient *
+trafilatura_client_new(const char *python_path)
+{
+  (void)python_path;
+  TrafilaturaClient *client = g_new0(TrafilaturaClient, 1);
+  client->ref_count = 1;
+  return client;
+}
+
+TrafilaturaClient *
+trafilatura_client_ref(TrafilaturaClient *client)
+{
+  if (client != NULL) {
+    g_atomic_int_inc(&client->ref_count);
+  }
+  return client;
+}
+
+void
+trafilatura_client_unref(TrafilaturaClient *client)
+{
+  if (client != NULL && g_atomic_int_dec_and_test(&client->ref_count)) {
+    g_free(client);
+  }
+}
+
+gboolean
+trafilatura_client_is_usable(TrafilaturaClient *client)
+{
+  (void)client;
+  return FALSE;
+}
+
+char *
+trafilatura_client_extract_sync(TrafilaturaClient *client,
+                                const char *html,
+                                const char *url,
+                                GCancellable *cancellable,
+                                GError **error)
+{
+  (void)client;
+  (void)html;
+  (void)url;
+  (void)cancellable;
+  g_set_error(error,
+              G_IO_ERROR,
+              G_IO_ERROR_NOT_SUPPORTED,
+              "Trafilatura support unavailable (libsoup/json-glib missing)");
+  return NULL;
+}
+
+void
+trafilatura_client_stop(TrafilaturaClient *client)
+{
+  (void)client;
+}
+
+#endif
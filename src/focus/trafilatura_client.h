@@ -1,5 +1,6 @@
 #pragma once
 
+#include <gio/gio.h>
 #include <glib.h>
 
 typedef enum {
@@ -8,4 +9,18 @@ typedef enum {
   TRAFILATURA_STATUS_NO_MODULE = 2
 } TrafilaturaStatus;
 
+typedef struct _TrafilaturaClient TrafilaturaClient;
+
 TrafilaturaStatus trafilatura_client_get_status(const char *python_path);
+
+TrafilaturaClient *trafilatura_client_new(const char *python_path);
+TrafilaturaClient *trafilatura_client_ref(TrafilaturaClient *client);
+void trafilatura_client_unref(TrafilaturaClient *client);
+
+gboolean trafilatura_client_is_usable(TrafilaturaClient *client);
+char *trafilatura_client_extract_sync(TrafilaturaClient *client,
+                                      const char *html,
+                                      const char *url,
+                                      GCancellable *cancellable,
+                                      GError **error);
+void trafilatura_client_stop(TrafilaturaClient *client);
@@ -1,6 +1,7 @@
 #include <gtk/gtk.h>
 
 #include "app/app_init.h"
+#include "app/app_stats_cli.h"
 #include "config.h"
 #include "ui/main_window.h"
 
@@ -56,6 +57,11 @@ main(int argc, char *argv[])
 
   gboolean autostart_launch = extract_autostart_flag(&argc, &argv);
 
+  int cli_status = 0;
+  if (app_stats_cli_run(&argc, &argv, &cli_status)) {
+    return cli_status;
+  }
+
   GtkApplication *app = gtk_application_new(APP_ID, G_APPLICATION_DEFAULT_FLAGS);
   g_object_set_data(G_OBJECT(app),
                     "autostart-launch",
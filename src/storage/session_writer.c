@@ -0,0 +1,115 @@
+#include "storage/session_writer.h"
+
+/* How long the thread waits for more rows before writing a batch. */
+#define SESSION_WRITER_BATCH_WAIT_US (250 * 1000)
+#define SESSION_WRITER_BATCH_MAX 64
+
+struct _SessionWriter {
+  GAsyncQueue *queue;
+  GThread *thread;
+};
+
+/* Queued last by free; the thread writes what it holds and exits. */
+static UsageStatsSession session_writer_stop;
+
+static void
+session_writer_session_free(gpointer data)
+{
+  UsageStatsSession *session = data;
+  if (session == NULL || session == &session_writer_stop) {
+    return;
+  }
+
+  g_free(session->task_id);
+  g_free(session);
+}
+
+static void
+session_writer_write_batch(UsageStatsStore **store, GPtrArray *batch)
+{
+  if (batch->len == 0) {
+    return;
+  }
+
+  if (*store == NULL) {
+    *store = usage_stats_store_new();
+  }
+  if (*store == NULL) {
+    g_warning("Dropping %u session rows: usage stats database unavailable", batch->len);
+    g_ptr_array_set_size(batch, 0);
+    return;
+  }
+
+  gboolean in_transaction = usage_stats_store_begin(*store);
+  for (guint i = 0; i < batch->len; i++) {
+    usage_stats_store_add_session(*store, g_ptr_array_index(batch, i));
+  }
+  if (in_transaction) {
+    usage_stats_store_commit(*store);
+  }
+  g_ptr_array_set_size(batch, 0);
+}
+
+static gpointer
+session_writer_thread(gpointer data)
+{
+  SessionWriter *writer = data;
+  UsageStatsStore *store = NULL;
+  GPtrArray *batch = g_ptr_array_new_with_free_func(session_writer_session_free);
+
+  gboolean stopping = FALSE;
+  while (!stopping) {
+    UsageStatsSession *session = g_async_queue_pop(writer->queue);
+    while (session != NULL) {
+      if (session == &session_writer_stop) {
+        stopping = TRUE;
+        break;
+      }
+      g_ptr_array_add(batch, session);
+      if (batch->len >= SESSION_WRITER_BATCH_MAX) {
+        break;
+      }
+      session = g_async_queue_timeout_pop(writer->queue, SESSION_WRITER_BATCH_WAIT_US);
+    }
+    session_writer_write_batch(&store, batch);
+  }
+
+  g_ptr_array_unref(batch);
+  usage_stats_store_free(store);
+  return NULL;
+}
+
+SessionWriter *
+session_writer_new(void)
+{
+  SessionWriter *writer = g_new0(SessionWriter, 1);
+  writer->queue = g_async_queue_new();
+  writer->thread = g_thread_new("session-writer", session_writer_thread, writer);
+  return writer;
+}
+
+void
+session_writer_free(SessionWriter *writer)
+{
+  if (writer == NULL) {
+    return;
+  }
+
+  g_async_queue_push(writer->queue, &session_writer_stop);
+  g_thread_join(writer->thread);
+  g_async_queue_unref(writer->queue);
+  g_free(writer);
+}
+
+void
+session_writer_push(SessionWriter *writer, const UsageStatsSession *session)
+{
+  if (writer == NULL || session == NULL) {
+    return;
+  }
+
+  UsageStatsSession *copy = g_new0(UsageStatsSession, 1);
+  *copy = *session;
+  copy->task_id = g_strdup(session->task_id);
+  g_async_queue_push(writer->queue, copy);
+}
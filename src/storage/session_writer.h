@@ -0,0 +1,15 @@
+#pragma once
+
+#include <glib.h>
+
+#include "storage/usage_stats_storage.h"
+
+typedef struct _SessionWriter SessionWriter;
+
+/* Appends session rows from a background thread with its own database
+ * connection. Rows that arrive close together are written in one
+ * transaction; free waits until everything queued has been written. */
+SessionWriter *session_writer_new(void);
+void session_writer_free(SessionWriter *writer);
+
+void session_writer_push(SessionWriter *writer, const UsageStatsSession *session);
@@ -181,6 +181,27 @@ settings_storage_save_timer(const PomodoroTimerConfig *config, GError **error)
   return result;
 }
 
+/* A similarity threshold; a malformed value keeps the default rather than
+ * reading as 0, which would pass every page. The range is left to
+ * focus_guard_config_normalize. */
+static void
+settings_storage_load_threshold(GKeyFile *key_file, const char *key, double *value_out)
+{
+  if (!g_key_file_has_key(key_file, "focus_guard", key, NULL)) {
+    return;
+  }
+
+  GError *error = NULL;
+  double value = g_key_file_get_double(key_file, "focus_guard", key, &error);
+  if (error != NULL) {
+    g_warning("Ignoring focus_guard.%s: %s", key, error->message);
+    g_clear_error(&error);
+    return;
+  }
+
+  *value_out = value;
+}
+
 gboolean
 settings_storage_load_focus_guard(FocusGuardConfig *config, GError **error)
 {
@@ -262,6 +283,25 @@ settings_storage_load_focus_guard(FocusGuardConfig *config, GError **error)
     }
   }
 
+  if (g_key_file_has_key(key_file, "focus_guard", "ollama_embed_model", NULL)) {
+    gchar *value = g_key_file_get_string(key_file,
+                                         "focus_guard",
+                                         "ollama_embed_model",
+                                         NULL);
+    if (value != NULL) {
+      g_free(config->ollama_embed_model);
+      config->ollama_embed_model = g_strdup(value);
+      g_free(value);
+    }
+  }
+
+  settings_storage_load_threshold(key_file,
+                                  "embed_relevant_threshold",
+                                  &config->embed_relevant_threshold);
+  settings_storage_load_threshold(key_file,
+                                  "embed_irrelevant_threshold",
+                                  &config->embed_irrelevant_threshold);
+
   if (g_key_file_has_key(key_file, "focus_guard", "trafilatura_python_path", NULL)) {
     gchar *value = g_key_file_get_string(key_file,
                                          "focus_guard",
@@ -274,6 +314,40 @@ settings_storage_load_focus_guard(FocusGuardConfig *config, GError **error)
     }
   }
 
+  if (g_key_file_has_key(key_file, "focus_guard", "batch_tabs_enabled", NULL)) {
+    config->batch_tabs_enabled =
+        g_key_file_get_boolean(key_file,
+                               "focus_guard",
+                               "batch_tabs_enabled",
+                               NULL);
+  }
+
+  if (g_key_file_has_key(key_file, "focus_guard", "batch_tabs_interval_seconds", NULL)) {
+    gint value = g_key_file_get_integer(key_file,
+                                        "focus_guard",
+                                        "batch_tabs_interval_seconds",
+                                        NULL);
+    if (value > 0) {
+      config->batch_tabs_interval_seconds = (guint)value;
+    }
+  }
+
+  /* A missing or malformed grain leaves the database's grain alone; guessing
+   * one would re-aggregate the stored stats for good. */
+  if (g_key_file_has_key(key_file, "focus_guard", "usage_bucket_seconds", NULL)) {
+    GError *bucket_error = NULL;
+    gint value = g_key_file_get_integer(key_file,
+                                        "focus_guard",
+                                        "usage_bucket_seconds",
+                                        &bucket_error);
+    if (bucket_error != NULL) {
+      g_warning("Ignoring focus_guard.usage_bucket_seconds: %s", bucket_error->message);
+      g_clear_error(&bucket_error);
+    } else if (value > 0) {
+      config->usage_bucket_seconds = (guint)value;
+    }
+  }
+
   if (g_key_file_has_key(key_file, "focus_guard", "blacklist", NULL)) {
     gsize length = 0;
     gchar **list = g_key_file_get_string_list(key_file,
@@ -349,12 +423,40 @@ settings_storage_save_focus_guard(const FocusGuardConfig *config,
                         normalized.ollama_model != NULL
                             ? normalized.ollama_model
                             : "");
+  g_key_file_set_string(key_file,
+                        "focus_guard",
+                        "ollama_embed_model",
+                        normalized.ollama_embed_model != NULL
+                            ? normalized.ollama_embed_model
+                            : "");
+  g_key_file_set_double(key_file,
+                        "focus_guard",
+                        "embed_relevant_threshold",
+                        normalized.embed_relevant_threshold);
+  g_key_file_set_double(key_file,
+                        "focus_guard",
+                        "embed_irrelevant_threshold",
+                        normalized.embed_irrelevant_threshold);
   g_key_file_set_string(key_file,
                         "focus_guard",
                         "trafilatura_python_path",
                         normalized.trafilatura_python_path != NULL
                             ? normalized.trafilatura_python_path
                             : "");
+  g_key_file_set_boolean(key_file,
+                         "focus_guard",
+                         "batch_tabs_enabled",
+                         normalized.batch_tabs_enabled);
+  g_key_file_set_integer(key_file,
+                         "focus_guard",
+                         "batch_tabs_interval_seconds",
+                         (gint)normalized.batch_tabs_interval_seconds);
+  if (normalized.usage_bucket_seconds > 0) {
+    g_key_file_set_integer(key_file,
+                           "focus_guard",
+                           "usage_bucket_seconds",
+                           (gint)normalized.usage_bucket_seconds);
+  }
 
   if (normalized.blacklist != NULL) {
     gsize length = g_strv_length(normalized.blacklist);
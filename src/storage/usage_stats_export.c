@@ -0,0 +1,801 @@
+#include "storage/usage_stats_export.h"
+
+#include <string.h>
+
+#define USAGE_STATS_TRANSFER_PROGRESS_ROWS 5000
+#define USAGE_STATS_TRANSFER_BUFFER_BYTES (64 * 1024)
+#define USAGE_STATS_IMPORT_CHUNK_ROWS 1000
+
+typedef enum {
+  USAGE_STATS_COLUMN_BUCKET_START,
+  USAGE_STATS_COLUMN_SCOPE,
+  USAGE_STATS_COLUMN_TASK_ID,
+  USAGE_STATS_COLUMN_APP_KEY,
+  USAGE_STATS_COLUMN_APP_NAME,
+  USAGE_STATS_COLUMN_DURATION,
+  USAGE_STATS_N_COLUMNS
+} UsageStatsColumn;
+
+static const char *const usage_stats_column_names[USAGE_STATS_N_COLUMNS] = {
+    "bucket_start",
+    "scope",
+    "task_id",
+    "app_key",
+    "app_name",
+    "duration_sec",
+};
+
+typedef struct {
+  GOutputStream *out;
+  UsageStatsFormat format;
+  GString *line;
+  guint64 rows;
+  gint64 rows_total;
+  UsageStatsProgressFunc progress;
+  gpointer user_data;
+  GCancellable *cancellable;
+  GError *error;
+} UsageStatsExportContext;
+
+gboolean
+usage_stats_format_parse(const char *name, UsageStatsFormat *format_out)
+{
+  if (name == NULL || format_out == NULL) {
+    return FALSE;
+  }
+
+  if (g_ascii_strcasecmp(name, "csv") == 0) {
+    *format_out = USAGE_STATS_FORMAT_CSV;
+    return TRUE;
+  }
+
+  if (g_ascii_strcasecmp(name, "ndjson") == 0 || g_ascii_strcasecmp(name, "jsonl") == 0 ||
+      g_ascii_strcasecmp(name, "json") == 0) {
+    *format_out = USAGE_STATS_FORMAT_NDJSON;
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+UsageStatsFormat
+usage_stats_format_for_path(const char *path)
+{
+  const char *dot = path != NULL ? strrchr(path, '.') : NULL;
+  UsageStatsFormat format = USAGE_STATS_FORMAT_CSV;
+  if (dot != NULL && !usage_stats_format_parse(dot + 1, &format)) {
+    format = USAGE_STATS_FORMAT_CSV;
+  }
+  return format;
+}
+
+static void
+usage_stats_append_csv_field(GString *line, const char *value)
+{
+  if (value == NULL) {
+    return;
+  }
+
+  if (strpbrk(value, ",\"\r\n") == NULL) {
+    g_string_append(line, value);
+    return;
+  }
+
+  g_string_append_c(line, '"');
+  for (const char *p = value; *p != '\0'; p++) {
+    if (*p == '"') {
+      g_string_append_c(line, '"');
+    }
+    g_string_append_c(line, *p);
+  }
+  g_string_append_c(line, '"');
+}
+
+static void
+usage_stats_append_json_string(GString *line, const char *value)
+{
+  if (value == NULL) {
+    g_string_append(line, "null");
+    return;
+  }
+
+  g_string_append_c(line, '"');
+  for (const unsigned char *p = (const unsigned char *)value; *p != '\0'; p++) {
+    switch (*p) {
+      case '"':
+        g_string_append(line, "\\\"");
+        break;
+      case '\\':
+        g_string_append(line, "\\\\");
+        break;
+      case '\n':
+        g_string_append(line, "\\n");
+        break;
+      case '\r':
+        g_string_append(line, "\\r");
+        break;
+      case '\t':
+        g_string_append(line, "\\t");
+        break;
+      default:
+        if (*p < 0x20) {
+          g_string_append_printf(line, "\\u%04x", *p);
+        } else {
+          g_string_append_c(line, (char)*p);
+        }
+        break;
+    }
+  }
+  g_string_append_c(line, '"');
+}
+
+static void
+usage_stats_format_row(UsageStatsExportContext *context, const UsageStatsRow *row)
+{
+  GString *line = context->line;
+  g_string_truncate(line, 0);
+
+  if (context->format == USAGE_STATS_FORMAT_CSV) {
+    g_string_append_printf(line, "%" G_GINT64_FORMAT ",", row->bucket_start_utc);
+    usage_stats_append_csv_field(line, row->scope);
+    g_string_append_c(line, ',');
+    usage_stats_append_csv_field(line, row->task_id);
+    g_string_append_c(line, ',');
+    usage_stats_append_csv_field(line, row->app_key);
+    g_string_append_c(line, ',');
+    usage_stats_append_csv_field(line, row->app_name);
+    g_string_append_printf(line, ",%" G_GINT64_FORMAT "\n", row->duration_sec);
+    return;
+  }
+
+  const char *values[USAGE_STATS_N_COLUMNS] = {
+      NULL, row->scope, row->task_id, row->app_key, row->app_name, NULL,
+  };
+  g_string_append_printf(line,
+                         "{\"%s\":%" G_GINT64_FORMAT,
+                         usage_stats_column_names[USAGE_STATS_COLUMN_BUCKET_START],
+                         row->bucket_start_utc);
+  for (guint i = USAGE_STATS_COLUMN_SCOPE; i <= USAGE_STATS_COLUMN_APP_NAME; i++) {
+    g_string_append_printf(line, ",\"%s\":", usage_stats_column_names[i]);
+    usage_stats_append_json_string(line, values[i]);
+  }
+  g_string_append_printf(line,
+                         ",\"%s\":%" G_GINT64_FORMAT "}\n",
+                         usage_stats_column_names[USAGE_STATS_COLUMN_DURATION],
+                         row->duration_sec);
+}
+
+static gboolean
+usage_stats_export_row(const UsageStatsRow *row, gpointer user_data)
+{
+  UsageStatsExportContext *context = user_data;
+
+  usage_stats_format_row(context, row);
+  if (!g_output_stream_write_all(context->out,
+                                 context->line->str,
+                                 context->line->len,
+                                 NULL,
+                                 context->cancellable,
+                                 &context->error)) {
+    return FALSE;
+  }
+
+  context->rows++;
+  if (context->progress != NULL &&
+      context->rows % USAGE_STATS_TRANSFER_PROGRESS_ROWS == 0) {
+    context->progress(context->rows, context->rows_total, context->user_data);
+  }
+  return !g_cancellable_set_error_if_cancelled(context->cancellable, &context->error);
+}
+
+gboolean
+usage_stats_export_file(UsageStatsStore *store,
+                        GFile *file,
+                        UsageStatsFormat format,
+                        const char *scope,
+                        gint64 since_utc,
+                        gint64 until_utc,
+                        UsageStatsProgressFunc progress,
+                        gpointer user_data,
+                        GCancellable *cancellable,
+                        guint64 *rows_out,
+                        GError **error)
+{
+  g_return_val_if_fail(store != NULL, FALSE);
+  g_return_val_if_fail(G_IS_FILE(file), FALSE);
+
+  GFileOutputStream *file_out = g_file_replace(file,
+                                               NULL,
+                                               FALSE,
+                                               G_FILE_CREATE_REPLACE_DESTINATION,
+                                               cancellable,
+                                               error);
+  if (file_out == NULL) {
+    return FALSE;
+  }
+
+  UsageStatsExportContext context = {
+      .out = g_buffered_output_stream_new_sized(G_OUTPUT_STREAM(file_out),
+                                                USAGE_STATS_TRANSFER_BUFFER_BYTES),
+      .format = format,
+      .line = g_string_sized_new(256),
+      .rows_total = usage_stats_store_count_rows(store, scope, since_utc, until_utc),
+      .progress = progress,
+      .user_data = user_data,
+      .cancellable = cancellable,
+  };
+  g_object_unref(file_out);
+
+  gboolean ok = TRUE;
+  if (format == USAGE_STATS_FORMAT_CSV) {
+    for (guint i = 0; i < USAGE_STATS_N_COLUMNS; i++) {
+      g_string_append(context.line, usage_stats_column_names[i]);
+      g_string_append_c(context.line, i + 1 < USAGE_STATS_N_COLUMNS ? ',' : '\n');
+    }
+    ok = g_output_stream_write_all(context.out,
+                                   context.line->str,
+                                   context.line->len,
+                                   NULL,
+                                   cancellable,
+                                   &context.error);
+  }
+
+  if (ok) {
+    ok = usage_stats_store_foreach_row(store,
+                                       scope,
+                                       since_utc,
+                                       until_utc,
+                                       usage_stats_export_row,
+                                       &context);
+    if (!ok && context.error == NULL) {
+      g_set_error(&context.error,
+                  G_IO_ERROR,
+                  G_IO_ERROR_FAILED,
+                  "Failed to read usage stats from the database");
+    }
+  }
+
+  if (ok) {
+    ok = g_output_stream_close(context.out, cancellable, &context.error);
+  } else {
+    /* Closing with a cancelled cancellable keeps the previous file. */
+    GCancellable *abort = g_cancellable_new();
+    g_cancellable_cancel(abort);
+    g_output_stream_close(context.out, abort, NULL);
+    g_object_unref(abort);
+  }
+
+  if (ok && progress != NULL) {
+    progress(context.rows, context.rows_total, user_data);
+  }
+  if (rows_out != NULL) {
+    *rows_out = context.rows;
+  }
+
+  g_object_unref(context.out);
+  g_string_free(context.line, TRUE);
+  if (context.error != NULL) {
+    g_propagate_error(error, context.error);
+  }
+  return ok;
+}
+
+/* Splits one CSV record into fields; quoted fields may hold commas, doubled
+ * quotes and line breaks. */
+static void
+usage_stats_split_csv(const char *record, GPtrArray *fields)
+{
+  g_ptr_array_set_size(fields, 0);
+
+  GString *field = g_string_new(NULL);
+  gboolean quoted = FALSE;
+  for (const char *p = record;; p++) {
+    if (quoted) {
+      if (*p == '\0') {
+        break;
+      }
+      if (*p == '"' && p[1] == '"') {
+        g_string_append_c(field, '"');
+        p++;
+      } else if (*p == '"') {
+        quoted = FALSE;
+      } else {
+        g_string_append_c(field, *p);
+      }
+      continue;
+    }
+
+    if (*p == '"') {
+      quoted = TRUE;
+    } else if (*p == ',' || *p == '\0') {
+      g_ptr_array_add(fields, g_string_free(field, FALSE));
+      if (*p == '\0') {
+        return;
+      }
+      field = g_string_new(NULL);
+    } else if (*p != '\r') {
+      g_string_append_c(field, *p);
+    }
+  }
+
+  g_ptr_array_add(fields, g_string_free(field, FALSE));
+}
+
+static gboolean
+usage_stats_csv_record_open(const char *record)
+{
+  gboolean quoted = FALSE;
+  for (const char *p = record; *p != '\0'; p++) {
+    if (*p == '"') {
+      quoted = !quoted;
+    }
+  }
+  return quoted;
+}
+
+static const char *
+usage_stats_json_skip_space(const char *p)
+{
+  while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+    p++;
+  }
+  return p;
+}
+
+static gboolean
+usage_stats_json_hex4(const char *p, gunichar *value_out)
+{
+  gunichar value = 0;
+  for (guint i = 0; i < 4; i++) {
+    int digit = g_ascii_xdigit_value(p[i]);
+    if (digit < 0) {
+      return FALSE;
+    }
+    value = value * 16 + (gunichar)digit;
+  }
+  *value_out = value;
+  return TRUE;
+}
+
+static const char *
+usage_stats_json_parse_string(const char *p, char **value_out)
+{
+  if (*p != '"') {
+    return NULL;
+  }
+
+  GString *value = g_string_new(NULL);
+  for (p++; *p != '"'; p++) {
+    if (*p == '\0') {
+      g_string_free(value, TRUE);
+      return NULL;
+    }
+    if (*p != '\\') {
+      g_string_append_c(value, *p);
+      continue;
+    }
+
+    p++;
+    gunichar ch = 0;
+    switch (*p) {
+      case '"':
+      case '\\':
+      case '/':
+        g_string_append_c(value, *p);
+        break;
+      case 'b':
+        g_string_append_c(value, '\b');
+        break;
+      case 'f':
+        g_string_append_c(value, '\f');
+        break;
+      case 'n':
+        g_string_append_c(value, '\n');
+        break;
+      case 'r':
+        g_string_append_c(value, '\r');
+        break;
+      case 't':
+        g_string_append_c(value, '\t');
+        break;
+      case 'u':
+        if (!usage_stats_json_hex4(p + 1, &ch)) {
+          g_string_free(value, TRUE);
+          return NULL;
+        }
+        p += 4;
+        if (ch >= 0xD800 && ch < 0xDC00) {
+          gunichar low = 0;
+          if (p[1] != '\\' || p[2] != 'u' || !usage_stats_json_hex4(p + 3, &low) ||
+              low < 0xDC00 || low >= 0xE000) {
+            g_string_free(value, TRUE);
+            return NULL;
+          }
+          ch = 0x10000 + ((ch - 0xD800) << 10) + (low - 0xDC00);
+          p += 6;
+        }
+        g_string_append_unichar(value, ch);
+        break;
+      default:
+        g_string_free(value, TRUE);
+        return NULL;
+    }
+  }
+
+  *value_out = g_string_free(value, FALSE);
+  return p + 1;
+}
+
+/* Reads one flat JSON object of string, integer and null members, which is
+ * all an export line holds; unknown members are skipped. */
+static gboolean
+usage_stats_parse_json_row(const char *line, char *values[USAGE_STATS_N_COLUMNS])
+{
+  const char *p = usage_stats_json_skip_space(line);
+  if (*p++ != '{') {
+    return FALSE;
+  }
+
+  p = usage_stats_json_skip_space(p);
+  if (*p == '}') {
+    return *usage_stats_json_skip_space(p + 1) == '\0';
+  }
+
+  while (TRUE) {
+    char *key = NULL;
+    p = usage_stats_json_parse_string(usage_stats_json_skip_space(p), &key);
+    if (p == NULL) {
+      return FALSE;
+    }
+    p = usage_stats_json_skip_space(p);
+    if (*p++ != ':') {
+      g_free(key);
+      return FALSE;
+    }
+    p = usage_stats_json_skip_space(p);
+
+    char *value = NULL;
+    if (*p == '"') {
+      p = usage_stats_json_parse_string(p, &value);
+    } else if (g_str_has_prefix(p, "null")) {
+      p += 4;
+    } else {
+      const char *start = p;
+      if (*p == '-') {
+        p++;
+      }
+      while (g_ascii_isdigit(*p)) {
+        p++;
+      }
+      value = p > start ? g_strndup(start, (gsize)(p - start)) : NULL;
+      if (value == NULL) {
+        p = NULL;
+      }
+    }
+    if (p == NULL) {
+      g_free(key);
+      return FALSE;
+    }
+
+    for (guint i = 0; i < USAGE_STATS_N_COLUMNS; i++) {
+      if (g_strcmp0(key, usage_stats_column_names[i]) == 0) {
+        g_free(values[i]);
+        values[i] = g_steal_pointer(&value);
+        break;
+      }
+    }
+    g_free(value);
+    g_free(key);
+
+    p = usage_stats_json_skip_space(p);
+    if (*p == ',') {
+      p++;
+      continue;
+    }
+    return *p == '}' && *usage_stats_json_skip_space(p + 1) == '\0';
+  }
+}
+
+static gboolean
+usage_stats_import_values(UsageStatsStore *store,
+                          char *values[USAGE_STATS_N_COLUMNS],
+                          guint bucket_seconds,
+                          GHashTable *replaced,
+                          const char **problem_out)
+{
+  gint64 bucket_start = 0;
+  gint64 duration = 0;
+  if (values[USAGE_STATS_COLUMN_BUCKET_START] == NULL ||
+      !g_ascii_string_to_signed(values[USAGE_STATS_COLUMN_BUCKET_START],
+                                10,
+                                0,
+                                G_MAXINT64,
+                                &bucket_start,
+                                NULL)) {
+    *problem_out = "bucket_start is not a Unix time";
+    return FALSE;
+  }
+  if (values[USAGE_STATS_COLUMN_DURATION] == NULL ||
+      !g_ascii_string_to_signed(values[USAGE_STATS_COLUMN_DURATION],
+                                10,
+                                0,
+                                G_MAXINT64,
+                                &duration,
+                                NULL)) {
+    *problem_out = "duration_sec is not a number of seconds";
+    return FALSE;
+  }
+
+  const char *scope = values[USAGE_STATS_COLUMN_SCOPE];
+  const char *task_id = values[USAGE_STATS_COLUMN_TASK_ID];
+  if (task_id != NULL && *task_id == '\0') {
+    task_id = NULL;
+  }
+  if (!((g_strcmp0(scope, "global") == 0 && task_id == NULL) ||
+        (g_strcmp0(scope, "task") == 0 && task_id != NULL))) {
+    *problem_out = "scope must be global, or task with a task_id";
+    return FALSE;
+  }
+
+  const char *app_key = values[USAGE_STATS_COLUMN_APP_KEY];
+  if (app_key == NULL || *app_key == '\0') {
+    *problem_out = "app_key is empty";
+    return FALSE;
+  }
+  const char *app_name = values[USAGE_STATS_COLUMN_APP_NAME];
+  if (app_name == NULL || *app_name == '\0') {
+    app_name = app_key;
+  }
+
+  if (store == NULL) {
+    return TRUE;
+  }
+
+  /* The first row of a bucket replaces what is stored for it; later rows of
+   * the same bucket (several file buckets can snap to one) add up. */
+  bucket_start -= bucket_start % bucket_seconds;
+  char *bucket_key = g_strdup_printf("%" G_GINT64_FORMAT "\n%s", bucket_start, scope);
+  if (!g_hash_table_contains(replaced, bucket_key)) {
+    if (!usage_stats_store_remove_bucket(store, bucket_start, scope)) {
+      g_free(bucket_key);
+      *problem_out = "the database rejected the row";
+      return FALSE;
+    }
+    g_hash_table_add(replaced, bucket_key);
+  } else {
+    g_free(bucket_key);
+  }
+
+  if (!usage_stats_store_add(store,
+                             bucket_start,
+                             scope,
+                             task_id,
+                             app_key,
+                             app_name,
+                             duration)) {
+    *problem_out = "the database rejected the row";
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/* Maps header names to field positions so columns may come in any order. */
+static gboolean
+usage_stats_read_csv_header(const char *line, gint columns[USAGE_STATS_N_COLUMNS])
+{
+  GPtrArray *fields = g_ptr_array_new_with_free_func(g_free);
+  usage_stats_split_csv(line, fields);
+
+  for (guint i = 0; i < USAGE_STATS_N_COLUMNS; i++) {
+    columns[i] = -1;
+    for (guint f = 0; f < fields->len; f++) {
+      if (g_strcmp0(g_strstrip((char *)g_ptr_array_index(fields, f)),
+                    usage_stats_column_names[i]) == 0) {
+        columns[i] = (gint)f;
+        break;
+      }
+    }
+  }
+  g_ptr_array_unref(fields);
+
+  return columns[USAGE_STATS_COLUMN_BUCKET_START] >= 0 &&
+         columns[USAGE_STATS_COLUMN_SCOPE] >= 0 &&
+         columns[USAGE_STATS_COLUMN_APP_KEY] >= 0 &&
+         columns[USAGE_STATS_COLUMN_DURATION] >= 0;
+}
+
+/* One read of the file. Without a store it only checks every row; with one
+ * it writes them, committing every USAGE_STATS_IMPORT_CHUNK_ROWS rows so the
+ * app's own writers never wait long for the database. */
+static gboolean
+usage_stats_import_pass(UsageStatsStore *store,
+                        GFile *file,
+                        UsageStatsFormat format,
+                        guint bucket_seconds,
+                        gint64 rows_total,
+                        UsageStatsProgressFunc progress,
+                        gpointer user_data,
+                        GCancellable *cancellable,
+                        guint64 *rows_out,
+                        GError **error)
+{
+  GFileInputStream *file_in = g_file_read(file, cancellable, error);
+  if (file_in == NULL) {
+    return FALSE;
+  }
+
+  GDataInputStream *in = g_data_input_stream_new(G_INPUT_STREAM(file_in));
+  g_object_unref(file_in);
+  g_buffered_input_stream_set_buffer_size(G_BUFFERED_INPUT_STREAM(in),
+                                          USAGE_STATS_TRANSFER_BUFFER_BYTES);
+  g_data_input_stream_set_newline_type(in, G_DATA_STREAM_NEWLINE_TYPE_ANY);
+
+  if (store != NULL && !usage_stats_store_begin(store)) {
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_BUSY,
+                "The usage stats database is busy");
+    g_object_unref(in);
+    return FALSE;
+  }
+
+  gint columns[USAGE_STATS_N_COLUMNS] = {0};
+  gboolean header_read = format != USAGE_STATS_FORMAT_CSV;
+  GPtrArray *fields = g_ptr_array_new_with_free_func(g_free);
+  GHashTable *replaced = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+  GString *record = g_string_new(NULL);
+  guint64 rows = 0;
+  guint line_number = 0;
+  guint record_line = 0;
+  const char *problem = NULL;
+  GError *local_error = NULL;
+  gboolean in_transaction = store != NULL;
+
+  while (problem == NULL && local_error == NULL) {
+    gsize length = 0;
+    char *line = g_data_input_stream_read_line(in, &length, cancellable, &local_error);
+    if (line == NULL) {
+      if (local_error == NULL && record->len > 0) {
+        problem = "the file ends inside a quoted field";
+      }
+      break;
+    }
+    line_number++;
+
+    /* A quoted CSV field can span lines; keep reading until it closes. */
+    if (record->len == 0) {
+      record_line = line_number;
+    } else {
+      g_string_append_c(record, '\n');
+    }
+    g_string_append_len(record, line, (gssize)length);
+    g_free(line);
+    if (format == USAGE_STATS_FORMAT_CSV && usage_stats_csv_record_open(record->str)) {
+      continue;
+    }
+
+    if (*g_strstrip(record->str) == '\0') {
+      g_string_truncate(record, 0);
+      continue;
+    }
+    record->len = strlen(record->str);
+
+    if (!header_read) {
+      header_read = TRUE;
+      if (!usage_stats_read_csv_header(record->str, columns)) {
+        problem = "the header lacks bucket_start, scope, app_key or duration_sec";
+      }
+      g_string_truncate(record, 0);
+      continue;
+    }
+
+    char *values[USAGE_STATS_N_COLUMNS] = {NULL};
+    if (format == USAGE_STATS_FORMAT_CSV) {
+      usage_stats_split_csv(record->str, fields);
+      for (guint i = 0; i < USAGE_STATS_N_COLUMNS; i++) {
+        if (columns[i] >= 0 && (guint)columns[i] < fields->len) {
+          values[i] = g_strdup(g_ptr_array_index(fields, columns[i]));
+        }
+      }
+    } else if (!usage_stats_parse_json_row(record->str, values)) {
+      problem = "not a JSON object";
+    }
+
+    if (problem == NULL &&
+        usage_stats_import_values(store, values, bucket_seconds, replaced, &problem)) {
+      rows++;
+      if (store != NULL && rows % USAGE_STATS_IMPORT_CHUNK_ROWS == 0) {
+        in_transaction = usage_stats_store_commit(store) && usage_stats_store_begin(store);
+        if (!in_transaction) {
+          problem = "the database is busy";
+        }
+      }
+      if (progress != NULL && rows % USAGE_STATS_TRANSFER_PROGRESS_ROWS == 0) {
+        progress(rows, rows_total, user_data);
+      }
+    }
+    for (guint i = 0; i < USAGE_STATS_N_COLUMNS; i++) {
+      g_free(values[i]);
+    }
+    g_string_truncate(record, 0);
+  }
+
+  if (problem == NULL && local_error == NULL && !header_read) {
+    problem = "the file is empty";
+  }
+  if (problem != NULL) {
+    g_set_error(&local_error,
+                G_IO_ERROR,
+                G_IO_ERROR_INVALID_DATA,
+                "Line %u: %s",
+                record_line,
+                problem);
+  }
+
+  gboolean ok = local_error == NULL;
+  if (in_transaction && ok && !usage_stats_store_commit(store)) {
+    g_set_error(&local_error,
+                G_IO_ERROR,
+                G_IO_ERROR_FAILED,
+                "Failed to commit the imported usage stats");
+    ok = FALSE;
+  } else if (in_transaction && !ok) {
+    usage_stats_store_rollback(store);
+  }
+
+  if (ok && progress != NULL) {
+    progress(rows, rows_total, user_data);
+  }
+  if (rows_out != NULL) {
+    *rows_out = ok ? rows : 0;
+  }
+
+  g_string_free(record, TRUE);
+  g_hash_table_destroy(replaced);
+  g_ptr_array_unref(fields);
+  g_object_unref(in);
+  if (local_error != NULL) {
+    g_propagate_error(error, local_error);
+  }
+  return ok;
+}
+
+gboolean
+usage_stats_import_file(UsageStatsStore *store,
+                        GFile *file,
+                        UsageStatsFormat format,
+                        UsageStatsProgressFunc progress,
+                        gpointer user_data,
+                        GCancellable *cancellable,
+                        guint64 *rows_out,
+                        GError **error)
+{
+  g_return_val_if_fail(store != NULL, FALSE);
+  g_return_val_if_fail(G_IS_FILE(file), FALSE);
+
+  guint bucket_seconds = usage_stats_store_get_bucket_seconds(store);
+  guint64 rows_total = 0;
+  if (!usage_stats_import_pass(NULL,
+                               file,
+                               format,
+                               bucket_seconds,
+                               -1,
+                               NULL,
+                               NULL,
+                               cancellable,
+                               &rows_total,
+                               error)) {
+    return FALSE;
+  }
+
+  return usage_stats_import_pass(store,
+                                 file,
+                                 format,
+                                 bucket_seconds,
+                                 (gint64)MIN(rows_total, (guint64)G_MAXINT64),
+                                 progress,
+                                 user_data,
+                                 cancellable,
+                                 rows_out,
+                                 error);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <gio/gio.h>
+
+#include "storage/usage_stats_storage.h"
+
+typedef enum {
+  USAGE_STATS_FORMAT_CSV,
+  USAGE_STATS_FORMAT_NDJSON
+} UsageStatsFormat;
+
+/* Reported every few thousand rows and once at the end. rows_total is the
+ * expected count: the selected rows for exports, the rows the checking pass
+ * found for imports. */
+typedef void (*UsageStatsProgressFunc)(guint64 rows_done,
+                                       gint64 rows_total,
+                                       gpointer user_data);
+
+gboolean usage_stats_format_parse(const char *name, UsageStatsFormat *format_out);
+/* .json/.jsonl/.ndjson mean NDJSON, anything else CSV. */
+UsageStatsFormat usage_stats_format_for_path(const char *path);
+
+/* Streams app_usage rows in [since_utc, until_utc) to file; the file is only
+ * replaced once every row has been written. A NULL scope exports both the
+ * global and the per-task rows. */
+gboolean usage_stats_export_file(UsageStatsStore *store,
+                                 GFile *file,
+                                 UsageStatsFormat format,
+                                 const char *scope,
+                                 gint64 since_utc,
+                                 gint64 until_utc,
+                                 UsageStatsProgressFunc progress,
+                                 gpointer user_data,
+                                 GCancellable *cancellable,
+                                 guint64 *rows_out,
+                                 GError **error);
+
+/* Reads the file twice: first every line is checked, and a bad one fails
+ * the import before anything is written; then the rows are written in short
+ * transactions so the app's own writers are not locked out. Rows are snapped
+ * to the store's bucket grain, and each (bucket, scope) the file covers
+ * replaces the stored one, so importing the same file twice changes nothing
+ * and importing again completes an import that failed part-way. A replaced
+ * bucket loses its per-domain split, which the file does not carry, and
+ * task_focus is left alone, so task rows do not count imported history. */
+gboolean usage_stats_import_file(UsageStatsStore *store,
+                                 GFile *file,
+                                 UsageStatsFormat format,
+                                 UsageStatsProgressFunc progress,
+                                 gpointer user_data,
+                                 GCancellable *cancellable,
+                                 guint64 *rows_out,
+                                 GError **error);
@@ -2,10 +2,24 @@
 
 #include <errno.h>
 #include <sqlite3.h>
+#include <string.h>
 
 struct _UsageStatsStore {
   sqlite3 *db;
   sqlite3_stmt *stmt_upsert;
+  sqlite3_stmt *stmt_verdict;
+  sqlite3_stmt *stmt_example;
+  sqlite3_stmt *stmt_domain_insert;
+  sqlite3_stmt *stmt_domain_lookup;
+  sqlite3_stmt *stmt_domain_upsert;
+  sqlite3_stmt *stmt_checkpoint_insert;
+  sqlite3_stmt *stmt_checkpoint_reset;
+  sqlite3_stmt *stmt_hour_upsert;
+  sqlite3_stmt *stmt_session_insert;
+  sqlite3_stmt *stmt_task_focus_add;
+  GHashTable *domain_ids;
+  guint bucket_seconds;
+  GTimeZone *timezone;
 };
 
 static char *
@@ -51,6 +65,112 @@ usage_stats_store_exec(UsageStatsStore *store, const char *sql)
   return TRUE;
 }
 
+static gboolean
+usage_stats_store_add_hour(UsageStatsStore *store,
+                           gint64 bucket_start_utc,
+                           const char *scope,
+                           const char *app_key,
+                           const char *app_name,
+                           gint64 duration_sec)
+{
+  GDateTime *local = NULL;
+  if (store->timezone != NULL) {
+    GDateTime *utc = g_date_time_new_from_unix_utc(bucket_start_utc);
+    if (utc != NULL) {
+      local = g_date_time_to_timezone(utc, store->timezone);
+      g_date_time_unref(utc);
+    }
+  } else {
+    local = g_date_time_new_from_unix_local(bucket_start_utc);
+  }
+  if (local == NULL) {
+    return FALSE;
+  }
+
+  gint minute = g_date_time_get_minute(local);
+  gint second = g_date_time_get_second(local);
+  gint64 hour_start = bucket_start_utc - minute * 60 - second;
+  /* 0 = Monday, matching the heatmap rows. */
+  gint weekday = g_date_time_get_day_of_week(local) - 1;
+  gint hour = g_date_time_get_hour(local);
+  g_date_time_unref(local);
+
+  sqlite3_stmt *stmt = store->stmt_hour_upsert;
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+
+  sqlite3_bind_int64(stmt, 1, hour_start);
+  sqlite3_bind_int(stmt, 2, weekday);
+  sqlite3_bind_int(stmt, 3, hour);
+  sqlite3_bind_text(stmt, 4, scope, -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt, 5, app_key, -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt, 6, app_name, -1, SQLITE_TRANSIENT);
+  sqlite3_bind_int64(stmt, 7, duration_sec);
+
+  if (sqlite3_step(stmt) != SQLITE_DONE) {
+    g_warning("Failed to write hour usage: %s", sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+usage_stats_store_table_exists(UsageStatsStore *store, const char *name)
+{
+  gboolean exists = FALSE;
+  sqlite3_stmt *stmt = NULL;
+  if (sqlite3_prepare_v2(store->db,
+                         "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?1",
+                         -1,
+                         &stmt,
+                         NULL) == SQLITE_OK) {
+    sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+    exists = sqlite3_step(stmt) == SQLITE_ROW;
+  }
+  sqlite3_finalize(stmt);
+  return exists;
+}
+
+/* One pass over app_usage when the hour table is first created. */
+static void
+usage_stats_store_backfill_hours(UsageStatsStore *store)
+{
+  sqlite3_stmt *stmt = NULL;
+  if (sqlite3_prepare_v2(store->db,
+                         "SELECT bucket_start, scope, app_key, app_name, duration_sec "
+                         "FROM app_usage",
+                         -1,
+                         &stmt,
+                         NULL) != SQLITE_OK) {
+    g_warning("Failed to prepare hour usage backfill: %s", sqlite3_errmsg(store->db));
+    return;
+  }
+
+  usage_stats_store_exec(store, "BEGIN IMMEDIATE");
+  guint rows = 0;
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    const char *scope = (const char *)sqlite3_column_text(stmt, 1);
+    const char *app_key = (const char *)sqlite3_column_text(stmt, 2);
+    const char *app_name = (const char *)sqlite3_column_text(stmt, 3);
+    if (scope == NULL || app_key == NULL || app_name == NULL) {
+      continue;
+    }
+    if (usage_stats_store_add_hour(store,
+                                   sqlite3_column_int64(stmt, 0),
+                                   scope,
+                                   app_key,
+                                   app_name,
+                                   sqlite3_column_int64(stmt, 4))) {
+      rows++;
+    }
+  }
+  sqlite3_finalize(stmt);
+  usage_stats_store_exec(store, "COMMIT");
+
+  g_info("Built hourly usage from %u existing rows", rows);
+}
+
 static gboolean
 usage_stats_store_init(UsageStatsStore *store)
 {
@@ -58,6 +178,11 @@ usage_stats_store_init(UsageStatsStore *store)
     return FALSE;
   }
 
+  /* WAL keeps the frequent small checkpoint transactions cheap; with
+   * synchronous=NORMAL a commit survives a crash of this process. */
+  usage_stats_store_exec(store, "PRAGMA journal_mode=WAL");
+  usage_stats_store_exec(store, "PRAGMA synchronous=NORMAL");
+
   if (!usage_stats_store_exec(store,
                               "CREATE TABLE IF NOT EXISTS app_usage ("
                               "bucket_start INTEGER NOT NULL,"
@@ -77,6 +202,183 @@ usage_stats_store_init(UsageStatsStore *store)
     return FALSE;
   }
 
+  if (!usage_stats_store_exec(store,
+                              "CREATE TABLE IF NOT EXISTS relevance_verdicts ("
+                              "task_key TEXT NOT NULL,"
+                              "url TEXT NOT NULL,"
+                              "fingerprint INTEGER NOT NULL,"
+                              "verdict INTEGER NOT NULL,"
+                              "checked_at INTEGER NOT NULL,"
+                              "PRIMARY KEY (task_key, url)"
+                              ")")) {
+    return FALSE;
+  }
+
+  if (!usage_stats_store_exec(store,
+                              "CREATE TABLE IF NOT EXISTS relevance_examples ("
+                              "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                              "task_title TEXT NOT NULL,"
+                              "domain TEXT NOT NULL,"
+                              "page_title TEXT NOT NULL,"
+                              "verdict INTEGER NOT NULL,"
+                              "created_at INTEGER NOT NULL"
+                              ")")) {
+    return FALSE;
+  }
+
+  if (!usage_stats_store_exec(store,
+                              "CREATE TABLE IF NOT EXISTS domains ("
+                              "id INTEGER PRIMARY KEY,"
+                              "domain TEXT NOT NULL UNIQUE"
+                              ")")) {
+    return FALSE;
+  }
+
+  if (!usage_stats_store_exec(store,
+                              "CREATE TABLE IF NOT EXISTS domain_usage ("
+                              "bucket_start INTEGER NOT NULL,"
+                              "scope TEXT NOT NULL,"
+                              "task_id TEXT,"
+                              "app_key TEXT NOT NULL,"
+                              "domain_id INTEGER NOT NULL REFERENCES domains (id),"
+                              "duration_sec INTEGER NOT NULL,"
+                              "PRIMARY KEY (bucket_start, scope, task_id, app_key, domain_id)"
+                              ")")) {
+    return FALSE;
+  }
+
+  /* One grain for app_usage and domain_usage together: the domain rows
+   * split their app row and must share its buckets. */
+  if (!usage_stats_store_exec(store,
+                              "CREATE TABLE IF NOT EXISTS bucket_grain ("
+                              "id INTEGER PRIMARY KEY CHECK (id = 1),"
+                              "bucket_seconds INTEGER NOT NULL"
+                              ")")) {
+    return FALSE;
+  }
+
+  /* Earlier builds kept a nominal grain per table; app_usage's is the one
+   * that was ever read. */
+  if (usage_stats_store_table_exists(store, "bucket_resolution") &&
+      !usage_stats_store_exec(store,
+                              "INSERT OR IGNORE INTO bucket_grain (id, bucket_seconds) "
+                              "SELECT 1, bucket_seconds FROM bucket_resolution "
+                              "WHERE table_name = 'app_usage';"
+                              "DROP TABLE bucket_resolution")) {
+    return FALSE;
+  }
+
+  char *grain_sql = g_strdup_printf(
+      "INSERT OR IGNORE INTO bucket_grain (id, bucket_seconds) VALUES (1, %d)",
+      USAGE_STATS_DEFAULT_BUCKET_SECONDS);
+  gboolean grain_ok = usage_stats_store_exec(store, grain_sql);
+  g_free(grain_sql);
+  if (!grain_ok) {
+    return FALSE;
+  }
+
+  store->bucket_seconds = USAGE_STATS_DEFAULT_BUCKET_SECONDS;
+  sqlite3_stmt *grain = NULL;
+  if (sqlite3_prepare_v2(store->db,
+                         "SELECT bucket_seconds FROM bucket_grain WHERE id = 1",
+                         -1,
+                         &grain,
+                         NULL) == SQLITE_OK &&
+      sqlite3_step(grain) == SQLITE_ROW) {
+    store->bucket_seconds = (guint)MAX(sqlite3_column_int(grain, 0), 1);
+  }
+  sqlite3_finalize(grain);
+
+  if (!usage_stats_store_exec(store,
+                              "CREATE TABLE IF NOT EXISTS open_bucket ("
+                              "bucket_start INTEGER NOT NULL,"
+                              "scope TEXT NOT NULL,"
+                              "task_id TEXT,"
+                              "app_key TEXT NOT NULL,"
+                              "app_name TEXT NOT NULL,"
+                              "domain TEXT,"
+                              "duration_sec INTEGER NOT NULL"
+                              ")")) {
+    return FALSE;
+  }
+
+  if (!usage_stats_store_exec(store,
+                              "CREATE INDEX IF NOT EXISTS idx_domain_usage_scope_day "
+                              "ON domain_usage (scope, task_id, bucket_start)")) {
+    return FALSE;
+  }
+
+  /* Usage per local hour (all tasks together), kept up to date by
+   * usage_stats_store_add so the heatmap never scans app_usage. */
+  gboolean hour_table_exists = usage_stats_store_table_exists(store, "hour_usage");
+
+  if (!usage_stats_store_exec(store,
+                              "CREATE TABLE IF NOT EXISTS hour_usage ("
+                              "hour_start INTEGER NOT NULL,"
+                              "weekday INTEGER NOT NULL,"
+                              "hour INTEGER NOT NULL,"
+                              "scope TEXT NOT NULL,"
+                              "app_key TEXT NOT NULL,"
+                              "app_name TEXT NOT NULL,"
+                              "duration_sec INTEGER NOT NULL,"
+                              "PRIMARY KEY (hour_start, scope, app_key)"
+                              ")")) {
+    return FALSE;
+  }
+
+  if (!usage_stats_store_exec(store,
+                              "CREATE INDEX IF NOT EXISTS idx_hour_usage_scope "
+                              "ON hour_usage (scope, hour_start)")) {
+    return FALSE;
+  }
+
+  /* One row per finished pomodoro phase. The per-task index covers the
+   * focus totals, so they are read without touching the table. */
+  if (!usage_stats_store_exec(store,
+                              "CREATE TABLE IF NOT EXISTS sessions ("
+                              "id INTEGER PRIMARY KEY,"
+                              "started_at INTEGER NOT NULL,"
+                              "ended_at INTEGER NOT NULL,"
+                              "phase INTEGER NOT NULL,"
+                              "outcome INTEGER NOT NULL,"
+                              "task_id TEXT,"
+                              "duration_ms INTEGER NOT NULL,"
+                              "interruptions INTEGER NOT NULL"
+                              ")") ||
+      !usage_stats_store_exec(store,
+                              "CREATE INDEX IF NOT EXISTS idx_sessions_task "
+                              "ON sessions (task_id, phase, duration_ms)") ||
+      !usage_stats_store_exec(store,
+                              "CREATE INDEX IF NOT EXISTS idx_sessions_started "
+                              "ON sessions (started_at)")) {
+    return FALSE;
+  }
+
+  /* Running focus totals per task, bumped with every focus session so task
+   * rows never aggregate. The first build takes them from the session
+   * history, and from the per-task usage buckets for tasks that predate it. */
+  gboolean task_focus_exists = usage_stats_store_table_exists(store, "task_focus");
+  if (!usage_stats_store_exec(store,
+                              "CREATE TABLE IF NOT EXISTS task_focus ("
+                              "task_id TEXT PRIMARY KEY,"
+                              "focus_ms INTEGER NOT NULL,"
+                              "sessions INTEGER NOT NULL"
+                              ") WITHOUT ROWID")) {
+    return FALSE;
+  }
+  if (!task_focus_exists) {
+    usage_stats_store_exec(store,
+                           "INSERT INTO task_focus (task_id, focus_ms, sessions) "
+                           "SELECT task_id, SUM(duration_ms), SUM(outcome = "
+                           G_STRINGIFY(USAGE_STATS_SESSION_COMPLETED) ") FROM sessions "
+                           "WHERE phase = " G_STRINGIFY(USAGE_STATS_SESSION_FOCUS)
+                           " AND task_id IS NOT NULL GROUP BY task_id");
+    usage_stats_store_exec(store,
+                           "INSERT OR IGNORE INTO task_focus (task_id, focus_ms, sessions) "
+                           "SELECT task_id, SUM(duration_sec) * 1000, 0 FROM app_usage "
+                           "WHERE scope = 'task' AND task_id IS NOT NULL GROUP BY task_id");
+  }
+
   const char *sql =
       "INSERT INTO app_usage (bucket_start, scope, task_id, app_key, app_name, duration_sec) "
       "VALUES (?1, ?2, ?3, ?4, ?5, ?6) "
@@ -90,6 +392,115 @@ usage_stats_store_init(UsageStatsStore *store)
     return FALSE;
   }
 
+  const char *verdict_sql =
+      "INSERT INTO relevance_verdicts (task_key, url, fingerprint, verdict, checked_at) "
+      "VALUES (?1, ?2, ?3, ?4, ?5) "
+      "ON CONFLICT(task_key, url) DO UPDATE SET "
+      "fingerprint = excluded.fingerprint, "
+      "verdict = excluded.verdict, "
+      "checked_at = excluded.checked_at";
+
+  if (sqlite3_prepare_v2(store->db, verdict_sql, -1, &store->stmt_verdict, NULL) !=
+      SQLITE_OK) {
+    g_warning("Failed to prepare relevance verdict statement: %s",
+              sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+
+  const char *example_sql =
+      "INSERT INTO relevance_examples (task_title, domain, page_title, verdict, created_at) "
+      "VALUES (?1, ?2, ?3, ?4, ?5)";
+
+  if (sqlite3_prepare_v2(store->db, example_sql, -1, &store->stmt_example, NULL) !=
+      SQLITE_OK) {
+    g_warning("Failed to prepare relevance example statement: %s",
+              sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+
+  if (sqlite3_prepare_v2(store->db,
+                         "INSERT OR IGNORE INTO domains (domain) VALUES (?1)",
+                         -1,
+                         &store->stmt_domain_insert,
+                         NULL) != SQLITE_OK ||
+      sqlite3_prepare_v2(store->db,
+                         "SELECT id FROM domains WHERE domain = ?1",
+                         -1,
+                         &store->stmt_domain_lookup,
+                         NULL) != SQLITE_OK) {
+    g_warning("Failed to prepare domain statements: %s", sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+
+  const char *domain_usage_sql =
+      "INSERT INTO domain_usage (bucket_start, scope, task_id, app_key, domain_id, "
+      "duration_sec) "
+      "VALUES (?1, ?2, ?3, ?4, ?5, ?6) "
+      "ON CONFLICT(bucket_start, scope, task_id, app_key, domain_id) DO UPDATE SET "
+      "duration_sec = duration_sec + excluded.duration_sec";
+
+  if (sqlite3_prepare_v2(store->db, domain_usage_sql, -1, &store->stmt_domain_upsert, NULL) !=
+      SQLITE_OK) {
+    g_warning("Failed to prepare domain usage statement: %s", sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+
+  if (sqlite3_prepare_v2(store->db,
+                         "INSERT INTO open_bucket (bucket_start, scope, task_id, app_key, "
+                         "app_name, domain, duration_sec) VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7)",
+                         -1,
+                         &store->stmt_checkpoint_insert,
+                         NULL) != SQLITE_OK ||
+      sqlite3_prepare_v2(store->db,
+                         "DELETE FROM open_bucket",
+                         -1,
+                         &store->stmt_checkpoint_reset,
+                         NULL) != SQLITE_OK) {
+    g_warning("Failed to prepare checkpoint statements: %s", sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+
+  const char *hour_sql =
+      "INSERT INTO hour_usage (hour_start, weekday, hour, scope, app_key, app_name, "
+      "duration_sec) "
+      "VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7) "
+      "ON CONFLICT(hour_start, scope, app_key) DO UPDATE SET "
+      "duration_sec = duration_sec + excluded.duration_sec, "
+      "app_name = excluded.app_name";
+
+  if (sqlite3_prepare_v2(store->db, hour_sql, -1, &store->stmt_hour_upsert, NULL) !=
+      SQLITE_OK) {
+    g_warning("Failed to prepare hour usage statement: %s", sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+
+  if (sqlite3_prepare_v2(store->db,
+                         "INSERT INTO sessions (started_at, ended_at, phase, outcome, task_id, "
+                         "duration_ms, interruptions) VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7)",
+                         -1,
+                         &store->stmt_session_insert,
+                         NULL) != SQLITE_OK) {
+    g_warning("Failed to prepare session statement: %s", sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+
+  if (sqlite3_prepare_v2(store->db,
+                         "INSERT INTO task_focus (task_id, focus_ms, sessions) "
+                         "VALUES (?1, ?2, ?3) "
+                         "ON CONFLICT(task_id) DO UPDATE SET "
+                         "focus_ms = focus_ms + excluded.focus_ms, "
+                         "sessions = sessions + excluded.sessions",
+                         -1,
+                         &store->stmt_task_focus_add,
+                         NULL) != SQLITE_OK) {
+    g_warning("Failed to prepare task focus statement: %s", sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+
+  if (!hour_table_exists) {
+    usage_stats_store_backfill_hours(store);
+  }
+
   return TRUE;
 }
 
@@ -97,6 +508,7 @@ UsageStatsStore *
 usage_stats_store_new(void)
 {
   UsageStatsStore *store = g_new0(UsageStatsStore, 1);
+  store->domain_ids = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
 
   char *path = usage_stats_storage_get_path();
   GError *error = NULL;
@@ -105,6 +517,7 @@ usage_stats_store_new(void)
               error ? error->message : "unknown error");
     g_clear_error(&error);
     g_free(path);
+    g_hash_table_destroy(store->domain_ids);
     g_free(store);
     return NULL;
   }
@@ -114,6 +527,7 @@ usage_stats_store_new(void)
               sqlite3_errmsg(store->db));
     sqlite3_close(store->db);
     g_free(path);
+    g_hash_table_destroy(store->domain_ids);
     g_free(store);
     return NULL;
   }
@@ -142,11 +556,32 @@ usage_stats_store_free(UsageStatsStore *store)
     store->stmt_upsert = NULL;
   }
 
+  if (store->stmt_verdict != NULL) {
+    sqlite3_finalize(store->stmt_verdict);
+    store->stmt_verdict = NULL;
+  }
+
+  if (store->stmt_example != NULL) {
+    sqlite3_finalize(store->stmt_example);
+    store->stmt_example = NULL;
+  }
+
+  g_clear_pointer(&store->stmt_domain_insert, sqlite3_finalize);
+  g_clear_pointer(&store->stmt_domain_lookup, sqlite3_finalize);
+  g_clear_pointer(&store->stmt_domain_upsert, sqlite3_finalize);
+  g_clear_pointer(&store->stmt_checkpoint_insert, sqlite3_finalize);
+  g_clear_pointer(&store->stmt_checkpoint_reset, sqlite3_finalize);
+  g_clear_pointer(&store->stmt_hour_upsert, sqlite3_finalize);
+  g_clear_pointer(&store->stmt_session_insert, sqlite3_finalize);
+  g_clear_pointer(&store->stmt_task_focus_add, sqlite3_finalize);
+
   if (store->db != NULL) {
     sqlite3_close(store->db);
     store->db = NULL;
   }
 
+  g_clear_pointer(&store->domain_ids, g_hash_table_destroy);
+  g_clear_pointer(&store->timezone, g_time_zone_unref);
   g_free(store);
 }
 
@@ -188,7 +623,77 @@ usage_stats_store_add(UsageStatsStore *store,
     return FALSE;
   }
 
-  return TRUE;
+  return usage_stats_store_add_hour(store,
+                                    bucket_start_utc,
+                                    scope,
+                                    app_key,
+                                    app_name,
+                                    duration_sec);
+}
+
+gboolean
+usage_stats_store_remove_bucket(UsageStatsStore *store,
+                                gint64 bucket_start_utc,
+                                const char *scope)
+{
+  if (store == NULL || store->db == NULL || scope == NULL) {
+    return FALSE;
+  }
+
+  sqlite3_stmt *stmt = NULL;
+  if (sqlite3_prepare_v2(store->db,
+                         "SELECT app_key, app_name, SUM(duration_sec) FROM app_usage "
+                         "WHERE bucket_start = ?1 AND scope = ?2 GROUP BY app_key",
+                         -1,
+                         &stmt,
+                         NULL) != SQLITE_OK) {
+    g_warning("Failed to prepare bucket query: %s", sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+  sqlite3_bind_int64(stmt, 1, bucket_start_utc);
+  sqlite3_bind_text(stmt, 2, scope, -1, SQLITE_TRANSIENT);
+
+  gboolean ok = TRUE;
+  gboolean found = FALSE;
+  int rc = SQLITE_ROW;
+  while (ok && (rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+    found = TRUE;
+    ok = usage_stats_store_add_hour(store,
+                                    bucket_start_utc,
+                                    scope,
+                                    (const char *)sqlite3_column_text(stmt, 0),
+                                    (const char *)sqlite3_column_text(stmt, 1),
+                                    -sqlite3_column_int64(stmt, 2));
+  }
+  if (ok && rc != SQLITE_DONE) {
+    g_warning("Failed to read bucket rows: %s", sqlite3_errmsg(store->db));
+    ok = FALSE;
+  }
+  sqlite3_finalize(stmt);
+  if (!ok || !found) {
+    return ok;
+  }
+
+  const char *const statements[] = {
+      "DELETE FROM hour_usage WHERE scope = ?2 AND hour_start > ?1 - 3600 "
+      "AND hour_start <= ?1 AND duration_sec <= 0",
+      "DELETE FROM domain_usage WHERE bucket_start = ?1 AND scope = ?2",
+      "DELETE FROM app_usage WHERE bucket_start = ?1 AND scope = ?2",
+  };
+  for (guint i = 0; ok && i < G_N_ELEMENTS(statements); i++) {
+    if (sqlite3_prepare_v2(store->db, statements[i], -1, &stmt, NULL) != SQLITE_OK) {
+      g_warning("Failed to prepare bucket delete: %s", sqlite3_errmsg(store->db));
+      return FALSE;
+    }
+    sqlite3_bind_int64(stmt, 1, bucket_start_utc);
+    sqlite3_bind_text(stmt, 2, scope, -1, SQLITE_TRANSIENT);
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+      g_warning("Failed to delete bucket rows: %s", sqlite3_errmsg(store->db));
+      ok = FALSE;
+    }
+    sqlite3_finalize(stmt);
+  }
+  return ok;
 }
 
 GPtrArray *
@@ -268,50 +773,1148 @@ usage_stats_store_query_day(UsageStatsStore *store,
   return entries;
 }
 
-gboolean
-usage_stats_store_clear(UsageStatsStore *store)
+gint64
+usage_stats_store_intern_domain(UsageStatsStore *store, const char *domain)
 {
-  if (store == NULL || store->db == NULL) {
-    return FALSE;
+  if (store == NULL || store->db == NULL || store->stmt_domain_insert == NULL ||
+      domain == NULL || *domain == '\0') {
+    return -1;
+  }
+
+  gpointer cached = NULL;
+  if (g_hash_table_lookup_extended(store->domain_ids, domain, NULL, &cached)) {
+    return GPOINTER_TO_SIZE(cached);
+  }
+
+  sqlite3_stmt *stmt = store->stmt_domain_insert;
+  sqlite3_reset(stmt);
+  sqlite3_bind_text(stmt, 1, domain, -1, SQLITE_TRANSIENT);
+  if (sqlite3_step(stmt) != SQLITE_DONE) {
+    g_warning("Failed to write domain: %s", sqlite3_errmsg(store->db));
+    return -1;
   }
 
-  return usage_stats_store_exec(store, "DELETE FROM app_usage");
+  stmt = store->stmt_domain_lookup;
+  sqlite3_reset(stmt);
+  sqlite3_bind_text(stmt, 1, domain, -1, SQLITE_TRANSIENT);
+  gint64 id = -1;
+  if (sqlite3_step(stmt) == SQLITE_ROW) {
+    id = sqlite3_column_int64(stmt, 0);
+    g_hash_table_insert(store->domain_ids, g_strdup(domain), GSIZE_TO_POINTER(id));
+  } else {
+    g_warning("Failed to read domain id: %s", sqlite3_errmsg(store->db));
+  }
+  sqlite3_reset(stmt);
+  return id;
 }
 
 gboolean
-usage_stats_store_prune(UsageStatsStore *store, gint64 cutoff_utc)
+usage_stats_store_add_domain(UsageStatsStore *store,
+                             gint64 bucket_start_utc,
+                             const char *scope,
+                             const char *task_id,
+                             const char *app_key,
+                             gint64 domain_id,
+                             gint64 duration_sec)
 {
-  if (store == NULL || store->db == NULL) {
+  if (store == NULL || store->db == NULL || store->stmt_domain_upsert == NULL ||
+      scope == NULL || app_key == NULL || domain_id < 0) {
     return FALSE;
   }
 
-  sqlite3_stmt *stmt = NULL;
-  const char *sql = "DELETE FROM app_usage WHERE bucket_start < ?1";
-  if (sqlite3_prepare_v2(store->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
-    g_warning("Failed to prepare usage stats prune: %s", sqlite3_errmsg(store->db));
-    return FALSE;
+  if (duration_sec <= 0) {
+    return TRUE;
   }
 
-  sqlite3_bind_int64(stmt, 1, cutoff_utc);
-  gboolean ok = TRUE;
+  sqlite3_stmt *stmt = store->stmt_domain_upsert;
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+
+  sqlite3_bind_int64(stmt, 1, bucket_start_utc);
+  sqlite3_bind_text(stmt, 2, scope, -1, SQLITE_TRANSIENT);
+  if (task_id != NULL) {
+    sqlite3_bind_text(stmt, 3, task_id, -1, SQLITE_TRANSIENT);
+  } else {
+    sqlite3_bind_null(stmt, 3);
+  }
+  sqlite3_bind_text(stmt, 4, app_key, -1, SQLITE_TRANSIENT);
+  sqlite3_bind_int64(stmt, 5, domain_id);
+  sqlite3_bind_int64(stmt, 6, duration_sec);
+
   if (sqlite3_step(stmt) != SQLITE_DONE) {
-    g_warning("Failed to prune usage stats: %s", sqlite3_errmsg(store->db));
-    ok = FALSE;
+    g_warning("Failed to write domain usage: %s", sqlite3_errmsg(store->db));
+    return FALSE;
   }
 
-  sqlite3_finalize(stmt);
-  return ok;
+  return TRUE;
 }
 
-void
-usage_stats_entry_free(gpointer data)
+GPtrArray *
+usage_stats_store_query_domains_day(UsageStatsStore *store,
+                                    gint64 day_start_utc,
+                                    gint64 day_end_utc,
+                                    const char *scope,
+                                    const char *task_id)
 {
-  UsageStatsEntry *entry = data;
-  if (entry == NULL) {
-    return;
+  if (store == NULL || store->db == NULL || scope == NULL) {
+    return NULL;
   }
 
-  g_free(entry->app_key);
-  g_free(entry->app_name);
-  g_free(entry);
+  const char *sql =
+      "SELECT u.app_key, d.domain, SUM(u.duration_sec) AS total "
+      "FROM domain_usage u JOIN domains d ON d.id = u.domain_id "
+      "WHERE u.scope = ?1 AND u.task_id IS ?2 AND u.bucket_start >= ?3 "
+      "AND u.bucket_start < ?4 "
+      "GROUP BY u.app_key, u.domain_id "
+      "ORDER BY total DESC";
+
+  sqlite3_stmt *stmt = NULL;
+  if (sqlite3_prepare_v2(store->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    g_warning("Failed to prepare domain usage query: %s", sqlite3_errmsg(store->db));
+    return NULL;
+  }
+  sqlite3_bind_text(stmt, 1, scope, -1, SQLITE_TRANSIENT);
+  if (task_id != NULL) {
+    sqlite3_bind_text(stmt, 2, task_id, -1, SQLITE_TRANSIENT);
+  } else {
+    sqlite3_bind_null(stmt, 2);
+  }
+  sqlite3_bind_int64(stmt, 3, day_start_utc);
+  sqlite3_bind_int64(stmt, 4, day_end_utc);
+
+  GPtrArray *entries = g_ptr_array_new_with_free_func(usage_stats_domain_entry_free);
+
+  for (;;) {
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+      const char *app_key = (const char *)sqlite3_column_text(stmt, 0);
+      const char *domain = (const char *)sqlite3_column_text(stmt, 1);
+      gint64 total = sqlite3_column_int64(stmt, 2);
+      if (app_key == NULL || domain == NULL || total <= 0) {
+        continue;
+      }
+
+      UsageStatsDomainEntry *entry = g_new0(UsageStatsDomainEntry, 1);
+      entry->app_key = g_strdup(app_key);
+      entry->domain = g_strdup(domain);
+      entry->duration_sec = total;
+      g_ptr_array_add(entries, entry);
+      continue;
+    }
+
+    if (rc == SQLITE_DONE) {
+      break;
+    }
+
+    g_warning("Failed to read domain usage: %s", sqlite3_errmsg(store->db));
+    break;
+  }
+
+  sqlite3_finalize(stmt);
+  return entries;
+}
+
+void
+usage_stats_store_rollback(UsageStatsStore *store)
+{
+  if (store == NULL) {
+    return;
+  }
+
+  usage_stats_store_exec(store, "ROLLBACK");
+  /* A domain interned inside the rolled back transaction has no row. */
+  g_hash_table_remove_all(store->domain_ids);
+}
+
+gboolean
+usage_stats_store_begin(UsageStatsStore *store)
+{
+  return usage_stats_store_exec(store, "BEGIN IMMEDIATE");
+}
+
+gboolean
+usage_stats_store_commit(UsageStatsStore *store)
+{
+  if (store == NULL) {
+    return FALSE;
+  }
+
+  if (usage_stats_store_exec(store, "COMMIT")) {
+    return TRUE;
+  }
+
+  usage_stats_store_rollback(store);
+  return FALSE;
+}
+
+static sqlite3_stmt *
+usage_stats_store_prepare_rows(UsageStatsStore *store,
+                               const char *select,
+                               const char *scope,
+                               gint64 since_utc,
+                               gint64 until_utc)
+{
+  char *sql = g_strdup_printf("SELECT %s FROM app_usage "
+                              "WHERE bucket_start >= ?1 AND bucket_start < ?2 "
+                              "AND (?3 IS NULL OR scope = ?3) "
+                              "ORDER BY bucket_start",
+                              select);
+  sqlite3_stmt *stmt = NULL;
+  if (sqlite3_prepare_v2(store->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    g_warning("Failed to prepare usage stats rows: %s", sqlite3_errmsg(store->db));
+    g_free(sql);
+    return NULL;
+  }
+  g_free(sql);
+
+  sqlite3_bind_int64(stmt, 1, since_utc);
+  sqlite3_bind_int64(stmt, 2, until_utc > 0 ? until_utc : G_MAXINT64);
+  if (scope != NULL) {
+    sqlite3_bind_text(stmt, 3, scope, -1, SQLITE_TRANSIENT);
+  } else {
+    sqlite3_bind_null(stmt, 3);
+  }
+  return stmt;
+}
+
+gint64
+usage_stats_store_count_rows(UsageStatsStore *store,
+                             const char *scope,
+                             gint64 since_utc,
+                             gint64 until_utc)
+{
+  if (store == NULL || store->db == NULL) {
+    return -1;
+  }
+
+  sqlite3_stmt *stmt =
+      usage_stats_store_prepare_rows(store, "COUNT(*)", scope, since_utc, until_utc);
+  if (stmt == NULL) {
+    return -1;
+  }
+
+  gint64 count = -1;
+  if (sqlite3_step(stmt) == SQLITE_ROW) {
+    count = sqlite3_column_int64(stmt, 0);
+  } else {
+    g_warning("Failed to count usage stats rows: %s", sqlite3_errmsg(store->db));
+  }
+
+  sqlite3_finalize(stmt);
+  return count;
+}
+
+gboolean
+usage_stats_store_foreach_row(UsageStatsStore *store,
+                              const char *scope,
+                              gint64 since_utc,
+                              gint64 until_utc,
+                              UsageStatsRowFunc func,
+                              gpointer user_data)
+{
+  if (store == NULL || store->db == NULL || func == NULL) {
+    return FALSE;
+  }
+
+  sqlite3_stmt *stmt = usage_stats_store_prepare_rows(
+      store,
+      "bucket_start, scope, task_id, app_key, app_name, duration_sec",
+      scope,
+      since_utc,
+      until_utc);
+  if (stmt == NULL) {
+    return FALSE;
+  }
+
+  gboolean ok = TRUE;
+  while (TRUE) {
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_DONE) {
+      break;
+    }
+    if (rc != SQLITE_ROW) {
+      g_warning("Failed to read usage stats rows: %s", sqlite3_errmsg(store->db));
+      ok = FALSE;
+      break;
+    }
+
+    UsageStatsRow row = {
+        .bucket_start_utc = sqlite3_column_int64(stmt, 0),
+        .scope = (const char *)sqlite3_column_text(stmt, 1),
+        .task_id = (const char *)sqlite3_column_text(stmt, 2),
+        .app_key = (const char *)sqlite3_column_text(stmt, 3),
+        .app_name = (const char *)sqlite3_column_text(stmt, 4),
+        .duration_sec = sqlite3_column_int64(stmt, 5),
+    };
+    if (!func(&row, user_data)) {
+      ok = FALSE;
+      break;
+    }
+  }
+
+  sqlite3_finalize(stmt);
+  return ok;
+}
+
+void
+usage_stats_store_set_timezone(UsageStatsStore *store, GTimeZone *timezone)
+{
+  if (store == NULL || store->timezone == timezone) {
+    return;
+  }
+
+  g_clear_pointer(&store->timezone, g_time_zone_unref);
+  store->timezone = timezone != NULL ? g_time_zone_ref(timezone) : NULL;
+}
+
+guint
+usage_stats_store_get_bucket_seconds(UsageStatsStore *store)
+{
+  if (store == NULL || store->bucket_seconds == 0) {
+    return USAGE_STATS_DEFAULT_BUCKET_SECONDS;
+  }
+
+  return store->bucket_seconds;
+}
+
+static gboolean
+usage_stats_store_regrain_table(UsageStatsStore *store,
+                                const char *table,
+                                const char *columns,
+                                const char *group_by,
+                                const char *aggregates,
+                                guint bucket_seconds)
+{
+  char *sql = g_strdup_printf(
+      "CREATE TEMP TABLE regrain AS "
+      "SELECT (bucket_start / %u) * %u AS bucket_start, %s, %s "
+      "FROM %s GROUP BY 1, %s;"
+      "DELETE FROM %s;"
+      "INSERT INTO %s (bucket_start, %s) SELECT bucket_start, %s FROM regrain;"
+      "DROP TABLE regrain",
+      bucket_seconds,
+      bucket_seconds,
+      group_by,
+      aggregates,
+      table,
+      group_by,
+      table,
+      table,
+      columns,
+      columns);
+  gboolean ok = usage_stats_store_exec(store, sql);
+  g_free(sql);
+  return ok;
+}
+
+gboolean
+usage_stats_store_set_bucket_seconds(UsageStatsStore *store, guint bucket_seconds)
+{
+  if (store == NULL || store->db == NULL || bucket_seconds == 0) {
+    return FALSE;
+  }
+
+  guint current = usage_stats_store_get_bucket_seconds(store);
+  if (bucket_seconds == current) {
+    return TRUE;
+  }
+
+  if (!usage_stats_store_begin(store)) {
+    return FALSE;
+  }
+
+  gboolean ok = TRUE;
+  if (bucket_seconds > current) {
+    ok = usage_stats_store_regrain_table(store,
+                                         "app_usage",
+                                         "scope, task_id, app_key, app_name, duration_sec",
+                                         "scope, task_id, app_key",
+                                         "MAX(app_name) AS app_name, "
+                                         "SUM(duration_sec) AS duration_sec",
+                                         bucket_seconds) &&
+         usage_stats_store_regrain_table(store,
+                                         "domain_usage",
+                                         "scope, task_id, app_key, domain_id, duration_sec",
+                                         "scope, task_id, app_key, domain_id",
+                                         "SUM(duration_sec) AS duration_sec",
+                                         bucket_seconds);
+  }
+
+  if (ok) {
+    char *sql = g_strdup_printf("UPDATE bucket_grain SET bucket_seconds = %u WHERE id = 1",
+                                bucket_seconds);
+    ok = usage_stats_store_exec(store, sql);
+    g_free(sql);
+  }
+
+  if (!ok) {
+    usage_stats_store_rollback(store);
+    return FALSE;
+  }
+  if (!usage_stats_store_commit(store)) {
+    return FALSE;
+  }
+
+  g_info("Usage stats buckets changed from %u s to %u s", current, bucket_seconds);
+  store->bucket_seconds = bucket_seconds;
+  return TRUE;
+}
+
+gboolean
+usage_stats_store_checkpoint_reset(UsageStatsStore *store)
+{
+  if (store == NULL || store->db == NULL || store->stmt_checkpoint_reset == NULL) {
+    return FALSE;
+  }
+
+  sqlite3_stmt *stmt = store->stmt_checkpoint_reset;
+  sqlite3_reset(stmt);
+  if (sqlite3_step(stmt) != SQLITE_DONE) {
+    g_warning("Failed to reset usage checkpoint: %s", sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+gboolean
+usage_stats_store_checkpoint_put(UsageStatsStore *store,
+                                 gint64 bucket_start_utc,
+                                 const char *scope,
+                                 const char *task_id,
+                                 const char *app_key,
+                                 const char *app_name,
+                                 const char *domain,
+                                 gint64 duration_sec)
+{
+  if (store == NULL || store->db == NULL || store->stmt_checkpoint_insert == NULL ||
+      scope == NULL || app_key == NULL || app_name == NULL) {
+    return FALSE;
+  }
+
+  if (duration_sec <= 0) {
+    return TRUE;
+  }
+
+  sqlite3_stmt *stmt = store->stmt_checkpoint_insert;
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+
+  sqlite3_bind_int64(stmt, 1, bucket_start_utc);
+  sqlite3_bind_text(stmt, 2, scope, -1, SQLITE_TRANSIENT);
+  if (task_id != NULL) {
+    sqlite3_bind_text(stmt, 3, task_id, -1, SQLITE_TRANSIENT);
+  } else {
+    sqlite3_bind_null(stmt, 3);
+  }
+  sqlite3_bind_text(stmt, 4, app_key, -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt, 5, app_name, -1, SQLITE_TRANSIENT);
+  if (domain != NULL) {
+    sqlite3_bind_text(stmt, 6, domain, -1, SQLITE_TRANSIENT);
+  } else {
+    sqlite3_bind_null(stmt, 6);
+  }
+  sqlite3_bind_int64(stmt, 7, duration_sec);
+
+  if (sqlite3_step(stmt) != SQLITE_DONE) {
+    g_warning("Failed to write usage checkpoint: %s", sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+guint
+usage_stats_store_replay_checkpoint(UsageStatsStore *store)
+{
+  if (store == NULL || store->db == NULL || !usage_stats_store_begin(store)) {
+    return 0;
+  }
+
+  const char *sql =
+      "SELECT bucket_start, scope, task_id, app_key, app_name, domain, duration_sec "
+      "FROM open_bucket";
+
+  sqlite3_stmt *stmt = NULL;
+  if (sqlite3_prepare_v2(store->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    g_warning("Failed to prepare checkpoint replay: %s", sqlite3_errmsg(store->db));
+    usage_stats_store_rollback(store);
+    return 0;
+  }
+
+  guint replayed = 0;
+  gboolean ok = TRUE;
+  for (;;) {
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_DONE) {
+      break;
+    }
+    if (rc != SQLITE_ROW) {
+      g_warning("Failed to read usage checkpoint: %s", sqlite3_errmsg(store->db));
+      ok = FALSE;
+      break;
+    }
+
+    gint64 bucket_start = sqlite3_column_int64(stmt, 0);
+    const char *scope = (const char *)sqlite3_column_text(stmt, 1);
+    const char *task_id = (const char *)sqlite3_column_text(stmt, 2);
+    const char *app_key = (const char *)sqlite3_column_text(stmt, 3);
+    const char *app_name = (const char *)sqlite3_column_text(stmt, 4);
+    const char *domain = (const char *)sqlite3_column_text(stmt, 5);
+    gint64 duration_sec = sqlite3_column_int64(stmt, 6);
+
+    if (domain != NULL) {
+      ok = usage_stats_store_add_domain(store,
+                                        bucket_start,
+                                        scope,
+                                        task_id,
+                                        app_key,
+                                        usage_stats_store_intern_domain(store, domain),
+                                        duration_sec);
+    } else {
+      ok = usage_stats_store_add(store,
+                                 bucket_start,
+                                 scope,
+                                 task_id,
+                                 app_key,
+                                 app_name,
+                                 duration_sec);
+    }
+    if (!ok) {
+      break;
+    }
+    replayed++;
+  }
+  sqlite3_finalize(stmt);
+
+  if (!ok || !usage_stats_store_checkpoint_reset(store)) {
+    usage_stats_store_rollback(store);
+    return 0;
+  }
+
+  return usage_stats_store_commit(store) ? replayed : 0;
+}
+
+gboolean
+usage_stats_store_query_heatmap(UsageStatsStore *store,
+                                const char *scope,
+                                gint64 since_utc,
+                                gint64 cells_out[USAGE_STATS_WEEKDAYS][USAGE_STATS_HOURS])
+{
+  memset(cells_out, 0, sizeof(gint64) * USAGE_STATS_WEEKDAYS * USAGE_STATS_HOURS);
+  if (store == NULL || store->db == NULL || scope == NULL) {
+    return FALSE;
+  }
+
+  const char *sql =
+      "SELECT weekday, hour, SUM(duration_sec) FROM hour_usage "
+      "WHERE scope = ?1 AND hour_start >= ?2 "
+      "GROUP BY weekday, hour";
+
+  sqlite3_stmt *stmt = NULL;
+  if (sqlite3_prepare_v2(store->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    g_warning("Failed to prepare heatmap query: %s", sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+  sqlite3_bind_text(stmt, 1, scope, -1, SQLITE_TRANSIENT);
+  sqlite3_bind_int64(stmt, 2, since_utc);
+
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    gint weekday = sqlite3_column_int(stmt, 0);
+    gint hour = sqlite3_column_int(stmt, 1);
+    if (weekday < 0 || weekday >= USAGE_STATS_WEEKDAYS || hour < 0 ||
+        hour >= USAGE_STATS_HOURS) {
+      continue;
+    }
+    cells_out[weekday][hour] = sqlite3_column_int64(stmt, 2);
+  }
+
+  sqlite3_finalize(stmt);
+  return TRUE;
+}
+
+gboolean
+usage_stats_store_query_heatmap_apps(UsageStatsStore *store,
+                                     const char *scope,
+                                     gint64 since_utc,
+                                     guint limit,
+                                     GPtrArray *apps_out[USAGE_STATS_WEEKDAYS]
+                                                        [USAGE_STATS_HOURS])
+{
+  memset(apps_out, 0, sizeof(GPtrArray *) * USAGE_STATS_WEEKDAYS * USAGE_STATS_HOURS);
+  if (store == NULL || store->db == NULL || scope == NULL) {
+    return FALSE;
+  }
+
+  const char *sql =
+      "SELECT weekday, hour, app_key, MAX(app_name), SUM(duration_sec) AS total "
+      "FROM hour_usage WHERE scope = ?1 AND hour_start >= ?2 "
+      "GROUP BY weekday, hour, app_key HAVING total > 0 "
+      "ORDER BY weekday, hour, total DESC";
+
+  sqlite3_stmt *stmt = NULL;
+  if (sqlite3_prepare_v2(store->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    g_warning("Failed to prepare heatmap app query: %s", sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+  sqlite3_bind_text(stmt, 1, scope, -1, SQLITE_TRANSIENT);
+  sqlite3_bind_int64(stmt, 2, since_utc);
+
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    gint weekday = sqlite3_column_int(stmt, 0);
+    gint hour = sqlite3_column_int(stmt, 1);
+    const char *app_key = (const char *)sqlite3_column_text(stmt, 2);
+    const char *app_name = (const char *)sqlite3_column_text(stmt, 3);
+    if (weekday < 0 || weekday >= USAGE_STATS_WEEKDAYS || hour < 0 ||
+        hour >= USAGE_STATS_HOURS || app_key == NULL) {
+      continue;
+    }
+
+    GPtrArray **apps = &apps_out[weekday][hour];
+    if (*apps == NULL) {
+      *apps = g_ptr_array_new_with_free_func(usage_stats_entry_free);
+    }
+    /* Rows come largest first within a cell. */
+    if ((*apps)->len >= limit) {
+      continue;
+    }
+
+    UsageStatsEntry *entry = g_new0(UsageStatsEntry, 1);
+    entry->app_key = g_strdup(app_key);
+    entry->app_name = g_strdup(app_name != NULL ? app_name : app_key);
+    entry->duration_sec = sqlite3_column_int64(stmt, 4);
+    g_ptr_array_add(*apps, entry);
+  }
+
+  sqlite3_finalize(stmt);
+  return TRUE;
+}
+
+gboolean
+usage_stats_store_add_session(UsageStatsStore *store, const UsageStatsSession *session)
+{
+  if (store == NULL || store->db == NULL || store->stmt_session_insert == NULL ||
+      session == NULL) {
+    return FALSE;
+  }
+
+  sqlite3_stmt *stmt = store->stmt_session_insert;
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+
+  sqlite3_bind_int64(stmt, 1, session->started_at_utc);
+  sqlite3_bind_int64(stmt, 2, session->ended_at_utc);
+  sqlite3_bind_int(stmt, 3, session->phase);
+  sqlite3_bind_int(stmt, 4, session->outcome);
+  if (session->task_id != NULL) {
+    sqlite3_bind_text(stmt, 5, session->task_id, -1, SQLITE_TRANSIENT);
+  } else {
+    sqlite3_bind_null(stmt, 5);
+  }
+  sqlite3_bind_int64(stmt, 6, session->duration_ms);
+  sqlite3_bind_int(stmt, 7, (int)session->interruptions);
+
+  if (sqlite3_step(stmt) != SQLITE_DONE) {
+    g_warning("Failed to write session: %s", sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+
+  if (session->phase != USAGE_STATS_SESSION_FOCUS || session->task_id == NULL) {
+    return TRUE;
+  }
+
+  stmt = store->stmt_task_focus_add;
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+  sqlite3_bind_text(stmt, 1, session->task_id, -1, SQLITE_TRANSIENT);
+  sqlite3_bind_int64(stmt, 2, session->duration_ms);
+  sqlite3_bind_int(stmt, 3, session->outcome == USAGE_STATS_SESSION_COMPLETED ? 1 : 0);
+  if (sqlite3_step(stmt) != SQLITE_DONE) {
+    g_warning("Failed to update task focus: %s", sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+GPtrArray *
+usage_stats_store_load_task_focus(UsageStatsStore *store)
+{
+  if (store == NULL || store->db == NULL) {
+    return NULL;
+  }
+
+  sqlite3_stmt *stmt = NULL;
+  if (sqlite3_prepare_v2(store->db,
+                         "SELECT task_id, focus_ms, sessions FROM task_focus",
+                         -1,
+                         &stmt,
+                         NULL) != SQLITE_OK) {
+    g_warning("Failed to prepare task focus query: %s", sqlite3_errmsg(store->db));
+    return NULL;
+  }
+
+  GPtrArray *entries = g_ptr_array_new_with_free_func(usage_stats_task_focus_free);
+  while (TRUE) {
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_DONE) {
+      break;
+    }
+    if (rc != SQLITE_ROW) {
+      g_warning("Failed to read task focus: %s", sqlite3_errmsg(store->db));
+      break;
+    }
+
+    UsageStatsTaskFocus *entry = g_new0(UsageStatsTaskFocus, 1);
+    entry->task_id = g_strdup((const char *)sqlite3_column_text(stmt, 0));
+    entry->focus_ms = sqlite3_column_int64(stmt, 1);
+    entry->sessions = (guint)sqlite3_column_int64(stmt, 2);
+    g_ptr_array_add(entries, entry);
+  }
+
+  sqlite3_finalize(stmt);
+  return entries;
+}
+
+gboolean
+usage_stats_store_query_task_sessions(UsageStatsStore *store,
+                                      const char *task_id,
+                                      gint phase,
+                                      guint *sessions_out,
+                                      gint64 *duration_ms_out)
+{
+  if (store == NULL || store->db == NULL || task_id == NULL) {
+    return FALSE;
+  }
+
+  sqlite3_stmt *stmt = NULL;
+  const char *sql =
+      "SELECT COUNT(*), COALESCE(SUM(duration_ms), 0) FROM sessions "
+      "WHERE task_id = ?1 AND phase = ?2";
+  if (sqlite3_prepare_v2(store->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    g_warning("Failed to prepare task session query: %s", sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+
+  sqlite3_bind_text(stmt, 1, task_id, -1, SQLITE_TRANSIENT);
+  sqlite3_bind_int(stmt, 2, phase);
+
+  gboolean ok = sqlite3_step(stmt) == SQLITE_ROW;
+  if (ok) {
+    if (sessions_out != NULL) {
+      *sessions_out = (guint)sqlite3_column_int64(stmt, 0);
+    }
+    if (duration_ms_out != NULL) {
+      *duration_ms_out = sqlite3_column_int64(stmt, 1);
+    }
+  } else {
+    g_warning("Failed to read task sessions: %s", sqlite3_errmsg(store->db));
+  }
+
+  sqlite3_finalize(stmt);
+  return ok;
+}
+
+GArray *
+usage_stats_store_query_day_sessions(UsageStatsStore *store,
+                                     gint64 day_start_utc,
+                                     gint64 day_end_utc)
+{
+  if (store == NULL || store->db == NULL) {
+    return NULL;
+  }
+
+  sqlite3_stmt *stmt = NULL;
+  const char *sql =
+      "SELECT phase, COUNT(*), SUM(duration_ms), SUM(interruptions) FROM sessions "
+      "WHERE started_at >= ?1 AND started_at < ?2 "
+      "GROUP BY phase ORDER BY phase";
+  if (sqlite3_prepare_v2(store->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    g_warning("Failed to prepare day session query: %s", sqlite3_errmsg(store->db));
+    return NULL;
+  }
+
+  sqlite3_bind_int64(stmt, 1, day_start_utc);
+  sqlite3_bind_int64(stmt, 2, day_end_utc);
+
+  GArray *totals = g_array_new(FALSE, TRUE, sizeof(UsageStatsSessionTotals));
+  while (TRUE) {
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_DONE) {
+      break;
+    }
+    if (rc != SQLITE_ROW) {
+      g_warning("Failed to read day sessions: %s", sqlite3_errmsg(store->db));
+      break;
+    }
+
+    UsageStatsSessionTotals entry = {
+        .phase = sqlite3_column_int(stmt, 0),
+        .sessions = (guint)sqlite3_column_int64(stmt, 1),
+        .duration_ms = sqlite3_column_int64(stmt, 2),
+        .interruptions = (guint)sqlite3_column_int64(stmt, 3),
+    };
+    g_array_append_val(totals, entry);
+  }
+
+  sqlite3_finalize(stmt);
+  return totals;
+}
+
+gboolean
+usage_stats_store_clear(UsageStatsStore *store)
+{
+  if (store == NULL || store->db == NULL) {
+    return FALSE;
+  }
+
+  /* Everything derived from browsing goes too: cached verdicts and training
+   * examples carry page URLs and titles, domains their names. */
+  const char *const statements[] = {
+      "DELETE FROM app_usage",
+      "DELETE FROM domain_usage",
+      "DELETE FROM domains",
+      "DELETE FROM open_bucket",
+      "DELETE FROM hour_usage",
+      "DELETE FROM sessions",
+      "DELETE FROM task_focus",
+      "DELETE FROM relevance_verdicts",
+      "DELETE FROM relevance_examples",
+  };
+
+  if (!usage_stats_store_begin(store)) {
+    return FALSE;
+  }
+  for (guint i = 0; i < G_N_ELEMENTS(statements); i++) {
+    if (!usage_stats_store_exec(store, statements[i])) {
+      usage_stats_store_rollback(store);
+      return FALSE;
+    }
+  }
+  if (!usage_stats_store_commit(store)) {
+    return FALSE;
+  }
+
+  g_hash_table_remove_all(store->domain_ids);
+  return TRUE;
+}
+
+gboolean
+usage_stats_store_prune(UsageStatsStore *store, gint64 cutoff_utc)
+{
+  if (store == NULL || store->db == NULL) {
+    return FALSE;
+  }
+
+  const char *const statements[] = {
+      "DELETE FROM app_usage WHERE bucket_start < ?1",
+      "DELETE FROM domain_usage WHERE bucket_start < ?1",
+      "DELETE FROM hour_usage WHERE hour_start < ?1",
+  };
+
+  gboolean ok = TRUE;
+  for (guint i = 0; i < G_N_ELEMENTS(statements); i++) {
+    sqlite3_stmt *stmt = NULL;
+    if (sqlite3_prepare_v2(store->db, statements[i], -1, &stmt, NULL) != SQLITE_OK) {
+      g_warning("Failed to prepare usage stats prune: %s", sqlite3_errmsg(store->db));
+      return FALSE;
+    }
+
+    sqlite3_bind_int64(stmt, 1, cutoff_utc);
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+      g_warning("Failed to prune usage stats: %s", sqlite3_errmsg(store->db));
+      ok = FALSE;
+    }
+
+    sqlite3_finalize(stmt);
+  }
+  return ok;
+}
+
+gboolean
+usage_stats_store_put_verdict(UsageStatsStore *store,
+                              const char *task_key,
+                              const char *url,
+                              guint64 fingerprint,
+                              gint verdict,
+                              gint64 checked_at_utc)
+{
+  if (store == NULL || store->db == NULL || store->stmt_verdict == NULL ||
+      task_key == NULL || url == NULL) {
+    return FALSE;
+  }
+
+  sqlite3_stmt *stmt = store->stmt_verdict;
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+
+  sqlite3_bind_text(stmt, 1, task_key, -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt, 2, url, -1, SQLITE_TRANSIENT);
+  sqlite3_bind_int64(stmt, 3, (sqlite3_int64)fingerprint);
+  sqlite3_bind_int(stmt, 4, verdict);
+  sqlite3_bind_int64(stmt, 5, checked_at_utc);
+
+  if (sqlite3_step(stmt) != SQLITE_DONE) {
+    g_warning("Failed to write relevance verdict: %s", sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+GPtrArray *
+usage_stats_store_load_verdicts(UsageStatsStore *store, gint64 since_utc)
+{
+  if (store == NULL || store->db == NULL) {
+    return NULL;
+  }
+
+  const char *sql =
+      "SELECT task_key, url, fingerprint, verdict, checked_at "
+      "FROM relevance_verdicts "
+      "WHERE checked_at >= ?1 "
+      "ORDER BY checked_at ASC";
+
+  sqlite3_stmt *stmt = NULL;
+  if (sqlite3_prepare_v2(store->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    g_warning("Failed to prepare relevance verdict query: %s",
+              sqlite3_errmsg(store->db));
+    return NULL;
+  }
+  sqlite3_bind_int64(stmt, 1, since_utc);
+
+  GPtrArray *verdicts = g_ptr_array_new_with_free_func(usage_stats_verdict_free);
+
+  for (;;) {
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+      const char *task_key = (const char *)sqlite3_column_text(stmt, 0);
+      const char *url = (const char *)sqlite3_column_text(stmt, 1);
+      if (task_key == NULL || url == NULL) {
+        continue;
+      }
+
+      UsageStatsVerdict *verdict = g_new0(UsageStatsVerdict, 1);
+      verdict->task_key = g_strdup(task_key);
+      verdict->url = g_strdup(url);
+      verdict->fingerprint = (guint64)sqlite3_column_int64(stmt, 2);
+      verdict->verdict = sqlite3_column_int(stmt, 3);
+      verdict->checked_at_utc = sqlite3_column_int64(stmt, 4);
+      g_ptr_array_add(verdicts, verdict);
+      continue;
+    }
+
+    if (rc == SQLITE_DONE) {
+      break;
+    }
+
+    g_warning("Failed to read relevance verdicts: %s", sqlite3_errmsg(store->db));
+    break;
+  }
+
+  sqlite3_finalize(stmt);
+  return verdicts;
+}
+
+gboolean
+usage_stats_store_prune_verdicts(UsageStatsStore *store, gint64 cutoff_utc)
+{
+  if (store == NULL || store->db == NULL) {
+    return FALSE;
+  }
+
+  sqlite3_stmt *stmt = NULL;
+  const char *sql = "DELETE FROM relevance_verdicts WHERE checked_at < ?1";
+  if (sqlite3_prepare_v2(store->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    g_warning("Failed to prepare relevance verdict prune: %s",
+              sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+
+  sqlite3_bind_int64(stmt, 1, cutoff_utc);
+  gboolean ok = TRUE;
+  if (sqlite3_step(stmt) != SQLITE_DONE) {
+    g_warning("Failed to prune relevance verdicts: %s", sqlite3_errmsg(store->db));
+    ok = FALSE;
+  }
+
+  sqlite3_finalize(stmt);
+  return ok;
+}
+
+gboolean
+usage_stats_store_add_example(UsageStatsStore *store,
+                              const char *task_title,
+                              const char *domain,
+                              const char *page_title,
+                              gint verdict,
+                              gint64 created_at_utc)
+{
+  if (store == NULL || store->db == NULL || store->stmt_example == NULL ||
+      task_title == NULL) {
+    return FALSE;
+  }
+
+  sqlite3_stmt *stmt = store->stmt_example;
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+
+  sqlite3_bind_text(stmt, 1, task_title, -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt, 2, domain != NULL ? domain : "", -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt, 3, page_title != NULL ? page_title : "", -1, SQLITE_TRANSIENT);
+  sqlite3_bind_int(stmt, 4, verdict);
+  sqlite3_bind_int64(stmt, 5, created_at_utc);
+
+  if (sqlite3_step(stmt) != SQLITE_DONE) {
+    g_warning("Failed to write relevance example: %s", sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+GPtrArray *
+usage_stats_store_load_examples(UsageStatsStore *store, guint limit)
+{
+  if (store == NULL || store->db == NULL) {
+    return NULL;
+  }
+
+  /* The newest examples, replayed oldest first. */
+  const char *sql =
+      "SELECT task_title, domain, page_title, verdict, created_at FROM ("
+      "SELECT * FROM relevance_examples ORDER BY id DESC LIMIT ?1"
+      ") ORDER BY id ASC";
+
+  sqlite3_stmt *stmt = NULL;
+  if (sqlite3_prepare_v2(store->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    g_warning("Failed to prepare relevance example query: %s",
+              sqlite3_errmsg(store->db));
+    return NULL;
+  }
+  sqlite3_bind_int64(stmt, 1, limit);
+
+  GPtrArray *examples = g_ptr_array_new_with_free_func(usage_stats_example_free);
+
+  for (;;) {
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+      const char *task_title = (const char *)sqlite3_column_text(stmt, 0);
+      if (task_title == NULL) {
+        continue;
+      }
+
+      UsageStatsExample *example = g_new0(UsageStatsExample, 1);
+      example->task_title = g_strdup(task_title);
+      example->domain = g_strdup((const char *)sqlite3_column_text(stmt, 1));
+      example->page_title = g_strdup((const char *)sqlite3_column_text(stmt, 2));
+      example->verdict = sqlite3_column_int(stmt, 3);
+      example->created_at_utc = sqlite3_column_int64(stmt, 4);
+      g_ptr_array_add(examples, example);
+      continue;
+    }
+
+    if (rc == SQLITE_DONE) {
+      break;
+    }
+
+    g_warning("Failed to read relevance examples: %s", sqlite3_errmsg(store->db));
+    break;
+  }
+
+  sqlite3_finalize(stmt);
+  return examples;
+}
+
+gboolean
+usage_stats_store_prune_examples(UsageStatsStore *store, guint keep)
+{
+  if (store == NULL || store->db == NULL) {
+    return FALSE;
+  }
+
+  sqlite3_stmt *stmt = NULL;
+  const char *sql =
+      "DELETE FROM relevance_examples WHERE id <= "
+      "(SELECT id FROM relevance_examples ORDER BY id DESC LIMIT 1 OFFSET ?1)";
+  if (sqlite3_prepare_v2(store->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    g_warning("Failed to prepare relevance example prune: %s",
+              sqlite3_errmsg(store->db));
+    return FALSE;
+  }
+
+  sqlite3_bind_int64(stmt, 1, keep);
+  gboolean ok = TRUE;
+  if (sqlite3_step(stmt) != SQLITE_DONE) {
+    g_warning("Failed to prune relevance examples: %s", sqlite3_errmsg(store->db));
+    ok = FALSE;
+  }
+
+  sqlite3_finalize(stmt);
+  return ok;
+}
+
+void
+usage_stats_verdict_free(gpointer data)
+{
+  UsageStatsVerdict *verdict = data;
+  if (verdict == NULL) {
+    return;
+  }
+
+  g_free(verdict->task_key);
+  g_free(verdict->url);
+  g_free(verdict);
+}
+
+void
+usage_stats_entry_free(gpointer data)
+{
+  UsageStatsEntry *entry = data;
+  if (entry == NULL) {
+    return;
+  }
+
+  g_free(entry->app_key);
+  g_free(entry->app_name);
+  g_free(entry);
+}
+
+void
+usage_stats_task_focus_free(gpointer data)
+{
+  UsageStatsTaskFocus *entry = data;
+  if (entry == NULL) {
+    return;
+  }
+
+  g_free(entry->task_id);
+  g_free(entry);
+}
+
+void
+usage_stats_domain_entry_free(gpointer data)
+{
+  UsageStatsDomainEntry *entry = data;
+  if (entry == NULL) {
+    return;
+  }
+
+  g_free(entry->app_key);
+  g_free(entry->domain);
+  g_free(entry);
+}
+
+void
+usage_stats_example_free(gpointer data)
+{
+  UsageStatsExample *example = data;
+  if (example == NULL) {
+    return;
+  }
+
+  g_free(example->task_title);
+  g_free(example->domain);
+  g_free(example->page_title);
+  g_free(example);
 }
@@ -10,6 +10,75 @@ typedef struct {
   gint64 duration_sec;
 } UsageStatsEntry;
 
+typedef struct {
+  char *app_key;
+  char *domain;
+  gint64 duration_sec;
+} UsageStatsDomainEntry;
+
+typedef struct {
+  char *task_key;
+  char *url;
+  guint64 fingerprint;
+  gint verdict;
+  gint64 checked_at_utc;
+} UsageStatsVerdict;
+
+typedef struct {
+  char *task_title;
+  char *domain;
+  char *page_title;
+  gint verdict;
+  gint64 created_at_utc;
+} UsageStatsExample;
+
+/* A finished pomodoro phase; phase and outcome are the timer's enums
+ * (PomodoroPhase, PomodoroPhaseOutcome), of which the store needs two.
+ * main_window_timer.c, where records become sessions, asserts they match. */
+#define USAGE_STATS_SESSION_FOCUS 0
+#define USAGE_STATS_SESSION_COMPLETED 0
+
+typedef struct {
+  gint64 started_at_utc;
+  gint64 ended_at_utc;
+  gint phase;
+  gint outcome;
+  char *task_id;
+  gint64 duration_ms;
+  guint interruptions;
+} UsageStatsSession;
+
+typedef struct {
+  char *task_id;
+  gint64 focus_ms;
+  guint sessions;
+} UsageStatsTaskFocus;
+
+typedef struct {
+  gint phase;
+  guint sessions;
+  gint64 duration_ms;
+  guint interruptions;
+} UsageStatsSessionTotals;
+
+/* One app_usage row; the strings are only valid inside the callback. */
+typedef struct {
+  gint64 bucket_start_utc;
+  const char *scope;
+  const char *task_id;
+  const char *app_key;
+  const char *app_name;
+  gint64 duration_sec;
+} UsageStatsRow;
+
+typedef gboolean (*UsageStatsRowFunc)(const UsageStatsRow *row, gpointer user_data);
+
+/* Databases created before the grain was stored used 5-minute buckets. */
+#define USAGE_STATS_DEFAULT_BUCKET_SECONDS 300
+
+#define USAGE_STATS_WEEKDAYS 7
+#define USAGE_STATS_HOURS 24
+
 UsageStatsStore *usage_stats_store_new(void);
 void usage_stats_store_free(UsageStatsStore *store);
 
@@ -20,6 +89,11 @@ gboolean usage_stats_store_add(UsageStatsStore *store,
                                const char *app_key,
                                const char *app_name,
                                gint64 duration_sec);
+/* Deletes one bucket's rows of a scope and takes them off the hourly totals;
+ * an import calls it before writing a bucket so importing twice is harmless. */
+gboolean usage_stats_store_remove_bucket(UsageStatsStore *store,
+                                         gint64 bucket_start_utc,
+                                         const char *scope);
 
 GPtrArray *usage_stats_store_query_day(UsageStatsStore *store,
                                        gint64 day_start_utc,
@@ -27,7 +101,124 @@ GPtrArray *usage_stats_store_query_day(UsageStatsStore *store,
                                        const char *scope,
                                        const char *task_id);
 
+/* Domains are stored once and referenced by id; returns -1 on failure. */
+gint64 usage_stats_store_intern_domain(UsageStatsStore *store, const char *domain);
+gboolean usage_stats_store_add_domain(UsageStatsStore *store,
+                                      gint64 bucket_start_utc,
+                                      const char *scope,
+                                      const char *task_id,
+                                      const char *app_key,
+                                      gint64 domain_id,
+                                      gint64 duration_sec);
+GPtrArray *usage_stats_store_query_domains_day(UsageStatsStore *store,
+                                               gint64 day_start_utc,
+                                               gint64 day_end_utc,
+                                               const char *scope,
+                                               const char *task_id);
+
+/* Bucket size shared by app_usage and domain_usage, kept in the database as
+ * a single value. Moving to a coarser grain re-aggregates existing rows;
+ * moving to a finer one leaves them as they are, since every allowed grain
+ * divides the coarser ones. */
+guint usage_stats_store_get_bucket_seconds(UsageStatsStore *store);
+/* Zone that hour_usage rows are bucketed in, so they follow the same days
+ * as the stats view. NULL (the default) is GLib's local zone, which it
+ * resolves once per process. Hours already written keep their zone. */
+void usage_stats_store_set_timezone(UsageStatsStore *store, GTimeZone *timezone);
+gboolean usage_stats_store_set_bucket_seconds(UsageStatsStore *store,
+                                              guint bucket_seconds);
+
+gboolean usage_stats_store_begin(UsageStatsStore *store);
+gboolean usage_stats_store_commit(UsageStatsStore *store);
+void usage_stats_store_rollback(UsageStatsStore *store);
+
+/* Walks app_usage rows in [since_utc, until_utc) in bucket order through a
+ * single cursor, so memory stays flat however long the range. A NULL scope
+ * matches every scope and until_utc <= 0 leaves the range open; the callback
+ * returns FALSE to stop. count_rows returns -1 on failure. */
+gint64 usage_stats_store_count_rows(UsageStatsStore *store,
+                                    const char *scope,
+                                    gint64 since_utc,
+                                    gint64 until_utc);
+gboolean usage_stats_store_foreach_row(UsageStatsStore *store,
+                                       const char *scope,
+                                       gint64 since_utc,
+                                       gint64 until_utc,
+                                       UsageStatsRowFunc func,
+                                       gpointer user_data);
+
+/* The open (not yet flushed) bucket is mirrored in its own table as a full
+ * snapshot, so rewriting it is idempotent and a crash loses only the time
+ * since the last checkpoint. Replay folds a leftover snapshot into
+ * app_usage/domain_usage; a NULL domain marks an app row. */
+gboolean usage_stats_store_checkpoint_reset(UsageStatsStore *store);
+gboolean usage_stats_store_checkpoint_put(UsageStatsStore *store,
+                                          gint64 bucket_start_utc,
+                                          const char *scope,
+                                          const char *task_id,
+                                          const char *app_key,
+                                          const char *app_name,
+                                          const char *domain,
+                                          gint64 duration_sec);
+guint usage_stats_store_replay_checkpoint(UsageStatsStore *store);
+
+/* Totals per local weekday (0 = Monday) and hour since since_utc, read from
+ * the hour_usage aggregate that every add keeps current. */
+gboolean usage_stats_store_query_heatmap(UsageStatsStore *store,
+                                         const char *scope,
+                                         gint64 since_utc,
+                                         gint64 cells_out[USAGE_STATS_WEEKDAYS]
+                                                         [USAGE_STATS_HOURS]);
+/* The top limit apps of every cell in one pass: apps_out[weekday][hour] gets
+ * a GPtrArray of UsageStatsEntry, or NULL when nobody was focused then. */
+gboolean usage_stats_store_query_heatmap_apps(UsageStatsStore *store,
+                                              const char *scope,
+                                              gint64 since_utc,
+                                              guint limit,
+                                              GPtrArray *apps_out[USAGE_STATS_WEEKDAYS]
+                                                                 [USAGE_STATS_HOURS]);
+
+/* Session history is kept past the usage retention window; only clear
+ * removes it. The per-day query returns UsageStatsSessionTotals by phase
+ * for sessions that started in the range. */
+gboolean usage_stats_store_add_session(UsageStatsStore *store,
+                                       const UsageStatsSession *session);
+gboolean usage_stats_store_query_task_sessions(UsageStatsStore *store,
+                                               const char *task_id,
+                                               gint phase,
+                                               guint *sessions_out,
+                                               gint64 *duration_ms_out);
+GArray *usage_stats_store_query_day_sessions(UsageStatsStore *store,
+                                             gint64 day_start_utc,
+                                             gint64 day_end_utc);
+/* The task_focus index: focus time and completed sessions per task. */
+GPtrArray *usage_stats_store_load_task_focus(UsageStatsStore *store);
+
 gboolean usage_stats_store_clear(UsageStatsStore *store);
 gboolean usage_stats_store_prune(UsageStatsStore *store, gint64 cutoff_utc);
 
+gboolean usage_stats_store_put_verdict(UsageStatsStore *store,
+                                       const char *task_key,
+                                       const char *url,
+                                       guint64 fingerprint,
+                                       gint verdict,
+                                       gint64 checked_at_utc);
+GPtrArray *usage_stats_store_load_verdicts(UsageStatsStore *store,
+                                           gint64 since_utc);
+gboolean usage_stats_store_prune_verdicts(UsageStatsStore *store,
+                                          gint64 cutoff_utc);
+
+gboolean usage_stats_store_add_example(UsageStatsStore *store,
+                                       const char *task_title,
+                                       const char *domain,
+                                       const char *page_title,
+                                       gint verdict,
+                                       gint64 created_at_utc);
+GPtrArray *usage_stats_store_load_examples(UsageStatsStore *store, guint limit);
+gboolean usage_stats_store_prune_examples(UsageStatsStore *store, guint keep);
+
 void usage_stats_entry_free(gpointer data);
+void usage_stats_domain_entry_free(gpointer data);
+void usage_stats_task_focus_free(gpointer data);
+void usage_stats_verdict_free(gpointer data);
+void usage_stats_example_free(gpointer data);
@@ -160,6 +160,7 @@ focus_guard_update_active_label(gpointer user_data)
   }
 
   g_free(app_name);
+  focus_guard_update_latency_label(dialog);
 
   return G_SOURCE_CONTINUE;
 }
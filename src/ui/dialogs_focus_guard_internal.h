@@ -24,6 +24,7 @@ void focus_guard_apply_model_selection(TimerSettingsDialog *dialog,
 void focus_guard_apply_models_to_dropdown(TimerSettingsDialog *dialog,
                                           GPtrArray *models);
 void focus_guard_refresh_models(TimerSettingsDialog *dialog);
+void focus_guard_update_latency_label(TimerSettingsDialog *dialog);
 
 void on_focus_guard_interval_changed(GtkSpinButton *spin, gpointer user_data);
 void on_focus_guard_global_toggled(GtkCheckButton *button, gpointer user_data);
@@ -37,6 +38,7 @@ void on_focus_guard_model_changed(GObject *object,
                                   GParamSpec *pspec,
                                   gpointer user_data);
 void on_focus_guard_ollama_refresh_clicked(GtkButton *button, gpointer user_data);
+void on_focus_guard_latency_copy_clicked(GtkButton *button, gpointer user_data);
 void on_focus_guard_add_clicked(GtkButton *button, gpointer user_data);
 void on_focus_guard_entry_activate(GtkEntry *entry, gpointer user_data);
 void on_focus_guard_remove_clicked(GtkButton *button, gpointer user_data);
@@ -1,6 +1,6 @@
 #include "ui/dialogs_focus_guard_internal.h"
 
-#include "focus/ollama_client.h"
+#include "focus/ollama_catalog.h"
 
 typedef struct {
   GWeakRef window_ref;
@@ -153,24 +153,87 @@ focus_guard_ollama_refresh_context_free(gpointer data)
   g_free(context);
 }
 
+static OllamaCatalog *
+focus_guard_dialog_catalog(TimerSettingsDialog *dialog)
+{
+  if (dialog == NULL || dialog->state == NULL) {
+    return NULL;
+  }
+
+  return focus_guard_get_ollama_catalog(dialog->state->focus_guard);
+}
+
 static void
-focus_guard_ollama_refresh_task(GTask *task,
-                                gpointer source_object,
-                                gpointer task_data,
-                                GCancellable *cancellable)
+focus_guard_update_ollama_details(TimerSettingsDialog *dialog)
 {
-  (void)source_object;
-  (void)cancellable;
-  (void)task_data;
+  OllamaCatalog *catalog = focus_guard_dialog_catalog(dialog);
+  if (catalog == NULL) {
+    return;
+  }
 
-  GError *error = NULL;
-  GPtrArray *models = ollama_client_list_models_sync(&error);
-  if (models == NULL) {
-    g_task_return_error(task, error);
+  if (!ollama_catalog_is_server_up(catalog)) {
+    const char *reason = ollama_catalog_get_error(catalog);
+    char *text = g_strdup_printf("Ollama server not reachable at 127.0.0.1:11434%s%s",
+                                 reason != NULL ? ": " : ".",
+                                 reason != NULL ? reason : "");
+    focus_guard_set_ollama_status(dialog, text);
+    g_free(text);
+    return;
+  }
+
+  GtkStringList *list = focus_guard_get_model_list(dialog);
+  if (list == NULL || g_list_model_get_n_items(G_LIST_MODEL(list)) == 0) {
+    focus_guard_set_ollama_status(
+        dialog,
+        "No Ollama models found. Use `ollama pull` to download one.");
     return;
   }
 
-  g_task_return_pointer(task, models, (GDestroyNotify)g_ptr_array_unref);
+  char *selected = focus_guard_get_selected_model(dialog);
+  const OllamaModelInfo *info = ollama_catalog_find_model(catalog, selected);
+  g_free(selected);
+  if (info == NULL) {
+    focus_guard_set_ollama_status(dialog, NULL);
+    return;
+  }
+
+  GString *text = g_string_new(NULL);
+  if (info->size_bytes > 0) {
+    char *size = g_format_size((guint64)info->size_bytes);
+    g_string_append(text, size);
+    g_free(size);
+  }
+  if (info->parameter_size != NULL && *info->parameter_size != '\0') {
+    g_string_append_printf(text, "%s%s params", text->len > 0 ? " · " : "",
+                           info->parameter_size);
+  }
+  if (info->quantization != NULL && *info->quantization != '\0') {
+    g_string_append_printf(text, "%s%s", text->len > 0 ? " · " : "",
+                           info->quantization);
+  }
+  const char *version = ollama_catalog_get_version(catalog);
+  if (version != NULL) {
+    g_string_append_printf(text, "%sOllama %s", text->len > 0 ? " · " : "", version);
+  }
+  focus_guard_set_ollama_status(dialog, text->str);
+  g_string_free(text, TRUE);
+}
+
+static void
+focus_guard_apply_catalog(TimerSettingsDialog *dialog)
+{
+  OllamaCatalog *catalog = focus_guard_dialog_catalog(dialog);
+  GPtrArray *models = ollama_catalog_dup_model_names(catalog);
+  focus_guard_apply_models_to_dropdown(dialog, models);
+  if (models != NULL) {
+    g_ptr_array_unref(models);
+  }
+
+  gboolean prev_suppress = dialog->suppress_signals;
+  dialog->suppress_signals = TRUE;
+  focus_guard_settings_update_controls(dialog);
+  dialog->suppress_signals = prev_suppress;
+  focus_guard_update_ollama_details(dialog);
 }
 
 static void
@@ -197,50 +260,22 @@ focus_guard_ollama_refresh_complete(GObject *source_object,
     dialog = g_object_get_data(G_OBJECT(window), "timer-settings-dialog");
   }
 
-  focus_guard_settings_model_set_refresh_cancellable(model, NULL);
-  if (dialog != NULL && dialog->focus_guard_ollama_refresh_button != NULL) {
-    gtk_widget_set_sensitive(GTK_WIDGET(dialog->focus_guard_ollama_refresh_button),
-                             TRUE);
-  }
-
+  /* A cancelled refresh was superseded; the newer one owns the controls. */
   GError *error = NULL;
-  GPtrArray *models = g_task_propagate_pointer(G_TASK(res), &error);
-  if (models == NULL) {
-    if (dialog != NULL) {
-      focus_guard_set_ollama_status(dialog,
-                                    error != NULL && error->message != NULL
-                                        ? error->message
-                                        : "Unable to load Ollama models.");
-    }
-    g_clear_error(&error);
-    if (dialog != NULL) {
-      focus_guard_apply_models_to_dropdown(dialog, NULL);
-    } else {
-      focus_guard_settings_model_replace_ollama_models(model, NULL);
-    }
-  } else {
-    if (dialog != NULL) {
-      focus_guard_apply_models_to_dropdown(dialog, models);
-    } else {
-      focus_guard_settings_model_replace_ollama_models(model, models);
-    }
-    if (dialog != NULL) {
-      if (models->len == 0) {
-        focus_guard_set_ollama_status(
-            dialog,
-            "No Ollama models found. Use `ollama pull` to download one.");
-      } else {
-        focus_guard_set_ollama_status(dialog, NULL);
-      }
-    }
-    g_ptr_array_unref(models);
+  ollama_catalog_refresh_finish(focus_guard_dialog_catalog(dialog), res, &error);
+  gboolean cancelled = g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_clear_error(&error);
+
+  if (!cancelled) {
+    focus_guard_settings_model_set_refresh_cancellable(model, NULL);
   }
 
-  if (dialog != NULL) {
-    gboolean prev_suppress = dialog->suppress_signals;
-    dialog->suppress_signals = TRUE;
-    focus_guard_settings_update_controls(dialog);
-    dialog->suppress_signals = prev_suppress;
+  if (dialog != NULL && !cancelled) {
+    if (dialog->focus_guard_ollama_refresh_button != NULL) {
+      gtk_widget_set_sensitive(GTK_WIDGET(dialog->focus_guard_ollama_refresh_button),
+                               TRUE);
+    }
+    focus_guard_apply_catalog(dialog);
     focus_guard_apply_settings(dialog);
   }
 
@@ -251,8 +286,8 @@ focus_guard_ollama_refresh_complete(GObject *source_object,
   focus_guard_ollama_refresh_context_free(context);
 }
 
-void
-focus_guard_refresh_models(TimerSettingsDialog *dialog)
+static void
+focus_guard_load_models(TimerSettingsDialog *dialog, gboolean force)
 {
   if (dialog == NULL || dialog->focus_guard_ollama_dropdown == NULL ||
       dialog->focus_guard_model == NULL) {
@@ -261,11 +296,19 @@ focus_guard_refresh_models(TimerSettingsDialog *dialog)
 
   focus_guard_settings_model_cancel_refresh(dialog->focus_guard_model);
 
+  /* Whatever the catalog already knows is shown right away; the refresh
+   * only updates the dropdown if the server has something newer. */
+  OllamaCatalog *catalog = focus_guard_dialog_catalog(dialog);
+  if (ollama_catalog_has_models(catalog)) {
+    focus_guard_apply_catalog(dialog);
+  } else {
+    focus_guard_set_ollama_status(dialog, "Refreshing Ollama models...");
+  }
+
   if (dialog->focus_guard_ollama_refresh_button != NULL) {
     gtk_widget_set_sensitive(GTK_WIDGET(dialog->focus_guard_ollama_refresh_button),
                              FALSE);
   }
-  focus_guard_set_ollama_status(dialog, "Refreshing Ollama models...");
 
   GCancellable *cancellable = g_cancellable_new();
   focus_guard_settings_model_set_refresh_cancellable(dialog->focus_guard_model,
@@ -276,15 +319,20 @@ focus_guard_refresh_models(TimerSettingsDialog *dialog)
   g_weak_ref_init(&context->window_ref, G_OBJECT(dialog->window));
   g_weak_ref_init(&context->model_ref, G_OBJECT(dialog->focus_guard_model));
 
-  GTask *task = g_task_new(NULL,
-                           cancellable,
-                           focus_guard_ollama_refresh_complete,
-                           context);
-  g_task_run_in_thread(task, focus_guard_ollama_refresh_task);
-  g_object_unref(task);
+  ollama_catalog_refresh_async(catalog,
+                               force,
+                               cancellable,
+                               focus_guard_ollama_refresh_complete,
+                               context);
   g_object_unref(cancellable);
 }
 
+void
+focus_guard_refresh_models(TimerSettingsDialog *dialog)
+{
+  focus_guard_load_models(dialog, FALSE);
+}
+
 void
 on_focus_guard_model_changed(GObject *object,
                              GParamSpec *pspec,
@@ -310,6 +358,7 @@ on_focus_guard_model_changed(GObject *object,
   }
 
   focus_guard_update_ollama_toggle(dialog);
+  focus_guard_update_ollama_details(dialog);
   focus_guard_apply_settings(dialog);
 }
 
@@ -317,5 +366,36 @@ void
 on_focus_guard_ollama_refresh_clicked(GtkButton *button, gpointer user_data)
 {
   (void)button;
-  focus_guard_refresh_models((TimerSettingsDialog *)user_data);
+  focus_guard_load_models((TimerSettingsDialog *)user_data, TRUE);
+}
+
+void
+focus_guard_update_latency_label(TimerSettingsDialog *dialog)
+{
+  if (dialog == NULL || dialog->focus_guard_latency_label == NULL ||
+      dialog->state == NULL) {
+    return;
+  }
+
+  char *report = focus_guard_dup_latency_report(dialog->state->focus_guard);
+  /* Skip identical text so a selection in the label survives the refresh. */
+  if (g_strcmp0(gtk_label_get_text(GTK_LABEL(dialog->focus_guard_latency_label)),
+                report) != 0) {
+    gtk_label_set_text(GTK_LABEL(dialog->focus_guard_latency_label), report);
+  }
+  g_free(report);
+}
+
+void
+on_focus_guard_latency_copy_clicked(GtkButton *button, gpointer user_data)
+{
+  TimerSettingsDialog *dialog = user_data;
+  if (dialog == NULL || dialog->state == NULL) {
+    return;
+  }
+
+  char *report = focus_guard_dup_latency_report(dialog->state->focus_guard);
+  gdk_clipboard_set_text(gtk_widget_get_clipboard(GTK_WIDGET(button)), report);
+  g_message("Focus guard pipeline latency:\n%s", report);
+  g_free(report);
 }
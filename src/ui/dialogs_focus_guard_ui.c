@@ -146,11 +146,10 @@ focus_guard_settings_append(TimerSettingsDialog *dialog,
   gtk_box_append(GTK_BOX(focus_root), guard_card);
   gtk_box_append(GTK_BOX(focus_root), blacklist_card);
 
-  gboolean ollama_available = FALSE;
+  /* Shown even while the Ollama server is down; the status line says so. */
+  gboolean chrome_supported = FALSE;
 #if HAVE_CHROME_OLLAMA
-  ollama_available = dialog->state != NULL &&
-                     dialog->state->focus_guard != NULL &&
-                     focus_guard_is_ollama_available(dialog->state->focus_guard);
+  chrome_supported = dialog->state != NULL && dialog->state->focus_guard != NULL;
 #endif
 
   GtkCheckButton *chrome_check = NULL;
@@ -160,10 +159,12 @@ focus_guard_settings_append(TimerSettingsDialog *dialog,
   GtkWidget *ollama_status_label = NULL;
   GtkWidget *trafilatura_status_label = NULL;
   GtkEntry *trafilatura_python_entry = NULL;
+  GtkWidget *latency_label_widget = NULL;
+  GtkWidget *latency_copy_button = NULL;
 
   dialog->focus_guard_ollama_section = NULL;
 
-  if (ollama_available && chrome_root != NULL) {
+  if (chrome_supported && chrome_root != NULL) {
     GtkWidget *chrome_card = gtk_box_new(GTK_ORIENTATION_VERTICAL, 12);
     gtk_widget_add_css_class(chrome_card, "card");
 
@@ -257,12 +258,35 @@ focus_guard_settings_append(TimerSettingsDialog *dialog,
     gtk_label_set_wrap(GTK_LABEL(status_label), TRUE);
     gtk_widget_set_visible(status_label, FALSE);
 
+    GtkWidget *latency_row = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 8);
+    gtk_widget_set_hexpand(latency_row, TRUE);
+    GtkWidget *latency_title = gtk_label_new("Pipeline latency");
+    gtk_widget_add_css_class(latency_title, "setting-label");
+    gtk_widget_set_halign(latency_title, GTK_ALIGN_START);
+    gtk_widget_set_hexpand(latency_title, TRUE);
+    GtkWidget *latency_copy = gtk_button_new_with_label("Copy report");
+    gtk_widget_add_css_class(latency_copy, "btn-secondary");
+    gtk_widget_add_css_class(latency_copy, "btn-compact");
+    gtk_widget_set_halign(latency_copy, GTK_ALIGN_END);
+    gtk_widget_set_tooltip_text(latency_copy,
+                                "Copy per-stage timings to the clipboard and the log");
+    gtk_box_append(GTK_BOX(latency_row), latency_title);
+    gtk_box_append(GTK_BOX(latency_row), latency_copy);
+
+    GtkWidget *latency_label = gtk_label_new("");
+    gtk_widget_add_css_class(latency_label, "task-meta");
+    gtk_widget_add_css_class(latency_label, "monospace");
+    gtk_widget_set_halign(latency_label, GTK_ALIGN_START);
+    gtk_label_set_selectable(GTK_LABEL(latency_label), TRUE);
+
     gtk_box_append(GTK_BOX(chrome_card), chrome_title);
     gtk_box_append(GTK_BOX(chrome_card), chrome_desc);
     gtk_box_append(GTK_BOX(chrome_card), chrome_grid);
     gtk_box_append(GTK_BOX(chrome_card), chrome_hint);
     gtk_box_append(GTK_BOX(chrome_card), trafilatura_label);
     gtk_box_append(GTK_BOX(chrome_card), status_label);
+    gtk_box_append(GTK_BOX(chrome_card), latency_row);
+    gtk_box_append(GTK_BOX(chrome_card), latency_label);
     gtk_box_append(GTK_BOX(chrome_root), chrome_card);
 
     chrome_check = GTK_CHECK_BUTTON(chrome_enable_check);
@@ -272,6 +296,8 @@ focus_guard_settings_append(TimerSettingsDialog *dialog,
     ollama_status_label = status_label;
     trafilatura_status_label = trafilatura_label;
     trafilatura_python_entry = GTK_ENTRY(python_entry);
+    latency_label_widget = latency_label;
+    latency_copy_button = latency_copy;
     dialog->focus_guard_ollama_section = chrome_root;
   }
 
@@ -289,6 +315,7 @@ focus_guard_settings_append(TimerSettingsDialog *dialog,
   dialog->focus_guard_ollama_status_label = ollama_status_label;
   dialog->focus_guard_trafilatura_status_label = trafilatura_status_label;
   dialog->focus_guard_trafilatura_python_entry = trafilatura_python_entry;
+  dialog->focus_guard_latency_label = latency_label_widget;
 
   g_signal_connect(guard_interval_spin,
                    "value-changed",
@@ -315,7 +342,7 @@ focus_guard_settings_append(TimerSettingsDialog *dialog,
                    G_CALLBACK(on_focus_guard_use_active_clicked),
                    dialog);
 
-  if (ollama_available && dialog->focus_guard_ollama_section != NULL) {
+  if (chrome_supported && dialog->focus_guard_ollama_section != NULL) {
     g_signal_connect(ollama_dropdown,
                      "notify::selected",
                      G_CALLBACK(on_focus_guard_model_changed),
@@ -336,9 +363,14 @@ focus_guard_settings_append(TimerSettingsDialog *dialog,
                      "changed",
                      G_CALLBACK(on_focus_guard_trafilatura_python_changed),
                      dialog);
+    g_signal_connect(latency_copy_button,
+                     "clicked",
+                     G_CALLBACK(on_focus_guard_latency_copy_clicked),
+                     dialog);
   }
 
-  if (ollama_available && dialog->focus_guard_ollama_section != NULL) {
+  if (chrome_supported && dialog->focus_guard_ollama_section != NULL) {
     focus_guard_refresh_models(dialog);
+    focus_guard_update_latency_label(dialog);
   }
 }
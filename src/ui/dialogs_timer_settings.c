@@ -41,6 +41,7 @@ timer_settings_dialog_teardown(TimerSettingsDialog *dialog)
   dialog->autostart_check = NULL;
   dialog->autostart_start_in_tray_check = NULL;
   dialog->minimize_to_tray_check = NULL;
+  dialog->stats_transfer_label = NULL;
 
   dialog->window = NULL;
   dialog->state = NULL;
@@ -316,6 +317,7 @@ apply_delete_stats(AppState *state, gpointer user_data)
   }
 
   focus_guard_clear_stats(state->focus_guard);
+  task_list_refresh(state);
 }
 
 void
@@ -390,6 +392,106 @@ on_app_delete_stats_clicked(GtkButton *button, gpointer user_data)
       NULL);
 }
 
+static void
+stats_label_ref_free(gpointer data)
+{
+  GWeakRef *label_ref = data;
+  g_weak_ref_clear(label_ref);
+  g_free(label_ref);
+}
+
+/* The settings window may be gone by the time the chooser answers, so only
+ * the app state and a weak reference to the status label are kept. */
+static void
+on_stats_file_chosen(GtkNativeDialog *native, int response, gpointer user_data)
+{
+  AppState *state = user_data;
+  gboolean import = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(native), "stats-import"));
+  GtkLabel *label = g_weak_ref_get(g_object_get_data(G_OBJECT(native), "stats-label"));
+
+  G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+  GFile *file = response == GTK_RESPONSE_ACCEPT
+                    ? gtk_file_chooser_get_file(GTK_FILE_CHOOSER(native))
+                    : NULL;
+  G_GNUC_END_IGNORE_DEPRECATIONS
+
+  if (file != NULL && state != NULL && state->focus_guard != NULL) {
+    gboolean started = import ? focus_guard_import_stats(state->focus_guard, file, label)
+                              : focus_guard_export_stats(state->focus_guard, file, label);
+    if (!started && label != NULL) {
+      gtk_label_set_text(label, "Another stats export or import is still running.");
+      gtk_widget_set_visible(GTK_WIDGET(label), TRUE);
+    }
+  }
+
+  g_clear_object(&label);
+  g_clear_object(&file);
+  g_object_unref(native);
+}
+
+static void
+show_stats_file_chooser(TimerSettingsDialog *dialog, gboolean import)
+{
+  G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+  GtkFileChooserNative *native =
+      gtk_file_chooser_native_new(import ? "Import usage stats" : "Export usage stats",
+                                  dialog->window,
+                                  import ? GTK_FILE_CHOOSER_ACTION_OPEN
+                                         : GTK_FILE_CHOOSER_ACTION_SAVE,
+                                  import ? "_Import" : "_Export",
+                                  "_Cancel");
+  GtkFileChooser *chooser = GTK_FILE_CHOOSER(native);
+
+  GtkFileFilter *filter = gtk_file_filter_new();
+  gtk_file_filter_set_name(filter, "CSV or NDJSON");
+  gtk_file_filter_add_pattern(filter, "*.csv");
+  gtk_file_filter_add_pattern(filter, "*.ndjson");
+  gtk_file_filter_add_pattern(filter, "*.jsonl");
+  gtk_file_chooser_add_filter(chooser, filter);
+  g_object_unref(filter);
+
+  if (!import) {
+    GDateTime *now = g_date_time_new_now_local();
+    char *name = g_date_time_format(now, "usage-stats-%Y-%m-%d.csv");
+    gtk_file_chooser_set_current_name(chooser, name);
+    g_free(name);
+    g_date_time_unref(now);
+  }
+  G_GNUC_END_IGNORE_DEPRECATIONS
+
+  GWeakRef *label_ref = g_new0(GWeakRef, 1);
+  g_weak_ref_init(label_ref, G_OBJECT(dialog->stats_transfer_label));
+  g_object_set_data_full(G_OBJECT(native), "stats-label", label_ref, stats_label_ref_free);
+  g_object_set_data(G_OBJECT(native), "stats-import", GINT_TO_POINTER(import));
+  gtk_native_dialog_set_modal(GTK_NATIVE_DIALOG(native), TRUE);
+  g_signal_connect(native, "response", G_CALLBACK(on_stats_file_chosen), dialog->state);
+  gtk_native_dialog_show(GTK_NATIVE_DIALOG(native));
+}
+
+void
+on_app_export_stats_clicked(GtkButton *button, gpointer user_data)
+{
+  (void)button;
+  TimerSettingsDialog *dialog = user_data;
+  if (dialog == NULL || dialog->state == NULL) {
+    return;
+  }
+
+  show_stats_file_chooser(dialog, FALSE);
+}
+
+void
+on_app_import_stats_clicked(GtkButton *button, gpointer user_data)
+{
+  (void)button;
+  TimerSettingsDialog *dialog = user_data;
+  if (dialog == NULL || dialog->state == NULL) {
+    return;
+  }
+
+  show_stats_file_chooser(dialog, TRUE);
+}
+
 void
 timer_settings_update_controls(TimerSettingsDialog *dialog)
 {
@@ -15,6 +15,7 @@ typedef struct {
   GtkCheckButton *autostart_check;
   GtkCheckButton *autostart_start_in_tray_check;
   GtkCheckButton *minimize_to_tray_check;
+  GtkWidget *stats_transfer_label;
   GtkCheckButton *focus_guard_global_check;
   GtkCheckButton *focus_guard_warnings_check;
   GtkSpinButton *focus_guard_interval_spin;
@@ -25,6 +26,7 @@ typedef struct {
   GtkWidget *focus_guard_ollama_status_label;
   GtkWidget *focus_guard_trafilatura_status_label;
   GtkEntry *focus_guard_trafilatura_python_entry;
+  GtkWidget *focus_guard_latency_label;
   GtkWidget *focus_guard_ollama_section;
   GtkWidget *focus_guard_list;
   GtkWidget *focus_guard_empty_label;
@@ -52,4 +54,6 @@ void on_app_reset_settings_clicked(GtkButton *button, gpointer user_data);
 void on_app_archive_all_clicked(GtkButton *button, gpointer user_data);
 void on_app_delete_archived_clicked(GtkButton *button, gpointer user_data);
 void on_app_delete_stats_clicked(GtkButton *button, gpointer user_data);
+void on_app_export_stats_clicked(GtkButton *button, gpointer user_data);
+void on_app_import_stats_clicked(GtkButton *button, gpointer user_data);
 void timer_settings_update_controls(TimerSettingsDialog *dialog);
@@ -245,6 +245,34 @@ timer_settings_build_app_page(TimerSettingsDialog *dialog)
   gtk_widget_add_css_class(delete_stats_button, "btn-compact");
   gtk_widget_set_halign(delete_stats_button, GTK_ALIGN_END);
 
+  GtkWidget *export_stats_label = gtk_label_new("Export usage stats (CSV or NDJSON)");
+  gtk_widget_add_css_class(export_stats_label, "setting-label");
+  gtk_widget_set_halign(export_stats_label, GTK_ALIGN_START);
+  gtk_widget_set_hexpand(export_stats_label, TRUE);
+  GtkWidget *export_stats_button = gtk_button_new_with_label("Export...");
+  gtk_widget_add_css_class(export_stats_button, "btn-secondary");
+  gtk_widget_add_css_class(export_stats_button, "btn-compact");
+  gtk_widget_set_halign(export_stats_button, GTK_ALIGN_END);
+
+  GtkWidget *import_stats_label = gtk_label_new("Import usage stats");
+  gtk_widget_add_css_class(import_stats_label, "setting-label");
+  gtk_widget_set_halign(import_stats_label, GTK_ALIGN_START);
+  gtk_widget_set_hexpand(import_stats_label, TRUE);
+  GtkWidget *import_stats_button = gtk_button_new_with_label("Import...");
+  gtk_widget_add_css_class(import_stats_button, "btn-secondary");
+  gtk_widget_add_css_class(import_stats_button, "btn-compact");
+  gtk_widget_set_halign(import_stats_button, GTK_ALIGN_END);
+  gtk_widget_set_tooltip_text(import_stats_button,
+                              "Time slots in the file replace the stored ones, "
+                              "so importing the same file twice changes nothing. "
+                              "Task focus totals are not updated");
+
+  GtkWidget *stats_transfer_label = gtk_label_new(NULL);
+  gtk_widget_add_css_class(stats_transfer_label, "task-meta");
+  gtk_widget_set_halign(stats_transfer_label, GTK_ALIGN_START);
+  gtk_label_set_wrap(GTK_LABEL(stats_transfer_label), TRUE);
+  gtk_widget_set_visible(stats_transfer_label, FALSE);
+
   gtk_grid_attach(GTK_GRID(data_grid), reset_label, 0, 0, 1, 1);
   gtk_grid_attach(GTK_GRID(data_grid), reset_button, 1, 0, 1, 1);
   gtk_grid_attach(GTK_GRID(data_grid), archive_all_label, 0, 1, 1, 1);
@@ -253,6 +281,11 @@ timer_settings_build_app_page(TimerSettingsDialog *dialog)
   gtk_grid_attach(GTK_GRID(data_grid), delete_archived_button, 1, 2, 1, 1);
   gtk_grid_attach(GTK_GRID(data_grid), delete_stats_label, 0, 3, 1, 1);
   gtk_grid_attach(GTK_GRID(data_grid), delete_stats_button, 1, 3, 1, 1);
+  gtk_grid_attach(GTK_GRID(data_grid), export_stats_label, 0, 4, 1, 1);
+  gtk_grid_attach(GTK_GRID(data_grid), export_stats_button, 1, 4, 1, 1);
+  gtk_grid_attach(GTK_GRID(data_grid), import_stats_label, 0, 5, 1, 1);
+  gtk_grid_attach(GTK_GRID(data_grid), import_stats_button, 1, 5, 1, 1);
+  gtk_grid_attach(GTK_GRID(data_grid), stats_transfer_label, 0, 6, 2, 1);
 
   gtk_box_append(GTK_BOX(data_card), data_title);
   gtk_box_append(GTK_BOX(data_card), data_desc);
@@ -273,6 +306,7 @@ timer_settings_build_app_page(TimerSettingsDialog *dialog)
   dialog->autostart_start_in_tray_check =
       GTK_CHECK_BUTTON(autostart_tray_check);
   dialog->minimize_to_tray_check = GTK_CHECK_BUTTON(minimize_check);
+  dialog->stats_transfer_label = stats_transfer_label;
 
   g_signal_connect(tray_check,
                    "toggled",
@@ -306,6 +340,14 @@ timer_settings_build_app_page(TimerSettingsDialog *dialog)
                    "clicked",
                    G_CALLBACK(on_app_delete_stats_clicked),
                    dialog);
+  g_signal_connect(export_stats_button,
+                   "clicked",
+                   G_CALLBACK(on_app_export_stats_clicked),
+                   dialog);
+  g_signal_connect(import_stats_button,
+                   "clicked",
+                   G_CALLBACK(on_app_import_stats_clicked),
+                   dialog);
 
   return app_scroller;
 }
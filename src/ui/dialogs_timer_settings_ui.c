@@ -83,14 +83,13 @@ timer_settings_show_window(AppState *state)
   gtk_widget_set_vexpand(focus_scroller, TRUE);
   gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(focus_scroller), focus_page);
 
-  gboolean ollama_available = FALSE;
+  gboolean chrome_supported = FALSE;
 #if HAVE_CHROME_OLLAMA
-  ollama_available = state->focus_guard != NULL &&
-                     focus_guard_is_ollama_available(state->focus_guard);
+  chrome_supported = state->focus_guard != NULL;
 #endif
   GtkWidget *chrome_page = NULL;
   GtkWidget *chrome_scroller = NULL;
-  if (ollama_available) {
+  if (chrome_supported) {
     chrome_page = gtk_box_new(GTK_ORIENTATION_VERTICAL, 16);
     gtk_widget_add_css_class(chrome_page, "settings-page");
     gtk_widget_set_margin_top(chrome_page, 4);
@@ -6,6 +6,7 @@
 #include "core/task_store.h"
 #include "focus/focus_guard.h"
 #include "overlay/overlay_window.h"
+#include "storage/session_writer.h"
 #include "storage/settings_storage.h"
 #include "storage/task_storage.h"
 #include "tray/tray_item.h"
@@ -110,6 +111,14 @@ on_main_window_destroy(GtkWidget *widget, gpointer user_data)
   }
 }
 
+static void
+on_main_window_app_shutdown(GApplication *app, gpointer user_data)
+{
+  (void)app;
+  GtkWindow *window = user_data;
+  app_state_shutdown(g_object_get_data(G_OBJECT(window), "app-state"));
+}
+
 void
 main_window_present(GtkApplication *app, gboolean autostart_launch)
 {
@@ -179,6 +188,15 @@ main_window_present(GtkApplication *app, gboolean autostart_launch)
                                      on_timer_tick,
                                      on_timer_phase_changed,
                                      state);
+  state->session_writer = session_writer_new();
+  pomodoro_timer_set_phase_end_callback(timer, on_timer_phase_ended, state);
+  if (app != NULL) {
+    g_signal_connect_object(app,
+                            "shutdown",
+                            G_CALLBACK(on_main_window_app_shutdown),
+                            window,
+                            0);
+  }
 
   overlay_window_create(app, state);
   FocusGuardConfig guard_config = focus_guard_config_default();
@@ -14,3 +14,6 @@ void on_overlay_toggle_clicked(GtkButton *button, gpointer user_data);
 
 void on_timer_tick(PomodoroTimer *timer, gpointer user_data);
 void on_timer_phase_changed(PomodoroTimer *timer, gpointer user_data);
+void on_timer_phase_ended(PomodoroTimer *timer,
+                          const PomodoroPhaseRecord *record,
+                          gpointer user_data);
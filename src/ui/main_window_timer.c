@@ -3,9 +3,15 @@
 
 #include "core/task_store.h"
 #include "overlay/overlay_window.h"
+#include "storage/session_writer.h"
 #include "tray/tray_item.h"
 #include "ui/task_list.h"
 
+/* The store keeps the timer's phase and outcome numbers as they are, and its
+ * task_focus backfill bakes these two into SQL. */
+G_STATIC_ASSERT(USAGE_STATS_SESSION_FOCUS == POMODORO_PHASE_FOCUS);
+G_STATIC_ASSERT(USAGE_STATS_SESSION_COMPLETED == POMODORO_PHASE_COMPLETED);
+
 static const char *
 timer_phase_title(PomodoroPhase phase)
 {
@@ -189,3 +195,35 @@ on_timer_phase_changed(PomodoroTimer *timer, gpointer user_data)
 
   main_window_update_timer_ui(state);
 }
+
+void
+on_timer_phase_ended(PomodoroTimer *timer,
+                     const PomodoroPhaseRecord *record,
+                     gpointer user_data)
+{
+  (void)timer;
+  AppState *state = user_data;
+  if (state == NULL || record == NULL) {
+    return;
+  }
+
+  PomodoroTask *task = task_store_get_active(state->store);
+  UsageStatsSession session = {
+      .started_at_utc = record->started_at_utc,
+      .ended_at_utc = record->ended_at_utc,
+      .phase = record->phase,
+      .outcome = record->outcome,
+      .task_id = task != NULL ? (char *)pomodoro_task_get_id(task) : NULL,
+      .duration_ms = record->active_ms,
+      .interruptions = record->interruptions,
+  };
+  session_writer_push(state->session_writer, &session);
+
+  /* The writer bumps the task_focus index; mirror it in the cached totals. */
+  if (task != NULL && record->phase == POMODORO_PHASE_FOCUS) {
+    pomodoro_task_add_focus(task,
+                            record->active_ms,
+                            record->outcome == POMODORO_PHASE_COMPLETED);
+    task_list_update_task_meta(state, task);
+  }
+}
@@ -21,6 +21,15 @@ set_icon_button_label(GtkWidget *button, const char *label)
                                  -1);
 }
 
+static void
+on_task_list_destroy(GtkWidget *widget, gpointer user_data)
+{
+  AppState *state = user_data;
+  if (state != NULL && state->task_list == widget) {
+    state->task_list = NULL;
+  }
+}
+
 static GtkWidget *
 create_action_icon(const char *icon_name, int size)
 {
@@ -29,6 +38,21 @@ create_action_icon(const char *icon_name, int size)
   return icon;
 }
 
+static void
+on_focus_stats_row_activated(GtkListBox *list, GtkListBoxRow *row, gpointer user_data)
+{
+  (void)list;
+  AppState *state = user_data;
+  if (state == NULL || state->focus_guard == NULL) {
+    return;
+  }
+
+  const char *app_key = g_object_get_data(G_OBJECT(row), "app-key");
+  if (app_key != NULL) {
+    focus_guard_toggle_app_details(state->focus_guard, app_key);
+  }
+}
+
 void
 main_window_build_ui(AppState *state, gboolean autostart_launch)
 {
@@ -337,6 +361,7 @@ main_window_build_ui(AppState *state, gboolean autostart_launch)
   gtk_widget_add_css_class(task_list, "task-list");
   gtk_list_box_set_selection_mode(GTK_LIST_BOX(task_list), GTK_SELECTION_NONE);
   state->task_list = task_list;
+  g_signal_connect(task_list, "destroy", G_CALLBACK(on_task_list_destroy), state);
 
   GtkWidget *task_scroller = gtk_scrolled_window_new();
   gtk_widget_add_css_class(task_scroller, "task-scroller");
@@ -393,6 +418,10 @@ main_window_build_ui(AppState *state, gboolean autostart_launch)
   gtk_widget_add_css_class(focus_list, "focus-guard-list");
   gtk_list_box_set_selection_mode(GTK_LIST_BOX(focus_list),
                                   GTK_SELECTION_NONE);
+  g_signal_connect(focus_list,
+                   "row-activated",
+                   G_CALLBACK(on_focus_stats_row_activated),
+                   state);
   state->focus_stats_list = focus_list;
 
   GtkWidget *focus_scroller = gtk_scrolled_window_new();
@@ -411,10 +440,30 @@ main_window_build_ui(AppState *state, gboolean autostart_launch)
   gtk_label_set_wrap(GTK_LABEL(focus_empty_label), TRUE);
   state->focus_stats_empty_label = focus_empty_label;
 
+  GtkWidget *focus_heatmap_title = gtk_label_new("Focus time by hour (last 5 weeks)");
+  gtk_widget_add_css_class(focus_heatmap_title, "focus-guard-context");
+  gtk_widget_set_halign(focus_heatmap_title, GTK_ALIGN_START);
+
+  GtkWidget *focus_heatmap = gtk_drawing_area_new();
+  gtk_widget_add_css_class(focus_heatmap, "focus-guard-heatmap");
+  gtk_widget_set_size_request(focus_heatmap, -1, 112);
+  gtk_drawing_area_set_draw_func(GTK_DRAWING_AREA(focus_heatmap),
+                                 focus_guard_heatmap_draw,
+                                 state,
+                                 NULL);
+  gtk_widget_set_has_tooltip(focus_heatmap, TRUE);
+  g_signal_connect(focus_heatmap,
+                   "query-tooltip",
+                   G_CALLBACK(focus_guard_heatmap_query_tooltip),
+                   state);
+  state->focus_heatmap = focus_heatmap;
+
   gtk_box_append(GTK_BOX(focus_card), focus_title);
   gtk_box_append(GTK_BOX(focus_card), focus_meta_row);
   gtk_box_append(GTK_BOX(focus_card), focus_scroller);
   gtk_box_append(GTK_BOX(focus_card), focus_empty_label);
+  gtk_box_append(GTK_BOX(focus_card), focus_heatmap_title);
+  gtk_box_append(GTK_BOX(focus_card), focus_heatmap);
 
   gtk_box_append(GTK_BOX(task_section), tasks_card);
   gtk_box_append(GTK_BOX(task_section), focus_card);
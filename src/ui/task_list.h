@@ -6,6 +6,8 @@
 
 void task_list_refresh(AppState *state);
 void task_list_save_store(AppState *state);
+/* Re-renders one row's meta line after its focus totals change. */
+void task_list_update_task_meta(AppState *state, PomodoroTask *task);
 void task_list_update_repeat_hint(GtkSpinButton *spin, GtkWidget *label);
 void task_list_on_repeat_spin_changed(GtkSpinButton *spin, gpointer user_data);
 void task_list_on_add_clicked(GtkButton *button, gpointer user_data);
@@ -55,3 +55,24 @@ task_list_format_cycle_summary(guint cycles)
   g_free(duration);
   return text;
 }
+
+char *
+task_list_format_task_summary(const PomodoroTask *task)
+{
+  char *summary = task_list_format_cycle_summary(pomodoro_task_get_repeat_count(task));
+  guint focus_minutes = (guint)MIN(pomodoro_task_get_focus_seconds(task) / 60, (gint64)G_MAXUINT);
+  if (focus_minutes == 0) {
+    return summary;
+  }
+
+  guint sessions = pomodoro_task_get_focus_sessions(task);
+  char *focused = task_list_format_minutes(focus_minutes);
+  char *text = g_strdup_printf("%s - focused %s in %u session%s",
+                               summary,
+                               focused,
+                               sessions,
+                               sessions == 1 ? "" : "s");
+  g_free(focused);
+  g_free(summary);
+  return text;
+}
@@ -20,6 +20,8 @@ struct _TaskRowControls {
 guint task_list_calculate_cycle_minutes(guint cycles);
 char *task_list_format_minutes(guint minutes);
 char *task_list_format_cycle_summary(guint cycles);
+/* Cycle summary plus the task's cached focus totals, when it has any. */
+char *task_list_format_task_summary(const PomodoroTask *task);
 
 void task_list_update_current_summary(AppState *state);
 void task_list_append_row(AppState *state, GtkWidget *list, PomodoroTask *task);
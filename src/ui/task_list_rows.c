@@ -50,7 +50,7 @@ update_task_cycle_ui(TaskRowControls *controls)
   }
 
   if (controls->repeat_label != NULL) {
-    char *summary = task_list_format_cycle_summary(cycles);
+    char *summary = task_list_format_task_summary(controls->task);
     gtk_label_set_text(GTK_LABEL(controls->repeat_label), summary);
     g_free(summary);
   }
@@ -126,6 +126,28 @@ on_task_row_pressed(GtkGestureClick *gesture,
   focus_guard_select_task(controls->state->focus_guard, controls->task);
 }
 
+void
+task_list_update_task_meta(AppState *state, PomodoroTask *task)
+{
+  /* task_list is cleared when the list is destroyed, so a phase ending
+   * during teardown leaves the UI alone. */
+  if (state == NULL || state->task_list == NULL || task == NULL) {
+    return;
+  }
+
+  for (GtkWidget *row = gtk_widget_get_first_child(state->task_list);
+       row != NULL;
+       row = gtk_widget_get_next_sibling(row)) {
+    GtkWidget *child = gtk_list_box_row_get_child(GTK_LIST_BOX_ROW(row));
+    TaskRowControls *controls =
+        child != NULL ? g_object_get_data(G_OBJECT(child), "task-row-controls") : NULL;
+    if (controls != NULL && controls->task == task) {
+      update_task_cycle_ui(controls);
+      return;
+    }
+  }
+}
+
 void
 task_list_append_row(AppState *state, GtkWidget *list, PomodoroTask *task)
 {
@@ -154,7 +176,7 @@ task_list_append_row(AppState *state, GtkWidget *list, PomodoroTask *task)
   gtk_widget_set_hexpand(title_entry, TRUE);
   gtk_widget_set_visible(title_entry, FALSE);
 
-  char *repeat_text = task_list_format_cycle_summary(pomodoro_task_get_repeat_count(task));
+  char *repeat_text = task_list_format_task_summary(task);
   GtkWidget *repeat_label = gtk_label_new(repeat_text);
   gtk_widget_add_css_class(repeat_label, "task-meta");
   gtk_widget_set_halign(repeat_label, GTK_ALIGN_START);
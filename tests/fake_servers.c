@@ -0,0 +1,1185 @@
+#include "fake_servers.h"
+
+#include <json-glib/json-glib.h>
+#include <libsoup/soup.h>
+#include <math.h>
+#include <string.h>
+
+#define FAKE_CDP_PAGE_PREFIX "/devtools/page/"
+#define FAKE_CDP_BROWSER_PATH "/devtools/browser"
+#define FAKE_OLLAMA_EMBED_DIMENSIONS 64
+#define FAKE_OLLAMA_TOKEN_CHARS 4
+
+typedef void (*FakeServerHook)(SoupServer *server, gpointer user_data);
+
+typedef struct {
+  GThread *thread;
+  GMainContext *context;
+  GMainLoop *loop;
+  SoupServer *server;
+  guint port;
+  GMutex mutex;
+  GCond cond;
+  gboolean ready;
+  FakeServerHook setup;
+  FakeServerHook teardown;
+  gpointer hook_data;
+} FakeServerThread;
+
+typedef struct {
+  char *id;
+  char *title;
+  char *url;
+  char *text;
+} FakeCdpPage;
+
+struct _FakeCdpServer {
+  FakeServerThread base;
+  GMutex lock;
+  GPtrArray *pages;
+  guint evaluate_ms;
+  guint evaluate_count;
+  /* Server thread only. */
+  GPtrArray *connections;
+};
+
+typedef struct {
+  SoupWebsocketConnection *connection;
+  char *payload;
+} FakeCdpReply;
+
+typedef struct {
+  char *needle;
+  char *label;
+} FakeOllamaRule;
+
+struct _FakeOllamaServer {
+  FakeServerThread base;
+  char *base_url;
+  GMutex lock;
+  GPtrArray *models;
+  GPtrArray *rules;
+  char *default_label;
+  guint first_token_ms;
+  guint per_token_ms;
+  guint chat_count;
+  GHashTable *loaded;
+};
+
+typedef struct {
+  SoupServerMessage *msg;
+  char *model;
+  char *content;
+  gsize offset;
+  gboolean stream;
+  guint per_token_ms;
+  gulong finished_id;
+  gboolean finished;
+} FakeOllamaReply;
+
+static gpointer
+fake_server_thread_main(gpointer data)
+{
+  FakeServerThread *base = data;
+  g_main_context_push_thread_default(base->context);
+
+  base->server = soup_server_new("server-header", "fake-server", NULL);
+  base->setup(base->server, base->hook_data);
+
+  GError *error = NULL;
+  if (soup_server_listen_local(base->server, 0, SOUP_SERVER_LISTEN_IPV4_ONLY, &error)) {
+    GSList *uris = soup_server_get_uris(base->server);
+    if (uris != NULL) {
+      base->port = (guint)g_uri_get_port(uris->data);
+    }
+    g_slist_free_full(uris, (GDestroyNotify)g_uri_unref);
+  } else {
+    g_warning("Fake server failed to listen: %s", error->message);
+    g_clear_error(&error);
+  }
+
+  g_mutex_lock(&base->mutex);
+  base->ready = TRUE;
+  g_cond_signal(&base->cond);
+  g_mutex_unlock(&base->mutex);
+
+  if (base->port != 0) {
+    g_main_loop_run(base->loop);
+  }
+
+  if (base->teardown != NULL) {
+    base->teardown(base->server, base->hook_data);
+  }
+  soup_server_disconnect(base->server);
+  g_clear_object(&base->server);
+  while (g_main_context_iteration(base->context, FALSE)) {
+  }
+
+  g_main_context_pop_thread_default(base->context);
+  return NULL;
+}
+
+static void
+fake_server_thread_start(FakeServerThread *base,
+                         const char *name,
+                         FakeServerHook setup,
+                         FakeServerHook teardown,
+                         gpointer hook_data)
+{
+  base->context = g_main_context_new();
+  base->loop = g_main_loop_new(base->context, FALSE);
+  g_mutex_init(&base->mutex);
+  g_cond_init(&base->cond);
+  base->setup = setup;
+  base->teardown = teardown;
+  base->hook_data = hook_data;
+  base->thread = g_thread_new(name, fake_server_thread_main, base);
+
+  g_mutex_lock(&base->mutex);
+  while (!base->ready) {
+    g_cond_wait(&base->cond, &base->mutex);
+  }
+  g_mutex_unlock(&base->mutex);
+}
+
+static gboolean
+fake_server_quit(gpointer data)
+{
+  g_main_loop_quit(data);
+  return G_SOURCE_REMOVE;
+}
+
+static void
+fake_server_thread_stop(FakeServerThread *base)
+{
+  if (base->thread == NULL) {
+    return;
+  }
+
+  g_main_context_invoke(base->context, fake_server_quit, base->loop);
+  g_thread_join(base->thread);
+  base->thread = NULL;
+
+  g_main_loop_unref(base->loop);
+  g_main_context_unref(base->context);
+  g_mutex_clear(&base->mutex);
+  g_cond_clear(&base->cond);
+}
+
+/* Runs func on the server thread after delay_ms (on the next iteration when
+ * zero). Must be called from a handler, i.e. on the server thread. */
+static void
+fake_server_schedule(guint delay_ms, GSourceFunc func, gpointer data)
+{
+  GSource *source = delay_ms > 0 ? g_timeout_source_new(delay_ms) : g_idle_source_new();
+  g_source_set_callback(source, func, data, NULL);
+  g_source_attach(source, g_main_context_get_thread_default());
+  g_source_unref(source);
+}
+
+static char *
+fake_server_builder_to_data(JsonBuilder *builder)
+{
+  JsonGenerator *generator = json_generator_new();
+  JsonNode *root = json_builder_get_root(builder);
+  json_generator_set_root(generator, root);
+  char *data = json_generator_to_data(generator, NULL);
+  json_node_free(root);
+  g_object_unref(generator);
+  g_object_unref(builder);
+  return data;
+}
+
+static void
+fake_server_reply(SoupServerMessage *msg, guint status, char *body)
+{
+  soup_server_message_set_status(msg, status, NULL);
+  soup_server_message_set_response(msg,
+                                   "application/json",
+                                   SOUP_MEMORY_TAKE,
+                                   body,
+                                   strlen(body));
+}
+
+static void
+fake_server_reply_error(SoupServerMessage *msg, guint status, const char *message)
+{
+  JsonBuilder *builder = json_builder_new();
+  json_builder_begin_object(builder);
+  json_builder_set_member_name(builder, "error");
+  json_builder_add_string_value(builder, message);
+  json_builder_end_object(builder);
+  fake_server_reply(msg, status, fake_server_builder_to_data(builder));
+}
+
+static JsonObject *
+fake_server_parse_request(SoupServerMessage *msg, JsonParser *parser)
+{
+  SoupMessageBody *body = soup_server_message_get_request_body(msg);
+  if (body == NULL || body->data == NULL ||
+      !json_parser_load_from_data(parser, body->data, (gssize)body->length, NULL)) {
+    return NULL;
+  }
+
+  JsonNode *root = json_parser_get_root(parser);
+  return root != NULL && JSON_NODE_HOLDS_OBJECT(root) ? json_node_get_object(root) : NULL;
+}
+
+static const char *
+fake_server_get_string(JsonObject *object, const char *member)
+{
+  if (object == NULL || !json_object_has_member(object, member)) {
+    return NULL;
+  }
+
+  JsonNode *node = json_object_get_member(object, member);
+  return JSON_NODE_HOLDS_VALUE(node) ? json_node_get_string(node) : NULL;
+}
+
+/* ---- Chrome DevTools ---------------------------------------------------- */
+
+static void
+fake_cdp_page_free(gpointer data)
+{
+  FakeCdpPage *page = data;
+  g_free(page->id);
+  g_free(page->title);
+  g_free(page->url);
+  g_free(page->text);
+  g_free(page);
+}
+
+static void
+fake_cdp_handle_list(SoupServer *soup_server,
+                     SoupServerMessage *msg,
+                     const char *path,
+                     GHashTable *query,
+                     gpointer user_data)
+{
+  (void)soup_server;
+  (void)path;
+  (void)query;
+  FakeCdpServer *server = user_data;
+
+  JsonBuilder *builder = json_builder_new();
+  json_builder_begin_array(builder);
+  g_mutex_lock(&server->lock);
+  for (guint i = 0; i < server->pages->len; i++) {
+    FakeCdpPage *page = g_ptr_array_index(server->pages, i);
+    char *ws_url = g_strdup_printf("ws://127.0.0.1:%u" FAKE_CDP_PAGE_PREFIX "%s",
+                                   server->base.port,
+                                   page->id);
+    json_builder_begin_object(builder);
+    json_builder_set_member_name(builder, "id");
+    json_builder_add_string_value(builder, page->id);
+    json_builder_set_member_name(builder, "type");
+    json_builder_add_string_value(builder, "page");
+    json_builder_set_member_name(builder, "title");
+    json_builder_add_string_value(builder, page->title);
+    json_builder_set_member_name(builder, "url");
+    json_builder_add_string_value(builder, page->url);
+    json_builder_set_member_name(builder, "webSocketDebuggerUrl");
+    json_builder_add_string_value(builder, ws_url);
+    json_builder_end_object(builder);
+    g_free(ws_url);
+  }
+  g_mutex_unlock(&server->lock);
+  json_builder_end_array(builder);
+
+  fake_server_reply(msg, SOUP_STATUS_OK, fake_server_builder_to_data(builder));
+}
+
+static void
+fake_cdp_handle_version(SoupServer *soup_server,
+                        SoupServerMessage *msg,
+                        const char *path,
+                        GHashTable *query,
+                        gpointer user_data)
+{
+  (void)soup_server;
+  (void)path;
+  (void)query;
+  FakeCdpServer *server = user_data;
+  fake_server_reply(msg,
+                    SOUP_STATUS_OK,
+                    g_strdup_printf("{\"Browser\":\"FakeChrome/1.0\",\"Protocol-Version\":\"1.3\","
+                                    "\"webSocketDebuggerUrl\":\"ws://127.0.0.1:%u"
+                                    FAKE_CDP_BROWSER_PATH "/fake\"}",
+                                    server->base.port));
+}
+
+/* A minimal document around the page text, enough for extractors. */
+static char *
+fake_cdp_build_html(const FakeCdpPage *page)
+{
+  char *title = g_markup_escape_text(page->title, -1);
+  char *text = g_markup_escape_text(page->text, -1);
+  char *html = g_strdup_printf("<html><head><title>%s</title></head>"
+                               "<body><nav>Home | About</nav>"
+                               "<article><h1>%s</h1><p>%s</p></article></body></html>",
+                               title,
+                               title,
+                               text);
+  g_free(title);
+  g_free(text);
+  return html;
+}
+
+static char *
+fake_cdp_build_evaluate_reply(FakeCdpServer *server,
+                              const char *page_id,
+                              gint64 id,
+                              gboolean want_html)
+{
+  JsonBuilder *builder = json_builder_new();
+  json_builder_begin_object(builder);
+  json_builder_set_member_name(builder, "id");
+  json_builder_add_int_value(builder, id);
+
+  g_mutex_lock(&server->lock);
+  FakeCdpPage *page = NULL;
+  for (guint i = 0; i < server->pages->len && page == NULL; i++) {
+    FakeCdpPage *candidate = g_ptr_array_index(server->pages, i);
+    if (g_strcmp0(candidate->id, page_id) == 0) {
+      page = candidate;
+    }
+  }
+
+  if (page == NULL) {
+    json_builder_set_member_name(builder, "error");
+    json_builder_begin_object(builder);
+    json_builder_set_member_name(builder, "message");
+    json_builder_add_string_value(builder, "Target closed");
+    json_builder_end_object(builder);
+  } else {
+    json_builder_set_member_name(builder, "result");
+    json_builder_begin_object(builder);
+    json_builder_set_member_name(builder, "result");
+    json_builder_begin_object(builder);
+    json_builder_set_member_name(builder, "type");
+    json_builder_add_string_value(builder, "object");
+    json_builder_set_member_name(builder, "value");
+    json_builder_begin_object(builder);
+    json_builder_set_member_name(builder, "title");
+    json_builder_add_string_value(builder, page->title);
+    json_builder_set_member_name(builder, "url");
+    json_builder_add_string_value(builder, page->url);
+    json_builder_set_member_name(builder, "text");
+    json_builder_add_string_value(builder, page->text);
+    if (want_html) {
+      char *html = fake_cdp_build_html(page);
+      json_builder_set_member_name(builder, "html");
+      json_builder_add_string_value(builder, html);
+      g_free(html);
+    }
+    json_builder_end_object(builder);
+    json_builder_end_object(builder);
+    json_builder_end_object(builder);
+    server->evaluate_count++;
+  }
+  g_mutex_unlock(&server->lock);
+
+  json_builder_end_object(builder);
+  return fake_server_builder_to_data(builder);
+}
+
+static gboolean
+fake_cdp_send_reply(gpointer data)
+{
+  FakeCdpReply *reply = data;
+  if (soup_websocket_connection_get_state(reply->connection) ==
+      SOUP_WEBSOCKET_STATE_OPEN) {
+    soup_websocket_connection_send_text(reply->connection, reply->payload);
+  }
+
+  g_object_unref(reply->connection);
+  g_free(reply->payload);
+  g_free(reply);
+  return G_SOURCE_REMOVE;
+}
+
+static void
+fake_cdp_on_message(SoupWebsocketConnection *connection,
+                    SoupWebsocketDataType type,
+                    GBytes *message,
+                    gpointer user_data)
+{
+  FakeCdpServer *server = user_data;
+  if (type != SOUP_WEBSOCKET_DATA_TEXT) {
+    return;
+  }
+
+  gsize length = 0;
+  const char *data = g_bytes_get_data(message, &length);
+  JsonParser *parser = json_parser_new();
+  if (!json_parser_load_from_data(parser, data, (gssize)length, NULL) ||
+      !JSON_NODE_HOLDS_OBJECT(json_parser_get_root(parser))) {
+    g_object_unref(parser);
+    return;
+  }
+
+  JsonObject *request = json_node_get_object(json_parser_get_root(parser));
+  gint64 id = json_object_has_member(request, "id")
+                  ? json_object_get_int_member(request, "id")
+                  : 0;
+  const char *method = fake_server_get_string(request, "method");
+  const char *page_id = g_object_get_data(G_OBJECT(connection), "fake-page-id");
+
+  FakeCdpReply *reply = g_new0(FakeCdpReply, 1);
+  reply->connection = g_object_ref(connection);
+  if (g_strcmp0(method, "Runtime.evaluate") == 0) {
+    JsonObject *params = json_object_has_member(request, "params")
+                             ? json_object_get_object_member(request, "params")
+                             : NULL;
+    const char *expression = params != NULL ? fake_server_get_string(params, "expression")
+                                            : NULL;
+    gboolean want_html =
+        expression != NULL && strstr(expression, "wantHtml=true") != NULL;
+    reply->payload = fake_cdp_build_evaluate_reply(server, page_id, id, want_html);
+  } else {
+    reply->payload = g_strdup_printf("{\"id\":%" G_GINT64_FORMAT
+                                     ",\"error\":{\"message\":\"Method not found\"}}",
+                                     id);
+  }
+  g_object_unref(parser);
+
+  g_mutex_lock(&server->lock);
+  guint delay_ms = server->evaluate_ms;
+  g_mutex_unlock(&server->lock);
+  fake_server_schedule(delay_ms, fake_cdp_send_reply, reply);
+}
+
+/* The browser-level target stream: answers Target.setDiscoverTargets with a
+ * targetCreated event per page, as Chrome does. */
+static void
+fake_cdp_on_browser_message(SoupWebsocketConnection *connection,
+                            SoupWebsocketDataType type,
+                            GBytes *message,
+                            gpointer user_data)
+{
+  FakeCdpServer *server = user_data;
+  if (type != SOUP_WEBSOCKET_DATA_TEXT) {
+    return;
+  }
+
+  gsize length = 0;
+  const char *data = g_bytes_get_data(message, &length);
+  JsonParser *parser = json_parser_new();
+  if (!json_parser_load_from_data(parser, data, (gssize)length, NULL) ||
+      !JSON_NODE_HOLDS_OBJECT(json_parser_get_root(parser))) {
+    g_object_unref(parser);
+    return;
+  }
+
+  JsonObject *request = json_node_get_object(json_parser_get_root(parser));
+  gint64 id = json_object_has_member(request, "id")
+                  ? json_object_get_int_member(request, "id")
+                  : 0;
+  gboolean discover = g_strcmp0(fake_server_get_string(request, "method"),
+                                "Target.setDiscoverTargets") == 0;
+  g_object_unref(parser);
+
+  char *reply = g_strdup_printf("{\"id\":%" G_GINT64_FORMAT ",\"result\":{}}", id);
+  soup_websocket_connection_send_text(connection, reply);
+  g_free(reply);
+  if (!discover) {
+    return;
+  }
+
+  g_mutex_lock(&server->lock);
+  for (guint i = 0; i < server->pages->len; i++) {
+    FakeCdpPage *page = g_ptr_array_index(server->pages, i);
+    JsonBuilder *builder = json_builder_new();
+    json_builder_begin_object(builder);
+    json_builder_set_member_name(builder, "method");
+    json_builder_add_string_value(builder, "Target.targetCreated");
+    json_builder_set_member_name(builder, "params");
+    json_builder_begin_object(builder);
+    json_builder_set_member_name(builder, "targetInfo");
+    json_builder_begin_object(builder);
+    json_builder_set_member_name(builder, "targetId");
+    json_builder_add_string_value(builder, page->id);
+    json_builder_set_member_name(builder, "type");
+    json_builder_add_string_value(builder, "page");
+    json_builder_set_member_name(builder, "title");
+    json_builder_add_string_value(builder, page->title);
+    json_builder_set_member_name(builder, "url");
+    json_builder_add_string_value(builder, page->url);
+    json_builder_end_object(builder);
+    json_builder_end_object(builder);
+    json_builder_end_object(builder);
+    char *event = fake_server_builder_to_data(builder);
+    soup_websocket_connection_send_text(connection, event);
+    g_free(event);
+  }
+  g_mutex_unlock(&server->lock);
+}
+
+static void
+fake_cdp_on_closed(SoupWebsocketConnection *connection, gpointer user_data)
+{
+  FakeCdpServer *server = user_data;
+  g_ptr_array_remove_fast(server->connections, connection);
+}
+
+static void
+fake_cdp_handle_socket(SoupServer *soup_server,
+                       SoupServerMessage *msg,
+                       const char *path,
+                       SoupWebsocketConnection *connection,
+                       gpointer user_data)
+{
+  (void)soup_server;
+  (void)msg;
+  FakeCdpServer *server = user_data;
+  const char *page_id = g_str_has_prefix(path, FAKE_CDP_PAGE_PREFIX)
+                            ? path + strlen(FAKE_CDP_PAGE_PREFIX)
+                            : "";
+
+  if (g_str_has_prefix(path, FAKE_CDP_BROWSER_PATH)) {
+    g_signal_connect(connection, "message", G_CALLBACK(fake_cdp_on_browser_message), server);
+  } else {
+    g_object_set_data_full(G_OBJECT(connection), "fake-page-id", g_strdup(page_id), g_free);
+    g_signal_connect(connection, "message", G_CALLBACK(fake_cdp_on_message), server);
+  }
+  g_signal_connect(connection, "closed", G_CALLBACK(fake_cdp_on_closed), server);
+  g_ptr_array_add(server->connections, g_object_ref(connection));
+}
+
+static void
+fake_cdp_setup(SoupServer *soup_server, gpointer user_data)
+{
+  FakeCdpServer *server = user_data;
+  soup_server_add_handler(soup_server, "/json/list", fake_cdp_handle_list, server, NULL);
+  soup_server_add_handler(soup_server, "/json/version", fake_cdp_handle_version, server, NULL);
+  soup_server_add_websocket_handler(soup_server,
+                                    "/devtools/page",
+                                    NULL,
+                                    NULL,
+                                    fake_cdp_handle_socket,
+                                    server,
+                                    NULL);
+  soup_server_add_websocket_handler(soup_server,
+                                    FAKE_CDP_BROWSER_PATH,
+                                    NULL,
+                                    NULL,
+                                    fake_cdp_handle_socket,
+                                    server,
+                                    NULL);
+}
+
+static void
+fake_cdp_teardown(SoupServer *soup_server, gpointer user_data)
+{
+  (void)soup_server;
+  FakeCdpServer *server = user_data;
+  for (guint i = 0; i < server->connections->len; i++) {
+    SoupWebsocketConnection *connection = g_ptr_array_index(server->connections, i);
+    g_signal_handlers_disconnect_by_data(connection, server);
+    if (soup_websocket_connection_get_state(connection) == SOUP_WEBSOCKET_STATE_OPEN) {
+      soup_websocket_connection_close(connection, SOUP_WEBSOCKET_CLOSE_GOING_AWAY, NULL);
+    }
+  }
+  g_ptr_array_set_size(server->connections, 0);
+}
+
+FakeCdpServer *
+fake_cdp_server_new(void)
+{
+  FakeCdpServer *server = g_new0(FakeCdpServer, 1);
+  g_mutex_init(&server->lock);
+  server->pages = g_ptr_array_new_with_free_func(fake_cdp_page_free);
+  server->connections = g_ptr_array_new_with_free_func(g_object_unref);
+  fake_server_thread_start(&server->base,
+                           "fake-cdp",
+                           fake_cdp_setup,
+                           fake_cdp_teardown,
+                           server);
+  return server;
+}
+
+void
+fake_cdp_server_free(FakeCdpServer *server)
+{
+  if (server == NULL) {
+    return;
+  }
+
+  fake_server_thread_stop(&server->base);
+  g_ptr_array_unref(server->connections);
+  g_ptr_array_unref(server->pages);
+  g_mutex_clear(&server->lock);
+  g_free(server);
+}
+
+guint
+fake_cdp_server_get_port(FakeCdpServer *server)
+{
+  return server != NULL ? server->base.port : 0;
+}
+
+void
+fake_cdp_server_add_page(FakeCdpServer *server,
+                         const char *id,
+                         const char *title,
+                         const char *url,
+                         const char *text)
+{
+  g_return_if_fail(server != NULL && id != NULL);
+
+  FakeCdpPage *page = g_new0(FakeCdpPage, 1);
+  page->id = g_strdup(id);
+  page->title = g_strdup(title != NULL ? title : "");
+  page->url = g_strdup(url != NULL ? url : "about:blank");
+  page->text = g_strdup(text != NULL ? text : "");
+
+  g_mutex_lock(&server->lock);
+  g_ptr_array_add(server->pages, page);
+  g_mutex_unlock(&server->lock);
+}
+
+void
+fake_cdp_server_set_latency_ms(FakeCdpServer *server, guint evaluate_ms)
+{
+  g_return_if_fail(server != NULL);
+
+  g_mutex_lock(&server->lock);
+  server->evaluate_ms = evaluate_ms;
+  g_mutex_unlock(&server->lock);
+}
+
+guint
+fake_cdp_server_get_evaluate_count(FakeCdpServer *server)
+{
+  g_return_val_if_fail(server != NULL, 0);
+
+  g_mutex_lock(&server->lock);
+  guint count = server->evaluate_count;
+  g_mutex_unlock(&server->lock);
+  return count;
+}
+
+/* ---- Ollama ------------------------------------------------------------- */
+
+static void
+fake_ollama_rule_free(gpointer data)
+{
+  FakeOllamaRule *rule = data;
+  g_free(rule->needle);
+  g_free(rule->label);
+  g_free(rule);
+}
+
+static gboolean
+fake_ollama_has_model(FakeOllamaServer *server, const char *model)
+{
+  gboolean found = FALSE;
+  g_mutex_lock(&server->lock);
+  for (guint i = 0; i < server->models->len && !found; i++) {
+    found = g_strcmp0(g_ptr_array_index(server->models, i), model) == 0;
+  }
+  g_mutex_unlock(&server->lock);
+  return found;
+}
+
+static void
+fake_ollama_handle_version(SoupServer *soup_server,
+                           SoupServerMessage *msg,
+                           const char *path,
+                           GHashTable *query,
+                           gpointer user_data)
+{
+  (void)soup_server;
+  (void)path;
+  (void)query;
+  (void)user_data;
+  fake_server_reply(msg, SOUP_STATUS_OK, g_strdup("{\"version\":\"0.0.0-fake\"}"));
+}
+
+static void
+fake_ollama_handle_tags(SoupServer *soup_server,
+                        SoupServerMessage *msg,
+                        const char *path,
+                        GHashTable *query,
+                        gpointer user_data)
+{
+  (void)soup_server;
+  (void)path;
+  (void)query;
+  FakeOllamaServer *server = user_data;
+
+  JsonBuilder *builder = json_builder_new();
+  json_builder_begin_object(builder);
+  json_builder_set_member_name(builder, "models");
+  json_builder_begin_array(builder);
+  g_mutex_lock(&server->lock);
+  for (guint i = 0; i < server->models->len; i++) {
+    const char *name = g_ptr_array_index(server->models, i);
+    json_builder_begin_object(builder);
+    json_builder_set_member_name(builder, "name");
+    json_builder_add_string_value(builder, name);
+    json_builder_set_member_name(builder, "model");
+    json_builder_add_string_value(builder, name);
+    json_builder_set_member_name(builder, "size");
+    json_builder_add_int_value(builder, 1000000);
+    json_builder_set_member_name(builder, "details");
+    json_builder_begin_object(builder);
+    json_builder_set_member_name(builder, "parameter_size");
+    json_builder_add_string_value(builder, "1B");
+    json_builder_set_member_name(builder, "quantization_level");
+    json_builder_add_string_value(builder, "Q4_0");
+    json_builder_end_object(builder);
+    json_builder_end_object(builder);
+  }
+  g_mutex_unlock(&server->lock);
+  json_builder_end_array(builder);
+  json_builder_end_object(builder);
+
+  fake_server_reply(msg, SOUP_STATUS_OK, fake_server_builder_to_data(builder));
+}
+
+static void
+fake_ollama_handle_ps(SoupServer *soup_server,
+                      SoupServerMessage *msg,
+                      const char *path,
+                      GHashTable *query,
+                      gpointer user_data)
+{
+  (void)soup_server;
+  (void)path;
+  (void)query;
+  FakeOllamaServer *server = user_data;
+
+  JsonBuilder *builder = json_builder_new();
+  json_builder_begin_object(builder);
+  json_builder_set_member_name(builder, "models");
+  json_builder_begin_array(builder);
+  g_mutex_lock(&server->lock);
+  GHashTableIter iter;
+  gpointer key = NULL;
+  g_hash_table_iter_init(&iter, server->loaded);
+  while (g_hash_table_iter_next(&iter, &key, NULL)) {
+    json_builder_begin_object(builder);
+    json_builder_set_member_name(builder, "name");
+    json_builder_add_string_value(builder, key);
+    json_builder_set_member_name(builder, "model");
+    json_builder_add_string_value(builder, key);
+    json_builder_end_object(builder);
+  }
+  g_mutex_unlock(&server->lock);
+  json_builder_end_array(builder);
+  json_builder_end_object(builder);
+
+  fake_server_reply(msg, SOUP_STATUS_OK, fake_server_builder_to_data(builder));
+}
+
+static void
+fake_ollama_handle_generate(SoupServer *soup_server,
+                            SoupServerMessage *msg,
+                            const char *path,
+                            GHashTable *query,
+                            gpointer user_data)
+{
+  (void)soup_server;
+  (void)path;
+  (void)query;
+  FakeOllamaServer *server = user_data;
+
+  JsonParser *parser = json_parser_new();
+  JsonObject *request = fake_server_parse_request(msg, parser);
+  const char *model = fake_server_get_string(request, "model");
+  if (model == NULL || !fake_ollama_has_model(server, model)) {
+    fake_server_reply_error(msg, SOUP_STATUS_NOT_FOUND, "model not found");
+    g_object_unref(parser);
+    return;
+  }
+
+  gint64 keep_alive = json_object_has_member(request, "keep_alive")
+                          ? json_object_get_int_member(request, "keep_alive")
+                          : 300;
+  g_mutex_lock(&server->lock);
+  if (keep_alive == 0) {
+    g_hash_table_remove(server->loaded, model);
+  } else {
+    g_hash_table_add(server->loaded, g_strdup(model));
+  }
+  g_mutex_unlock(&server->lock);
+
+  fake_server_reply(msg,
+                    SOUP_STATUS_OK,
+                    g_strdup_printf("{\"model\":\"%s\",\"response\":\"\",\"done\":true}", model));
+  g_object_unref(parser);
+}
+
+static void
+fake_ollama_add_embedding(JsonBuilder *builder, const char *text)
+{
+  double vector[FAKE_OLLAMA_EMBED_DIMENSIONS] = {0};
+  char *lower = g_utf8_strdown(text != NULL ? text : "", -1);
+  char **words = g_regex_split_simple("[^[:alnum:]]+", lower, 0, 0);
+  for (guint i = 0; words[i] != NULL; i++) {
+    if (*words[i] != '\0') {
+      vector[g_str_hash(words[i]) % FAKE_OLLAMA_EMBED_DIMENSIONS] += 1.0;
+    }
+  }
+  g_strfreev(words);
+  g_free(lower);
+
+  double norm = 0.0;
+  for (guint i = 0; i < FAKE_OLLAMA_EMBED_DIMENSIONS; i++) {
+    norm += vector[i] * vector[i];
+  }
+
+  json_builder_begin_array(builder);
+  for (guint i = 0; i < FAKE_OLLAMA_EMBED_DIMENSIONS; i++) {
+    json_builder_add_double_value(builder, norm > 0.0 ? vector[i] / sqrt(norm) : 0.0);
+  }
+  json_builder_end_array(builder);
+}
+
+static void
+fake_ollama_handle_embed(SoupServer *soup_server,
+                         SoupServerMessage *msg,
+                         const char *path,
+                         GHashTable *query,
+                         gpointer user_data)
+{
+  (void)soup_server;
+  (void)path;
+  (void)query;
+  FakeOllamaServer *server = user_data;
+
+  JsonParser *parser = json_parser_new();
+  JsonObject *request = fake_server_parse_request(msg, parser);
+  const char *model = fake_server_get_string(request, "model");
+  if (model == NULL || !fake_ollama_has_model(server, model)) {
+    fake_server_reply_error(msg, SOUP_STATUS_NOT_FOUND, "model not found");
+    g_object_unref(parser);
+    return;
+  }
+
+  JsonBuilder *builder = json_builder_new();
+  json_builder_begin_object(builder);
+  json_builder_set_member_name(builder, "model");
+  json_builder_add_string_value(builder, model);
+  json_builder_set_member_name(builder, "embeddings");
+  json_builder_begin_array(builder);
+  JsonNode *input = json_object_has_member(request, "input")
+                        ? json_object_get_member(request, "input")
+                        : NULL;
+  if (input != NULL && JSON_NODE_HOLDS_ARRAY(input)) {
+    JsonArray *inputs = json_node_get_array(input);
+    for (guint i = 0; i < json_array_get_length(inputs); i++) {
+      fake_ollama_add_embedding(builder, json_array_get_string_element(inputs, i));
+    }
+  } else if (input != NULL && JSON_NODE_HOLDS_VALUE(input)) {
+    fake_ollama_add_embedding(builder, json_node_get_string(input));
+  }
+  json_builder_end_array(builder);
+  json_builder_end_object(builder);
+
+  fake_server_reply(msg, SOUP_STATUS_OK, fake_server_builder_to_data(builder));
+  g_object_unref(parser);
+}
+
+static const char *
+fake_ollama_user_content(JsonObject *request)
+{
+  JsonArray *messages = json_object_has_member(request, "messages")
+                            ? json_object_get_array_member(request, "messages")
+                            : NULL;
+  const char *content = NULL;
+  guint count = messages != NULL ? json_array_get_length(messages) : 0;
+  for (guint i = 0; i < count; i++) {
+    JsonObject *message = json_array_get_object_element(messages, i);
+    if (g_strcmp0(fake_server_get_string(message, "role"), "user") == 0) {
+      content = fake_server_get_string(message, "content");
+    }
+  }
+  return content;
+}
+
+static char *
+fake_ollama_pick_label(FakeOllamaServer *server, const char *user_content)
+{
+  char *lower = g_utf8_strdown(user_content != NULL ? user_content : "", -1);
+  char *label = NULL;
+
+  g_mutex_lock(&server->lock);
+  for (guint i = 0; i < server->rules->len && label == NULL; i++) {
+    FakeOllamaRule *rule = g_ptr_array_index(server->rules, i);
+    if (strstr(lower, rule->needle) != NULL) {
+      label = g_strdup(rule->label);
+    }
+  }
+  if (label == NULL) {
+    label = g_strdup(server->default_label);
+  }
+  g_mutex_unlock(&server->lock);
+
+  g_free(lower);
+  return label;
+}
+
+static void
+fake_ollama_reply_free(FakeOllamaReply *reply)
+{
+  if (reply->finished_id != 0) {
+    g_signal_handler_disconnect(reply->msg, reply->finished_id);
+  }
+  g_object_unref(reply->msg);
+  g_free(reply->model);
+  g_free(reply->content);
+  g_free(reply);
+}
+
+static void
+fake_ollama_on_finished(SoupServerMessage *msg, gpointer user_data)
+{
+  (void)msg;
+  FakeOllamaReply *reply = user_data;
+  reply->finished = TRUE;
+}
+
+static void
+fake_ollama_append_chunk(FakeOllamaReply *reply, const char *piece, gboolean done)
+{
+  JsonBuilder *builder = json_builder_new();
+  json_builder_begin_object(builder);
+  json_builder_set_member_name(builder, "model");
+  json_builder_add_string_value(builder, reply->model);
+  json_builder_set_member_name(builder, "message");
+  json_builder_begin_object(builder);
+  json_builder_set_member_name(builder, "role");
+  json_builder_add_string_value(builder, "assistant");
+  json_builder_set_member_name(builder, "content");
+  json_builder_add_string_value(builder, piece);
+  json_builder_end_object(builder);
+  json_builder_set_member_name(builder, "done");
+  json_builder_add_boolean_value(builder, done);
+  if (done) {
+    json_builder_set_member_name(builder, "done_reason");
+    json_builder_add_string_value(builder, "stop");
+  }
+  json_builder_end_object(builder);
+
+  char *data = fake_server_builder_to_data(builder);
+  char *line = g_strconcat(data, "\n", NULL);
+  g_free(data);
+  soup_message_body_append(soup_server_message_get_response_body(reply->msg),
+                           SOUP_MEMORY_TAKE,
+                           line,
+                           strlen(line));
+}
+
+static gboolean
+fake_ollama_stream_tick(gpointer data)
+{
+  FakeOllamaReply *reply = data;
+  if (reply->finished) {
+    fake_ollama_reply_free(reply);
+    return G_SOURCE_REMOVE;
+  }
+
+  if (!reply->stream) {
+    reply->offset = strlen(reply->content);
+    fake_ollama_append_chunk(reply, reply->content, TRUE);
+    soup_message_body_complete(soup_server_message_get_response_body(reply->msg));
+    soup_server_message_unpause(reply->msg);
+    fake_ollama_reply_free(reply);
+    return G_SOURCE_REMOVE;
+  }
+
+  const char *start = reply->content + reply->offset;
+  if (*start == '\0') {
+    fake_ollama_append_chunk(reply, "", TRUE);
+    soup_message_body_complete(soup_server_message_get_response_body(reply->msg));
+    soup_server_message_unpause(reply->msg);
+    fake_ollama_reply_free(reply);
+    return G_SOURCE_REMOVE;
+  }
+
+  const char *end = start;
+  for (guint i = 0; i < FAKE_OLLAMA_TOKEN_CHARS && *end != '\0'; i++) {
+    end = g_utf8_next_char(end);
+  }
+  char *piece = g_strndup(start, (gsize)(end - start));
+  fake_ollama_append_chunk(reply, piece, FALSE);
+  g_free(piece);
+  reply->offset = (gsize)(end - reply->content);
+  soup_server_message_unpause(reply->msg);
+
+  fake_server_schedule(reply->per_token_ms, fake_ollama_stream_tick, reply);
+  return G_SOURCE_REMOVE;
+}
+
+static void
+fake_ollama_handle_chat(SoupServer *soup_server,
+                        SoupServerMessage *msg,
+                        const char *path,
+                        GHashTable *query,
+                        gpointer user_data)
+{
+  (void)soup_server;
+  (void)path;
+  (void)query;
+  FakeOllamaServer *server = user_data;
+
+  JsonParser *parser = json_parser_new();
+  JsonObject *request = fake_server_parse_request(msg, parser);
+  const char *model = fake_server_get_string(request, "model");
+  if (request == NULL) {
+    fake_server_reply_error(msg, SOUP_STATUS_BAD_REQUEST, "invalid request");
+    g_object_unref(parser);
+    return;
+  }
+  if (model == NULL || !fake_ollama_has_model(server, model)) {
+    fake_server_reply_error(msg, SOUP_STATUS_NOT_FOUND, "model not found");
+    g_object_unref(parser);
+    return;
+  }
+
+  char *label = fake_ollama_pick_label(server, fake_ollama_user_content(request));
+  gboolean structured = json_object_has_member(request, "format");
+
+  FakeOllamaReply *reply = g_new0(FakeOllamaReply, 1);
+  reply->msg = g_object_ref(msg);
+  reply->model = g_strdup(model);
+  reply->content = structured ? g_strdup_printf("{\"label\": \"%s\"}", label)
+                              : g_strdup(label);
+  reply->stream = !json_object_has_member(request, "stream") ||
+                  json_object_get_boolean_member(request, "stream");
+  g_free(label);
+
+  g_mutex_lock(&server->lock);
+  server->chat_count++;
+  g_hash_table_add(server->loaded, g_strdup(model));
+  reply->per_token_ms = server->per_token_ms;
+  guint first_token_ms = server->first_token_ms;
+  g_mutex_unlock(&server->lock);
+  g_object_unref(parser);
+
+  soup_server_message_set_status(msg, SOUP_STATUS_OK, NULL);
+  SoupMessageHeaders *headers = soup_server_message_get_response_headers(msg);
+  soup_message_headers_set_content_type(headers,
+                                        reply->stream ? "application/x-ndjson"
+                                                      : "application/json",
+                                        NULL);
+  soup_message_headers_set_encoding(headers, SOUP_ENCODING_CHUNKED);
+  reply->finished_id = g_signal_connect(msg,
+                                        "finished",
+                                        G_CALLBACK(fake_ollama_on_finished),
+                                        reply);
+  soup_server_message_pause(msg);
+  fake_server_schedule(first_token_ms, fake_ollama_stream_tick, reply);
+}
+
+static void
+fake_ollama_setup(SoupServer *soup_server, gpointer user_data)
+{
+  FakeOllamaServer *server = user_data;
+  soup_server_add_handler(soup_server, "/api/version", fake_ollama_handle_version, server, NULL);
+  soup_server_add_handler(soup_server, "/api/tags", fake_ollama_handle_tags, server, NULL);
+  soup_server_add_handler(soup_server, "/api/ps", fake_ollama_handle_ps, server, NULL);
+  soup_server_add_handler(soup_server, "/api/generate", fake_ollama_handle_generate, server, NULL);
+  soup_server_add_handler(soup_server, "/api/embed", fake_ollama_handle_embed, server, NULL);
+  soup_server_add_handler(soup_server, "/api/chat", fake_ollama_handle_chat, server, NULL);
+}
+
+FakeOllamaServer *
+fake_ollama_server_new(void)
+{
+  FakeOllamaServer *server = g_new0(FakeOllamaServer, 1);
+  g_mutex_init(&server->lock);
+  server->models = g_ptr_array_new_with_free_func(g_free);
+  server->rules = g_ptr_array_new_with_free_func(fake_ollama_rule_free);
+  server->default_label = g_strdup("not sure");
+  server->loaded = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+  fake_server_thread_start(&server->base, "fake-ollama", fake_ollama_setup, NULL, server);
+  server->base_url = g_strdup_printf("http://127.0.0.1:%u", server->base.port);
+  return server;
+}
+
+void
+fake_ollama_server_free(FakeOllamaServer *server)
+{
+  if (server == NULL) {
+    return;
+  }
+
+  fake_server_thread_stop(&server->base);
+  g_free(server->base_url);
+  g_ptr_array_unref(server->models);
+  g_ptr_array_unref(server->rules);
+  g_free(server->default_label);
+  g_hash_table_unref(server->loaded);
+  g_mutex_clear(&server->lock);
+  g_free(server);
+}
+
+const char *
+fake_ollama_server_get_base_url(FakeOllamaServer *server)
+{
+  return server != NULL ? server->base_url : NULL;
+}
+
+void
+fake_ollama_server_add_model(FakeOllamaServer *server, const char *name)
+{
+  g_return_if_fail(server != NULL && name != NULL);
+
+  g_mutex_lock(&server->lock);
+  g_ptr_array_add(server->models, g_strdup(name));
+  g_mutex_unlock(&server->lock);
+}
+
+void
+fake_ollama_server_set_latency_ms(FakeOllamaServer *server,
+                                  guint first_token_ms,
+                                  guint per_token_ms)
+{
+  g_return_if_fail(server != NULL);
+
+  g_mutex_lock(&server->lock);
+  server->first_token_ms = first_token_ms;
+  server->per_token_ms = per_token_ms;
+  g_mutex_unlock(&server->lock);
+}
+
+void
+fake_ollama_server_set_default_label(FakeOllamaServer *server, const char *label)
+{
+  g_return_if_fail(server != NULL && label != NULL);
+
+  g_mutex_lock(&server->lock);
+  g_free(server->default_label);
+  server->default_label = g_strdup(label);
+  g_mutex_unlock(&server->lock);
+}
+
+void
+fake_ollama_server_add_label_rule(FakeOllamaServer *server,
+                                  const char *needle,
+                                  const char *label)
+{
+  g_return_if_fail(server != NULL && needle != NULL && label != NULL);
+
+  FakeOllamaRule *rule = g_new0(FakeOllamaRule, 1);
+  rule->needle = g_utf8_strdown(needle, -1);
+  rule->label = g_strdup(label);
+
+  g_mutex_lock(&server->lock);
+  g_ptr_array_add(server->rules, rule);
+  g_mutex_unlock(&server->lock);
+}
+
+guint
+fake_ollama_server_get_chat_count(FakeOllamaServer *server)
+{
+  g_return_val_if_fail(server != NULL, 0);
+
+  g_mutex_lock(&server->lock);
+  guint count = server->chat_count;
+  g_mutex_unlock(&server->lock);
+  return count;
+}
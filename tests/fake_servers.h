@@ -0,0 +1,35 @@
+#pragma once
+
+#include <glib.h>
+
+/* In-process stand-ins for Chrome's DevTools endpoint and the Ollama API.
+ * Each server runs its own main loop on a private thread, so the blocking
+ * client calls under test can run on the test thread unchanged. */
+
+typedef struct _FakeCdpServer FakeCdpServer;
+typedef struct _FakeOllamaServer FakeOllamaServer;
+
+FakeCdpServer *fake_cdp_server_new(void);
+void fake_cdp_server_free(FakeCdpServer *server);
+guint fake_cdp_server_get_port(FakeCdpServer *server);
+void fake_cdp_server_add_page(FakeCdpServer *server,
+                              const char *id,
+                              const char *title,
+                              const char *url,
+                              const char *text);
+void fake_cdp_server_set_latency_ms(FakeCdpServer *server, guint evaluate_ms);
+guint fake_cdp_server_get_evaluate_count(FakeCdpServer *server);
+
+FakeOllamaServer *fake_ollama_server_new(void);
+void fake_ollama_server_free(FakeOllamaServer *server);
+const char *fake_ollama_server_get_base_url(FakeOllamaServer *server);
+void fake_ollama_server_add_model(FakeOllamaServer *server, const char *name);
+void fake_ollama_server_set_latency_ms(FakeOllamaServer *server,
+                                       guint first_token_ms,
+                                       guint per_token_ms);
+void fake_ollama_server_set_default_label(FakeOllamaServer *server,
+                                          const char *label);
+void fake_ollama_server_add_label_rule(FakeOllamaServer *server,
+                                       const char *needle,
+                                       const char *label);
+guint fake_ollama_server_get_chat_count(FakeOllamaServer *server);
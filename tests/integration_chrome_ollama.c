@@ -324,7 +324,7 @@ test_chrome_ollama_pipeline(void)
   }
 
   if (!ollama_client_detect_available()) {
-    g_test_skip("Ollama not available on PATH.");
+    g_test_skip("Ollama server not reachable.");
     return;
   }
 
@@ -403,7 +403,7 @@ test_chrome_ollama_pipeline(void)
   ChromeCdpPage *page = NULL;
   for (int attempt = 0; attempt < 50 && page == NULL; attempt++) {
     GError *error = NULL;
-    page = chrome_cdp_fetch_page_sync(port, title, NULL, &error);
+    page = chrome_cdp_fetch_page_sync(port, title, CHROME_CDP_FETCH_TEXT, NULL, &error);
     if (page == NULL) {
       if (error != NULL) {
         g_test_message("CDP attempt %d failed: %s", attempt + 1, error->message);
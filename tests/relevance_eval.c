@@ -0,0 +1,446 @@
+#include <gio/gio.h>
+#include <glib.h>
+#include <json-glib/json-glib.h>
+#include <string.h>
+
+#include "fake_servers.h"
+#include "focus/chrome_cdp_client.h"
+#include "focus/content_extractor.h"
+#include "focus/ollama_client.h"
+#include "focus/relevance_prompt.h"
+
+/* Runs a labeled dataset through the focus guard's relevance prompt and
+ * chat client and reports accuracy, the confusion matrix, token counts and
+ * latency per model, so models and prompt variants can be compared.
+ *
+ *   relevance_eval [--endpoint URL | --fake] [--system-prompt FILE]
+ *                  [--repeat N] --model NAME [--model NAME ...] DATASET.jsonl
+ *
+ * Each dataset line is a JSON object with "task", "title", "url", either
+ * "content" (page text) or "html" (run through the main-content extractor
+ * like a live page), and "label": relevant, unsure or irrelevant (the
+ * prompt's own labels are accepted as well). */
+
+#define EVAL_LABEL_COUNT 4
+
+typedef struct {
+  char *task;
+  ChromeCdpPage page;
+  FocusGuardRelevance expected;
+} EvalCase;
+
+typedef struct {
+  char *model;
+  guint confusion[EVAL_LABEL_COUNT][EVAL_LABEL_COUNT];
+  guint requests;
+  guint errors;
+  GArray *latency_us;
+  GArray *first_chunk_us;
+  guint64 prompt_tokens;
+  guint prompt_tokens_reported;
+  guint64 prompt_tokens_estimated;
+  guint64 output_chunks;
+} EvalReport;
+
+static const char *const eval_label_names[EVAL_LABEL_COUNT] = {
+    "none",
+    "relevant",
+    "unsure",
+    "irrelevant",
+};
+
+static void
+eval_case_free(gpointer data)
+{
+  EvalCase *eval_case = data;
+  if (eval_case == NULL) {
+    return;
+  }
+
+  g_free(eval_case->task);
+  g_free(eval_case->page.title);
+  g_free(eval_case->page.url);
+  g_free(eval_case->page.text);
+  g_free(eval_case);
+}
+
+static void
+eval_report_free(gpointer data)
+{
+  EvalReport *report = data;
+  if (report == NULL) {
+    return;
+  }
+
+  g_free(report->model);
+  g_array_unref(report->latency_us);
+  g_array_unref(report->first_chunk_us);
+  g_free(report);
+}
+
+static FocusGuardRelevance
+eval_parse_label(const char *label)
+{
+  if (label == NULL) {
+    return FOCUS_GUARD_RELEVANCE_UNKNOWN;
+  }
+
+  if (g_ascii_strcasecmp(label, "relevant") == 0 ||
+      g_ascii_strcasecmp(label, "directly relevant") == 0) {
+    return FOCUS_GUARD_RELEVANCE_RELEVANT;
+  }
+  if (g_ascii_strcasecmp(label, "unsure") == 0 ||
+      g_ascii_strcasecmp(label, "not sure") == 0) {
+    return FOCUS_GUARD_RELEVANCE_UNSURE;
+  }
+  if (g_ascii_strcasecmp(label, "irrelevant") == 0 ||
+      g_ascii_strcasecmp(label, "clearly irrelevant") == 0) {
+    return FOCUS_GUARD_RELEVANCE_IRRELEVANT;
+  }
+  return FOCUS_GUARD_RELEVANCE_UNKNOWN;
+}
+
+static const char *
+eval_get_string(JsonObject *object, const char *member)
+{
+  if (!json_object_has_member(object, member)) {
+    return NULL;
+  }
+
+  JsonNode *node = json_object_get_member(object, member);
+  return JSON_NODE_HOLDS_VALUE(node) ? json_node_get_string(node) : NULL;
+}
+
+/* Page text goes through the same budget as a live check: extracted main
+ * content for HTML, clipped text otherwise. */
+static char *
+eval_page_text(const char *content, const char *html)
+{
+  char *text = NULL;
+  if (html != NULL) {
+    text = content_extractor_extract(html, strlen(html), RELEVANCE_PROMPT_TOKEN_BUDGET);
+  }
+  if (text == NULL && content != NULL) {
+    text = content_extractor_clip(content, RELEVANCE_PROMPT_TOKEN_BUDGET);
+  }
+  return text != NULL ? text : g_strdup("");
+}
+
+static GPtrArray *
+eval_load_dataset(const char *path, GError **error)
+{
+  char *contents = NULL;
+  if (!g_file_get_contents(path, &contents, NULL, error)) {
+    return NULL;
+  }
+
+  GPtrArray *cases = g_ptr_array_new_with_free_func(eval_case_free);
+  JsonParser *parser = json_parser_new();
+  char **lines = g_strsplit(contents, "\n", -1);
+  gboolean ok = TRUE;
+  for (guint i = 0; lines[i] != NULL && ok; i++) {
+    char *line = g_strstrip(lines[i]);
+    if (*line == '\0' || *line == '#') {
+      continue;
+    }
+
+    if (!json_parser_load_from_data(parser, line, -1, error)) {
+      g_prefix_error(error, "%s:%u: ", path, i + 1);
+      ok = FALSE;
+      break;
+    }
+
+    JsonNode *root = json_parser_get_root(parser);
+    JsonObject *object = JSON_NODE_HOLDS_OBJECT(root) ? json_node_get_object(root) : NULL;
+    const char *task = object != NULL ? eval_get_string(object, "task") : NULL;
+    FocusGuardRelevance expected =
+        object != NULL ? eval_parse_label(eval_get_string(object, "label"))
+                       : FOCUS_GUARD_RELEVANCE_UNKNOWN;
+    if (task == NULL || expected == FOCUS_GUARD_RELEVANCE_UNKNOWN) {
+      g_set_error(error,
+                  G_IO_ERROR,
+                  G_IO_ERROR_INVALID_DATA,
+                  "%s:%u: needs \"task\" and a \"label\" of relevant, unsure or irrelevant",
+                  path,
+                  i + 1);
+      ok = FALSE;
+      break;
+    }
+
+    EvalCase *eval_case = g_new0(EvalCase, 1);
+    eval_case->task = g_strdup(task);
+    eval_case->expected = expected;
+    eval_case->page.title = g_strdup(eval_get_string(object, "title"));
+    eval_case->page.url = g_strdup(eval_get_string(object, "url"));
+    eval_case->page.text = eval_page_text(eval_get_string(object, "content"),
+                                          eval_get_string(object, "html"));
+    g_ptr_array_add(cases, eval_case);
+  }
+
+  g_strfreev(lines);
+  g_object_unref(parser);
+  g_free(contents);
+
+  if (!ok) {
+    g_ptr_array_unref(cases);
+    return NULL;
+  }
+  return cases;
+}
+
+static char *
+eval_chat(const char *model,
+          const char *system_prompt,
+          const EvalCase *eval_case,
+          OllamaChatUsage *usage,
+          gint64 *elapsed_us_out,
+          GError **error)
+{
+  char *user_prompt = relevance_prompt_build_user(eval_case->task, &eval_case->page);
+  OllamaChatOptions options = {
+      .num_predict = RELEVANCE_PROMPT_MAX_TOKENS,
+      .stop = relevance_prompt_stop,
+      .labels = relevance_prompt_labels,
+      .structured = TRUE,
+      .keep_alive_seconds = 300,
+      .usage = usage,
+  };
+
+  gint64 start_us = g_get_monotonic_time();
+  char *response =
+      ollama_client_chat_stream_sync(model, system_prompt, user_prompt, &options, NULL, error);
+  *elapsed_us_out = g_get_monotonic_time() - start_us;
+
+  g_free(user_prompt);
+  return response;
+}
+
+static gint
+eval_compare_us(gconstpointer left, gconstpointer right)
+{
+  gint64 a = *(const gint64 *)left;
+  gint64 b = *(const gint64 *)right;
+  return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+static double
+eval_percentile_ms(GArray *samples, guint percent)
+{
+  if (samples->len == 0) {
+    return 0.0;
+  }
+
+  g_array_sort(samples, eval_compare_us);
+  guint rank = (samples->len * percent + 99) / 100;
+  return g_array_index(samples, gint64, MAX(rank, 1) - 1) / 1000.0;
+}
+
+static EvalReport *
+eval_run_model(const char *model,
+               const char *system_prompt,
+               GPtrArray *cases,
+               guint repeat)
+{
+  EvalReport *report = g_new0(EvalReport, 1);
+  report->model = g_strdup(model);
+  report->latency_us = g_array_new(FALSE, FALSE, sizeof(gint64));
+  report->first_chunk_us = g_array_new(FALSE, FALSE, sizeof(gint64));
+
+  /* The first request loads the model; keep it out of the numbers. */
+  gint64 elapsed_us = 0;
+  GError *error = NULL;
+  char *warmup = eval_chat(model, system_prompt, g_ptr_array_index(cases, 0), NULL,
+                           &elapsed_us, &error);
+  if (warmup == NULL) {
+    g_printerr("%s: warm-up failed: %s\n", model, error->message);
+    g_clear_error(&error);
+  }
+  g_free(warmup);
+
+  for (guint round = 0; round < repeat; round++) {
+    for (guint i = 0; i < cases->len; i++) {
+      const EvalCase *eval_case = g_ptr_array_index(cases, i);
+      OllamaChatUsage usage = {0};
+      char *response =
+          eval_chat(model, system_prompt, eval_case, &usage, &elapsed_us, &error);
+      report->requests++;
+      if (response == NULL) {
+        g_printerr("%s: case %u failed: %s\n", model, i + 1, error->message);
+        g_clear_error(&error);
+        report->errors++;
+        continue;
+      }
+
+      FocusGuardRelevance verdict = relevance_prompt_parse_response(response);
+      report->confusion[eval_case->expected][verdict]++;
+      g_array_append_val(report->latency_us, elapsed_us);
+      if (usage.chunks > 0) {
+        g_array_append_val(report->first_chunk_us, usage.first_chunk_us);
+      }
+      report->output_chunks += usage.chunks;
+      if (usage.prompt_tokens > 0) {
+        report->prompt_tokens += usage.prompt_tokens;
+        report->prompt_tokens_reported++;
+      }
+
+      char *user_prompt = relevance_prompt_build_user(eval_case->task, &eval_case->page);
+      report->prompt_tokens_estimated += content_extractor_estimate_tokens(system_prompt) +
+                                         content_extractor_estimate_tokens(user_prompt);
+      g_free(user_prompt);
+      g_free(response);
+    }
+  }
+
+  return report;
+}
+
+static void
+eval_print_report(const EvalReport *report)
+{
+  guint answered = report->requests - report->errors;
+  guint correct = 0;
+  for (guint label = 1; label < EVAL_LABEL_COUNT; label++) {
+    correct += report->confusion[label][label];
+  }
+
+  g_print("\nModel %s: %u requests, %u failed\n", report->model, report->requests, report->errors);
+  g_print("  Accuracy      %.1f%% (%u of %u answered)\n",
+          answered > 0 ? 100.0 * correct / answered : 0.0,
+          correct,
+          answered);
+
+  g_print("  Confusion     expected \\ got");
+  for (guint got = 1; got < EVAL_LABEL_COUNT; got++) {
+    g_print(" %10s", eval_label_names[got]);
+  }
+  g_print(" %10s\n", eval_label_names[0]);
+  for (guint expected = 1; expected < EVAL_LABEL_COUNT; expected++) {
+    g_print("                %-14s", eval_label_names[expected]);
+    for (guint got = 1; got < EVAL_LABEL_COUNT; got++) {
+      g_print(" %10u", report->confusion[expected][got]);
+    }
+    g_print(" %10u\n", report->confusion[expected][0]);
+  }
+
+  if (answered > 0) {
+    if (report->prompt_tokens_reported > 0) {
+      g_print("  Prompt tokens avg %.0f (reported by Ollama)\n",
+              (double)report->prompt_tokens / report->prompt_tokens_reported);
+    } else {
+      g_print("  Prompt tokens avg ~%.0f (estimated; the stream stops at the label)\n",
+              (double)report->prompt_tokens_estimated / answered);
+    }
+    g_print("  Output tokens avg %.1f\n", (double)report->output_chunks / answered);
+  }
+
+  g_print("  Latency       p50 %.0f ms  p95 %.0f ms  max %.0f ms\n",
+          eval_percentile_ms(report->latency_us, 50),
+          eval_percentile_ms(report->latency_us, 95),
+          eval_percentile_ms(report->latency_us, 100));
+  g_print("  First token   p50 %.0f ms  p95 %.0f ms\n",
+          eval_percentile_ms(report->first_chunk_us, 50),
+          eval_percentile_ms(report->first_chunk_us, 95));
+}
+
+int
+main(int argc, char **argv)
+{
+  char *endpoint = NULL;
+  char **models = NULL;
+  char *system_prompt_path = NULL;
+  gint repeat = 1;
+  gboolean fake = FALSE;
+  GOptionEntry entries[] = {
+      {"endpoint", 'e', 0, G_OPTION_ARG_STRING, &endpoint,
+       "Ollama base URL (default http://127.0.0.1:11434)", "URL"},
+      {"fake", 0, 0, G_OPTION_ARG_NONE, &fake,
+       "Use the in-process Ollama stand-in (smoke test)", NULL},
+      {"model", 'm', 0, G_OPTION_ARG_STRING_ARRAY, &models,
+       "Model to evaluate (repeatable)", "NAME"},
+      {"system-prompt", 's', 0, G_OPTION_ARG_FILENAME, &system_prompt_path,
+       "Use this system prompt instead of the built-in one", "FILE"},
+      {"repeat", 'r', 0, G_OPTION_ARG_INT, &repeat,
+       "Run the dataset this many times per model", "N"},
+      {NULL},
+  };
+
+  GError *error = NULL;
+  GOptionContext *options = g_option_context_new("DATASET.jsonl");
+  g_option_context_set_summary(options,
+                               "Measures relevance accuracy and latency per Ollama model.");
+  g_option_context_add_main_entries(options, entries, NULL);
+  if (!g_option_context_parse(options, &argc, &argv, &error)) {
+    g_printerr("%s\n", error->message);
+    g_clear_error(&error);
+    g_option_context_free(options);
+    return 2;
+  }
+  g_option_context_free(options);
+
+  if (argc != 2 || models == NULL || models[0] == NULL) {
+    g_printerr("Usage: %s [--endpoint URL | --fake] --model NAME ... DATASET.jsonl\n",
+               g_get_prgname());
+    return 2;
+  }
+
+  GPtrArray *cases = eval_load_dataset(argv[1], &error);
+  if (cases == NULL || cases->len == 0) {
+    g_printerr("%s\n", error != NULL ? error->message : "Dataset is empty");
+    g_clear_error(&error);
+    if (cases != NULL) {
+      g_ptr_array_unref(cases);
+    }
+    return 2;
+  }
+
+  char *system_prompt = NULL;
+  if (system_prompt_path != NULL &&
+      !g_file_get_contents(system_prompt_path, &system_prompt, NULL, &error)) {
+    g_printerr("%s\n", error->message);
+    g_clear_error(&error);
+    g_ptr_array_unref(cases);
+    return 2;
+  }
+
+  FakeOllamaServer *fake_server = NULL;
+  if (fake) {
+    fake_server = fake_ollama_server_new();
+    fake_ollama_server_set_latency_ms(fake_server, 10, 2);
+    for (guint i = 0; models[i] != NULL; i++) {
+      fake_ollama_server_add_model(fake_server, models[i]);
+    }
+    ollama_client_set_base_url(fake_ollama_server_get_base_url(fake_server));
+  } else if (endpoint != NULL) {
+    ollama_client_set_base_url(endpoint);
+  }
+
+  g_print("Dataset %s: %u pages, %d run(s) per model\n",
+          argv[1],
+          cases->len,
+          MAX(repeat, 1));
+
+  int status = 0;
+  for (guint i = 0; models[i] != NULL; i++) {
+    EvalReport *report = eval_run_model(models[i],
+                                        system_prompt != NULL ? system_prompt
+                                                              : relevance_prompt_system(),
+                                        cases,
+                                        (guint)MAX(repeat, 1));
+    eval_print_report(report);
+    if (report->errors == report->requests) {
+      status = 1;
+    }
+    eval_report_free(report);
+  }
+
+  ollama_client_set_base_url(NULL);
+  if (fake_server != NULL) {
+    fake_ollama_server_free(fake_server);
+  }
+  g_free(system_prompt);
+  g_ptr_array_unref(cases);
+  g_strfreev(models);
+  g_free(system_prompt_path);
+  g_free(endpoint);
+  return status;
+}
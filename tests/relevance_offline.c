@@ -0,0 +1,481 @@
+#include <gio/gio.h>
+#include <glib.h>
+#include <string.h>
+
+#include "fake_servers.h"
+#include "focus/chrome_cdp_client.h"
+#include "focus/chrome_cdp_tabs.h"
+#include "focus/content_extractor.h"
+#include "focus/focus_latency.h"
+#include "focus/ollama_client.h"
+#include "focus/relevance_cache.h"
+
+#define TEST_MODEL "fake-llm"
+#define TEST_EMBED_MODEL "fake-embed"
+
+static const char *const test_labels[] = {
+    "directly relevant",
+    "not sure",
+    "clearly irrelevant",
+    NULL,
+};
+
+static const char *const test_stop[] = {
+    "}",
+    NULL,
+};
+
+typedef struct {
+  FakeCdpServer *cdp;
+  FakeOllamaServer *ollama;
+} OfflineFixture;
+
+static void
+offline_fixture_setup(OfflineFixture *fixture, gconstpointer user_data)
+{
+  (void)user_data;
+  fixture->cdp = fake_cdp_server_new();
+  g_assert_cmpuint(fake_cdp_server_get_port(fixture->cdp), >, 0);
+  fake_cdp_server_add_page(fixture->cdp,
+                           "A1",
+                           "Q4 Budget - Google Sheets",
+                           "https://docs.example.com/budget",
+                           "Revenue, expenses, forecasts and variance notes for Q4.");
+  fake_cdp_server_add_page(fixture->cdp,
+                           "B2",
+                           "Lo-fi hip hop radio - YouTube",
+                           "https://video.example.com/lofi",
+                           "Playlists, comments and music channels.");
+
+  fixture->ollama = fake_ollama_server_new();
+  fake_ollama_server_add_model(fixture->ollama, TEST_MODEL);
+  fake_ollama_server_add_model(fixture->ollama, TEST_EMBED_MODEL);
+  fake_ollama_server_add_label_rule(fixture->ollama, "variance notes", "directly relevant");
+  fake_ollama_server_add_label_rule(fixture->ollama, "playlists", "clearly irrelevant");
+  ollama_client_set_base_url(fake_ollama_server_get_base_url(fixture->ollama));
+}
+
+static void
+offline_fixture_teardown(OfflineFixture *fixture, gconstpointer user_data)
+{
+  (void)user_data;
+  ollama_client_set_base_url(NULL);
+  fake_ollama_server_free(fixture->ollama);
+  fake_cdp_server_free(fixture->cdp);
+}
+
+static char *
+build_user_prompt(const char *task_title, const ChromeCdpPage *page)
+{
+  return g_strdup_printf("<context>\n"
+                         "  <task-title>%s</task-title>\n"
+                         "  <page>\n"
+                         "    <page-title>%s</page-title>\n"
+                         "    <page-url>%s</page-url>\n"
+                         "    <page-content>\n%s\n    </page-content>\n"
+                         "  </page>\n"
+                         "</context>\n",
+                         task_title,
+                         page->title,
+                         page->url,
+                         page->text);
+}
+
+/* Fetches the tab matching window_title and asks the model about it, the
+ * same hops a relevance check takes. Returns the raw reply. */
+static char *
+run_pipeline(guint port, const char *window_title, GCancellable *cancellable, GError **error)
+{
+  ChromeCdpPage *page = chrome_cdp_fetch_page_sync(port,
+                                                   window_title,
+                                                   CHROME_CDP_FETCH_TEXT,
+                                                   cancellable,
+                                                   error);
+  if (page == NULL) {
+    return NULL;
+  }
+
+  gint64 start_us = g_get_monotonic_time();
+  char *prompt = build_user_prompt("Draft Q4 budget report", page);
+  focus_latency_record(FOCUS_LATENCY_PROMPT, start_us);
+
+  OllamaChatOptions options = {
+      .num_predict = 24,
+      .stop = test_stop,
+      .labels = test_labels,
+      .structured = TRUE,
+  };
+  start_us = g_get_monotonic_time();
+  char *response = ollama_client_chat_stream_sync(TEST_MODEL,
+                                                  "Reply with one label.",
+                                                  prompt,
+                                                  &options,
+                                                  cancellable,
+                                                  error);
+  if (response != NULL) {
+    focus_latency_record(FOCUS_LATENCY_INFERENCE, start_us);
+  }
+
+  g_free(prompt);
+  chrome_cdp_page_free(page);
+  return response;
+}
+
+static void
+test_cdp_selects_tab_by_title(OfflineFixture *fixture, gconstpointer user_data)
+{
+  (void)user_data;
+  guint port = fake_cdp_server_get_port(fixture->cdp);
+
+  GError *error = NULL;
+  ChromeCdpPage *page = chrome_cdp_fetch_page_sync(port,
+                                                   "Lo-fi hip hop radio - YouTube - Google Chrome",
+                                                   CHROME_CDP_FETCH_TEXT,
+                                                   NULL,
+                                                   &error);
+  g_assert_no_error(error);
+  g_assert_nonnull(page);
+  g_assert_cmpstr(page->url, ==, "https://video.example.com/lofi");
+  g_assert_nonnull(strstr(page->text, "Playlists"));
+  g_assert_null(page->html);
+  chrome_cdp_page_free(page);
+
+  page = chrome_cdp_fetch_target_sync(port, "A1", NULL, CHROME_CDP_FETCH_HTML, NULL, &error);
+  g_assert_no_error(error);
+  g_assert_cmpstr(page->title, ==, "Q4 Budget - Google Sheets");
+  g_assert_nonnull(page->html);
+  g_assert_nonnull(strstr(page->html, "<article>"));
+  chrome_cdp_page_free(page);
+
+  page = chrome_cdp_fetch_target_sync(port, "missing", NULL, CHROME_CDP_FETCH_TEXT, NULL, &error);
+  g_assert_null(page);
+  g_assert_nonnull(error);
+  g_clear_error(&error);
+
+  g_assert_cmpuint(fake_cdp_server_get_evaluate_count(fixture->cdp), ==, 2);
+}
+
+static void
+test_tab_tracker_unmatched_title(OfflineFixture *fixture, gconstpointer user_data)
+{
+  (void)user_data;
+  ChromeCdpTabTracker *tracker =
+      chrome_cdp_tab_tracker_new(fake_cdp_server_get_port(fixture->cdp), NULL, NULL);
+  g_assert_nonnull(tracker);
+
+  gint64 deadline = g_get_monotonic_time() + 5 * G_USEC_PER_SEC;
+  guint tab_count = 0;
+  while (tab_count < 2 && g_get_monotonic_time() < deadline) {
+    while (g_main_context_iteration(NULL, FALSE)) {
+    }
+    GPtrArray *tabs = chrome_cdp_tab_tracker_list_tabs(tracker);
+    tab_count = tabs->len;
+    g_ptr_array_unref(tabs);
+    if (tab_count < 2) {
+      g_usleep(10000);
+    }
+  }
+  g_assert_cmpuint(tab_count, ==, 2);
+
+  const ChromeCdpTab *tab =
+      chrome_cdp_tab_tracker_find_active(tracker, "Q4 Budget - Google Sheets - Google Chrome");
+  g_assert_nonnull(tab);
+  g_assert_cmpstr(tab->id, ==, "A1");
+  g_assert_cmpstr(tab->domain, ==, "example.com");
+
+  /* Chrome windows that are not a tab must not borrow a tab's domain. */
+  g_assert_null(chrome_cdp_tab_tracker_find_active(tracker, "DevTools - Google Chrome"));
+  g_assert_null(chrome_cdp_tab_tracker_find_active(tracker, NULL));
+
+  chrome_cdp_tab_tracker_free(tracker);
+}
+
+static void
+test_ollama_catalog(OfflineFixture *fixture, gconstpointer user_data)
+{
+  (void)fixture;
+  (void)user_data;
+  g_assert_true(ollama_client_detect_available());
+
+  GError *error = NULL;
+  GPtrArray *models = ollama_client_list_models_sync(&error);
+  g_assert_no_error(error);
+  g_assert_cmpuint(models->len, ==, 2);
+  g_assert_cmpstr(g_ptr_array_index(models, 0), ==, TEST_MODEL);
+  g_ptr_array_unref(models);
+
+  g_assert_false(ollama_client_is_model_loaded_sync(TEST_MODEL, NULL, &error));
+  g_assert_no_error(error);
+  g_assert_true(ollama_client_keep_alive_sync(TEST_MODEL, 60, NULL, &error));
+  g_assert_true(ollama_client_is_model_loaded_sync(TEST_MODEL, NULL, &error));
+  g_assert_true(ollama_client_keep_alive_sync(TEST_MODEL, 0, NULL, &error));
+  g_assert_false(ollama_client_is_model_loaded_sync(TEST_MODEL, NULL, &error));
+  g_assert_no_error(error);
+}
+
+static void
+test_ollama_embeddings(OfflineFixture *fixture, gconstpointer user_data)
+{
+  (void)fixture;
+  (void)user_data;
+  const char *inputs[] = {"budget report forecast", "budget report forecast", "lofi music", NULL};
+
+  GError *error = NULL;
+  GPtrArray *vectors = ollama_client_embed_sync(TEST_EMBED_MODEL, inputs, NULL, &error);
+  g_assert_no_error(error);
+  g_assert_cmpuint(vectors->len, ==, 3);
+
+  GArray *first = g_ptr_array_index(vectors, 0);
+  GArray *second = g_ptr_array_index(vectors, 1);
+  g_assert_cmpuint(first->len, ==, second->len);
+  for (guint i = 0; i < first->len; i++) {
+    g_assert_cmpfloat(g_array_index(first, float, i), ==, g_array_index(second, float, i));
+  }
+  g_ptr_array_unref(vectors);
+
+  vectors = ollama_client_embed_sync("missing-model", inputs, NULL, &error);
+  g_assert_null(vectors);
+  g_assert_nonnull(error);
+  g_clear_error(&error);
+}
+
+static void
+test_pipeline_labels(OfflineFixture *fixture, gconstpointer user_data)
+{
+  (void)user_data;
+  guint port = fake_cdp_server_get_port(fixture->cdp);
+  GError *error = NULL;
+
+  char *response = run_pipeline(port, "Q4 Budget - Google Sheets - Google Chrome", NULL, &error);
+  g_assert_no_error(error);
+  g_assert_nonnull(strstr(response, "directly relevant"));
+  g_free(response);
+
+  response = run_pipeline(port, "Lo-fi hip hop radio - YouTube - Google Chrome", NULL, &error);
+  g_assert_no_error(error);
+  g_assert_nonnull(strstr(response, "clearly irrelevant"));
+  g_free(response);
+
+  g_assert_cmpuint(fake_ollama_server_get_chat_count(fixture->ollama), ==, 2);
+}
+
+static gpointer
+cancel_after_delay(gpointer data)
+{
+  g_usleep(100 * 1000);
+  g_cancellable_cancel(data);
+  return NULL;
+}
+
+static void
+test_pipeline_cancel_slow_model(OfflineFixture *fixture, gconstpointer user_data)
+{
+  (void)user_data;
+  fake_ollama_server_set_latency_ms(fixture->ollama, 5000, 0);
+
+  GCancellable *cancellable = g_cancellable_new();
+  GThread *canceller = g_thread_new("canceller", cancel_after_delay, cancellable);
+
+  gint64 start_us = g_get_monotonic_time();
+  GError *error = NULL;
+  char *response = run_pipeline(fake_cdp_server_get_port(fixture->cdp),
+                                "Q4 Budget - Google Sheets",
+                                cancellable,
+                                &error);
+  g_assert_null(response);
+  g_assert_error(error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert_cmpint(g_get_monotonic_time() - start_us, <, 2 * G_USEC_PER_SEC);
+  g_clear_error(&error);
+
+  g_thread_join(canceller);
+  g_object_unref(cancellable);
+}
+
+typedef struct {
+  guint port;
+  guint iterations;
+  guint failures;
+} LoadWorker;
+
+static gpointer
+load_worker_run(gpointer data)
+{
+  LoadWorker *worker = data;
+  for (guint i = 0; i < worker->iterations; i++) {
+    const char *title = i % 2 == 0 ? "Q4 Budget - Google Sheets" : "Lo-fi hip hop radio - YouTube";
+    GError *error = NULL;
+    gint64 start_us = g_get_monotonic_time();
+    char *response = run_pipeline(worker->port, title, NULL, &error);
+    if (response == NULL) {
+      g_test_message("Load iteration failed: %s", error->message);
+      g_clear_error(&error);
+      worker->failures++;
+    } else {
+      focus_latency_record(FOCUS_LATENCY_TOTAL, start_us);
+    }
+    g_free(response);
+  }
+  return NULL;
+}
+
+/* Runs the pipeline from several threads at once. POMODORO_BENCH_ITERATIONS
+ * raises the per-thread count for benchmarking; the per-stage timings are
+ * printed either way. */
+static void
+test_pipeline_load(OfflineFixture *fixture, gconstpointer user_data)
+{
+  (void)user_data;
+  const guint threads = 4;
+  guint iterations = 10;
+  const char *env = g_getenv("POMODORO_BENCH_ITERATIONS");
+  if (env != NULL && *env != '\0') {
+    iterations = (guint)MAX(g_ascii_strtoull(env, NULL, 10), 1);
+  }
+
+  fake_ollama_server_set_latency_ms(fixture->ollama, 20, 2);
+  fake_cdp_server_set_latency_ms(fixture->cdp, 5);
+  focus_latency_reset();
+
+  LoadWorker workers[4];
+  GThread *handles[4];
+  for (guint i = 0; i < threads; i++) {
+    workers[i] = (LoadWorker){
+        .port = fake_cdp_server_get_port(fixture->cdp),
+        .iterations = iterations,
+        .failures = 0,
+    };
+    handles[i] = g_thread_new("load", load_worker_run, &workers[i]);
+  }
+
+  guint failures = 0;
+  for (guint i = 0; i < threads; i++) {
+    g_thread_join(handles[i]);
+    failures += workers[i].failures;
+  }
+
+  GString *report = g_string_new(NULL);
+  focus_latency_append_report(report);
+  g_test_message("%u threads x %u iterations\n%s", threads, iterations, report->str);
+  g_string_free(report, TRUE);
+
+  g_assert_cmpuint(failures, ==, 0);
+  g_assert_cmpuint(fake_ollama_server_get_chat_count(fixture->ollama), ==, threads * iterations);
+}
+
+static const char *const test_article_html =
+    "<html><head><title>Budget</title><script>var p = '<p>not text</p>';</script></head>"
+    "<body><header><nav><a href='/'>Home</a> | <a href='/news'>News</a></nav></header>"
+    "<div id='cookie-banner'>We use cookies, accept all cookies, thanks, ok, sure.</div>"
+    "<main><article class='post-content'><h1>Quarterly budget planning &amp; forecasting</h1>"
+    "<p>Budget planning for the fourth quarter starts with a review of actual spending "
+    "against forecast, category by category, so variances are understood first.</p>"
+    "<p>Each department lead submits a draft with headcount, software, travel and "
+    "contractor lines, and finance consolidates the drafts into one workbook.</p></article></main>"
+    "<aside class='sidebar'><ul><li><a href='/1'>Ten budget tips, really</a></li></ul></aside>"
+    "<div class='comments'><p>Great article, thanks for sharing, very helpful, love it.</p></div>"
+    "<footer><p>Copyright 2026, Example Corp, all rights reserved.</p></footer></body></html>";
+
+static void
+test_extract_main_content(void)
+{
+  char *text = content_extractor_extract(test_article_html, strlen(test_article_html), 1024);
+  g_assert_nonnull(text);
+  g_assert_true(g_str_has_prefix(text, "Quarterly budget planning & forecasting\n"));
+  g_assert_nonnull(strstr(text, "finance consolidates the drafts"));
+  g_assert_null(strstr(text, "Home"));
+  g_assert_null(strstr(text, "cookies"));
+  g_assert_null(strstr(text, "not text"));
+  g_assert_null(strstr(text, "Great article"));
+  g_assert_null(strstr(text, "Copyright"));
+  g_free(text);
+
+  text = content_extractor_extract(test_article_html, strlen(test_article_html), 40);
+  g_assert_nonnull(text);
+  g_assert_cmpuint(content_extractor_estimate_tokens(text), <=, 40);
+  g_free(text);
+
+  const char *menu = "<body><ul><li><a href='/a'>Home</a></li><li><a href='/b'>About</a></li></ul></body>";
+  g_assert_null(content_extractor_extract(menu, strlen(menu), 1024));
+}
+
+/* Each relevance check counts once, whether the tick's URL lookup or the
+ * worker's content lookup answers it. */
+static void
+test_cache_hit_rate(void)
+{
+  RelevanceCache *cache = relevance_cache_new(8);
+  const char *url = "https://docs.example.com/budget";
+  guint64 fingerprint = relevance_cache_fingerprint("Revenue, expenses and variance notes");
+  gint64 now_utc = 1700000000;
+  gint verdict = -1;
+
+  /* A miss by URL, then by content, then inference. */
+  g_assert_false(relevance_cache_lookup_url(cache, "budget", url, now_utc, &verdict));
+  g_assert_false(relevance_cache_lookup_content(cache,
+                                                "budget",
+                                                url,
+                                                fingerprint,
+                                                now_utc,
+                                                FALSE,
+                                                &verdict));
+  relevance_cache_insert(cache, "budget", url, fingerprint, 0, now_utc);
+
+  /* Answered by URL. */
+  g_assert_true(relevance_cache_lookup_url(cache, "budget", url, now_utc + 10, &verdict));
+  g_assert_cmpint(verdict, ==, 0);
+
+  /* The URL verdict has gone stale; the unchanged page still matches. */
+  g_assert_false(relevance_cache_lookup_url(cache, "budget", url, now_utc + 600, &verdict));
+  g_assert_true(relevance_cache_lookup_content(cache,
+                                               "budget",
+                                               url,
+                                               fingerprint,
+                                               now_utc + 600,
+                                               FALSE,
+                                               &verdict));
+
+  /* A window without a tracked tab only has the content lookup. */
+  g_assert_false(relevance_cache_lookup_content(cache,
+                                                "budget",
+                                                "https://video.example.com/lofi",
+                                                relevance_cache_fingerprint("Playlists"),
+                                                now_utc + 600,
+                                                TRUE,
+                                                &verdict));
+
+  RelevanceCacheStats stats;
+  relevance_cache_get_stats(cache, &stats);
+  g_assert_cmpuint(stats.lookups, ==, 4);
+  g_assert_cmpuint(stats.url_hits, ==, 1);
+  g_assert_cmpuint(stats.content_hits, ==, 1);
+  g_assert_cmpfloat(relevance_cache_stats_hit_rate(&stats), ==, 50.0);
+
+  relevance_cache_clear(cache);
+  relevance_cache_get_stats(cache, &stats);
+  g_assert_cmpuint(stats.lookups, ==, 0);
+  g_assert_cmpfloat(relevance_cache_stats_hit_rate(&stats), ==, 0.0);
+  relevance_cache_unref(cache);
+}
+
+int
+main(int argc, char **argv)
+{
+  g_test_init(&argc, &argv, NULL);
+
+#define ADD_OFFLINE_TEST(path, func)                                                           \
+  g_test_add(path, OfflineFixture, NULL, offline_fixture_setup, func, offline_fixture_teardown)
+
+  g_test_add_func("/offline/extract/main_content", test_extract_main_content);
+  g_test_add_func("/offline/cache/hit_rate", test_cache_hit_rate);
+  ADD_OFFLINE_TEST("/offline/cdp/select_tab", test_cdp_selects_tab_by_title);
+  ADD_OFFLINE_TEST("/offline/cdp/tab_tracker_unmatched", test_tab_tracker_unmatched_title);
+  ADD_OFFLINE_TEST("/offline/ollama/catalog", test_ollama_catalog);
+  ADD_OFFLINE_TEST("/offline/ollama/embeddings", test_ollama_embeddings);
+  ADD_OFFLINE_TEST("/offline/pipeline/labels", test_pipeline_labels);
+  ADD_OFFLINE_TEST("/offline/pipeline/cancel", test_pipeline_cancel_slow_model);
+  ADD_OFFLINE_TEST("/offline/pipeline/load", test_pipeline_load);
+
+#undef ADD_OFFLINE_TEST
+
+  return g_test_run();
+}
@@ -0,0 +1,258 @@
+#include <gio/gio.h>
+#include <glib.h>
+
+#include "focus/focus_scheduler.h"
+
+#define SCHEDULER_TEST_TIMEOUT_US (5 * G_USEC_PER_SEC)
+
+typedef struct {
+  FocusScheduler *scheduler;
+  GMutex lock;
+  /* Keys in the order their job bodies ran, on the worker threads. */
+  GPtrArray *ran;
+  /* Keys as their callbacks reported them, on the main thread. */
+  GPtrArray *finished;
+  GPtrArray *cancelled;
+  guint pending;
+  gint release;
+} SchedulerFixture;
+
+typedef struct {
+  SchedulerFixture *fixture;
+  char *key;
+  gboolean wait;
+} SchedulerJob;
+
+static void
+scheduler_job_free(gpointer data)
+{
+  SchedulerJob *job = data;
+  g_free(job->key);
+  g_free(job);
+}
+
+/* A waiting job holds its worker until the test releases it or cancels it. */
+static void
+scheduler_job_run(GTask *task,
+                  gpointer source_object,
+                  gpointer task_data,
+                  GCancellable *cancellable)
+{
+  (void)source_object;
+  SchedulerJob *job = task_data;
+  SchedulerFixture *fixture = job->fixture;
+
+  g_mutex_lock(&fixture->lock);
+  g_ptr_array_add(fixture->ran, g_strdup(job->key));
+  g_mutex_unlock(&fixture->lock);
+
+  gint64 deadline = g_get_monotonic_time() + SCHEDULER_TEST_TIMEOUT_US;
+  while (job->wait && !g_atomic_int_get(&fixture->release) &&
+         !g_cancellable_is_cancelled(cancellable) && g_get_monotonic_time() < deadline) {
+    g_usleep(1000);
+  }
+
+  if (g_task_return_error_if_cancelled(task)) {
+    return;
+  }
+  g_task_return_boolean(task, TRUE);
+}
+
+static void
+scheduler_job_done(GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  (void)source_object;
+  SchedulerFixture *fixture = user_data;
+  SchedulerJob *job = g_task_get_task_data(G_TASK(res));
+  GError *error = NULL;
+  if (g_task_propagate_boolean(G_TASK(res), &error)) {
+    g_ptr_array_add(fixture->finished, g_strdup(job->key));
+  } else {
+    g_assert_error(error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+    g_ptr_array_add(fixture->cancelled, g_strdup(job->key));
+    g_error_free(error);
+  }
+  fixture->pending--;
+}
+
+static void
+scheduler_submit(SchedulerFixture *fixture,
+                 const char *key,
+                 FocusSchedulerPriority priority,
+                 gboolean wait)
+{
+  SchedulerJob *job = g_new0(SchedulerJob, 1);
+  job->fixture = fixture;
+  job->key = g_strdup(key);
+  job->wait = wait;
+  fixture->pending++;
+  focus_scheduler_submit(fixture->scheduler,
+                         key,
+                         priority,
+                         0,
+                         scheduler_job_run,
+                         job,
+                         scheduler_job_free,
+                         scheduler_job_done,
+                         fixture);
+}
+
+static guint
+scheduler_ran_count(SchedulerFixture *fixture)
+{
+  g_mutex_lock(&fixture->lock);
+  guint count = fixture->ran->len;
+  g_mutex_unlock(&fixture->lock);
+  return count;
+}
+
+static void
+scheduler_wait_until_ran(SchedulerFixture *fixture, guint count)
+{
+  gint64 deadline = g_get_monotonic_time() + SCHEDULER_TEST_TIMEOUT_US;
+  while (scheduler_ran_count(fixture) < count && g_get_monotonic_time() < deadline) {
+    g_usleep(1000);
+  }
+  g_assert_cmpuint(scheduler_ran_count(fixture), >=, count);
+}
+
+static void
+scheduler_wait_idle(SchedulerFixture *fixture)
+{
+  gint64 deadline = g_get_monotonic_time() + SCHEDULER_TEST_TIMEOUT_US;
+  while (fixture->pending > 0 && g_get_monotonic_time() < deadline) {
+    if (!g_main_context_iteration(NULL, FALSE)) {
+      g_usleep(1000);
+    }
+  }
+  g_assert_cmpuint(fixture->pending, ==, 0);
+}
+
+static char *
+scheduler_join(SchedulerFixture *fixture, GPtrArray *keys)
+{
+  g_mutex_lock(&fixture->lock);
+  GString *joined = g_string_new(NULL);
+  for (guint i = 0; i < keys->len; i++) {
+    if (i > 0) {
+      g_string_append_c(joined, ',');
+    }
+    g_string_append(joined, g_ptr_array_index(keys, i));
+  }
+  g_mutex_unlock(&fixture->lock);
+  return g_string_free(joined, FALSE);
+}
+
+static void
+scheduler_assert_keys(SchedulerFixture *fixture, GPtrArray *keys, const char *expected)
+{
+  char *joined = scheduler_join(fixture, keys);
+  g_assert_cmpstr(joined, ==, expected);
+  g_free(joined);
+}
+
+static void
+scheduler_fixture_setup(SchedulerFixture *fixture, gconstpointer user_data)
+{
+  (void)user_data;
+  /* One worker makes the queue order observable. */
+  fixture->scheduler = focus_scheduler_new(1);
+  g_mutex_init(&fixture->lock);
+  fixture->ran = g_ptr_array_new_with_free_func(g_free);
+  fixture->finished = g_ptr_array_new_with_free_func(g_free);
+  fixture->cancelled = g_ptr_array_new_with_free_func(g_free);
+}
+
+static void
+scheduler_fixture_teardown(SchedulerFixture *fixture, gconstpointer user_data)
+{
+  (void)user_data;
+  g_atomic_int_set(&fixture->release, 1);
+  scheduler_wait_idle(fixture);
+  focus_scheduler_free(fixture->scheduler);
+  g_ptr_array_unref(fixture->cancelled);
+  g_ptr_array_unref(fixture->finished);
+  g_ptr_array_unref(fixture->ran);
+  g_mutex_clear(&fixture->lock);
+}
+
+static void
+test_scheduler_priority_order(SchedulerFixture *fixture, gconstpointer user_data)
+{
+  (void)user_data;
+  scheduler_submit(fixture, "blocker", FOCUS_SCHEDULER_PRIORITY_NORMAL, TRUE);
+  scheduler_wait_until_ran(fixture, 1);
+
+  scheduler_submit(fixture, "low", FOCUS_SCHEDULER_PRIORITY_LOW, FALSE);
+  scheduler_submit(fixture, "normal-1", FOCUS_SCHEDULER_PRIORITY_NORMAL, FALSE);
+  scheduler_submit(fixture, "high", FOCUS_SCHEDULER_PRIORITY_HIGH, FALSE);
+  scheduler_submit(fixture, "normal-2", FOCUS_SCHEDULER_PRIORITY_NORMAL, FALSE);
+  g_assert_cmpuint(scheduler_ran_count(fixture), ==, 1);
+
+  g_atomic_int_set(&fixture->release, 1);
+  scheduler_wait_idle(fixture);
+
+  /* Higher priority first; equal priorities keep submission order. */
+  scheduler_assert_keys(fixture, fixture->ran, "blocker,high,normal-1,normal-2,low");
+  scheduler_assert_keys(fixture, fixture->cancelled, "");
+}
+
+static void
+test_scheduler_cancel_queued(SchedulerFixture *fixture, gconstpointer user_data)
+{
+  (void)user_data;
+  scheduler_submit(fixture, "blocker", FOCUS_SCHEDULER_PRIORITY_NORMAL, TRUE);
+  scheduler_wait_until_ran(fixture, 1);
+
+  scheduler_submit(fixture, "queued", FOCUS_SCHEDULER_PRIORITY_NORMAL, FALSE);
+  scheduler_submit(fixture, "page", FOCUS_SCHEDULER_PRIORITY_NORMAL, FALSE);
+  /* Newest wins: the second job for a key drops the queued first one. */
+  scheduler_submit(fixture, "page", FOCUS_SCHEDULER_PRIORITY_NORMAL, FALSE);
+  focus_scheduler_cancel(fixture->scheduler, "queued");
+  g_assert_false(focus_scheduler_is_busy(fixture->scheduler, "queued"));
+  g_assert_true(focus_scheduler_is_busy(fixture->scheduler, "page"));
+
+  g_atomic_int_set(&fixture->release, 1);
+  scheduler_wait_idle(fixture);
+
+  scheduler_assert_keys(fixture, fixture->ran, "blocker,page");
+  scheduler_assert_keys(fixture, fixture->finished, "blocker,page");
+  scheduler_assert_keys(fixture, fixture->cancelled, "page,queued");
+}
+
+static void
+test_scheduler_cancel_running(SchedulerFixture *fixture, gconstpointer user_data)
+{
+  (void)user_data;
+  scheduler_submit(fixture, "running", FOCUS_SCHEDULER_PRIORITY_NORMAL, TRUE);
+  scheduler_wait_until_ran(fixture, 1);
+  g_assert_true(focus_scheduler_is_busy(fixture->scheduler, "running"));
+
+  focus_scheduler_cancel(fixture->scheduler, "running");
+  g_assert_false(focus_scheduler_is_busy(fixture->scheduler, "running"));
+
+  /* The only worker is still winding the cancelled job down. */
+  scheduler_submit(fixture, "next", FOCUS_SCHEDULER_PRIORITY_NORMAL, FALSE);
+  scheduler_wait_idle(fixture);
+
+  scheduler_assert_keys(fixture, fixture->ran, "running,next");
+  scheduler_assert_keys(fixture, fixture->finished, "next");
+  scheduler_assert_keys(fixture, fixture->cancelled, "running");
+}
+
+int
+main(int argc, char **argv)
+{
+  g_test_init(&argc, &argv, NULL);
+
+#define ADD_SCHEDULER_TEST(path, func)                                                         \
+  g_test_add(path, SchedulerFixture, NULL, scheduler_fixture_setup, func, scheduler_fixture_teardown)
+
+  ADD_SCHEDULER_TEST("/scheduler/priority_order", test_scheduler_priority_order);
+  ADD_SCHEDULER_TEST("/scheduler/cancel_queued", test_scheduler_cancel_queued);
+  ADD_SCHEDULER_TEST("/scheduler/cancel_running", test_scheduler_cancel_running);
+
+#undef ADD_SCHEDULER_TEST
+
+  return g_test_run();
+}